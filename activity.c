@@ -0,0 +1,379 @@
+/**
+ * activity.c - Activity Feed for Git Master
+ *
+ * Records one structured event per operation (time, repository,
+ * operation, duration, result) in a fixed-size ring. A ring has exactly
+ * one producer thread and any number of readers, and neither side takes
+ * a lock: the producer stamps each slot with a sequence number before
+ * and after writing it, and a reader keeps its copy of a slot only if
+ * the number was the same on both sides of the copy.
+ *
+ * Rings are files mapped shared under <config dir>/activity/, one per
+ * producer, so `git_master --stats` can report what a running GUI or
+ * daemon did.
+ */
+
+#include "config.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* ============================================================================
+ * Ring Layout
+ * ============================================================================ */
+
+#define ACTIVITY_MAGIC      0x54434147u     /* "GACT" */
+#define ACTIVITY_VERSION    1
+#define ACTIVITY_DIR_NAME   "activity"
+#define ACTIVITY_SUFFIX     ".ring"
+
+typedef struct {
+    _Atomic uint64_t seq;       /* 2n + 2 once event n is complete, odd while written */
+    activity_event_t event;
+} activity_slot_t;
+
+/* File contents; only the producer writes */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t slot_size;
+    _Atomic uint64_t head;      /* Events written so far */
+    activity_slot_t slots[];
+} activity_file_t;
+
+struct activity_ring {
+    activity_file_t *file;
+    size_t size;
+    int fd;
+    bool private_file;          /* Per-process fallback, removed on close */
+    char path[MAX_PATH_LEN];
+    char source[16];
+};
+
+#define ACTIVITY_FILE_SIZE \
+    (sizeof(activity_file_t) + ACTIVITY_RING_CAPACITY * sizeof(activity_slot_t))
+
+/* ============================================================================
+ * Helpers
+ * ============================================================================ */
+
+/**
+ * Monotonic clock in milliseconds, for measuring durations
+ */
+double activity_clock_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+/**
+ * Directory holding the ring files, next to the config file
+ */
+static bool activity_dir(char *dir, size_t size) {
+    const char *config_path = config_get_default_path();
+    const char *slash = strrchr(config_path, '/');
+
+    if (slash == NULL) {
+        return false;
+    }
+
+    int n = snprintf(dir, size, "%.*s", (int)(slash - config_path), config_path);
+    if (n < 0 || (size_t)n >= size) {
+        return false;
+    }
+    mkdir(dir, 0755);
+
+    n = snprintf(dir + n, size - (size_t)n, "/%s", ACTIVITY_DIR_NAME);
+    if (n < 0) {
+        return false;
+    }
+    return mkdir(dir, 0755) == 0 || errno == EEXIST;
+}
+
+/**
+ * Copy a string into a fixed field, keeping its end if it is too long
+ * (the end of a path names the repository)
+ */
+static void activity_copy(char *dst, size_t size, const char *src, bool keep_tail) {
+    size_t len;
+
+    if (src == NULL) src = "";
+    len = strlen(src);
+
+    if (len < size) {
+        memcpy(dst, src, len + 1);
+    } else if (keep_tail && size > 4) {
+        memcpy(dst, "...", 3);
+        memcpy(dst + 3, src + len - (size - 4), size - 3);
+    } else {
+        memcpy(dst, src, size - 1);
+        dst[size - 1] = '\0';
+    }
+}
+
+static bool activity_file_valid(const activity_file_t *file) {
+    return file->magic == ACTIVITY_MAGIC && file->version == ACTIVITY_VERSION &&
+           file->capacity == ACTIVITY_RING_CAPACITY &&
+           file->slot_size == sizeof(activity_slot_t);
+}
+
+/**
+ * Copy the newest complete events of a ring, oldest first
+ *
+ * Slots the producer is rewriting during the copy are skipped.
+ */
+static int activity_read_file(const activity_file_t *file, activity_event_t *events, int max) {
+    uint64_t head = atomic_load_explicit(&file->head, memory_order_acquire);
+    uint64_t first = head > (uint64_t)max ? head - (uint64_t)max : 0;
+    int count = 0;
+
+    if (head - first > file->capacity) {
+        first = head - file->capacity;
+    }
+
+    for (uint64_t n = first; n < head; n++) {
+        const activity_slot_t *slot = &file->slots[n % file->capacity];
+        uint64_t expected = 2 * n + 2;
+
+        if (atomic_load_explicit(&slot->seq, memory_order_acquire) != expected) {
+            continue;
+        }
+        events[count] = slot->event;
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == expected) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* ============================================================================
+ * Producer
+ * ============================================================================ */
+
+static int activity_open_file(const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+    if (fd < 0) {
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * Open the ring a producer thread writes to
+ *
+ * The ring file is named after the source and keeps its events across
+ * runs. If another process is producing into it, a per-process file is
+ * used instead and removed on close.
+ *
+ * @param source Producer name, e.g. "gui"
+ * @return activity_ring_t* Ring handle, or NULL (pushing to NULL is a no-op)
+ */
+activity_ring_t* activity_open(const char *source) {
+    char dir[MAX_PATH_LEN];
+    activity_ring_t *ring;
+    struct stat st;
+
+    if (source == NULL || !activity_dir(dir, sizeof(dir))) {
+        return NULL;
+    }
+
+    ring = calloc(1, sizeof(activity_ring_t));
+    if (ring == NULL) {
+        return NULL;
+    }
+    activity_copy(ring->source, sizeof(ring->source), source, false);
+
+    ring->fd = -1;
+    if (snprintf(ring->path, sizeof(ring->path), "%s/%s%s",
+                 dir, ring->source, ACTIVITY_SUFFIX) < (int)sizeof(ring->path)) {
+        ring->fd = activity_open_file(ring->path);
+    }
+    if (ring->fd < 0 &&
+        snprintf(ring->path, sizeof(ring->path), "%s/%s-%d%s",
+                 dir, ring->source, (int)getpid(), ACTIVITY_SUFFIX) < (int)sizeof(ring->path)) {
+        ring->fd = activity_open_file(ring->path);
+        ring->private_file = true;
+    }
+    if (ring->fd < 0) {
+        free(ring);
+        return NULL;
+    }
+
+    ring->size = ACTIVITY_FILE_SIZE;
+    if (fstat(ring->fd, &st) != 0 || (size_t)st.st_size != ring->size) {
+        if (ftruncate(ring->fd, 0) != 0 || ftruncate(ring->fd, (off_t)ring->size) != 0) {
+            close(ring->fd);
+            free(ring);
+            return NULL;
+        }
+    }
+
+    ring->file = mmap(NULL, ring->size, PROT_READ | PROT_WRITE, MAP_SHARED, ring->fd, 0);
+    if (ring->file == MAP_FAILED) {
+        close(ring->fd);
+        free(ring);
+        return NULL;
+    }
+
+    if (!activity_file_valid(ring->file)) {
+        memset(ring->file, 0, ring->size);
+        ring->file->capacity = ACTIVITY_RING_CAPACITY;
+        ring->file->slot_size = sizeof(activity_slot_t);
+        ring->file->version = ACTIVITY_VERSION;
+        atomic_store_explicit(&ring->file->head, 0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        ring->file->magic = ACTIVITY_MAGIC;
+    }
+
+    return ring;
+}
+
+/**
+ * Close a ring opened with activity_open
+ */
+void activity_close(activity_ring_t *ring) {
+    if (ring == NULL) return;
+
+    munmap(ring->file, ring->size);
+    if (ring->private_file) {
+        unlink(ring->path);
+    }
+    close(ring->fd);
+    free(ring);
+}
+
+/**
+ * Record a finished operation
+ *
+ * Only the thread that owns the ring may push. Never blocks; the oldest
+ * event is overwritten when the ring is full.
+ *
+ * @param op Operation name, e.g. "commit"
+ * @param repo Repository path (may be NULL)
+ * @param duration_ms How long the operation took
+ * @param result Its outcome
+ * @param detail Short free text (may be NULL)
+ */
+void activity_push(activity_ring_t *ring, const char *op, const char *repo,
+                   double duration_ms, gm_error_t result, const char *detail) {
+    if (ring == NULL) return;
+
+    activity_file_t *file = ring->file;
+    uint64_t n = atomic_load_explicit(&file->head, memory_order_relaxed);
+    activity_slot_t *slot = &file->slots[n % file->capacity];
+    activity_event_t *event = &slot->event;
+    struct timespec now;
+
+    atomic_store_explicit(&slot->seq, 2 * n + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    event->timestamp_ms = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    event->duration_ms = duration_ms <= 0 ? 0 :
+                         duration_ms >= UINT32_MAX ? UINT32_MAX : (uint32_t)duration_ms;
+    event->result = (int32_t)result;
+    memcpy(event->source, ring->source, sizeof(event->source));
+    activity_copy(event->op, sizeof(event->op), op, false);
+    activity_copy(event->repo, sizeof(event->repo), repo, true);
+    activity_copy(event->detail, sizeof(event->detail), detail, false);
+
+    atomic_store_explicit(&slot->seq, 2 * n + 2, memory_order_release);
+    atomic_store_explicit(&file->head, n + 1, memory_order_release);
+}
+
+/* ============================================================================
+ * Readers
+ * ============================================================================ */
+
+/**
+ * Copy the newest events of a ring, oldest first
+ *
+ * Safe from any thread while the producer keeps pushing.
+ *
+ * @return int Number of events copied
+ */
+int activity_read(const activity_ring_t *ring, activity_event_t *events, int max) {
+    if (ring == NULL || events == NULL || max <= 0) {
+        return 0;
+    }
+    return activity_read_file(ring->file, events, max);
+}
+
+static int compare_event_time(const void *a, const void *b) {
+    const activity_event_t *x = a;
+    const activity_event_t *y = b;
+    return (x->timestamp_ms > y->timestamp_ms) - (x->timestamp_ms < y->timestamp_ms);
+}
+
+/**
+ * Read every producer's ring, merged by time
+ *
+ * @param events Output array, oldest first (free with free())
+ * @return int Number of events, or -1 if the activity directory is unreadable
+ */
+int activity_read_all(activity_event_t **events) {
+    char dir[MAX_PATH_LEN];
+    DIR *dp;
+    struct dirent *entry;
+    int count = 0;
+    int capacity = 0;
+
+    *events = NULL;
+    if (!activity_dir(dir, sizeof(dir)) || (dp = opendir(dir)) == NULL) {
+        return -1;
+    }
+
+    while ((entry = readdir(dp)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        size_t suffix_len = strlen(ACTIVITY_SUFFIX);
+        char path[MAX_PATH_LEN];
+        struct stat st;
+
+        if (len <= suffix_len || strcmp(entry->d_name + len - suffix_len, ACTIVITY_SUFFIX) != 0 ||
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name) >= (int)sizeof(path)) {
+            continue;
+        }
+
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size != ACTIVITY_FILE_SIZE) {
+            close(fd);
+            continue;
+        }
+
+        activity_file_t *file = mmap(NULL, ACTIVITY_FILE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (file == MAP_FAILED) continue;
+
+        if (activity_file_valid(file)) {
+            if (count + ACTIVITY_RING_CAPACITY > capacity) {
+                capacity = count + ACTIVITY_RING_CAPACITY;
+                activity_event_t *grown = safe_realloc(*events, (size_t)capacity * sizeof(activity_event_t));
+                if (grown == NULL) {
+                    munmap(file, ACTIVITY_FILE_SIZE);
+                    break;
+                }
+                *events = grown;
+            }
+            count += activity_read_file(file, *events + count, ACTIVITY_RING_CAPACITY);
+        }
+        munmap(file, ACTIVITY_FILE_SIZE);
+    }
+    closedir(dp);
+
+    if (count > 1) {
+        qsort(*events, (size_t)count, sizeof(activity_event_t), compare_event_time);
+    }
+    return count;
+}
@@ -6,6 +6,9 @@
  */
 
 #include "git_master.h"
+#include <ctype.h>
+#include <sys/statfs.h>
+#include <sys/sysmacros.h>
 
 /* ============================================================================
  * Repository Status Functions
@@ -148,40 +151,42 @@ repo_status_t* get_repo_status(void) {
         strncpy(status->repo_path, ".", sizeof(status->repo_path) - 1);
     }
     
-    /* Get current branch */
-    get_current_branch(status->current_branch, sizeof(status->current_branch));
-    
-    /* Check for uncommitted changes */
-    cmd_result_t *result = exec_git_command("status --porcelain");
-    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-        status->has_uncommitted_changes = (strlen(result->output) > 0);
+    /* Count modified, staged, and untracked files; like `git status`, an
+       untracked directory counts once instead of once per file inside it */
+    change_list_t changes;
+    if (load_change_list_at(NULL, &changes, "normal") == GM_SUCCESS) {
+        status->has_uncommitted_changes = (changes.count > 0);
         
-        /* Count modified, staged, and untracked files */
-        char *line = strtok(result->output, "\n");
-        while (line != NULL) {
-            if (strlen(line) >= 2) {
-                char index_status = line[0];
-                char worktree_status = line[1];
-                
-                if (index_status != ' ' && index_status != '?') {
-                    status->staged_files_count++;
-                    status->has_staged_changes = true;
-                }
-                
-                if (worktree_status != ' ' && worktree_status != '?') {
-                    status->modified_files_count++;
-                }
-                
-                if (index_status == '?' && worktree_status == '?') {
-                    status->untracked_files_count++;
-                    status->has_untracked_files = true;
-                }
+        for (int i = 0; i < changes.count; i++) {
+            const change_entry_t *entry = &changes.entries[i];
+            
+            if (entry->kind == CHANGE_UNTRACKED) {
+                status->untracked_files_count++;
+                status->has_untracked_files = true;
+                continue;
+            }
+            
+            if (entry->kind == CHANGE_IGNORED) {
+                continue;
+            }
+            
+            if (entry->index_state != '.') {
+                status->staged_files_count++;
+                status->has_staged_changes = true;
+            }
+            
+            if (entry->worktree_state != '.') {
+                status->modified_files_count++;
             }
-            line = strtok(NULL, "\n");
         }
-        free_cmd_result(result);
-    } else if (result != NULL) {
-        free_cmd_result(result);
+        
+        /* The branch header saves a separate rev-parse */
+        snprintf(status->current_branch, sizeof(status->current_branch), "%s", changes.branch);
+        free_change_list(&changes);
+    }
+    
+    if (strlen(status->current_branch) == 0) {
+        get_current_branch(status->current_branch, sizeof(status->current_branch));
     }
     
     return status;
@@ -414,9 +419,34 @@ gm_error_t delete_branch(const char *branch_name, bool force) {
     return GM_SUCCESS;
 }
 
+/**
+ * Map a failed switch to an error code, printing the reason
+ */
+static gm_error_t report_switch_failure(const cmd_result_t *result, const char *branch_name) {
+    if (result->error != NULL) {
+        /* Check for specific errors */
+        if (strstr(result->error, "invalid reference") != NULL ||
+            strstr(result->error, "a branch is expected") != NULL) {
+            PRINT_ERROR("Branch '%s' does not exist", branch_name);
+            return GM_ERR_BRANCH_NOT_FOUND;
+        }
+        if (strstr(result->error, "uncommitted changes") != NULL ||
+            strstr(result->error, "would be overwritten") != NULL) {
+            PRINT_ERROR("Cannot switch: uncommitted changes would be lost");
+            PRINT_INFO("Commit or stash your changes first");
+            return GM_ERR_UNCOMMITTED_CHANGES;
+        }
+        PRINT_ERROR("Failed to switch branch: %s", result->error);
+    }
+    return GM_ERR_CHECKOUT_FAILED;
+}
+
 /**
  * Switch to a different branch
  * 
+ * Large or sparse checkouts are routed through switch_branch_large,
+ * which enables parallel checkout and reports per-phase timings.
+ * 
  * @param branch_name Name of the branch to switch to
  * @return gm_error_t Error code
  */
@@ -425,12 +455,6 @@ gm_error_t switch_branch(const char *branch_name) {
         return GM_ERR_INVALID_INPUT;
     }
     
-    /* Check if branch exists */
-    if (!branch_exists(branch_name)) {
-        PRINT_ERROR("Branch '%s' does not exist", branch_name);
-        return GM_ERR_BRANCH_NOT_FOUND;
-    }
-    
     /* Check for uncommitted changes that might be lost */
     repo_status_t *status = get_repo_status();
     if (status != NULL) {
@@ -441,8 +465,22 @@ gm_error_t switch_branch(const char *branch_name) {
         free_repo_status(status);
     }
     
+    checkout_stats_t stats;
+    if (plan_checkout(&stats) == GM_SUCCESS && stats.large) {
+        gm_error_t err = switch_branch_large(branch_name, &stats);
+        if (err == GM_SUCCESS) {
+            print_checkout_stats(&stats);
+        }
+        return err;
+    }
+    
     char cmd[MAX_COMMAND_LEN];
-    snprintf(cmd, sizeof(cmd), "checkout \"%s\"", branch_name);
+    /*
+     * "switch --no-guess" only accepts local branches, so a missing
+     * branch is reported by the checkout itself instead of a separate
+     * show-ref spawn beforehand.
+     */
+    snprintf(cmd, sizeof(cmd), "switch --no-guess \"%s\"", branch_name);
     
     cmd_result_t *result = exec_git_command(cmd);
     
@@ -451,19 +489,9 @@ gm_error_t switch_branch(const char *branch_name) {
     }
     
     if (result->exit_code != 0) {
-        if (result->error != NULL) {
-            /* Check for specific errors */
-            if (strstr(result->error, "uncommitted changes") != NULL ||
-                strstr(result->error, "would be overwritten") != NULL) {
-                PRINT_ERROR("Cannot switch: uncommitted changes would be lost");
-                PRINT_INFO("Commit or stash your changes first");
-                free_cmd_result(result);
-                return GM_ERR_UNCOMMITTED_CHANGES;
-            }
-            PRINT_ERROR("Failed to switch branch: %s", result->error);
-        }
+        gm_error_t err = report_switch_failure(result, branch_name);
         free_cmd_result(result);
-        return GM_ERR_CHECKOUT_FAILED;
+        return err;
     }
     
     free_cmd_result(result);
@@ -628,6 +656,85 @@ gm_error_t list_branches(branch_info_t **branches, int *count, bool include_remo
     return GM_SUCCESS;
 }
 
+/**
+ * Get a branch's upstream and how far the branch is ahead of and
+ * behind it
+ * 
+ * The upstream is resolved from branch.<name>.remote/merge and the
+ * remote's fetch refspecs in process, and the counts come from the
+ * ahead/behind engine; git is only asked when the config needs it.
+ * 
+ * @param branch_name Local branch name
+ * @param upstream Output: short upstream name, e.g. "origin/main"
+ * @param len Size of upstream
+ * @param ahead Output: commits only on the branch
+ * @param behind Output: commits only on the upstream
+ * @return gm_error_t GM_ERR_BRANCH_NOT_FOUND if there is no upstream
+ */
+gm_error_t get_upstream_status(const char *branch_name, char *upstream, size_t len,
+                               int *ahead, int *behind) {
+    if (branch_name == NULL || upstream == NULL || len == 0 || ahead == NULL || behind == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    *ahead = 0;
+    *behind = 0;
+    
+    char upstream_ref[MAX_PATH_LEN];
+    char local_ref[MAX_BRANCH_NAME + 16];
+    gm_error_t err = resolve_upstream_ref(branch_name, upstream_ref, sizeof(upstream_ref));
+    
+    if (err == GM_SUCCESS) {
+        ahead_behind_t pair;
+        memset(&pair, 0, sizeof(pair));
+        snprintf(local_ref, sizeof(local_ref), "refs/heads/%s", branch_name);
+        
+        /* A configured upstream that was never fetched does not count */
+        if (resolve_ref_oid(local_ref, pair.left, sizeof(pair.left)) != GM_SUCCESS ||
+            resolve_ref_oid(upstream_ref, pair.right, sizeof(pair.right)) != GM_SUCCESS) {
+            return GM_ERR_BRANCH_NOT_FOUND;
+        }
+        
+        snprintf(upstream, len, "%s", short_ref_name(upstream_ref));
+        if (strcmp(pair.left, pair.right) != 0 && compute_ahead_behind(&pair, 1) == GM_SUCCESS) {
+            *ahead = pair.ahead;
+            *behind = pair.behind;
+        }
+        return GM_SUCCESS;
+    }
+    
+    if (err != GM_ERR_IO_ERROR) {
+        return err;
+    }
+    
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "rev-parse --abbrev-ref \"%s@{upstream}\"", branch_name);
+    cmd_result_t *result = exec_git_command(cmd);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    if (result->exit_code != 0 || result->output == NULL) {
+        free_cmd_result(result);
+        return GM_ERR_BRANCH_NOT_FOUND;
+    }
+    snprintf(upstream, len, "%s", trim_whitespace(result->output));
+    free_cmd_result(result);
+    
+    snprintf(cmd, sizeof(cmd), "rev-list --left-right --count \"%s\"...\"%s@{upstream}\"", 
+             branch_name, branch_name);
+    result = exec_git_command(cmd);
+    
+    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
+        sscanf(result->output, "%d\t%d", ahead, behind);
+    }
+    if (result != NULL) {
+        free_cmd_result(result);
+    }
+    
+    return GM_SUCCESS;
+}
+
 /**
  * Get detailed information about a specific branch
  * 
@@ -680,31 +787,1001 @@ gm_error_t get_branch_info(const char *branch_name, branch_info_t *info) {
     }
     
     /* Get upstream tracking info */
-    snprintf(cmd, sizeof(cmd), "rev-parse --abbrev-ref \"%s@{upstream}\"", branch_name);
-    result = exec_git_command(cmd);
-    
-    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-        strncpy(info->remote, trim_whitespace(result->output), sizeof(info->remote) - 1);
+    if (get_upstream_status(branch_name, info->remote, sizeof(info->remote),
+                            &info->commits_ahead, &info->commits_behind) == GM_SUCCESS) {
         info->has_upstream = true;
+    }
+    
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Large Repository Checkout
+ * ============================================================================ */
+
+/* Index size above which a checkout is treated as large (~100k entries) */
+#define LARGE_INDEX_BYTES       (8LL * 1024 * 1024)
+#define MAX_CHECKOUT_WORKERS    32
+
+/* Filesystem magic numbers for network mounts (see statfs(2)) */
+#define FS_MAGIC_NFS            0x6969
+#define FS_MAGIC_SMB2           0xFE534D42
+#define FS_MAGIC_CIFS           0xFF534D42
+#define FS_MAGIC_FUSE           0x65735546
+
+/**
+ * Read a sysfs "rotational" flag for a block device
+ *
+ * @return int 1 rotational, 0 solid-state, -1 unknown
+ */
+static int read_rotational(unsigned int major_id, unsigned int minor_id) {
+    char path[128];
+    const char *candidates[] = { "queue/rotational", "../queue/rotational" };
+
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        /* Partitions have no queue/ of their own; their parent does */
+        snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/%s",
+                 major_id, minor_id, candidates[i]);
+
+        FILE *fp = fopen(path, "r");
+        if (fp != NULL) {
+            int value = -1;
+            if (fscanf(fp, "%d", &value) != 1) {
+                value = -1;
+            }
+            fclose(fp);
+            return value;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Classify the disk holding a path and size checkout workers for it
+ *
+ * Parallel checkout is limited by the device: SSDs scale with cores,
+ * spinning disks lose throughput to seeks, and network filesystems are
+ * latency-bound and benefit from more requests in flight.
+ */
+static void size_checkout_workers(const char *path, checkout_stats_t *stats) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) cpus = 1;
+
+    struct stat st;
+    struct statfs sfs;
+    int rotational = -1;
+
+    stats->disk_type = "unknown";
+
+    if (statfs(path, &sfs) == 0 &&
+        ((unsigned long)sfs.f_type == FS_MAGIC_NFS ||
+         (unsigned long)sfs.f_type == FS_MAGIC_SMB2 ||
+         (unsigned long)sfs.f_type == FS_MAGIC_CIFS ||
+         (unsigned long)sfs.f_type == FS_MAGIC_FUSE)) {
+        stats->disk_type = "network";
+    } else if (stat(path, &st) == 0 && major(st.st_dev) != 0) {
+        rotational = read_rotational(major(st.st_dev), minor(st.st_dev));
+        if (rotational == 1) {
+            stats->disk_type = "hdd";
+        } else if (rotational == 0) {
+            stats->disk_type = "ssd";
+        }
+    }
+
+    if (strcmp(stats->disk_type, "hdd") == 0) {
+        stats->workers = 1;
+    } else if (strcmp(stats->disk_type, "network") == 0) {
+        stats->workers = (int)(cpus * 2);
+    } else {
+        stats->workers = (int)cpus;
+    }
+
+    if (stats->workers > MAX_CHECKOUT_WORKERS) {
+        stats->workers = MAX_CHECKOUT_WORKERS;
+    }
+}
+
+/**
+ * Count the directories in a cone-mode sparse-checkout file
+ *
+ * Cone mode files only contain parent entries ("/" + "*", or negated
+ * "/dir/" + "*" + "/") and "/dir/" recursive entries; anything else
+ * means non-cone patterns.
+ *
+ * @return int Number of recursive cone directories, or -1 if not cone-shaped
+ */
+static int count_sparse_cones(const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    char line[MAX_PATH_LEN];
+    int cones = 0;
+    bool cone_shaped = true;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *entry = trim_whitespace(line);
+        size_t len = strlen(entry);
+
+        if (len == 0 || entry[0] == '#') {
+            continue;
+        }
+        if (entry[0] == '!') {
+            /* Parent exclusions end in a slash-star-slash */
+            if (len < 4 || strcmp(entry + len - 3, "/*/") != 0) {
+                cone_shaped = false;
+            }
+            continue;
+        }
+        if (entry[0] != '/') {
+            cone_shaped = false;
+        } else if (len >= 2 && strcmp(entry + len - 2, "/*") == 0) {
+            /* Parent inclusion (a trailing slash-star) */
+        } else if (entry[len - 1] == '/') {
+            cones++;
+        } else {
+            cone_shaped = false;
+        }
+    }
+
+    fclose(fp);
+    return cone_shaped ? cones : -1;
+}
+
+/**
+ * Inspect the repository and decide how the next checkout should run
+ *
+ * One rev-parse locates the index and sparse-checkout file; the config
+ * is only consulted when a sparse-checkout file exists.
+ *
+ * @param stats Output: checkout profile (timings zeroed)
+ * @return gm_error_t Error code
+ */
+gm_error_t plan_checkout(checkout_stats_t *stats) {
+    if (stats == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->cone_count = -1;
+    stats->disk_type = "unknown";
+
+    /* The index and sparse-checkout file are per-worktree, so both live in the git dir */
+    char git_dir[MAX_PATH_LEN];
+    if (find_git_dir(git_dir, sizeof(git_dir)) != GM_SUCCESS) {
+        return GM_ERR_NOT_GIT_REPO;
+    }
+
+    char index_path[MAX_PATH_LEN + 8] = "";
+    char sparse_path[MAX_PATH_LEN + 32] = "";
+    const char *index_env = getenv("GIT_INDEX_FILE");
+    if (index_env != NULL && index_env[0] != '\0') {
+        snprintf(index_path, sizeof(index_path), "%s", index_env);
+    } else {
+        snprintf(index_path, sizeof(index_path), "%s/index", git_dir);
+    }
+    snprintf(sparse_path, sizeof(sparse_path), "%s/info/sparse-checkout", git_dir);
+
+    struct stat st;
+    if (index_path[0] != '\0' && stat(index_path, &st) == 0) {
+        stats->index_bytes = (long long)st.st_size;
+    }
+
+    if (sparse_path[0] != '\0' && stat(sparse_path, &st) == 0) {
+        if (git_config_load() == GM_SUCCESS) {
+            char value[16];
+            stats->sparse = git_config_get_bool("core.sparsecheckout", false);
+            stats->cone_mode = git_config_get_bool("core.sparsecheckoutcone", false);
+            stats->sparse_index_set = git_config_get("index.sparse", value, sizeof(value));
+            stats->sparse_index = git_config_get_bool("index.sparse", false);
+        } else {
+            cmd_result_t *result = exec_git_command(
+                "config --get-regexp \"^(core\\.sparsecheckout|core\\.sparsecheckoutcone|index\\.sparse)$\"");
+
+            if (result != NULL && result->exit_code == 0) {
+                char *line = result->output;
+                while (line != NULL && *line != '\0') {
+                    char *eol = strchr(line, '\n');
+                    if (eol != NULL) *eol = '\0';
+
+                    char *value = strchr(line, ' ');
+                    bool on = (value != NULL && strcasecmp(value + 1, "true") == 0);
+
+                    if (strncasecmp(line, "core.sparsecheckoutcone ", 24) == 0) {
+                        stats->cone_mode = on;
+                    } else if (strncasecmp(line, "core.sparsecheckout ", 20) == 0) {
+                        stats->sparse = on;
+                    } else if (strncasecmp(line, "index.sparse ", 13) == 0) {
+                        stats->sparse_index = on;
+                        stats->sparse_index_set = true;
+                    }
+
+                    line = (eol != NULL) ? eol + 1 : NULL;
+                }
+            }
+            if (result != NULL) {
+                free_cmd_result(result);
+            }
+        }
+
+        if (stats->sparse && stats->cone_mode) {
+            stats->cone_count = count_sparse_cones(sparse_path);
+            if (stats->cone_count < 0) {
+                stats->cone_mode = false;
+            }
+        }
+    }
+
+    stats->large = stats->sparse || stats->index_bytes >= LARGE_INDEX_BYTES;
+    size_checkout_workers(index_path[0] != '\0' ? index_path : ".", stats);
+
+    return GM_SUCCESS;
+}
+
+/* Progress meter state fed from git's stderr */
+typedef struct {
+    char line[512];
+    size_t len;
+    int last_percent;
+    int total;
+    bool tty;
+} checkout_progress_t;
+
+/**
+ * Parse git's "Updating files: 45% (450/1000)" meter as it streams in
+ */
+static void on_checkout_stderr(const char *chunk, size_t len, void *ctx) {
+    checkout_progress_t *progress = (checkout_progress_t*)ctx;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = chunk[i];
+
+        if (c != '\r' && c != '\n') {
+            if (progress->len < sizeof(progress->line) - 1) {
+                progress->line[progress->len++] = c;
+            }
+            continue;
+        }
+
+        progress->line[progress->len] = '\0';
+        progress->len = 0;
+
+        const char *meter = strstr(progress->line, "Updating files:");
+        int percent = 0, done = 0, total = 0;
+
+        if (meter != NULL &&
+            sscanf(meter, "Updating files: %d%% (%d/%d)", &percent, &done, &total) == 3) {
+            progress->total = total;
+
+            if (progress->tty && percent != progress->last_percent) {
+                int filled = percent / 5;
+                printf("\r  Updating files [%-20.*s] %3d%% (%d/%d)",
+                       filled, "####################", percent, done, total);
+                fflush(stdout);
+            }
+            progress->last_percent = percent;
+        }
+    }
+}
+
+/**
+ * Extract a JSON string or number field from a trace2 event line
+ */
+static bool trace_field(const char *line, const char *key, char *out, size_t max_len) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+
+    const char *p = strstr(line, pattern);
+    if (p == NULL) {
+        return false;
+    }
+    p += strlen(pattern);
+
+    size_t n = 0;
+    if (*p == '"') {
+        p++;
+        while (*p != '\0' && *p != '"' && n < max_len - 1) {
+            out[n++] = *p++;
+        }
+    } else {
+        while (*p != '\0' && *p != ',' && *p != '}' && n < max_len - 1) {
+            out[n++] = *p++;
+        }
+    }
+    out[n] = '\0';
+    return true;
+}
+
+/**
+ * Fold trace2 region timings into per-phase totals
+ */
+static void collect_checkout_trace(const char *trace_path, checkout_stats_t *stats) {
+    FILE *fp = fopen(trace_path, "r");
+    if (fp == NULL) {
+        return;
+    }
+
+    char line[4096];
+    char category[64], label[64], value[64];
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (strstr(line, "\"event\":\"exit\"") != NULL) {
+            if (trace_field(line, "t_abs", value, sizeof(value))) {
+                stats->total_ms = strtod(value, NULL) * 1000.0;
+            }
+            continue;
+        }
+
+        if (strstr(line, "\"event\":\"region_leave\"") == NULL ||
+            !trace_field(line, "category", category, sizeof(category)) ||
+            !trace_field(line, "label", label, sizeof(label)) ||
+            !trace_field(line, "t_rel", value, sizeof(value))) {
+            continue;
+        }
+
+        double ms = strtod(value, NULL) * 1000.0;
+
+        if (strcmp(category, "index") == 0 && strcmp(label, "do_read_index") == 0) {
+            stats->index_read_ms += ms;
+        } else if (strcmp(category, "index") == 0 && strcmp(label, "refresh") == 0) {
+            stats->refresh_ms += ms;
+        } else if (strcmp(category, "unpack_trees") == 0 && strcmp(label, "traverse_trees") == 0) {
+            stats->unpack_ms += ms;
+        } else if (strcmp(category, "progress") == 0 && strcmp(label, "Updating files") == 0) {
+            stats->write_files_ms += ms;
+        } else if (strcmp(category, "index") == 0 && strcmp(label, "do_write_index") == 0) {
+            stats->index_write_ms += ms;
+        }
+    }
+
+    fclose(fp);
+}
+
+/**
+ * Switch branches using parallel checkout, with progress and phase timings
+ *
+ * Worker count comes from plan_checkout. The sparse index is left to
+ * the user's index.sparse setting: turning it on rewrites the on-disk
+ * index, so print_checkout_stats only suggests it for cone-mode checkouts.
+ *
+ * @param branch_name Branch to switch to
+ * @param stats In: profile from plan_checkout (NULL to plan here); out: timings
+ * @return gm_error_t Error code
+ */
+gm_error_t switch_branch_large(const char *branch_name, checkout_stats_t *stats) {
+    if (branch_name == NULL || strlen(branch_name) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    checkout_stats_t local;
+    if (stats == NULL) {
+        stats = &local;
+        gm_error_t err = plan_checkout(stats);
+        if (err != GM_SUCCESS) {
+            return err;
+        }
+    }
+
+    char trace_path[] = "/tmp/gm-checkout-trace-XXXXXX";
+    int trace_fd = mkstemp(trace_path);
+    if (trace_fd >= 0) {
+        close(trace_fd);
+    }
+
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd),
+             "%s%s%sgit -c checkout.workers=%d switch --no-guess --progress \"%s\"",
+             trace_fd >= 0 ? "GIT_TRACE2_EVENT='" : "",
+             trace_fd >= 0 ? trace_path : "",
+             trace_fd >= 0 ? "' " : "",
+             stats->workers, branch_name);
+
+    checkout_progress_t progress;
+    memset(&progress, 0, sizeof(progress));
+    progress.last_percent = -1;
+    progress.tty = isatty(STDOUT_FILENO);
+
+    cmd_result_t *result = exec_command_stream(cmd, on_checkout_stderr, &progress);
+
+    if (progress.tty && progress.last_percent >= 0) {
+        printf("\n");
+    }
+
+    if (trace_fd >= 0) {
+        collect_checkout_trace(trace_path, stats);
+        unlink(trace_path);
+    }
+
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    if (result->exit_code != 0) {
+        gm_error_t err = report_switch_failure(result, branch_name);
         free_cmd_result(result);
-        
-        /* Get ahead/behind count */
-        snprintf(cmd, sizeof(cmd), "rev-list --left-right --count \"%s\"...\"%s@{upstream}\"", 
-                 branch_name, branch_name);
-        result = exec_git_command(cmd);
-        
-        if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-            int ahead = 0, behind = 0;
-            if (sscanf(result->output, "%d\t%d", &ahead, &behind) == 2) {
-                info->commits_ahead = ahead;
-                info->commits_behind = behind;
+        return err;
+    }
+
+    stats->files_updated = progress.total;
+    free_cmd_result(result);
+    PRINT_SUCCESS("Switched to branch '%s'", branch_name);
+
+    return GM_SUCCESS;
+}
+
+/**
+ * Print the profile and phase timings of a large checkout
+ */
+void print_checkout_stats(const checkout_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    printf("  Checkout: %d worker%s on %s disk, index %.1f MB",
+           stats->workers, stats->workers == 1 ? "" : "s", stats->disk_type,
+           (double)stats->index_bytes / (1024.0 * 1024.0));
+    if (stats->sparse) {
+        if (stats->cone_mode) {
+            printf(", sparse (%d cone%s)", stats->cone_count, stats->cone_count == 1 ? "" : "s");
+            if (!stats->sparse_index) {
+                printf(", sparse index off (git config index.sparse true)");
             }
+        } else {
+            printf(", sparse (patterns)");
         }
     }
-    
+    printf("\n");
+
+    /* git only shows its meter for slow checkouts, so the count may be unknown */
+    char files[32] = "files";
+    if (stats->files_updated > 0) {
+        snprintf(files, sizeof(files), "%d files", stats->files_updated);
+    }
+
+    printf("  Phases: read index %.1f ms, refresh %.1f ms, unpack %.1f ms, "
+           "write %s %.1f ms, write index %.1f ms (total %.1f ms)\n",
+           stats->index_read_ms, stats->refresh_ms, stats->unpack_ms,
+           files, stats->write_files_ms, stats->index_write_ms, stats->total_ms);
+}
+
+/* ============================================================================
+ * Fuzzy Branch Finder
+ * ============================================================================ */
+
+/* Scoring weights (fzf-style subsequence matching) */
+#define FUZZY_SCORE_MATCH        16
+#define FUZZY_SCORE_GAP_START    (-3)
+#define FUZZY_SCORE_GAP_EXTEND   (-1)
+#define FUZZY_BONUS_BOUNDARY     8
+#define FUZZY_BONUS_SLASH        10
+#define FUZZY_BONUS_CAMEL        7
+#define FUZZY_BONUS_CONSECUTIVE  4
+#define FUZZY_FIRST_CHAR_MULT    2
+
+/* Ranking adjustments applied on top of the fuzzy score */
+#define BRANCH_RECENCY_BONUS     48
+#define BRANCH_CURRENT_PENALTY   64
+#define BRANCH_REFLOG_DEPTH      2000
+#define BRANCH_FILTER_RANKED     256
+
+/**
+ * Map a character to a bit in the per-name character mask
+ */
+static unsigned long long char_mask_bit(unsigned char c) {
+    if (c >= 'a' && c <= 'z') return 1ULL << (c - 'a');
+    if (c >= '0' && c <= '9') return 1ULL << (26 + c - '0');
+    return 1ULL << (36 + (c % 28));
+}
+
+/**
+ * Bonus for matching the character at position i of the original text
+ */
+static int fuzzy_char_bonus(const char *text, size_t i) {
+    if (i == 0) {
+        return FUZZY_BONUS_BOUNDARY;
+    }
+
+    unsigned char prev = (unsigned char)text[i - 1];
+    unsigned char c = (unsigned char)text[i];
+
+    if (prev == '/') return FUZZY_BONUS_SLASH;
+    if (prev == '-' || prev == '_' || prev == '.' || prev == ':') return FUZZY_BONUS_BOUNDARY;
+    if (islower(prev) && isupper(c)) return FUZZY_BONUS_CAMEL;
+    if (!isdigit(prev) && isdigit(c)) return FUZZY_BONUS_CAMEL;
+
+    return 0;
+}
+
+/**
+ * Score a lower-cased pattern against a lower-cased text
+ *
+ * Finds the first occurrence of the pattern as a subsequence, then
+ * walks backwards from its end to the tightest start so the scored
+ * window is as short as possible. The original text is only used for
+ * word-boundary bonuses.
+ *
+ * @return int Score, or -1 if the pattern is not a subsequence
+ */
+static int fuzzy_score_folded(const char *pattern, size_t plen,
+                              const char *folded, const char *original, size_t tlen) {
+    if (plen == 0) {
+        return 0;
+    }
+
+    /* Forward pass: find where the first full match ends */
+    size_t pi = 0;
+    size_t end = 0;
+    for (size_t ti = 0; ti < tlen; ti++) {
+        if (folded[ti] == pattern[pi] && ++pi == plen) {
+            end = ti + 1;
+            break;
+        }
+    }
+    if (pi < plen) {
+        return -1;
+    }
+
+    /* Backward pass: shrink the window to the tightest start */
+    size_t start = 0;
+    pi = plen;
+    for (size_t ti = end; ti-- > 0; ) {
+        if (folded[ti] == pattern[pi - 1] && --pi == 0) {
+            start = ti;
+            break;
+        }
+    }
+
+    /* Score the window */
+    int score = 0;
+    int consecutive = 0;
+    int first_bonus = 0;
+    bool in_gap = false;
+    pi = 0;
+
+    for (size_t ti = start; ti < end; ti++) {
+        if (pi < plen && folded[ti] == pattern[pi]) {
+            int bonus = fuzzy_char_bonus(original, ti);
+
+            if (consecutive == 0) {
+                first_bonus = bonus;
+            } else {
+                if (bonus >= FUZZY_BONUS_BOUNDARY && bonus > first_bonus) {
+                    first_bonus = bonus;
+                }
+                if (first_bonus > bonus) bonus = first_bonus;
+                if (FUZZY_BONUS_CONSECUTIVE > bonus) bonus = FUZZY_BONUS_CONSECUTIVE;
+            }
+
+            score += FUZZY_SCORE_MATCH + (pi == 0 ? bonus * FUZZY_FIRST_CHAR_MULT : bonus);
+            consecutive++;
+            in_gap = false;
+            pi++;
+        } else {
+            score += in_gap ? FUZZY_SCORE_GAP_EXTEND : FUZZY_SCORE_GAP_START;
+            in_gap = true;
+            consecutive = 0;
+            first_bonus = 0;
+        }
+    }
+
+    return score < 0 ? 0 : score;
+}
+
+/**
+ * Fold a query to lower case, dropping characters a branch name cannot hold
+ *
+ * @return size_t Length of the folded query
+ */
+static size_t fold_query(const char *query, char *out, size_t max_len) {
+    size_t len = 0;
+
+    for (const char *p = query; *p != '\0' && len < max_len - 1; p++) {
+        if (isspace((unsigned char)*p)) {
+            continue;
+        }
+        out[len++] = (char)tolower((unsigned char)*p);
+    }
+    out[len] = '\0';
+
+    return len;
+}
+
+/**
+ * Score a pattern against a branch name, ignoring case
+ *
+ * @param pattern Query typed by the user
+ * @param pattern_len Length of pattern
+ * @param text Candidate name
+ * @param text_len Length of text
+ * @return int Score (higher is better), or -1 if there is no match
+ */
+int fuzzy_match_score(const char *pattern, size_t pattern_len,
+                      const char *text, size_t text_len) {
+    if (pattern == NULL || text == NULL) {
+        return -1;
+    }
+
+    char pat[MAX_BRANCH_NAME];
+    char folded[MAX_BRANCH_NAME];
+
+    if (pattern_len >= sizeof(pat) || text_len >= sizeof(folded)) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < pattern_len; i++) {
+        pat[i] = (char)tolower((unsigned char)pattern[i]);
+    }
+    for (size_t i = 0; i < text_len; i++) {
+        folded[i] = (char)tolower((unsigned char)text[i]);
+    }
+
+    return fuzzy_score_folded(pat, pattern_len, folded, text, text_len);
+}
+
+/**
+ * FNV-1a hash over a length-delimited string
+ */
+static unsigned int branch_name_hash(const char *s, size_t len) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * Rank branches by how recently they were checked out
+ *
+ * Walks the HEAD reflog newest-first and records the first time each
+ * branch appears as a "checkout: moving from X to Y" target.
+ */
+static void load_branch_recency(branch_table_t *table) {
+    /* Open-addressed name -> row index (stored as row + 1) */
+    size_t slots = 16;
+    while (slots < (size_t)table->count * 2) {
+        slots *= 2;
+    }
+
+    int *map = (int*)safe_calloc(slots, sizeof(int));
+    if (map == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < table->count; i++) {
+        const char *name = table->names + table->offsets[i];
+        size_t h = branch_name_hash(name, table->lengths[i]) & (slots - 1);
+        while (map[h] != 0) {
+            h = (h + 1) & (slots - 1);
+        }
+        map[h] = i + 1;
+    }
+
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "reflog show --format=%%gs -n %d HEAD", BRANCH_REFLOG_DEPTH);
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
+
+    if (result != NULL && result->exit_code == 0) {
+        static const char prefix[] = "checkout: moving from ";
+        int next_rank = 0;
+        char *line = result->output;
+
+        while (line != NULL && *line != '\0' && next_rank < table->count) {
+            char *eol = strchr(line, '\n');
+            if (eol != NULL) {
+                *eol = '\0';
+            }
+
+            if (strncmp(line, prefix, sizeof(prefix) - 1) == 0) {
+                char *target = strstr(line + sizeof(prefix) - 1, " to ");
+                /* Branch names cannot contain spaces, so the last " to " wins */
+                for (char *p = target; p != NULL; p = strstr(p + 1, " to ")) {
+                    target = p;
+                }
+
+                if (target != NULL) {
+                    target += 4;
+                    size_t len = strlen(target);
+                    size_t h = branch_name_hash(target, len) & (slots - 1);
+
+                    while (map[h] != 0) {
+                        int row = map[h] - 1;
+                        if (table->lengths[row] == len &&
+                            memcmp(table->names + table->offsets[row], target, len) == 0) {
+                            if (table->recency[row] < 0) {
+                                table->recency[row] = next_rank++;
+                            }
+                            break;
+                        }
+                        h = (h + 1) & (slots - 1);
+                    }
+                }
+            }
+
+            line = (eol != NULL) ? eol + 1 : NULL;
+        }
+    }
+
     if (result != NULL) {
         free_cmd_result(result);
     }
-    
+    free(map);
+}
+
+/**
+ * Load all local branches into a compact table for the fuzzy finder
+ *
+ * Costs two spawns regardless of branch count: one for-each-ref for
+ * names and commit dates, and one reflog read for checkout recency.
+ *
+ * @param table Output: populated table (free with free_branch_table)
+ * @return gm_error_t Error code
+ */
+gm_error_t load_branch_table(branch_table_t *table) {
+    if (table == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    memset(table, 0, sizeof(*table));
+    table->current = -1;
+
+    cmd_result_t *result = exec_git_command_input(
+        "for-each-ref --format='%(committerdate:unix) %(HEAD) %(refname:lstrip=2)' refs/heads",
+        NULL, 0);
+
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Failed to list branches: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    int capacity = 0;
+    for (const char *p = result->output; *p != '\0'; p++) {
+        if (*p == '\n') capacity++;
+    }
+
+    table->names = (char*)safe_malloc(result->output_len + 1);
+    table->folded = (char*)safe_malloc(result->output_len + 1);
+    table->offsets = (unsigned int*)safe_calloc(capacity + 1, sizeof(unsigned int));
+    table->lengths = (unsigned short*)safe_calloc(capacity + 1, sizeof(unsigned short));
+    table->char_masks = (unsigned long long*)safe_calloc(capacity + 1, sizeof(unsigned long long));
+    table->commit_times = (long long*)safe_calloc(capacity + 1, sizeof(long long));
+    table->recency = (int*)safe_calloc(capacity + 1, sizeof(int));
+
+    if (table->names == NULL || table->folded == NULL || table->offsets == NULL ||
+        table->lengths == NULL || table->char_masks == NULL ||
+        table->commit_times == NULL || table->recency == NULL) {
+        free_cmd_result(result);
+        free_branch_table(table);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    size_t arena_len = 0;
+    char *line = result->output;
+
+    while (line != NULL && *line != '\0') {
+        char *eol = strchr(line, '\n');
+        if (eol != NULL) {
+            *eol = '\0';
+        }
+
+        /* "<unix time> <'*' or ' '> <name>" */
+        char *rest = NULL;
+        long long when = strtoll(line, &rest, 10);
+
+        if (rest != NULL && rest[0] == ' ' && rest[1] != '\0' && rest[2] == ' ') {
+            const char *name = rest + 3;
+            size_t len = strlen(name);
+
+            if (len > 0 && len < MAX_BRANCH_NAME) {
+                int row = table->count++;
+                unsigned long long mask = 0;
+
+                table->offsets[row] = (unsigned int)arena_len;
+                table->lengths[row] = (unsigned short)len;
+                table->commit_times[row] = when;
+                table->recency[row] = -1;
+
+                for (size_t i = 0; i < len; i++) {
+                    char c = (char)tolower((unsigned char)name[i]);
+                    table->names[arena_len + i] = name[i];
+                    table->folded[arena_len + i] = c;
+                    mask |= char_mask_bit((unsigned char)c);
+                }
+                table->names[arena_len + len] = '\0';
+                table->folded[arena_len + len] = '\0';
+                table->char_masks[row] = mask;
+                arena_len += len + 1;
+
+                if (rest[1] == '*') {
+                    table->current = row;
+                }
+            }
+        }
+
+        line = (eol != NULL) ? eol + 1 : NULL;
+    }
+
+    free_cmd_result(result);
+
+    if (table->count > 0) {
+        load_branch_recency(table);
+    }
+
     return GM_SUCCESS;
 }
+
+/**
+ * Free a branch table
+ */
+void free_branch_table(branch_table_t *table) {
+    if (table == NULL) {
+        return;
+    }
+
+    free(table->names);
+    free(table->folded);
+    free(table->offsets);
+    free(table->lengths);
+    free(table->char_masks);
+    free(table->commit_times);
+    free(table->recency);
+    memset(table, 0, sizeof(*table));
+    table->current = -1;
+}
+
+/**
+ * Order matches by descending sort key, then table order
+ */
+static int compare_branch_matches(const void *a, const void *b) {
+    const branch_match_t *ma = (const branch_match_t*)a;
+    const branch_match_t *mb = (const branch_match_t*)b;
+
+    if (ma->sort_key != mb->sort_key) {
+        return (ma->sort_key > mb->sort_key) ? -1 : 1;
+    }
+    return ma->index - mb->index;
+}
+
+/**
+ * Partially order matches so the k best occupy the front, in any order
+ *
+ * Hoare-style quickselect on the sort key; O(n) on average, which keeps
+ * a single-letter query over tens of thousands of branches cheap.
+ */
+static void select_top_matches(branch_match_t *m, int n, int k) {
+    int lo = 0;
+    int hi = n - 1;
+
+    while (lo < hi) {
+        branch_match_t pivot = m[lo + (hi - lo) / 2];
+        int i = lo;
+        int j = hi;
+
+        while (i <= j) {
+            while (compare_branch_matches(&m[i], &pivot) < 0) i++;
+            while (compare_branch_matches(&m[j], &pivot) > 0) j--;
+            if (i <= j) {
+                branch_match_t tmp = m[i];
+                m[i] = m[j];
+                m[j] = tmp;
+                i++;
+                j--;
+            }
+        }
+
+        if (k - 1 <= j) {
+            hi = j;
+        } else if (k - 1 >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+}
+
+/**
+ * Re-filter and rank the branch table for a new query
+ *
+ * When the new query extends the previous one, only the previous
+ * matches are rescanned: a subsequence match for "abc" is always a
+ * match for "ab", so anything dropped earlier cannot come back. Only
+ * the first filter->ranked matches are sorted; the rest keep no order.
+ *
+ * @param table Branch table from load_branch_table
+ * @param filter Filter state (zero-initialise before first use)
+ * @param query Current query text
+ * @return gm_error_t Error code
+ */
+gm_error_t branch_filter_update(const branch_table_t *table, branch_filter_t *filter,
+                                const char *query) {
+    if (table == NULL || filter == NULL || query == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char pattern[MAX_BRANCH_NAME];
+    size_t plen = fold_query(query, pattern, sizeof(pattern));
+
+    if (filter->capacity < table->count) {
+        branch_match_t *grown = (branch_match_t*)safe_realloc(filter->matches,
+                                    (size_t)table->count * sizeof(branch_match_t));
+        if (grown == NULL) {
+            return GM_ERR_MEMORY_ALLOC;
+        }
+        filter->matches = grown;
+        filter->capacity = table->count;
+        filter->valid = false;
+    }
+
+    size_t prev_len = strlen(filter->query);
+    bool incremental = filter->valid && prev_len > 0 && prev_len <= plen &&
+                       memcmp(filter->query, pattern, prev_len) == 0;
+
+    unsigned long long need = 0;
+    for (size_t i = 0; i < plen; i++) {
+        need |= char_mask_bit((unsigned char)pattern[i]);
+    }
+
+    int scan_count = incremental ? filter->count : table->count;
+    int kept = 0;
+
+    for (int n = 0; n < scan_count; n++) {
+        int row = incremental ? filter->matches[n].index : n;
+
+        if ((table->char_masks[row] & need) != need) {
+            continue;
+        }
+
+        const char *folded = table->folded + table->offsets[row];
+        const char *name = table->names + table->offsets[row];
+        int score = fuzzy_score_folded(pattern, plen, folded, name, table->lengths[row]);
+
+        if (score < 0) {
+            continue;
+        }
+
+        if (table->recency[row] >= 0) {
+            score += BRANCH_RECENCY_BONUS / (1 + table->recency[row]);
+        }
+        if (row == table->current) {
+            score -= BRANCH_CURRENT_PENALTY;
+        }
+
+        branch_match_t *m = &filter->matches[kept++];
+        m->index = row;
+        m->score = score;
+        m->sort_key = (long long)score * (1LL << 40) +
+                      (table->commit_times[row] & ((1LL << 40) - 1));
+    }
+
+    /* Only the head of the list is ever shown, so only it is fully sorted */
+    filter->count = kept;
+    filter->ranked = (kept < BRANCH_FILTER_RANKED) ? kept : BRANCH_FILTER_RANKED;
+    if (kept > filter->ranked) {
+        select_top_matches(filter->matches, kept, filter->ranked);
+    }
+    qsort(filter->matches, (size_t)filter->ranked, sizeof(branch_match_t), compare_branch_matches);
+
+    memcpy(filter->query, pattern, plen + 1);
+    filter->valid = true;
+
+    return GM_SUCCESS;
+}
+
+/**
+ * Free a branch filter's match buffer
+ */
+void free_branch_filter(branch_filter_t *filter) {
+    if (filter == NULL) {
+        return;
+    }
+
+    free(filter->matches);
+    memset(filter, 0, sizeof(*filter));
+}
@@ -87,6 +87,275 @@ gm_error_t stage_file(const char *file_path) {
     return GM_SUCCESS;
 }
 
+/**
+ * Extract the path git names in a failure message
+ *
+ * Recognises update-index's "Unable to process path X" and add's
+ * "pathspec 'X' did not match any files".
+ *
+ * @return bool True if a path was found
+ */
+static bool find_failed_path(const char *error, char *path_out, size_t max_len) {
+    const char *p = strstr(error, "Unable to process path ");
+    if (p != NULL) {
+        p += strlen("Unable to process path ");
+        size_t n = strcspn(p, "\n");
+        if (n >= max_len) n = max_len - 1;
+        memcpy(path_out, p, n);
+        path_out[n] = '\0';
+        return true;
+    }
+
+    p = strstr(error, "pathspec '");
+    if (p != NULL) {
+        p += strlen("pathspec '");
+        const char *end = strstr(p, "' did not match");
+        if (end != NULL) {
+            size_t n = (size_t)(end - p);
+            if (n >= max_len) n = max_len - 1;
+            memcpy(path_out, p, n);
+            path_out[n] = '\0';
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Copy git's own explanation for a failed path into a result
+ */
+static void record_stage_failure(stage_result_t *result, const char *error, const char *path) {
+    result->status = STAGE_STATUS_FAILED;
+    result->error[0] = '\0';
+
+    /* Prefer the "error: <path>: <reason>" line when there is one */
+    char needle[MAX_PATH_LEN + 8];
+    snprintf(needle, sizeof(needle), "%s: ", path);
+    const char *reason = strstr(error, needle);
+
+    if (reason != NULL) {
+        reason += strlen(needle);
+    } else {
+        reason = error;
+        if (strncmp(reason, "fatal: ", 7) == 0 || strncmp(reason, "error: ", 7) == 0) {
+            reason += 7;
+        }
+    }
+
+    size_t n = strcspn(reason, "\n");
+    if (n >= sizeof(result->error)) n = sizeof(result->error) - 1;
+    memcpy(result->error, reason, n);
+    result->error[n] = '\0';
+}
+
+/**
+ * Run one batch command over every pending path in the group
+ *
+ * Paths are streamed NUL-separated on stdin. update-index and add both
+ * abandon the whole index update when one path fails, so the failing
+ * path is marked, dropped, and the rest retried until a run succeeds.
+ *
+ * @return int Number of paths that ended up failed
+ */
+static int run_stage_batch(const char *git_args, const char *const *paths,
+                           const int *members, int member_count, stage_result_t *results) {
+    int failed = 0;
+
+    for (;;) {
+        size_t input_len = 0;
+        int pending = 0;
+
+        for (int i = 0; i < member_count; i++) {
+            if (results[members[i]].status == STAGE_STATUS_PENDING) {
+                input_len += strlen(paths[members[i]]) + 1;
+                pending++;
+            }
+        }
+        if (pending == 0) {
+            return failed;
+        }
+
+        char *input = (char*)safe_malloc(input_len);
+        if (input == NULL) {
+            return failed + pending;
+        }
+
+        size_t off = 0;
+        for (int i = 0; i < member_count; i++) {
+            if (results[members[i]].status == STAGE_STATUS_PENDING) {
+                size_t len = strlen(paths[members[i]]) + 1;
+                memcpy(input + off, paths[members[i]], len);
+                off += len;
+            }
+        }
+
+        cmd_result_t *result = exec_git_command_input(git_args, input, input_len);
+        free(input);
+
+        if (result == NULL) {
+            for (int i = 0; i < member_count; i++) {
+                stage_result_t *r = &results[members[i]];
+                if (r->status == STAGE_STATUS_PENDING) {
+                    r->status = STAGE_STATUS_FAILED;
+                    snprintf(r->error, sizeof(r->error), "could not run git");
+                    failed++;
+                }
+            }
+            return failed;
+        }
+
+        if (result->exit_code == 0) {
+            for (int i = 0; i < member_count; i++) {
+                stage_result_t *r = &results[members[i]];
+                if (r->status == STAGE_STATUS_PENDING) {
+                    struct stat st;
+                    r->status = (lstat(paths[members[i]], &st) == 0) ?
+                                STAGE_STATUS_STAGED : STAGE_STATUS_REMOVED;
+                }
+            }
+            free_cmd_result(result);
+            return failed;
+        }
+
+        /* Find which path broke the batch; without one, fail them all */
+        char bad[MAX_PATH_LEN];
+        bool matched = false;
+
+        if (find_failed_path(result->error, bad, sizeof(bad))) {
+            for (int i = 0; i < member_count; i++) {
+                stage_result_t *r = &results[members[i]];
+                if (r->status == STAGE_STATUS_PENDING && strcmp(paths[members[i]], bad) == 0) {
+                    record_stage_failure(r, result->error, bad);
+                    failed++;
+                    matched = true;
+                    break;
+                }
+            }
+        }
+
+        if (!matched) {
+            for (int i = 0; i < member_count; i++) {
+                stage_result_t *r = &results[members[i]];
+                if (r->status == STAGE_STATUS_PENDING) {
+                    record_stage_failure(r, result->error, paths[members[i]]);
+                    failed++;
+                }
+            }
+        }
+
+        free_cmd_result(result);
+    }
+}
+
+/**
+ * Stage, update, remove or intent-to-add many paths with one process
+ *
+ * Files go through a single `update-index -z --stdin`; directories (in
+ * STAGE_MODE_ADD) and intent-to-add go through a single `add` reading
+ * NUL-separated literal pathspecs from stdin. Staging thousands of
+ * selected files therefore costs one or two processes, not one per path.
+ *
+ * @param paths Paths relative to the current directory
+ * @param count Number of paths
+ * @param mode What to do with each path
+ * @param results Optional per-path outcome array of length count
+ * @return gm_error_t GM_SUCCESS if every path succeeded
+ */
+gm_error_t stage_paths(const char *const *paths, int count, stage_mode_t mode,
+                       stage_result_t *results) {
+    if (paths == NULL || count <= 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    stage_result_t *outcome = results;
+    if (outcome == NULL) {
+        outcome = (stage_result_t*)safe_calloc((size_t)count, sizeof(stage_result_t));
+        if (outcome == NULL) {
+            return GM_ERR_MEMORY_ALLOC;
+        }
+    } else {
+        memset(outcome, 0, (size_t)count * sizeof(stage_result_t));
+    }
+
+    int *files = (int*)safe_malloc((size_t)count * sizeof(int));
+    int *dirs = (int*)safe_malloc((size_t)count * sizeof(int));
+    if (files == NULL || dirs == NULL) {
+        free(files);
+        free(dirs);
+        if (outcome != results) free(outcome);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    int file_count = 0;
+    int dir_count = 0;
+
+    for (int i = 0; i < count; i++) {
+        struct stat st;
+        if (paths[i] == NULL || paths[i][0] == '\0') {
+            outcome[i].status = STAGE_STATUS_FAILED;
+            snprintf(outcome[i].error, sizeof(outcome[i].error), "empty path");
+        } else if (mode == STAGE_MODE_ADD && lstat(paths[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            dirs[dir_count++] = i;
+        } else {
+            files[file_count++] = i;
+        }
+    }
+
+    const char *file_args = NULL;
+    switch (mode) {
+        case STAGE_MODE_ADD:
+            file_args = "update-index --add --remove --verbose -z --stdin";
+            break;
+        case STAGE_MODE_UPDATE:
+            file_args = "update-index --remove --verbose -z --stdin";
+            break;
+        case STAGE_MODE_REMOVE:
+            file_args = "update-index --force-remove --verbose -z --stdin";
+            break;
+        case STAGE_MODE_INTENT_TO_ADD:
+            file_args = "--literal-pathspecs add --intent-to-add --verbose "
+                        "--pathspec-from-file=- --pathspec-file-nul";
+            break;
+    }
+
+    int failed = 0;
+    if (file_count > 0) {
+        failed += run_stage_batch(file_args, paths, files, file_count, outcome);
+    }
+    if (dir_count > 0) {
+        failed += run_stage_batch("--literal-pathspecs add --verbose "
+                                  "--pathspec-from-file=- --pathspec-file-nul",
+                                  paths, dirs, dir_count, outcome);
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (outcome[i].status == STAGE_STATUS_FAILED && (paths[i] == NULL || paths[i][0] == '\0')) {
+            failed++;
+        }
+    }
+
+    /* Report once per batch rather than once per path */
+    if (failed > 0) {
+        for (int i = 0; i < count; i++) {
+            if (outcome[i].status == STAGE_STATUS_FAILED) {
+                PRINT_ERROR("Cannot stage '%s': %s", paths[i] ? paths[i] : "", outcome[i].error);
+            }
+        }
+    }
+    if (count - failed > 0) {
+        PRINT_SUCCESS("%s %d of %d path(s)",
+                      mode == STAGE_MODE_REMOVE ? "Removed from index" : "Staged",
+                      count - failed, count);
+    }
+
+    free(files);
+    free(dirs);
+    if (outcome != results) free(outcome);
+
+    return (failed == 0) ? GM_SUCCESS : GM_ERR_COMMAND_FAILED;
+}
+
 /**
  * Unstage a file (remove from staging area but keep changes)
  * 
@@ -132,97 +401,89 @@ gm_error_t unstage_file(const char *file_path) {
  * ============================================================================ */
 
 /**
- * Commit staged changes
- * 
+ * Commit staged changes and return the new commit's object ID
+ *
+ * The message is streamed to `commit -F -`, so it needs no escaping
+ * and has no length limit. Git itself refuses an empty commit, so the
+ * only up-front check is a header read of the index for the unborn,
+ * nothing-staged case; the new OID is read back from the ref files.
+ *
  * @param message Commit message
+ * @param oid Output: new commit ID (may be NULL)
+ * @param oid_len Size of oid (MAX_OID_LEN)
  * @return gm_error_t Error code
  */
-gm_error_t commit_changes(const char *message) {
+gm_error_t commit_changes_oid(const char *message, char *oid, size_t oid_len) {
     if (message == NULL || strlen(message) == 0) {
         PRINT_ERROR("Commit message cannot be empty");
         return GM_ERR_INVALID_INPUT;
     }
     
-    /* Check if there are staged changes */
-    cmd_result_t *check = exec_git_command("diff --cached --quiet");
-    if (check != NULL) {
-        if (check->exit_code == 0) {
-            /* No staged changes */
-            PRINT_WARNING("No staged changes to commit");
-            free_cmd_result(check);
-            return GM_ERR_NO_COMMITS;
-        }
-        free_cmd_result(check);
+    char head[MAX_OID_LEN];
+    unsigned int entries = 0;
+    if (read_index_entry_count(&entries) == GM_SUCCESS && entries == 0 &&
+        resolve_ref_oid("HEAD", head, sizeof(head)) == GM_ERR_NO_COMMITS) {
+        PRINT_WARNING("No staged changes to commit");
+        return GM_ERR_NO_COMMITS;
     }
     
-    /* Escape quotes in commit message */
-    char escaped_msg[MAX_COMMIT_MSG * 2];
-    size_t j = 0;
-    for (size_t i = 0; message[i] != '\0' && j < sizeof(escaped_msg) - 2; i++) {
-        if (message[i] == '"' || message[i] == '\\') {
-            escaped_msg[j++] = '\\';
-        }
-        escaped_msg[j++] = message[i];
-    }
-    escaped_msg[j] = '\0';
-    
-    char cmd[MAX_COMMAND_LEN];
-    snprintf(cmd, sizeof(cmd), "commit -m \"%s\"", escaped_msg);
-    
-    cmd_result_t *result = exec_git_command(cmd);
+    cmd_result_t *result = exec_git_command_input("commit --quiet --file=-",
+                                                  message, strlen(message));
     
     if (result == NULL) {
         return GM_ERR_COMMAND_FAILED;
     }
     
     if (result->exit_code != 0) {
-        if (result->error != NULL && strlen(result->error) > 0) {
-            /* Check for specific errors */
-            if (strstr(result->error, "nothing to commit") != NULL ||
-                strstr(result->output, "nothing to commit") != NULL) {
-                PRINT_WARNING("Nothing to commit, working tree clean");
-                free_cmd_result(result);
-                return GM_ERR_NO_COMMITS;
-            }
-            
-            if (strstr(result->error, "Please tell me who you are") != NULL) {
-                PRINT_ERROR("Git user identity not configured");
-                PRINT_INFO("Run: git config --global user.email \"you@example.com\"");
-                PRINT_INFO("Run: git config --global user.name \"Your Name\"");
-                free_cmd_result(result);
-                return GM_ERR_COMMAND_FAILED;
-            }
-            
-            PRINT_ERROR("Commit failed: %s", result->error);
+        /* Check for specific errors */
+        if (strstr(result->output, "nothing to commit") != NULL ||
+            strstr(result->output, "nothing added to commit") != NULL ||
+            strstr(result->output, "no changes added to commit") != NULL ||
+            strstr(result->error, "nothing to commit") != NULL) {
+            PRINT_WARNING("No staged changes to commit");
+            free_cmd_result(result);
+            return GM_ERR_NO_COMMITS;
+        }
+        
+        if (strstr(result->error, "Please tell me who you are") != NULL) {
+            PRINT_ERROR("Git user identity not configured");
+            PRINT_INFO("Run: git config --global user.email \"you@example.com\"");
+            PRINT_INFO("Run: git config --global user.name \"Your Name\"");
+            free_cmd_result(result);
+            return GM_ERR_COMMAND_FAILED;
         }
+        
+        PRINT_ERROR("Commit failed: %s", result->error);
         free_cmd_result(result);
         return GM_ERR_COMMAND_FAILED;
     }
     
-    /* Extract commit hash from output */
-    char commit_hash[16] = "";
-    if (result->output != NULL) {
-        char *hash_start = strchr(result->output, '[');
-        if (hash_start != NULL) {
-            hash_start = strchr(hash_start, ' ');
-            if (hash_start != NULL) {
-                hash_start++;
-                char *hash_end = strchr(hash_start, ']');
-                if (hash_end != NULL) {
-                    size_t len = (size_t)(hash_end - hash_start);
-                    if (len < sizeof(commit_hash)) {
-                        strncpy(commit_hash, hash_start, len);
-                        commit_hash[len] = '\0';
-                    }
-                }
-            }
-        }
+    free_cmd_result(result);
+    
+    if (oid != NULL && oid_len > 0) {
+        oid[0] = '\0';
+        resolve_ref_oid("HEAD", oid, oid_len);
     }
     
-    free_cmd_result(result);
+    return GM_SUCCESS;
+}
+
+/**
+ * Commit staged changes
+ * 
+ * @param message Commit message
+ * @return gm_error_t Error code
+ */
+gm_error_t commit_changes(const char *message) {
+    char oid[MAX_OID_LEN];
+    gm_error_t err = commit_changes_oid(message, oid, sizeof(oid));
+    
+    if (err != GM_SUCCESS) {
+        return err;
+    }
     
-    if (strlen(commit_hash) > 0) {
-        PRINT_SUCCESS("Committed changes [%s]", commit_hash);
+    if (strlen(oid) > 0) {
+        PRINT_SUCCESS("Committed changes [%.7s]", oid);
     } else {
         PRINT_SUCCESS("Committed changes");
     }
@@ -237,27 +498,15 @@ gm_error_t commit_changes(const char *message) {
  * @return gm_error_t Error code
  */
 gm_error_t amend_commit(const char *new_message) {
-    char cmd[MAX_COMMAND_LEN];
+    cmd_result_t *result;
     
     if (new_message != NULL && strlen(new_message) > 0) {
-        /* Escape quotes in commit message */
-        char escaped_msg[MAX_COMMIT_MSG * 2];
-        size_t j = 0;
-        for (size_t i = 0; new_message[i] != '\0' && j < sizeof(escaped_msg) - 2; i++) {
-            if (new_message[i] == '"' || new_message[i] == '\\') {
-                escaped_msg[j++] = '\\';
-            }
-            escaped_msg[j++] = new_message[i];
-        }
-        escaped_msg[j] = '\0';
-        
-        snprintf(cmd, sizeof(cmd), "commit --amend -m \"%s\"", escaped_msg);
+        result = exec_git_command_input("commit --quiet --amend --file=-",
+                                        new_message, strlen(new_message));
     } else {
-        snprintf(cmd, sizeof(cmd), "commit --amend --no-edit");
+        result = exec_git_command("commit --quiet --amend --no-edit");
     }
     
-    cmd_result_t *result = exec_git_command(cmd);
-    
     if (result == NULL) {
         return GM_ERR_COMMAND_FAILED;
     }
@@ -281,22 +530,91 @@ gm_error_t amend_commit(const char *new_message) {
  * ============================================================================ */
 
 /**
- * Get list of uncommitted changes
- * 
- * @param files Output: array of file paths
- * @param count Output: number of files
+ * Skip a number of space-separated fields
+ *
+ * @return const char* Start of the following field, or NULL if the record ends
+ */
+static const char* skip_fields(const char *p, const char *end, int fields) {
+    while (fields > 0 && p < end) {
+        const char *space = memchr(p, ' ', (size_t)(end - p));
+        if (space == NULL) {
+            return NULL;
+        }
+        p = space + 1;
+        fields--;
+    }
+    return (fields == 0) ? p : NULL;
+}
+
+/**
+ * Parse one "# branch.*" header of porcelain v2 output
+ */
+static void parse_branch_header(change_list_t *list, const char *line) {
+    if (strncmp(line, "# branch.head ", 14) == 0) {
+        const char *head = line + 14;
+        snprintf(list->branch, sizeof(list->branch), "%s",
+                 strcmp(head, "(detached)") == 0 ? "HEAD" : head);
+    } else if (strncmp(line, "# branch.upstream ", 18) == 0) {
+        snprintf(list->upstream, sizeof(list->upstream), "%s", line + 18);
+        list->has_upstream = true;
+    } else if (strncmp(line, "# branch.ab ", 12) == 0) {
+        sscanf(line + 12, "+%d -%d", &list->ahead, &list->behind);
+    }
+}
+
+/**
+ * Load the working tree and index changes
+ *
+ * Parses `status --porcelain=v2 -z --branch` in one pass. Paths are
+ * NUL-terminated in that format, so the command output itself becomes
+ * the path arena and entries only record offsets into it; renames,
+ * quoted names and spaces need no special handling.
+ *
+ * @param list Output change list (free with free_change_list)
+ * @param include_untracked Report untracked files
  * @return gm_error_t Error code
  */
-gm_error_t get_uncommitted_changes(char ***files, int *count) {
-    if (files == NULL || count == NULL) {
+gm_error_t load_change_list(change_list_t *list, bool include_untracked) {
+    return load_change_list_at(NULL, list, include_untracked ? "all" : "no");
+}
+
+/**
+ * Load the changes of a repository other than the current one
+ *
+ * @param repo_path Repository to read with `git -C` (NULL for the current one)
+ * @param list Output change list (free with free_change_list)
+ * @param untracked_mode --untracked-files mode: "all", "normal" or "no"
+ * @return gm_error_t Error code
+ */
+gm_error_t load_change_list_at(const char *repo_path, change_list_t *list,
+                               const char *untracked_mode) {
+    if (list == NULL || untracked_mode == NULL) {
         return GM_ERR_INVALID_INPUT;
     }
     
-    *files = NULL;
-    *count = 0;
+    memset(list, 0, sizeof(*list));
+    
+    /* The path is spliced into a shell command between double quotes */
+    if (repo_path != NULL && strpbrk(repo_path, "\"$`\\") != NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
     
-    cmd_result_t *result = exec_git_command("status --porcelain");
+    char cmd[MAX_COMMAND_LEN];
+    int written;
+    if (repo_path != NULL) {
+        written = snprintf(cmd, sizeof(cmd),
+                           "-C \"%s\" status --porcelain=v2 -z --branch --untracked-files=%s",
+                           repo_path, untracked_mode);
+    } else {
+        written = snprintf(cmd, sizeof(cmd), "status --porcelain=v2 -z --branch --untracked-files=%s",
+                           untracked_mode);
+    }
+    if (written >= (int)sizeof(cmd)) {
+        return GM_ERR_INVALID_INPUT;
+    }
     
+    /* Uncapped read: large trees easily exceed MAX_OUTPUT_LEN */
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
     if (result == NULL) {
         return GM_ERR_COMMAND_FAILED;
     }
@@ -306,50 +624,162 @@ gm_error_t get_uncommitted_changes(char ***files, int *count) {
         return GM_ERR_COMMAND_FAILED;
     }
     
-    if (result->output == NULL || strlen(result->output) == 0) {
-        free_cmd_result(result);
-        return GM_SUCCESS; /* No changes */
+    /* Take the output over as the path arena */
+    list->paths = result->output;
+    list->paths_len = result->output_len;
+    result->output = NULL;
+    free_cmd_result(result);
+    
+    /* Every entry has at least one NUL, which bounds the entry count */
+    int capacity = 0;
+    for (size_t i = 0; i < list->paths_len; i++) {
+        if (list->paths[i] == '\0') capacity++;
     }
     
-    /* Count lines */
-    int line_count = 1;
-    for (char *p = result->output; *p; p++) {
-        if (*p == '\n') line_count++;
+    if (capacity > 0) {
+        list->entries = (change_entry_t*)safe_calloc((size_t)capacity, sizeof(change_entry_t));
+        if (list->entries == NULL) {
+            free_change_list(list);
+            return GM_ERR_MEMORY_ALLOC;
+        }
     }
     
-    /* Allocate array */
-    *files = (char**)safe_calloc(line_count + 1, sizeof(char*));
-    if (*files == NULL) {
-        free_cmd_result(result);
-        return GM_ERR_MEMORY_ALLOC;
+    const char *base = list->paths;
+    const char *p = base;
+    const char *end = base + list->paths_len;
+    
+    while (p < end) {
+        const char *record_end = memchr(p, '\0', (size_t)(end - p));
+        if (record_end == NULL) {
+            break;
+        }
+        
+        const char *path = NULL;
+        change_entry_t *entry = &list->entries[list->count];
+        memset(entry, 0, sizeof(*entry));
+        
+        switch (p[0]) {
+            case '#':
+                parse_branch_header(list, p);
+                break;
+                
+            case '1': /* 1 XY sub mH mI mW hH hI path */
+            case '2': /* 2 XY sub mH mI mW hH hI Xscore path NUL origPath */
+            case 'u': /* u XY sub m1 m2 m3 mW h1 h2 h3 path */
+                if (record_end - p < 8) break;
+                entry->index_state = p[2];
+                entry->worktree_state = p[3];
+                
+                if (p[5] == 'S') {
+                    entry->submodule = CHANGE_SUBMODULE;
+                    if (p[6] == 'C') entry->submodule |= CHANGE_SUBMODULE_COMMIT;
+                    if (p[7] == 'M') entry->submodule |= CHANGE_SUBMODULE_MODIFIED;
+                    if (p[8] == 'U') entry->submodule |= CHANGE_SUBMODULE_UNTRACKED;
+                }
+                
+                if (p[0] == '1') {
+                    entry->kind = CHANGE_ORDINARY;
+                    path = skip_fields(p, record_end, 8);
+                } else if (p[0] == '2') {
+                    const char *score = skip_fields(p, record_end, 8);
+                    entry->kind = (score != NULL && score[0] == 'C') ?
+                                  CHANGE_COPIED : CHANGE_RENAMED;
+                    if (score != NULL) entry->score = (unsigned char)atoi(score + 1);
+                    path = skip_fields(p, record_end, 9);
+                } else {
+                    entry->kind = CHANGE_UNMERGED;
+                    path = skip_fields(p, record_end, 10);
+                }
+                break;
+                
+            case '?':
+            case '!':
+                entry->kind = (p[0] == '?') ? CHANGE_UNTRACKED : CHANGE_IGNORED;
+                entry->index_state = p[0];
+                entry->worktree_state = p[0];
+                path = (record_end - p > 2) ? p + 2 : NULL;
+                break;
+                
+            default:
+                break;
+        }
+        
+        p = record_end + 1;
+        
+        if (path == NULL) {
+            continue;
+        }
+        
+        entry->path_offset = (unsigned int)(path - base);
+        
+        /* Renames and copies carry the source path as a second record */
+        if (entry->kind == CHANGE_RENAMED || entry->kind == CHANGE_COPIED) {
+            const char *orig_end = (p < end) ? memchr(p, '\0', (size_t)(end - p)) : NULL;
+            if (orig_end != NULL) {
+                entry->orig_offset = (unsigned int)(p - base);
+                entry->has_orig = true;
+                p = orig_end + 1;
+            }
+        }
+        
+        list->count++;
     }
     
-    /* Parse lines */
-    char *output_copy = safe_strdup(result->output);
-    if (output_copy == NULL) {
-        free(*files);
-        *files = NULL;
-        free_cmd_result(result);
+    return GM_SUCCESS;
+}
+
+/**
+ * Free a change list and its path arena
+ */
+void free_change_list(change_list_t *list) {
+    if (list == NULL) return;
+    
+    free(list->entries);
+    free(list->paths);
+    memset(list, 0, sizeof(*list));
+}
+
+/**
+ * Get list of uncommitted changes
+ * 
+ * @param files Output: array of file paths
+ * @param count Output: number of files
+ * @return gm_error_t Error code
+ */
+gm_error_t get_uncommitted_changes(char ***files, int *count) {
+    if (files == NULL || count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    *files = NULL;
+    *count = 0;
+    
+    change_list_t list;
+    gm_error_t err = load_change_list(&list, true);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    if (list.count == 0) {
+        free_change_list(&list);
+        return GM_SUCCESS; /* No changes */
+    }
+    
+    *files = (char**)safe_calloc((size_t)list.count + 1, sizeof(char*));
+    if (*files == NULL) {
+        free_change_list(&list);
         return GM_ERR_MEMORY_ALLOC;
     }
     
     int idx = 0;
-    char *line = strtok(output_copy, "\n");
-    
-    while (line != NULL && idx < line_count) {
-        if (strlen(line) > 3) {
-            /* Skip status prefix (first 3 chars) */
-            char *filename = line + 3;
-            (*files)[idx] = safe_strdup(trim_whitespace(filename));
-            if ((*files)[idx] != NULL) {
-                idx++;
-            }
+    for (int i = 0; i < list.count; i++) {
+        (*files)[idx] = safe_strdup(list.paths + list.entries[i].path_offset);
+        if ((*files)[idx] != NULL) {
+            idx++;
         }
-        line = strtok(NULL, "\n");
     }
     
-    free(output_copy);
-    free_cmd_result(result);
+    free_change_list(&list);
     
     (*files)[idx] = NULL;
     *count = idx;
@@ -406,6 +836,11 @@ gm_error_t discard_changes(const char *file_path) {
  * @return gm_error_t Error code
  */
 gm_error_t discard_all_changes(void) {
+    if (snapshot_before("before discarding all changes") != GM_SUCCESS) {
+        PRINT_ERROR("Could not save a snapshot; nothing was discarded");
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
     /* Reset staged changes */
     cmd_result_t *result = exec_git_command("reset HEAD");
     
@@ -576,6 +1011,307 @@ gm_error_t list_stash(void) {
     return GM_SUCCESS;
 }
 
+/* ============================================================================
+ * Snapshot Functions
+ * ============================================================================ */
+
+/* Snapshots live in this ref's reflog, apart from the user's stash list */
+#define SNAPSHOT_REF "refs/git-master/snapshots"
+
+/**
+ * Escape text for use inside a double-quoted shell argument
+ */
+static void escape_double_quoted(const char *text, char *out, size_t len) {
+    size_t j = 0;
+    for (size_t i = 0; text[i] != '\0' && j + 2 < len; i++) {
+        if (text[i] == '"' || text[i] == '\\' || text[i] == '$' || text[i] == '`') {
+            out[j++] = '\\';
+        }
+        out[j++] = text[i];
+    }
+    out[j] = '\0';
+}
+
+/**
+ * Record the working tree and index as a snapshot commit
+ *
+ * Uses `stash create`, which writes the state from a temporary index
+ * without touching the checkout, then files the commit in the
+ * snapshot reflog. Untracked files are not included.
+ *
+ * @param reason Description stored with the snapshot
+ * @param oid Output: snapshot commit ID, empty if there was nothing to save (may be NULL)
+ * @param oid_len Size of oid
+ * @return gm_error_t Error code
+ */
+gm_error_t create_snapshot(const char *reason, char *oid, size_t oid_len) {
+    char escaped[MAX_COMMIT_MSG * 2];
+    char cmd[MAX_COMMAND_LEN];
+    
+    if (oid != NULL && oid_len > 0) {
+        oid[0] = '\0';
+    }
+    
+    escape_double_quoted((reason != NULL && strlen(reason) > 0) ? reason : "snapshot",
+                         escaped, sizeof(escaped));
+    snprintf(cmd, sizeof(cmd), "stash create \"%s\"", escaped);
+    
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        /* No commits yet: there is nothing a reset or discard could lose */
+        char head[MAX_OID_LEN];
+        if (resolve_ref_oid("HEAD", head, sizeof(head)) == GM_ERR_NO_COMMITS) {
+            free_cmd_result(result);
+            return GM_ERR_NO_COMMITS;
+        }
+        
+        /* An unmerged index or a held index.lock: refuse rather than go unprotected */
+        PRINT_ERROR("Cannot snapshot your changes: %s",
+                    (result->error != NULL && result->error[0] != '\0') ?
+                    trim_whitespace(result->error) : "git stash create failed");
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    char snapshot[MAX_OID_LEN];
+    snprintf(snapshot, sizeof(snapshot), "%s", trim_whitespace(result->output));
+    free_cmd_result(result);
+    
+    if (strlen(snapshot) == 0) {
+        return GM_SUCCESS; /* Clean working tree */
+    }
+    
+    snprintf(cmd, sizeof(cmd), "update-ref --create-reflog -m \"%s\" %s %s",
+             escaped, SNAPSHOT_REF, snapshot);
+    
+    result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Failed to save snapshot: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    free_cmd_result(result);
+    
+    if (oid != NULL && oid_len > 0) {
+        snprintf(oid, oid_len, "%s", snapshot);
+    }
+    
+    return GM_SUCCESS;
+}
+
+/**
+ * Take a snapshot ahead of a destructive operation
+ *
+ * @param reason Description stored with the snapshot
+ * @return gm_error_t Error code (GM_SUCCESS if there was nothing to save)
+ */
+gm_error_t snapshot_before(const char *reason) {
+    char oid[MAX_OID_LEN];
+    gm_error_t err = create_snapshot(reason, oid, sizeof(oid));
+    
+    if (err == GM_ERR_NO_COMMITS) {
+        return GM_SUCCESS;
+    }
+    
+    if (err == GM_SUCCESS && strlen(oid) > 0) {
+        PRINT_INFO("Saved snapshot %.7s of your changes (restore it from the Commit menu)", oid);
+    }
+    
+    return err;
+}
+
+/**
+ * List saved snapshots, newest first
+ * 
+ * @return int Number of snapshots, or -1 on error
+ */
+int list_snapshots(void) {
+    cmd_result_t *result = exec_git_command(
+        "reflog show --format=\"%h%x09%cr%x09%gs\" " SNAPSHOT_REF " --");
+    
+    if (result == NULL) {
+        return -1;
+    }
+    
+    if (result->exit_code != 0 || result->output == NULL || strlen(result->output) == 0) {
+        free_cmd_result(result);
+        PRINT_INFO("No snapshots");
+        return 0;
+    }
+    
+    printf("\n" COLOR_BOLD "Snapshots:" COLOR_RESET "\n");
+    
+    int count = 0;
+    char *save = NULL;
+    for (char *line = strtok_r(result->output, "\n", &save); line != NULL;
+         line = strtok_r(NULL, "\n", &save)) {
+        char *when = strchr(line, '\t');
+        char *reason = (when != NULL) ? strchr(when + 1, '\t') : NULL;
+        if (reason == NULL) continue;
+        *when++ = '\0';
+        *reason++ = '\0';
+        
+        printf("  %3d. " COLOR_YELLOW "%s" COLOR_RESET " %-16s %s\n",
+               count + 1, line, when, reason);
+        count++;
+    }
+    
+    free_cmd_result(result);
+    return count;
+}
+
+/**
+ * Remove untracked files that block a restore when every one of them
+ * already matches the snapshot byte for byte (files a discard left
+ * behind unstaged)
+ *
+ * @param error Error text of the failed `stash apply`
+ * @param snapshot Snapshot revision
+ * @return int Number of files removed
+ */
+static int remove_identical_untracked(const char *error, const char *snapshot) {
+    const char *list = strstr(error, "would be overwritten by merge:");
+    if (list == NULL) {
+        return 0;
+    }
+    
+    char hash_cmd[MAX_COMMAND_LEN] = "hash-object --";
+    char tree_cmd[MAX_COMMAND_LEN] = "rev-parse";
+    size_t hash_len = strlen(hash_cmd);
+    size_t tree_len = strlen(tree_cmd);
+    char **paths = NULL;
+    int count = 0;
+    
+    /* Paths are listed one per line, indented with a tab */
+    for (const char *line = strchr(list, '\n'); line != NULL && line[1] == '\t';
+         line = strchr(line + 1, '\n')) {
+        const char *start = line + 2;
+        size_t len = strcspn(start, "\n");
+        char path[MAX_PATH_LEN];
+        if (len == 0 || len >= sizeof(path) || strcspn(start, "\"\\$`\n") < len) {
+            continue;
+        }
+        memcpy(path, start, len);
+        path[len] = '\0';
+        
+        int n1 = snprintf(hash_cmd + hash_len, sizeof(hash_cmd) - hash_len, " \"%s\"", path);
+        int n2 = snprintf(tree_cmd + tree_len, sizeof(tree_cmd) - tree_len,
+                          " \"%s:%s\"", snapshot, path);
+        if (n1 < 0 || n2 < 0 || hash_len + (size_t)n1 >= sizeof(hash_cmd) ||
+            tree_len + (size_t)n2 >= sizeof(tree_cmd)) {
+            break;
+        }
+        
+        char **grown = (char**)safe_realloc(paths, (size_t)(count + 1) * sizeof(char*));
+        if (grown == NULL) break;
+        paths = grown;
+        paths[count] = safe_strdup(path);
+        if (paths[count] == NULL) break;
+        count++;
+        hash_len += (size_t)n1;
+        tree_len += (size_t)n2;
+    }
+    
+    int removed = 0;
+    cmd_result_t *hashes = (count > 0) ? exec_git_command(hash_cmd) : NULL;
+    cmd_result_t *blobs = (count > 0) ? exec_git_command(tree_cmd) : NULL;
+    
+    if (hashes != NULL && blobs != NULL && hashes->exit_code == 0) {
+        char *hash_save = NULL, *blob_save = NULL;
+        char *hash = strtok_r(hashes->output, "\n", &hash_save);
+        char *blob = strtok_r(blobs->output, "\n", &blob_save);
+        
+        /* rev-parse stops at the first path missing from the snapshot */
+        int identical = 0;
+        while (identical < count && hash != NULL && blob != NULL && strcmp(hash, blob) == 0) {
+            identical++;
+            hash = strtok_r(NULL, "\n", &hash_save);
+            blob = strtok_r(NULL, "\n", &blob_save);
+        }
+        
+        /* Only clear the way if the retry can then succeed */
+        for (int i = 0; identical == count && i < count; i++) {
+            if (unlink(paths[i]) == 0) {
+                removed++;
+            }
+        }
+    }
+    
+    if (hashes != NULL) free_cmd_result(hashes);
+    if (blobs != NULL) free_cmd_result(blobs);
+    if (paths != NULL) free_string_array(paths, count);
+    
+    return removed;
+}
+
+/**
+ * Restore a snapshot onto the working tree and index
+ * 
+ * @param index Snapshot number as shown by list_snapshots (1 = newest)
+ * @return gm_error_t Error code
+ */
+gm_error_t restore_snapshot(int index) {
+    if (index < 1) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char snapshot[MAX_PATH_LEN];
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(snapshot, sizeof(snapshot), "%s@{%d}", SNAPSHOT_REF, index - 1);
+    snprintf(cmd, sizeof(cmd), "stash apply --index \"%s\"", snapshot);
+    
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0 && remove_identical_untracked(result->error, snapshot) > 0) {
+        free_cmd_result(result);
+        result = exec_git_command(cmd);
+        if (result == NULL) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+    }
+    
+    if (result->exit_code != 0 && strstr(result->error, "CONFLICT") == NULL &&
+        strstr(result->output, "CONFLICT") == NULL) {
+        /* The staged part may no longer apply; restore it as unstaged changes */
+        free_cmd_result(result);
+        snprintf(cmd, sizeof(cmd), "stash apply \"%s\"", snapshot);
+        result = exec_git_command(cmd);
+        if (result == NULL) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+    }
+    
+    if (result->exit_code != 0) {
+        if (strstr(result->error, "CONFLICT") != NULL ||
+            strstr(result->output, "CONFLICT") != NULL) {
+            PRINT_WARNING("Snapshot restore resulted in conflicts");
+            free_cmd_result(result);
+            return GM_ERR_MERGE_CONFLICT;
+        }
+        
+        PRINT_ERROR("Failed to restore snapshot: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    free_cmd_result(result);
+    PRINT_SUCCESS("Restored snapshot %d", index);
+    
+    return GM_SUCCESS;
+}
+
 /**
  * Display status of working tree
  * 
@@ -6,7 +6,11 @@
 
 #include "config.h"
 #include <ctype.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <pwd.h>
+#include <stddef.h>
+#include <sys/mman.h>
 
 /* ============================================================================
  * Default Configuration
@@ -48,9 +52,19 @@ static const char *DEFAULT_CONFIG =
 "window_height = 800\n"
 "start_minimized = false\n"
 "show_in_tray = true\n"
+"# Draw frames only on input or changes instead of 60 times a second\n"
+"redraw_on_demand = true\n"
 "font_size = 14\n"
 "theme = dark\n"
 "\n"
+"[worktree_pool]\n"
+"# Keep warm worktrees of frequently used branches; switching to one\n"
+"# becomes a directory change (see git_master --worktree-switch)\n"
+"enabled = false\n"
+"size = 4\n"
+"disk_budget_mb = 4096\n"
+"# directory = /path/to/pool (default: inside the repository's .git)\n"
+"\n"
 "[shortcuts]\n"
 "# Format: key = action\n"
 "# Available actions: status, stage_all, commit, push, pull, fetch,\n"
@@ -118,25 +132,80 @@ static const action_map_t ACTION_MAP[] = {
 };
 
 /* ============================================================================
- * Helper Functions
+ * Settings Key Table
  * ============================================================================ */
 
-/**
- * Trim whitespace from both ends of a string
- */
-static char* config_trim(char *str) {
-    if (str == NULL) return NULL;
-    
-    while (isspace((unsigned char)*str)) str++;
-    
-    if (*str == 0) return str;
-    
-    char *end = str + strlen(str) - 1;
-    while (end > str && isspace((unsigned char)*end)) end--;
-    end[1] = '\0';
-    
-    return str;
-}
+typedef enum {
+    FIELD_BOOL,
+    FIELD_INT,
+    FIELD_STRING
+} config_field_type_t;
+
+/* Where a "section.key" setting lives in config_t */
+typedef struct {
+    const char *name;
+    config_field_type_t type;
+    size_t offset;
+    size_t size;                /* String fields only */
+    int default_val;            /* Int fields: used when the value is not a number */
+    int min_val;
+    int max_val;
+} config_field_t;
+
+#define FIELD_B(name, member) \
+    { name, FIELD_BOOL, offsetof(config_t, member), 0, 0, 0, 0 }
+#define FIELD_I(name, member, def, lo, hi) \
+    { name, FIELD_INT, offsetof(config_t, member), 0, def, lo, hi }
+#define FIELD_S(name, member) \
+    { name, FIELD_STRING, offsetof(config_t, member), sizeof(((config_t*)0)->member), 0, 0, 0 }
+
+/* Sorted by name (strcmp order) for bsearch */
+static const config_field_t CONFIG_FIELDS[] = {
+    FIELD_B("daemon.auto_detect_repos", daemon.auto_detect_repos),
+    FIELD_B("daemon.auto_fetch", daemon.auto_fetch),
+    FIELD_B("daemon.enabled", daemon.enabled),
+    FIELD_S("daemon.log_file", daemon.log_file),
+    FIELD_S("daemon.pid_file", daemon.pid_file),
+    FIELD_I("daemon.poll_rate_ms", daemon.poll_rate_ms, DEFAULT_POLL_RATE_MS,
+            MIN_POLL_RATE_MS, MAX_POLL_RATE_MS),
+    FIELD_B("daemon.run_on_startup", daemon.run_on_startup),
+    FIELD_I("display.diff_context_lines", display.diff_context_lines, 3, INT_MIN, INT_MAX),
+    FIELD_B("display.show_line_numbers", display.show_line_numbers),
+    FIELD_B("display.side_by_side_diff", display.side_by_side_diff),
+    FIELD_B("display.syntax_highlighting", display.syntax_highlighting),
+    FIELD_I("display.terminal_width", display.terminal_width, 120, INT_MIN, INT_MAX),
+    FIELD_B("display.use_colors", display.use_colors),
+    FIELD_B("gui.enabled", gui.enabled),
+    FIELD_I("gui.font_size", gui.font_size, 14, INT_MIN, INT_MAX),
+    FIELD_B("gui.redraw_on_demand", gui.redraw_on_demand),
+    FIELD_B("gui.show_in_tray", gui.show_in_tray),
+    FIELD_B("gui.start_minimized", gui.start_minimized),
+    FIELD_S("gui.theme", gui.theme),
+    FIELD_I("gui.window_height", gui.window_height, 800, INT_MIN, INT_MAX),
+    FIELD_I("gui.window_width", gui.window_width, 1200, INT_MIN, INT_MAX),
+    FIELD_B("notifications.enabled", notifications.enabled),
+    FIELD_S("notifications.icon_path", notifications.icon_path),
+    FIELD_B("notifications.show_on_commit_complete", notifications.show_on_commit_complete),
+    FIELD_B("notifications.show_on_conflicts", notifications.show_on_conflicts),
+    FIELD_B("notifications.show_on_pull_complete", notifications.show_on_pull_complete),
+    FIELD_B("notifications.show_on_push_complete", notifications.show_on_push_complete),
+    FIELD_B("notifications.show_on_remote_changes", notifications.show_on_remote_changes),
+    FIELD_B("notifications.show_on_repo_detect", notifications.show_on_repo_detect),
+    FIELD_B("notifications.sound_enabled", notifications.sound_enabled),
+    FIELD_I("notifications.timeout_ms", notifications.timeout_ms, DEFAULT_NOTIFICATION_TIMEOUT,
+            INT_MIN, INT_MAX),
+    FIELD_S("worktree_pool.directory", worktree_pool.directory),
+    FIELD_I("worktree_pool.disk_budget_mb", worktree_pool.disk_budget_mb,
+            DEFAULT_WORKTREE_DISK_BUDGET_MB, 0, INT_MAX),
+    FIELD_B("worktree_pool.enabled", worktree_pool.enabled),
+    FIELD_I("worktree_pool.size", worktree_pool.size, DEFAULT_WORKTREE_POOL_SIZE, 1, INT_MAX),
+};
+
+#define CONFIG_FIELD_COUNT (sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]))
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
 
 /**
  * Parse a boolean value from string
@@ -171,18 +240,9 @@ static int config_parse_int(const char *value, int default_val) {
  * ============================================================================ */
 
 /**
- * Create a new configuration object
+ * Reset every setting to its built-in default
  */
-config_t* config_create(void) {
-    config_t *config = (config_t*)safe_calloc(1, sizeof(config_t));
-    
-    if (config == NULL) {
-        return NULL;
-    }
-    
-    pthread_mutex_init(&config->lock, NULL);
-    
-    /* Set defaults */
+static void config_set_defaults(config_t *config) {
     config->notifications.enabled = true;
     config->notifications.timeout_ms = DEFAULT_NOTIFICATION_TIMEOUT;
     config->notifications.show_on_remote_changes = true;
@@ -203,8 +263,28 @@ config_t* config_create(void) {
     config->gui.window_width = 1200;
     config->gui.window_height = 800;
     config->gui.font_size = 14;
+    config->gui.redraw_on_demand = true;
     strncpy(config->gui.theme, "dark", sizeof(config->gui.theme) - 1);
     
+    config->worktree_pool.size = DEFAULT_WORKTREE_POOL_SIZE;
+    config->worktree_pool.disk_budget_mb = DEFAULT_WORKTREE_DISK_BUDGET_MB;
+}
+
+/**
+ * Create a new configuration object
+ */
+config_t* config_create(void) {
+    config_t *config = (config_t*)safe_calloc(1, sizeof(config_t));
+    
+    if (config == NULL) {
+        return NULL;
+    }
+    
+    pthread_mutex_init(&config->lock, NULL);
+    
+    /* Set defaults */
+    config_set_defaults(config);
+    
     return config;
 }
 
@@ -221,6 +301,13 @@ config_t* config_create_with_defaults(void) {
 void config_destroy(config_t *config) {
     if (config == NULL) return;
     
+    shortcut_table_t *table = atomic_load(&config->shortcut_table);
+    while (table != NULL) {
+        shortcut_table_t *retired = table->retired;
+        free(table);
+        table = retired;
+    }
+    
     pthread_mutex_destroy(&config->lock);
     free(config);
 }
@@ -316,197 +403,600 @@ gm_error_t config_create_default(const char *path) {
     return GM_SUCCESS;
 }
 
+/* ============================================================================
+ * Shortcut Key Codes
+ * ============================================================================ */
+
+typedef struct {
+    const char *name;
+    int key;
+} key_name_t;
+
+static const key_name_t KEY_NAMES[] = {
+    { "backspace", SHORTCUT_KEY_BACKSPACE },
+    { "del", SHORTCUT_KEY_DELETE },
+    { "delete", SHORTCUT_KEY_DELETE },
+    { "down", SHORTCUT_KEY_DOWN },
+    { "end", SHORTCUT_KEY_END },
+    { "enter", SHORTCUT_KEY_ENTER },
+    { "esc", SHORTCUT_KEY_ESCAPE },
+    { "escape", SHORTCUT_KEY_ESCAPE },
+    { "home", SHORTCUT_KEY_HOME },
+    { "ins", SHORTCUT_KEY_INSERT },
+    { "insert", SHORTCUT_KEY_INSERT },
+    { "left", SHORTCUT_KEY_LEFT },
+    { "pagedown", SHORTCUT_KEY_PAGE_DOWN },
+    { "pageup", SHORTCUT_KEY_PAGE_UP },
+    { "pgdn", SHORTCUT_KEY_PAGE_DOWN },
+    { "pgup", SHORTCUT_KEY_PAGE_UP },
+    { "plus", '+' },
+    { "return", SHORTCUT_KEY_ENTER },
+    { "right", SHORTCUT_KEY_RIGHT },
+    { "space", SHORTCUT_KEY_SPACE },
+    { "tab", SHORTCUT_KEY_TAB },
+    { "up", SHORTCUT_KEY_UP },
+    { NULL, 0 }
+};
+
+static bool token_is(const char *token, size_t len, const char *name) {
+    return strlen(name) == len && strncasecmp(token, name, len) == 0;
+}
+
 /**
- * Load configuration from file
+ * Parse the key part of a combination ("s", "F5", "pageup")
+ * 
+ * @param token Key name
+ * @param len Length of the name
+ * @return int Key in [0, SHORTCUT_KEY_COUNT), or -1 if unknown
  */
-gm_error_t config_load(config_t *config, const char *path) {
-    if (config == NULL) {
-        return GM_ERR_INVALID_INPUT;
+static int shortcut_parse_key_name(const char *token, size_t len) {
+    if (len == 1) {
+        unsigned char c = (unsigned char)token[0];
+        if (c < 0x20 || c >= 0x7f) {
+            return -1;
+        }
+        return tolower(c);
     }
     
-    if (path == NULL) {
-        path = config_get_default_path();
+    if (tolower((unsigned char)token[0]) == 'f' && len <= 3 &&
+        isdigit((unsigned char)token[1]) &&
+        (len == 2 || isdigit((unsigned char)token[2]))) {
+        int n = atoi(token + 1);
+        return (n >= 1 && n <= 12) ? SHORTCUT_KEY_F1 + n - 1 : -1;
     }
     
-    pthread_mutex_lock(&config->lock);
+    for (int i = 0; KEY_NAMES[i].name != NULL; i++) {
+        if (token_is(token, len, KEY_NAMES[i].name)) {
+            return KEY_NAMES[i].key;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Parse a key combination such as "ctrl+shift+p" into a key code
+ * 
+ * Case is not significant, as with the old string lookup: "Ctrl+S" is
+ * "ctrl+s", and shift must be named ("ctrl+shift+s"). "ctrl++" names
+ * the plus key.
+ * 
+ * @param spec Key combination
+ * @return int Key code for config_dispatch_key(), or -1 if not recognized
+ */
+int shortcut_parse_key(const char *spec) {
+    if (spec == NULL || *spec == '\0') {
+        return -1;
+    }
     
-    strncpy(config->config_path, path, sizeof(config->config_path) - 1);
+    int mods = 0;
+    const char *p = spec;
     
-    /* Check if file exists, create default if not */
-    struct stat st;
-    if (stat(path, &st) != 0) {
-        pthread_mutex_unlock(&config->lock);
-        gm_error_t err = config_create_default(path);
-        if (err != GM_SUCCESS) return err;
-        pthread_mutex_lock(&config->lock);
-        stat(path, &st);
+    for (;;) {
+        const char *plus = strchr(p, '+');
+        
+        /* The last token, or a "+" that is itself the key */
+        if (plus == NULL || plus == p) {
+            int key = shortcut_parse_key_name(p, strlen(p));
+            return key < 0 ? -1 : SHORTCUT_CODE(mods, key);
+        }
+        
+        size_t len = (size_t)(plus - p);
+        if (token_is(p, len, "ctrl") || token_is(p, len, "control")) {
+            mods |= SHORTCUT_MOD_CTRL;
+        } else if (token_is(p, len, "alt") || token_is(p, len, "meta") ||
+                   token_is(p, len, "option")) {
+            mods |= SHORTCUT_MOD_ALT;
+        } else if (token_is(p, len, "shift")) {
+            mods |= SHORTCUT_MOD_SHIFT;
+        } else {
+            return -1;
+        }
+        p = plus + 1;
+    }
+}
+
+/**
+ * Key code of a single byte read from a terminal in raw mode
+ */
+static int shortcut_code_from_byte(unsigned char c) {
+    switch (c) {
+        case 0x00: return SHORTCUT_CODE(SHORTCUT_MOD_CTRL, ' ');
+        case 0x09: return SHORTCUT_KEY_TAB;
+        case 0x0a:
+        case 0x0d: return SHORTCUT_KEY_ENTER;
+        case 0x1b: return SHORTCUT_KEY_ESCAPE;
+        case 0x7f: return SHORTCUT_KEY_BACKSPACE;
+        default: break;
     }
     
-    config->config_mtime = st.st_mtime;
+    if (c < 0x20) {
+        /* ^A..^Z and ^\ ^] ^^ ^_ */
+        return SHORTCUT_CODE(SHORTCUT_MOD_CTRL, c < 0x1b ? 'a' + c - 1 : c + 0x40);
+    }
+    if (isupper(c)) {
+        return SHORTCUT_CODE(SHORTCUT_MOD_SHIFT, tolower(c));
+    }
+    return c < 0x80 ? c : -1;
+}
+
+/**
+ * Named key of a CSI ("ESC [") or SS3 ("ESC O") sequence
+ * 
+ * @param final Final byte of the sequence
+ * @param param First numeric parameter (for "~" sequences)
+ * @return int Key, or -1 if unknown
+ */
+static int shortcut_key_from_escape(unsigned char final, int param) {
+    switch (final) {
+        case 'A': return SHORTCUT_KEY_UP;
+        case 'B': return SHORTCUT_KEY_DOWN;
+        case 'C': return SHORTCUT_KEY_RIGHT;
+        case 'D': return SHORTCUT_KEY_LEFT;
+        case 'H': return SHORTCUT_KEY_HOME;
+        case 'F': return SHORTCUT_KEY_END;
+        case 'P': case 'Q': case 'R': case 'S':
+            return SHORTCUT_KEY_F1 + (final - 'P');
+        case '~': break;
+        default: return -1;
+    }
     
-    FILE *fp = fopen(path, "r");
-    if (fp == NULL) {
-        pthread_mutex_unlock(&config->lock);
-        PRINT_ERROR("Cannot open config file: %s", path);
-        return GM_ERR_IO_ERROR;
+    switch (param) {
+        case 1: case 7: return SHORTCUT_KEY_HOME;
+        case 2: return SHORTCUT_KEY_INSERT;
+        case 3: return SHORTCUT_KEY_DELETE;
+        case 4: case 8: return SHORTCUT_KEY_END;
+        case 5: return SHORTCUT_KEY_PAGE_UP;
+        case 6: return SHORTCUT_KEY_PAGE_DOWN;
+        case 11: case 12: case 13: case 14: case 15:
+            return SHORTCUT_KEY_F1 + (param - 11);
+        case 17: case 18: case 19: case 20: case 21:
+            return SHORTCUT_KEY_F1 + 5 + (param - 17);
+        case 23: case 24:
+            return SHORTCUT_KEY_F1 + 10 + (param - 23);
+        default: return -1;
+    }
+}
+
+/**
+ * Translate the bytes of one key press in a raw-mode terminal into a key code
+ * 
+ * Handles control bytes (^S is ctrl+s), ESC-prefixed keys (alt), and the
+ * xterm CSI/SS3 sequences for arrows, editing keys and F1-F12 including
+ * their ";<modifier>" parameter. Enter and Tab arrive as ^M and ^I, so
+ * "ctrl+m" and "ctrl+i" can only be pressed in the GUI.
+ * 
+ * @param seq Bytes read for the key press
+ * @param len Number of bytes
+ * @return int Key code for config_dispatch_key(), or -1 if not recognized
+ */
+int shortcut_code_from_terminal(const unsigned char *seq, size_t len) {
+    if (seq == NULL || len == 0) {
+        return -1;
+    }
+    if (len == 1) {
+        return shortcut_code_from_byte(seq[0]);
+    }
+    if (seq[0] != 0x1b) {
+        return -1;
+    }
+    
+    if (len == 2) {
+        int code = shortcut_code_from_byte(seq[1]);
+        return code < 0 ? -1 : code | SHORTCUT_CODE(SHORTCUT_MOD_ALT, 0);
+    }
+    
+    if (seq[1] == 'O') {
+        return len == 3 ? shortcut_key_from_escape(seq[2], 0) : -1;
+    }
+    if (seq[1] != '[') {
+        return -1;
+    }
+    
+    /* ESC [ <param> ; <modifier> <final> */
+    int params[2] = { 0, 1 };
+    int count = 0;
+    for (size_t i = 2; i < len - 1; i++) {
+        if (isdigit(seq[i])) {
+            params[count] = params[count] * 10 + (seq[i] - '0');
+            if (params[count] > 255) {
+                return -1;
+            }
+        } else if (seq[i] == ';' && count == 0) {
+            count = 1;
+            params[1] = 0;
+        } else {
+            return -1;
+        }
     }
     
-    char line[CONFIG_MAX_LINE_LEN];
-    char current_section[64] = "";
+    int key = shortcut_key_from_escape(seq[len - 1], params[0]);
+    if (key < 0) {
+        return -1;
+    }
     
-    config->shortcut_count = 0;
-    config->repo_count = 0;
+    /* xterm encodes modifiers as 1 + (shift | alt << 1 | ctrl << 2) */
+    int xmods = params[1] > 0 ? params[1] - 1 : 0;
+    int mods = 0;
+    if (xmods & 0x1) mods |= SHORTCUT_MOD_SHIFT;
+    if (xmods & 0x2) mods |= SHORTCUT_MOD_ALT;
+    if (xmods & 0x4) mods |= SHORTCUT_MOD_CTRL;
     
-    while (fgets(line, sizeof(line), fp) != NULL) {
-        char *trimmed = config_trim(line);
+    return SHORTCUT_CODE(mods, key);
+}
+
+/**
+ * Compile the enabled shortcuts into a dispatch table and publish it
+ * 
+ * Called with the lock held whenever the shortcut list changes. The first
+ * definition of a key code wins, as with the old list scan. Nothing is
+ * published when the table would not change, so hot reloads of unrelated
+ * settings do not grow the retired chain.
+ */
+static void config_compile_shortcuts(config_t *config) {
+    shortcut_table_t *current = atomic_load_explicit(&config->shortcut_table,
+                                                     memory_order_relaxed);
+    shortcut_table_t *table = (shortcut_table_t*)safe_calloc(1, sizeof(shortcut_table_t));
+    
+    if (table == NULL) {
+        return;
+    }
+    
+    for (int i = 0; i < config->shortcut_count; i++) {
+        const shortcut_t *shortcut = &config->shortcuts[i];
+        int code = shortcut_parse_key(shortcut->key);
         
-        /* Skip empty lines and comments */
-        if (strlen(trimmed) == 0 || trimmed[0] == '#' || trimmed[0] == ';') {
+        if (!shortcut->enabled || code < 0 ||
+            shortcut->action <= ACTION_NONE || shortcut->action >= ACTION_MAX) {
+            continue;
+        }
+        if (table->actions[code] == ACTION_NONE) {
+            table->actions[code] = (unsigned char)shortcut->action;
+        }
+    }
+    
+    if (current != NULL &&
+        memcmp(current->actions, table->actions, sizeof(table->actions)) == 0) {
+        free(table);
+        return;
+    }
+    
+    table->retired = current;
+    atomic_store_explicit(&config->shortcut_table, table, memory_order_release);
+}
+
+/* ============================================================================
+ * Configuration Parsing
+ * ============================================================================ */
+
+static int compare_field_name(const void *key, const void *field) {
+    return strcmp((const char*)key, ((const config_field_t*)field)->name);
+}
+
+/**
+ * Store one value into the field it names
+ */
+static void config_apply_field(config_t *config, const config_field_t *field, const char *value) {
+    char *target = (char*)config + field->offset;
+    
+    switch (field->type) {
+        case FIELD_BOOL:
+            *(bool*)target = config_parse_bool(value);
+            break;
+        case FIELD_INT: {
+            int parsed = config_parse_int(value, field->default_val);
+            if (parsed < field->min_val) parsed = field->min_val;
+            if (parsed > field->max_val) parsed = field->max_val;
+            *(int*)target = parsed;
+            break;
+        }
+        case FIELD_STRING:
+            snprintf(target, field->size, "%s", value);
+            break;
+    }
+}
+
+/* A slice of the mapped config file */
+typedef struct {
+    const char *start;
+    size_t len;
+} config_span_t;
+
+static bool config_span_is(config_span_t span, const char *text) {
+    return span.len == strlen(text) && memcmp(span.start, text, span.len) == 0;
+}
+
+/**
+ * Copy a span into a NUL-terminated buffer; false if it does not fit
+ */
+static bool config_span_copy(config_span_t span, char *out, size_t len) {
+    if (span.len >= len) {
+        return false;
+    }
+    memcpy(out, span.start, span.len);
+    out[span.len] = '\0';
+    return true;
+}
+
+/**
+ * Handle one "key = value" line of the [shortcuts] or [repos] section,
+ * or of a settings section through the key table
+ * 
+ * Spans are only copied out once they are known to be used, so lines
+ * that cannot be stored (e.g. repos past CONFIG_MAX_REPOS) cost a compare.
+ */
+static void config_apply_entry(config_t *config, config_span_t section,
+                               config_span_t key, config_span_t value) {
+    char value_buf[MAX_PATH_LEN];
+    
+    if (config_span_is(section, "shortcuts")) {
+        if (config->shortcut_count < CONFIG_MAX_SHORTCUTS) {
+            /* A key too long for the table could never be pressed */
+            shortcut_t *shortcut = &config->shortcuts[config->shortcut_count];
+            if (!config_span_copy(key, shortcut->key, sizeof(shortcut->key)) ||
+                !config_span_copy(value, value_buf, CONFIG_KEY_MAX_LEN)) {
+                return;
+            }
+            
+            shortcut_action_t action = config_string_to_action(value_buf);
+            if (action != ACTION_NONE) {
+                shortcut->action = action;
+                shortcut->enabled = true;
+                snprintf(shortcut->description, sizeof(shortcut->description), "%.*s: %s",
+                         (int)key.len, key.start, config_action_to_string(action));
+                config->shortcut_count++;
+            }
+        }
+        return;
+    }
+    
+    if (config_span_is(section, "repos")) {
+        if (config->repo_count < CONFIG_MAX_REPOS) {
+            monitored_repo_t *repo = &config->repos[config->repo_count];
+            if (config_span_copy(key, repo->path, sizeof(repo->path)) &&
+                config_span_copy(value, repo->remote_url, sizeof(repo->remote_url))) {
+                snprintf(repo->remote_name, sizeof(repo->remote_name), "origin");
+                repo->active = true;
+                repo->auto_detect = false;
+                config->repo_count++;
+            }
+        }
+        return;
+    }
+    
+    char name[CONFIG_KEY_MAX_LEN * 2];
+    if (section.len + key.len + 2 > sizeof(name)) {
+        return;
+    }
+    memcpy(name, section.start, section.len);
+    name[section.len] = '.';
+    memcpy(name + section.len + 1, key.start, key.len);
+    name[section.len + 1 + key.len] = '\0';
+    
+    const config_field_t *field = (const config_field_t*)bsearch(name, CONFIG_FIELDS, CONFIG_FIELD_COUNT,
+                                                                 sizeof(config_field_t), compare_field_name);
+    if (field != NULL && config_span_copy(value, value_buf, sizeof(value_buf))) {
+        config_apply_field(config, field, value_buf);
+    }
+}
+
+static bool config_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+/**
+ * Span of [start, end) without surrounding whitespace
+ */
+static config_span_t config_trim_span(const char *start, const char *end) {
+    while (start < end && config_is_space(*start)) start++;
+    while (end > start && config_is_space(end[-1])) end--;
+    
+    config_span_t span = { start, (size_t)(end - start) };
+    return span;
+}
+
+/**
+ * Parse a whole config file image in one pass
+ */
+static void config_parse_buffer(config_t *config, const char *data, size_t size) {
+    const char *p = data;
+    const char *end = data + size;
+    config_span_t section = { "", 0 };
+    
+    while (p < end) {
+        const char *eol = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (eol == NULL) eol = end;
+        
+        const char *line = p;
+        p = eol + 1;
+        
+        while (line < eol && config_is_space(*line)) line++;
+        if (line == eol || *line == '#' || *line == ';') {
             continue;
         }
         
         /* Section header */
-        if (trimmed[0] == '[') {
-            char *end = strchr(trimmed, ']');
-            if (end != NULL) {
-                *end = '\0';
-                strncpy(current_section, trimmed + 1, sizeof(current_section) - 1);
+        if (*line == '[') {
+            const char *close = (const char*)memchr(line, ']', (size_t)(eol - line));
+            if (close != NULL) {
+                section.start = line + 1;
+                section.len = (size_t)(close - section.start);
             }
             continue;
         }
         
         /* Key = Value */
-        char *equals = strchr(trimmed, '=');
-        if (equals == NULL) continue;
-        
-        *equals = '\0';
-        char *key = config_trim(trimmed);
-        char *value = config_trim(equals + 1);
-        
-        /* Parse based on section */
-        if (strcmp(current_section, "daemon") == 0) {
-            if (strcmp(key, "enabled") == 0) {
-                config->daemon.enabled = config_parse_bool(value);
-            } else if (strcmp(key, "poll_rate_ms") == 0) {
-                config->daemon.poll_rate_ms = config_parse_int(value, DEFAULT_POLL_RATE_MS);
-                if (config->daemon.poll_rate_ms < MIN_POLL_RATE_MS) {
-                    config->daemon.poll_rate_ms = MIN_POLL_RATE_MS;
-                }
-                if (config->daemon.poll_rate_ms > MAX_POLL_RATE_MS) {
-                    config->daemon.poll_rate_ms = MAX_POLL_RATE_MS;
-                }
-            } else if (strcmp(key, "auto_fetch") == 0) {
-                config->daemon.auto_fetch = config_parse_bool(value);
-            } else if (strcmp(key, "auto_detect_repos") == 0) {
-                config->daemon.auto_detect_repos = config_parse_bool(value);
-            } else if (strcmp(key, "run_on_startup") == 0) {
-                config->daemon.run_on_startup = config_parse_bool(value);
-            } else if (strcmp(key, "pid_file") == 0) {
-                strncpy(config->daemon.pid_file, value, sizeof(config->daemon.pid_file) - 1);
-            } else if (strcmp(key, "log_file") == 0) {
-                strncpy(config->daemon.log_file, value, sizeof(config->daemon.log_file) - 1);
-            }
-        } else if (strcmp(current_section, "notifications") == 0) {
-            if (strcmp(key, "enabled") == 0) {
-                config->notifications.enabled = config_parse_bool(value);
-            } else if (strcmp(key, "sound_enabled") == 0) {
-                config->notifications.sound_enabled = config_parse_bool(value);
-            } else if (strcmp(key, "timeout_ms") == 0) {
-                config->notifications.timeout_ms = config_parse_int(value, DEFAULT_NOTIFICATION_TIMEOUT);
-            } else if (strcmp(key, "show_on_remote_changes") == 0) {
-                config->notifications.show_on_remote_changes = config_parse_bool(value);
-            } else if (strcmp(key, "show_on_conflicts") == 0) {
-                config->notifications.show_on_conflicts = config_parse_bool(value);
-            } else if (strcmp(key, "show_on_commit_complete") == 0) {
-                config->notifications.show_on_commit_complete = config_parse_bool(value);
-            } else if (strcmp(key, "show_on_push_complete") == 0) {
-                config->notifications.show_on_push_complete = config_parse_bool(value);
-            } else if (strcmp(key, "show_on_pull_complete") == 0) {
-                config->notifications.show_on_pull_complete = config_parse_bool(value);
-            } else if (strcmp(key, "show_on_repo_detect") == 0) {
-                config->notifications.show_on_repo_detect = config_parse_bool(value);
-            } else if (strcmp(key, "icon_path") == 0) {
-                strncpy(config->notifications.icon_path, value, 
-                        sizeof(config->notifications.icon_path) - 1);
-            }
-        } else if (strcmp(current_section, "display") == 0) {
-            if (strcmp(key, "use_colors") == 0) {
-                config->display.use_colors = config_parse_bool(value);
-            } else if (strcmp(key, "side_by_side_diff") == 0) {
-                config->display.side_by_side_diff = config_parse_bool(value);
-            } else if (strcmp(key, "diff_context_lines") == 0) {
-                config->display.diff_context_lines = config_parse_int(value, 3);
-            } else if (strcmp(key, "terminal_width") == 0) {
-                config->display.terminal_width = config_parse_int(value, 120);
-            } else if (strcmp(key, "show_line_numbers") == 0) {
-                config->display.show_line_numbers = config_parse_bool(value);
-            } else if (strcmp(key, "syntax_highlighting") == 0) {
-                config->display.syntax_highlighting = config_parse_bool(value);
-            }
-        } else if (strcmp(current_section, "gui") == 0) {
-            if (strcmp(key, "enabled") == 0) {
-                config->gui.enabled = config_parse_bool(value);
-            } else if (strcmp(key, "window_width") == 0) {
-                config->gui.window_width = config_parse_int(value, 1200);
-            } else if (strcmp(key, "window_height") == 0) {
-                config->gui.window_height = config_parse_int(value, 800);
-            } else if (strcmp(key, "start_minimized") == 0) {
-                config->gui.start_minimized = config_parse_bool(value);
-            } else if (strcmp(key, "show_in_tray") == 0) {
-                config->gui.show_in_tray = config_parse_bool(value);
-            } else if (strcmp(key, "font_size") == 0) {
-                config->gui.font_size = config_parse_int(value, 14);
-            } else if (strcmp(key, "theme") == 0) {
-                strncpy(config->gui.theme, value, sizeof(config->gui.theme) - 1);
-            }
-        } else if (strcmp(current_section, "shortcuts") == 0) {
-            if (config->shortcut_count < CONFIG_MAX_SHORTCUTS) {
-                shortcut_action_t action = config_string_to_action(value);
-                if (action != ACTION_NONE) {
-                    strncpy(config->shortcuts[config->shortcut_count].key, key,
-                            sizeof(config->shortcuts[0].key) - 1);
-                    config->shortcuts[config->shortcut_count].action = action;
-                    config->shortcuts[config->shortcut_count].enabled = true;
-                    snprintf(config->shortcuts[config->shortcut_count].description,
-                             sizeof(config->shortcuts[0].description),
-                             "%s: %s", key, value);
-                    config->shortcut_count++;
-                }
-            }
-        } else if (strcmp(current_section, "repos") == 0) {
-            if (config->repo_count < CONFIG_MAX_REPOS) {
-                strncpy(config->repos[config->repo_count].path, key,
-                        sizeof(config->repos[0].path) - 1);
-                strncpy(config->repos[config->repo_count].remote_url, value,
-                        sizeof(config->repos[0].remote_url) - 1);
-                strncpy(config->repos[config->repo_count].remote_name, "origin",
-                        sizeof(config->repos[0].remote_name) - 1);
-                config->repos[config->repo_count].active = true;
-                config->repos[config->repo_count].auto_detect = false;
-                config->repo_count++;
+        const char *equals = (const char*)memchr(line, '=', (size_t)(eol - line));
+        if (equals != NULL) {
+            config_apply_entry(config, section, config_trim_span(line, equals),
+                               config_trim_span(equals + 1, eol));
+        }
+    }
+}
+
+/**
+ * Replace the live settings with a freshly parsed copy
+ * 
+ * Runtime state of monitored repositories that are still configured
+ * (ahead/behind counts, last check) is carried over.
+ */
+static void config_publish(config_t *config, config_t *staged) {
+    for (int i = 0; i < staged->repo_count; i++) {
+        for (int j = 0; j < config->repo_count; j++) {
+            monitored_repo_t *old_repo = &config->repos[j];
+            monitored_repo_t *new_repo = &staged->repos[i];
+            
+            if (strcmp(old_repo->path, new_repo->path) == 0) {
+                new_repo->last_check = old_repo->last_check;
+                new_repo->last_remote_update = old_repo->last_remote_update;
+                new_repo->commits_behind = old_repo->commits_behind;
+                new_repo->commits_ahead = old_repo->commits_ahead;
+                memcpy(new_repo->last_delta, old_repo->last_delta, sizeof(new_repo->last_delta));
+                break;
             }
         }
     }
     
-    fclose(fp);
+    memcpy(config->config_path, staged->config_path, sizeof(config->config_path));
+    config->config_mtime = staged->config_mtime;
+    memcpy(config->shortcuts, staged->shortcuts, (size_t)staged->shortcut_count * sizeof(shortcut_t));
+    config->shortcut_count = staged->shortcut_count;
+    memcpy(config->repos, staged->repos, (size_t)staged->repo_count * sizeof(monitored_repo_t));
+    config->repo_count = staged->repo_count;
+    config->notifications = staged->notifications;
+    config->display = staged->display;
+    config->gui = staged->gui;
+    config->daemon = staged->daemon;
+    config->worktree_pool = staged->worktree_pool;
     config->loaded = true;
     
+    config_compile_shortcuts(config);
+}
+
+/**
+ * Load configuration from file
+ * 
+ * The file is read in one go and parsed into a private copy; the lock
+ * is only held while that copy replaces the live settings, so the daemon
+ * and shortcut lookups never wait on file I/O. Settings missing from the
+ * file fall back to their defaults. It is read rather than mapped: a
+ * mapping faults (SIGBUS) if another writer truncates the file mid-parse.
+ */
+gm_error_t config_load(config_t *config, const char *path) {
+    if (config == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    if (path == NULL) {
+        path = config_get_default_path();
+    }
+    
+    /* Check if file exists, create default if not */
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        gm_error_t err = config_create_default(path);
+        if (err != GM_SUCCESS) return err;
+    }
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) close(fd);
+        PRINT_ERROR("Cannot open config file: %s", path);
+        return GM_ERR_IO_ERROR;
+    }
+    
+    /*
+     * A file that shrinks while it is read just parses shorter. The buffer
+     * is an anonymous mapping, not malloc: freeing a large malloc block
+     * raises glibc's mmap threshold, after which the staged config_t
+     * comes from the heap and calloc has to clear all of it on every load.
+     */
+    char *data = NULL;
+    size_t size = 0;
+    if (st.st_size > 0) {
+        data = (char*)mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (data == MAP_FAILED) data = NULL;
+        while (data != NULL && size < (size_t)st.st_size) {
+            ssize_t n = read(fd, data + size, (size_t)st.st_size - size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            size += (size_t)n;
+        }
+    }
+    close(fd);
+    
+    if (st.st_size > 0 && data == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    
+    config_t *staged = (config_t*)safe_calloc(1, sizeof(config_t));
+    if (staged == NULL) {
+        if (data != NULL) munmap(data, (size_t)st.st_size);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    
+    config_set_defaults(staged);
+    snprintf(staged->config_path, sizeof(staged->config_path), "%s", path);
+    staged->config_mtime = st.st_mtime;
+    
+    if (data != NULL) {
+        config_parse_buffer(staged, data, size);
+        munmap(data, (size_t)st.st_size);
+    }
+    
+    pthread_mutex_lock(&config->lock);
+    config_publish(config, staged);
     pthread_mutex_unlock(&config->lock);
     
+    free(staged);
     return GM_SUCCESS;
 }
 
 /**
  * Save configuration to file
+ * 
+ * Written to a temporary file beside it and renamed into place, so a
+ * concurrent config_load sees the old file or the new one, never a
+ * half-written one. A symlinked config file is replaced at its target.
  */
 gm_error_t config_save(config_t *config) {
     if (config == NULL || strlen(config->config_path) == 0) {
         return GM_ERR_INVALID_INPUT;
     }
     
+    char target[PATH_MAX];
+    const char *save_path = (realpath(config->config_path, target) != NULL) ?
+                            target : config->config_path;
+    
+    char tmp_path[PATH_MAX + 32];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp.%d",
+                 save_path, (int)getpid()) >= (int)sizeof(tmp_path)) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
     pthread_mutex_lock(&config->lock);
     
-    FILE *fp = fopen(config->config_path, "w");
+    FILE *fp = fopen(tmp_path, "w");
     if (fp == NULL) {
         pthread_mutex_unlock(&config->lock);
         PRINT_ERROR("Cannot write config file: %s", config->config_path);
@@ -568,10 +1058,21 @@ gm_error_t config_save(config_t *config) {
     fprintf(fp, "window_height = %d\n", config->gui.window_height);
     fprintf(fp, "start_minimized = %s\n", config->gui.start_minimized ? "true" : "false");
     fprintf(fp, "show_in_tray = %s\n", config->gui.show_in_tray ? "true" : "false");
+    fprintf(fp, "redraw_on_demand = %s\n", config->gui.redraw_on_demand ? "true" : "false");
     fprintf(fp, "font_size = %d\n", config->gui.font_size);
     fprintf(fp, "theme = %s\n", config->gui.theme);
     fprintf(fp, "\n");
     
+    /* Worktree pool section */
+    fprintf(fp, "[worktree_pool]\n");
+    fprintf(fp, "enabled = %s\n", config->worktree_pool.enabled ? "true" : "false");
+    fprintf(fp, "size = %d\n", config->worktree_pool.size);
+    fprintf(fp, "disk_budget_mb = %d\n", config->worktree_pool.disk_budget_mb);
+    if (strlen(config->worktree_pool.directory) > 0) {
+        fprintf(fp, "directory = %s\n", config->worktree_pool.directory);
+    }
+    fprintf(fp, "\n");
+    
     /* Shortcuts section */
     fprintf(fp, "[shortcuts]\n");
     for (int i = 0; i < config->shortcut_count; i++) {
@@ -594,7 +1095,13 @@ gm_error_t config_save(config_t *config) {
     }
     fprintf(fp, "\n");
     
-    fclose(fp);
+    bool written = !ferror(fp);
+    if (fclose(fp) != 0 || !written || rename(tmp_path, save_path) != 0) {
+        unlink(tmp_path);
+        pthread_mutex_unlock(&config->lock);
+        PRINT_ERROR("Cannot write config file: %s", config->config_path);
+        return GM_ERR_IO_ERROR;
+    }
     
     /* Update mtime */
     struct stat st;
@@ -682,6 +1189,7 @@ gm_error_t config_add_shortcut(config_t *config, const char *key,
                 strncpy(config->shortcuts[i].description, desc,
                         sizeof(config->shortcuts[0].description) - 1);
             }
+            config_compile_shortcuts(config);
             pthread_mutex_unlock(&config->lock);
             return GM_SUCCESS;
         }
@@ -704,6 +1212,7 @@ gm_error_t config_add_shortcut(config_t *config, const char *key,
     }
     
     config->shortcut_count++;
+    config_compile_shortcuts(config);
     
     pthread_mutex_unlock(&config->lock);
     return GM_SUCCESS;
@@ -726,6 +1235,7 @@ gm_error_t config_remove_shortcut(config_t *config, const char *key) {
                 config->shortcuts[j] = config->shortcuts[j + 1];
             }
             config->shortcut_count--;
+            config_compile_shortcuts(config);
             pthread_mutex_unlock(&config->lock);
             return GM_SUCCESS;
         }
@@ -737,25 +1247,37 @@ gm_error_t config_remove_shortcut(config_t *config, const char *key) {
 
 /**
  * Get action for a key combination
+ * 
+ * The combination is parsed and looked up in the compiled table; no lock
+ * is taken. Input paths that already have a key code should call
+ * config_dispatch_key() directly.
  */
 shortcut_action_t config_get_action_for_key(config_t *config, const char *key) {
     if (config == NULL || key == NULL) {
         return ACTION_NONE;
     }
     
-    pthread_mutex_lock(&config->lock);
-    
-    for (int i = 0; i < config->shortcut_count; i++) {
-        if (config->shortcuts[i].enabled && 
-            strcasecmp(config->shortcuts[i].key, key) == 0) {
-            shortcut_action_t action = config->shortcuts[i].action;
-            pthread_mutex_unlock(&config->lock);
-            return action;
-        }
+    return config_dispatch_key(config, shortcut_parse_key(key));
+}
+
+/**
+ * Get action for a key code
+ * 
+ * Reads the published table without taking the lock: a concurrent reload
+ * publishes a new table and leaves this one intact.
+ * 
+ * @param config Configuration
+ * @param code Key code from shortcut_parse_key() or shortcut_code_from_terminal()
+ * @return shortcut_action_t Bound action, or ACTION_NONE
+ */
+shortcut_action_t config_dispatch_key(const config_t *config, int code) {
+    if (config == NULL || code < 0 || code >= SHORTCUT_TABLE_SIZE) {
+        return ACTION_NONE;
     }
     
-    pthread_mutex_unlock(&config->lock);
-    return ACTION_NONE;
+    const shortcut_table_t *table = atomic_load_explicit(&config->shortcut_table,
+                                                         memory_order_acquire);
+    return table != NULL ? (shortcut_action_t)table->actions[code] : ACTION_NONE;
 }
 
 /* ============================================================================
@@ -941,6 +1463,12 @@ void config_print(config_t *config) {
     printf("  Terminal Width: %d\n", config->display.terminal_width);
     printf("\n");
     
+    printf(COLOR_CYAN "[Worktree Pool]" COLOR_RESET "\n");
+    printf("  Enabled: %s\n", config->worktree_pool.enabled ? "yes" : "no");
+    printf("  Size: %d\n", config->worktree_pool.size);
+    printf("  Disk Budget: %d MB\n", config->worktree_pool.disk_budget_mb);
+    printf("\n");
+    
     printf(COLOR_CYAN "[Shortcuts] (%d configured)" COLOR_RESET "\n", config->shortcut_count);
     for (int i = 0; i < config->shortcut_count && i < 10; i++) {
         printf("  %s = %s\n", config->shortcuts[i].key,
@@ -9,6 +9,8 @@
 
 #include "git_master.h"
 #include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
 
 /* ============================================================================
  * Configuration Constants
@@ -26,6 +28,9 @@
 #define MIN_POLL_RATE_MS        500
 #define MAX_POLL_RATE_MS        60000
 
+#define DEFAULT_WORKTREE_POOL_SIZE      4
+#define DEFAULT_WORKTREE_DISK_BUDGET_MB 4096
+
 /* ============================================================================
  * Shortcut Actions
  * ============================================================================ */
@@ -58,10 +63,57 @@ typedef enum {
     ACTION_MAX
 } shortcut_action_t;
 
+/* ============================================================================
+ * Shortcut Key Codes
+ * ============================================================================ */
+
+/*
+ * A key press is normalized to one integer: a key in [0, SHORTCUT_KEY_COUNT)
+ * (ASCII with letters lowercased, then named keys) plus a modifier mask.
+ * "ctrl+s" in the config and Ctrl-S from the terminal or the GUI all
+ * become SHORTCUT_CODE(SHORTCUT_MOD_CTRL, 's').
+ */
+#define SHORTCUT_MOD_CTRL       0x1
+#define SHORTCUT_MOD_ALT        0x2
+#define SHORTCUT_MOD_SHIFT      0x4
+#define SHORTCUT_MOD_COUNT      8
+
+#define SHORTCUT_KEY_COUNT      256
+#define SHORTCUT_KEY_TAB        0x09
+#define SHORTCUT_KEY_ENTER      0x0d
+#define SHORTCUT_KEY_ESCAPE     0x1b
+#define SHORTCUT_KEY_SPACE      0x20
+#define SHORTCUT_KEY_BACKSPACE  0x7f
+#define SHORTCUT_KEY_F1         0x80    /* F1..F12 are consecutive */
+#define SHORTCUT_KEY_UP         0x90
+#define SHORTCUT_KEY_DOWN       0x91
+#define SHORTCUT_KEY_LEFT       0x92
+#define SHORTCUT_KEY_RIGHT      0x93
+#define SHORTCUT_KEY_HOME       0x94
+#define SHORTCUT_KEY_END        0x95
+#define SHORTCUT_KEY_PAGE_UP    0x96
+#define SHORTCUT_KEY_PAGE_DOWN  0x97
+#define SHORTCUT_KEY_INSERT     0x98
+#define SHORTCUT_KEY_DELETE     0x99
+
+#define SHORTCUT_CODE(mods, key)    ((int)(mods) * SHORTCUT_KEY_COUNT + (int)(key))
+#define SHORTCUT_TABLE_SIZE         (SHORTCUT_MOD_COUNT * SHORTCUT_KEY_COUNT)
+
 /* ============================================================================
  * Data Structures
  * ============================================================================ */
 
+/*
+ * Shortcuts compiled for dispatch: one action per key code. A table is
+ * never modified once published; a change publishes a new one and keeps
+ * the old one on the retired chain until the config is destroyed, so
+ * readers need neither the lock nor a reference count.
+ */
+typedef struct shortcut_table {
+    unsigned char actions[SHORTCUT_TABLE_SIZE];     /* shortcut_action_t */
+    struct shortcut_table *retired;                 /* Previously published table */
+} shortcut_table_t;
+
 /* Keyboard shortcut definition */
 typedef struct {
     char key[16];               /* Key combination (e.g., "ctrl+s", "alt+p") */
@@ -82,6 +134,7 @@ typedef struct {
     time_t last_remote_update;      /* Last known remote update time */
     int commits_behind;             /* How far behind remote */
     int commits_ahead;              /* How far ahead of remote */
+    char last_delta[128];           /* Ref changes seen by the last fetch */
 } monitored_repo_t;
 
 /* Notification settings */
@@ -115,6 +168,7 @@ typedef struct {
     int window_height;
     bool start_minimized;
     bool show_in_tray;
+    bool redraw_on_demand;      /* Draw only when something changed */
     int font_size;
     char theme[64];
 } gui_settings_t;
@@ -130,9 +184,41 @@ typedef struct {
     char log_file[MAX_PATH_LEN];
 } daemon_settings_t;
 
+/* Worktree pool settings */
+typedef struct {
+    bool enabled;
+    int size;                       /* Maximum pooled worktrees */
+    int disk_budget_mb;             /* 0 = no disk limit */
+    char directory[MAX_PATH_LEN];   /* Empty = <git-common-dir>/gm-worktrees */
+} worktree_pool_settings_t;
+
 /* Daemon state (opaque pointer) */
 typedef struct daemon_state daemon_state_t;
 
+/* Multi-repository runner (--all-repos) */
+#define FANOUT_DEFAULT_JOBS     8
+#define FANOUT_MAX_JOBS         64
+
+/*
+ * Activity feed: one structured event per operation. Each producer
+ * thread owns a ring file under <config dir>/activity/, mapped shared so
+ * `git_master --stats` can read what a running GUI or daemon wrote.
+ */
+#define ACTIVITY_RING_CAPACITY  1024    /* Events kept per producer */
+
+typedef struct {
+    int64_t timestamp_ms;       /* Wall clock at completion, ms since the epoch */
+    uint32_t duration_ms;
+    int32_t result;             /* gm_error_t */
+    char source[16];            /* Producer: "gui", "daemon", "cli" */
+    char op[24];                /* e.g. "commit", "fetch" */
+    char repo[136];             /* Repository path, shortened from the left */
+    char detail[64];
+} activity_event_t;
+
+/* Producer handle (opaque pointer) */
+typedef struct activity_ring activity_ring_t;
+
 /* Main configuration structure */
 typedef struct {
     /* File info */
@@ -142,6 +228,7 @@ typedef struct {
     /* Shortcuts */
     shortcut_t shortcuts[CONFIG_MAX_SHORTCUTS];
     int shortcut_count;
+    _Atomic(shortcut_table_t*) shortcut_table;     /* Read without the lock */
     
     /* Monitored repositories */
     monitored_repo_t repos[CONFIG_MAX_REPOS];
@@ -152,6 +239,7 @@ typedef struct {
     display_settings_t display;
     gui_settings_t gui;
     daemon_settings_t daemon;
+    worktree_pool_settings_t worktree_pool;
     
     /* State */
     bool loaded;
@@ -183,11 +271,38 @@ void daemon_set_paused(daemon_state_t *daemon, bool paused);
 gm_error_t daemon_check_repo(daemon_state_t *daemon, const char *repo_path);
 const char* daemon_get_current_repo(daemon_state_t *daemon);
 
+/* Worktree pool */
+gm_error_t worktree_pool_switch(const worktree_pool_settings_t *settings, const char *repo_path,
+                                const char *branch_name, char *path_out, size_t max_len);
+gm_error_t worktree_pool_refresh(const worktree_pool_settings_t *settings, const char *repo_path);
+gm_error_t worktree_pool_show(const worktree_pool_settings_t *settings, const char *repo_path);
+
+/* Parallel fetch */
+gm_error_t fetch_monitored_repos(config_t *config, int max_parallel);
+
+/* Activity feed */
+activity_ring_t* activity_open(const char *source);
+void activity_close(activity_ring_t *ring);
+void activity_push(activity_ring_t *ring, const char *op, const char *repo,
+                   double duration_ms, gm_error_t result, const char *detail);
+int activity_read(const activity_ring_t *ring, activity_event_t *events, int max);
+int activity_read_all(activity_event_t **events);
+double activity_clock_ms(void);
+
+/* JSON-lines server */
+gm_error_t serve_run(const char *socket_path);
+
+/* Multi-repository runner; returns 0 all ok, 1 some need attention, 2 some failed */
+int fanout_run(const char *op, const char *arg, const char *const *paths, int count, int jobs);
+
 /* Shortcut management */
 gm_error_t config_add_shortcut(config_t *config, const char *key, 
                                 shortcut_action_t action, const char *desc);
 gm_error_t config_remove_shortcut(config_t *config, const char *key);
 shortcut_action_t config_get_action_for_key(config_t *config, const char *key);
+shortcut_action_t config_dispatch_key(const config_t *config, int code);
+int shortcut_parse_key(const char *spec);
+int shortcut_code_from_terminal(const unsigned char *seq, size_t len);
 const char* config_action_to_string(shortcut_action_t action);
 shortcut_action_t config_string_to_action(const char *str);
 
@@ -0,0 +1,158 @@
+/**
+ * config_bench.c - Config parse benchmark for Git Master
+ *
+ * Generates a configuration file with thousands of [repos] entries and
+ * loads it repeatedly through config_load, reporting load time
+ * percentiles. config_load runs on every hot reload the daemon and the
+ * menu do, so its cost on a large file is what this tracks.
+ *
+ * Build and run with: make config-bench
+ * Run with:           build/git_master_config_bench [--repos N] [--runs N] [--max-p95 US]
+ */
+
+#include "config.h"
+#include <time.h>
+
+#define BENCH_DEFAULT_REPOS     5000
+#define BENCH_DEFAULT_RUNS      200
+
+static double bench_now_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of a sorted array */
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * Write a config with every section filled in and `repos` repositories
+ *
+ * @return long File size in bytes, or -1 on error
+ */
+static long bench_write_config(const char *path, int repos) {
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+
+    fprintf(fp, "# Generated by config_bench\n\n");
+    fprintf(fp, "[daemon]\nenabled = true\npoll_rate_ms = 30000\nauto_fetch = true\n\n");
+    fprintf(fp, "[notifications]\nenabled = true\ntimeout_ms = 5000\n\n");
+    fprintf(fp, "[display]\nuse_colors = true\ndiff_context_lines = 3\n\n");
+    fprintf(fp, "[gui]\nwindow_width = 1280\nwindow_height = 800\ntheme = dark\n\n");
+    fprintf(fp, "[shortcuts]\nctrl+f = fetch\nctrl+u = pull\nctrl+p = push\n\n");
+    fprintf(fp, "[repos]\n");
+    for (int i = 0; i < repos; i++) {
+        fprintf(fp, "/home/user/src/project-%05d = git@example.com:team/project-%05d.git\n", i, i);
+    }
+
+    long size = ftell(fp);
+    if (fclose(fp) != 0) {
+        return -1;
+    }
+    return size;
+}
+
+static void bench_usage(const char *argv0) {
+    printf("Usage: %s [--repos N] [--runs N] [--max-p95 US]\n", argv0);
+    printf("  --repos N     [repos] entries in the generated file (default %d)\n",
+           BENCH_DEFAULT_REPOS);
+    printf("  --runs N      Loads to time (default %d)\n", BENCH_DEFAULT_RUNS);
+    printf("  --max-p95 US  Fail if the p95 load time exceeds US microseconds\n");
+}
+
+int main(int argc, char *argv[]) {
+    int repos = BENCH_DEFAULT_REPOS;
+    int runs = BENCH_DEFAULT_RUNS;
+    double max_p95 = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            bench_usage(argv[0]);
+            return 0;
+        } else if (value == NULL) {
+            PRINT_ERROR("Unknown option or missing value: %s", argv[i]);
+            return 1;
+        } else if (strcmp(argv[i], "--repos") == 0) {
+            repos = atoi(value);
+        } else if (strcmp(argv[i], "--runs") == 0) {
+            runs = atoi(value);
+        } else if (strcmp(argv[i], "--max-p95") == 0) {
+            max_p95 = atof(value);
+        } else {
+            PRINT_ERROR("Unknown option: %s", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+    if (repos < 0 || runs <= 0) {
+        PRINT_ERROR("--repos must be >= 0 and --runs > 0");
+        return 1;
+    }
+
+    char path[] = "/tmp/git_master_config_bench.XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        PRINT_ERROR("Cannot create a temporary config file");
+        return 1;
+    }
+    close(fd);
+
+    long size = bench_write_config(path, repos);
+    config_t *config = config_create();
+    double *load_us = (double*)safe_calloc((size_t)runs, sizeof(double));
+    if (size < 0 || config == NULL || load_us == NULL) {
+        PRINT_ERROR("Cannot set up the benchmark");
+        unlink(path);
+        return 1;
+    }
+
+    /* One untimed load warms the page cache and allocator */
+    gm_error_t err = config_load(config, path);
+    for (int i = 0; i < runs && err == GM_SUCCESS; i++) {
+        double started = bench_now_us();
+        err = config_load(config, path);
+        load_us[i] = bench_now_us() - started;
+    }
+    unlink(path);
+
+    if (err != GM_SUCCESS) {
+        PRINT_ERROR("config_load failed: %d", err);
+        return 1;
+    }
+
+    qsort(load_us, (size_t)runs, sizeof(double), compare_double);
+    double p95 = percentile(load_us, runs, 95);
+
+    printf(COLOR_BOLD "%-8s %8s %6s %10s %10s %10s %10s" COLOR_RESET "\n",
+           "repos", "KiB", "runs", "p50 us", "p95 us", "p99 us", "max us");
+    printf("%-8d %8.1f %6d %10.1f %10.1f %10.1f %10.1f\n",
+           repos, (double)size / 1024.0, runs,
+           percentile(load_us, runs, 50), p95, percentile(load_us, runs, 99),
+           load_us[runs - 1]);
+
+    free(load_us);
+    config_destroy(config);
+
+    if (max_p95 > 0 && p95 > max_p95) {
+        PRINT_WARNING("p95 load time %.1f us is over the %.1f us budget", p95, max_p95);
+        return 1;
+    }
+    return 0;
+}
@@ -136,6 +136,7 @@ struct daemon_state {
     char current_repo[MAX_PATH_LEN];
     int inotify_fd;
     pthread_mutex_t state_lock;
+    activity_ring_t *activity;      /* Written by the monitor thread only */
 };
 
 static daemon_state_t *g_daemon = NULL;
@@ -233,26 +234,30 @@ static bool check_remote_changes(const char *repo_path, monitored_repo_t *repo)
         free_cmd_result(result);
     }
     
-    /* Check ahead/behind status */
-    snprintf(cmd, sizeof(cmd), "rev-list --left-right --count HEAD...@{upstream} 2>/dev/null");
-    result = exec_git_command(cmd);
-    
-    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-        int ahead = 0, behind = 0;
-        if (sscanf(result->output, "%d\t%d", &ahead, &behind) == 2) {
-            int old_behind = repo->commits_behind;
-            repo->commits_ahead = ahead;
-            repo->commits_behind = behind;
-            
-            /* New remote commits detected */
-            if (behind > old_behind && old_behind >= 0) {
-                has_changes = true;
-            }
-        }
+    /* Remember what the fetch moved, for the notification */
+    ref_delta_t *delta = NULL;
+    int delta_count = 0;
+    if (update_remote_state(repo->remote_name[0] ? repo->remote_name : "origin",
+                            &delta, &delta_count) == GM_SUCCESS) {
+        summarize_ref_delta(delta, delta_count, repo->last_delta, sizeof(repo->last_delta));
+        free(delta);
     }
     
-    if (result != NULL) {
-        free_cmd_result(result);
+    /* Check ahead/behind status */
+    char branch[MAX_BRANCH_NAME];
+    char upstream[MAX_BRANCH_NAME];
+    int ahead = 0, behind = 0;
+    
+    if (get_current_branch(branch, sizeof(branch)) == GM_SUCCESS &&
+        get_upstream_status(branch, upstream, sizeof(upstream), &ahead, &behind) == GM_SUCCESS) {
+        int old_behind = repo->commits_behind;
+        repo->commits_ahead = ahead;
+        repo->commits_behind = behind;
+        
+        /* New remote commits detected */
+        if (behind > old_behind && old_behind >= 0) {
+            has_changes = true;
+        }
     }
     
     repo->last_check = time(NULL);
@@ -402,7 +407,26 @@ static void* monitor_thread_func(void *arg) {
                 if (time_since_check >= poll_interval) {
                     pthread_mutex_unlock(&daemon->config->lock);
                     
+                    double started = activity_clock_ms();
                     bool has_remote_changes = check_remote_changes(repo->path, repo);
+                    char detail[64];
+                    
+                    if (has_remote_changes) {
+                        snprintf(detail, sizeof(detail), "%d new commit(s)", repo->commits_behind);
+                    } else {
+                        snprintf(detail, sizeof(detail), "up to date");
+                    }
+                    activity_push(daemon->activity, "remote-check", repo->path,
+                                  activity_clock_ms() - started, GM_SUCCESS, detail);
+                    
+                    /* Keep pooled worktrees in step with what was just fetched */
+                    if (daemon->config->worktree_pool.enabled) {
+                        started = activity_clock_ms();
+                        gm_error_t err = worktree_pool_refresh(&daemon->config->worktree_pool,
+                                                               repo->path);
+                        activity_push(daemon->activity, "pool-refresh", repo->path,
+                                      activity_clock_ms() - started, err, NULL);
+                    }
                     
                     if (has_remote_changes && 
                         daemon->config->notifications.enabled &&
@@ -410,8 +434,9 @@ static void* monitor_thread_func(void *arg) {
                         
                         char msg[512];
                         snprintf(msg, sizeof(msg), 
-                                 "Repository: %s\n%d new commit(s) available\nPull to update",
-                                 repo->path, repo->commits_behind);
+                                 "Repository: %s\n%d new commit(s) available (%s)\nPull to update",
+                                 repo->path, repo->commits_behind,
+                                 repo->last_delta[0] ? repo->last_delta : "no ref changes");
                         
                         send_notification("Git Master - Remote Changes", msg,
                                         NOTIFY_URGENCY_NORMAL,
@@ -455,6 +480,7 @@ daemon_state_t* daemon_init(config_t *config) {
     daemon->paused = false;
     daemon->inotify_fd = -1;
     pthread_mutex_init(&daemon->state_lock, NULL);
+    daemon->activity = activity_open("daemon");
     
     /* Initialize notification system */
     notify_system_init();
@@ -562,6 +588,7 @@ void daemon_cleanup(daemon_state_t *daemon) {
     }
     
     pthread_mutex_destroy(&daemon->state_lock);
+    activity_close(daemon->activity);
     
     free(daemon);
     
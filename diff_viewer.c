@@ -694,6 +694,8 @@ gm_error_t show_commit_diff_sbs(const char *commit1, const char *commit2,
                                  display_settings_t *settings) {
     char cmd[MAX_COMMAND_LEN];
     
+    prefetch_diff_blobs(commit1, commit2);
+    
     if (commit2 != NULL && strlen(commit2) > 0) {
         snprintf(cmd, sizeof(cmd), "diff \"%s\" \"%s\"", commit1, commit2);
     } else {
@@ -786,3 +788,554 @@ void show_colored_diff(const char *diff_text, bool use_colors) {
     
     free(copy);
 }
+
+/* ============================================================================
+ * Patch Model (Partial Staging)
+ * ============================================================================ */
+
+/* Context lines kept around each change in generated patches */
+#define PATCH_CONTEXT_LINES 3
+
+/**
+ * Grow a patch_set_t array by one element
+ */
+static void* patch_grow(void *array, int count, int *capacity, size_t elem_size) {
+    if (count < *capacity) {
+        return array;
+    }
+
+    int new_capacity = (*capacity == 0) ? 64 : *capacity * 2;
+    void *grown = safe_realloc(array, (size_t)new_capacity * elem_size);
+    if (grown != NULL) {
+        *capacity = new_capacity;
+    }
+    return grown;
+}
+
+/**
+ * Parse a unified diff into an exact, selectable model
+ *
+ * Unlike the display parser above, nothing is copied or sanitized:
+ * every file header and line is an (offset, length) into the original
+ * text, so generated patches reproduce the input byte for byte.
+ *
+ * @param text Diff text; ownership passes to the set
+ * @param text_len Length of text
+ * @param set Output patch set (free with free_patch_set)
+ * @return gm_error_t Error code
+ */
+gm_error_t parse_patch(char *text, size_t text_len, patch_set_t *set) {
+    if (text == NULL || set == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    memset(set, 0, sizeof(*set));
+    set->text = text;
+    set->text_len = text_len;
+
+    int file_cap = 0, hunk_cap = 0, line_cap = 0;
+    patch_file_t *file = NULL;
+    patch_hunk_t *hunk = NULL;
+    int old_left = 0, new_left = 0;
+    size_t pos = 0;
+
+    while (pos < text_len) {
+        const char *line = text + pos;
+        const char *nl = memchr(line, '\n', text_len - pos);
+        size_t len = (nl != NULL) ? (size_t)(nl - line) : text_len - pos;
+        size_t next = pos + len + (nl != NULL ? 1 : 0);
+
+        if (hunk != NULL && (old_left > 0 || new_left > 0) &&
+            (line[0] == ' ' || line[0] == '+' || line[0] == '-' || len == 0)) {
+            /* Hunk body; an empty line is a context line with its space stripped */
+            set->lines = patch_grow(set->lines, set->line_count, &line_cap, sizeof(patch_line_t));
+            if (set->lines == NULL) goto oom;
+
+            patch_line_t *pl = &set->lines[set->line_count++];
+            memset(pl, 0, sizeof(*pl));
+            pl->kind = (len == 0) ? ' ' : line[0];
+            pl->offset = (len == 0) ? pos : pos + 1;
+            pl->length = (len == 0) ? 0 : len - 1;
+            hunk->line_count++;
+
+            if (pl->kind != '+') old_left--;
+            if (pl->kind != '-') new_left--;
+            if (pl->kind == '+') file->additions++;
+            if (pl->kind == '-') file->deletions++;
+        } else if (line[0] == '\\' && hunk != NULL && hunk->line_count > 0) {
+            /* "\ No newline at end of file" applies to the previous line */
+            set->lines[set->line_count - 1].no_newline = true;
+        } else if (len >= 11 && strncmp(line, "diff --git ", 11) == 0) {
+            set->files = patch_grow(set->files, set->file_count, &file_cap, sizeof(patch_file_t));
+            if (set->files == NULL) goto oom;
+
+            file = &set->files[set->file_count++];
+            memset(file, 0, sizeof(*file));
+            file->header_offset = pos;
+            file->first_hunk = set->hunk_count;
+            hunk = NULL;
+        } else if (file != NULL && len >= 2 && strncmp(line, "@@", 2) == 0) {
+            set->hunks = patch_grow(set->hunks, set->hunk_count, &hunk_cap, sizeof(patch_hunk_t));
+            if (set->hunks == NULL) goto oom;
+
+            hunk = &set->hunks[set->hunk_count++];
+            memset(hunk, 0, sizeof(*hunk));
+            hunk->old_count = 1;
+            hunk->new_count = 1;
+            hunk->first_line = set->line_count;
+            hunk->header_offset = pos;
+            hunk->header_length = len;
+
+            /* Counts default to 1 when omitted ("@@ -5 +5,2 @@") */
+            const char *p = line + 2;
+            while (*p == ' ') p++;
+            if (*p == '-') {
+                hunk->old_start = (int)strtol(p + 1, (char**)&p, 10);
+                if (*p == ',') hunk->old_count = (int)strtol(p + 1, (char**)&p, 10);
+            }
+            while (*p == ' ') p++;
+            if (*p == '+') {
+                hunk->new_start = (int)strtol(p + 1, (char**)&p, 10);
+                if (*p == ',') hunk->new_count = (int)strtol(p + 1, (char**)&p, 10);
+            }
+
+            old_left = hunk->old_count;
+            new_left = hunk->new_count;
+            file->hunk_count++;
+        } else if (file != NULL && hunk == NULL) {
+            /* Extended header line */
+            file->header_length = next - file->header_offset;
+
+            if (strncmp(line, "new file mode", 13) == 0) file->is_new = true;
+            if (strncmp(line, "deleted file mode", 17) == 0) file->is_deleted = true;
+            if (strncmp(line, "Binary files ", 13) == 0 ||
+                strncmp(line, "GIT binary patch", 16) == 0) {
+                file->is_binary = true;
+            }
+            /* /dev/null stands in for the missing side of an added or deleted file */
+            bool null_side = (len == 13 && strncmp(line + 4, "/dev/null", 9) == 0);
+            if (strncmp(line, "+++ ", 4) == 0 && !null_side) {
+                file->path_offset = pos + 4;
+                file->path_length = len - 4;
+                /* Strip the "b/" prefix git adds to the new side */
+                if (file->path_length > 2 && strncmp(line + 4, "b/", 2) == 0) {
+                    file->path_offset += 2;
+                    file->path_length -= 2;
+                }
+            } else if (strncmp(line, "--- ", 4) == 0 && !null_side && file->path_length == 0) {
+                file->path_offset = pos + 4;
+                file->path_length = len - 4;
+                if (file->path_length > 2 && strncmp(line + 4, "a/", 2) == 0) {
+                    file->path_offset += 2;
+                    file->path_length -= 2;
+                }
+            }
+        }
+
+        pos = next;
+    }
+
+    /* Header lengths are recorded up to (not including) the first hunk */
+    for (int i = 0; i < set->file_count; i++) {
+        patch_file_t *f = &set->files[i];
+        if (f->header_length == 0) {
+            f->header_length = (f->hunk_count > 0) ?
+                set->hunks[f->first_hunk].header_offset - f->header_offset :
+                ((i + 1 < set->file_count) ? set->files[i + 1].header_offset : text_len) -
+                f->header_offset;
+        }
+    }
+
+    return GM_SUCCESS;
+
+oom:
+    free_patch_set(set);
+    return GM_ERR_MEMORY_ALLOC;
+}
+
+/**
+ * Load the unstaged worktree diff as a patch set
+ *
+ * @param file_path Limit to one path (NULL or empty for all)
+ * @param set Output patch set (free with free_patch_set)
+ * @return gm_error_t Error code
+ */
+gm_error_t load_worktree_patch(const char *file_path, patch_set_t *set) {
+    if (set == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char cmd[MAX_COMMAND_LEN];
+    if (file_path != NULL && strlen(file_path) > 0) {
+        snprintf(cmd, sizeof(cmd),
+                 "diff --no-color --no-ext-diff --no-renames -U%d -- \"%s\"",
+                 PATCH_CONTEXT_LINES, file_path);
+    } else {
+        snprintf(cmd, sizeof(cmd), "diff --no-color --no-ext-diff --no-renames -U%d",
+                 PATCH_CONTEXT_LINES);
+    }
+
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Failed to read diff: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    /* Take the output buffer over instead of copying it */
+    char *text = result->output;
+    size_t text_len = result->output_len;
+    result->output = NULL;
+    free_cmd_result(result);
+
+    return parse_patch(text, text_len, set);
+}
+
+/**
+ * Free a patch set and the diff text it owns
+ */
+void free_patch_set(patch_set_t *set) {
+    if (set == NULL) return;
+
+    free(set->text);
+    free(set->files);
+    free(set->hunks);
+    free(set->lines);
+    memset(set, 0, sizeof(*set));
+}
+
+/**
+ * Select or deselect every change line of a hunk
+ */
+void patch_select_hunk(patch_set_t *set, int hunk_index, bool selected) {
+    if (set == NULL || hunk_index < 0 || hunk_index >= set->hunk_count) return;
+
+    patch_hunk_t *hunk = &set->hunks[hunk_index];
+    for (int i = 0; i < hunk->line_count; i++) {
+        patch_line_t *line = &set->lines[hunk->first_line + i];
+        if (line->kind != ' ') {
+            line->selected = selected;
+        }
+    }
+}
+
+/* Growable output buffer for patch generation */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} patch_buf_t;
+
+static void patch_buf_put(patch_buf_t *buf, const char *data, size_t len) {
+    if (buf->failed) return;
+
+    if (buf->len + len + 1 > buf->cap) {
+        size_t cap = (buf->cap == 0) ? 4096 : buf->cap;
+        while (buf->len + len + 1 > cap) cap *= 2;
+        char *grown = safe_realloc(buf->data, cap);
+        if (grown == NULL) {
+            buf->failed = true;
+            return;
+        }
+        buf->data = grown;
+        buf->cap = cap;
+    }
+
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+/* A line of a hunk after applying the selection */
+typedef struct {
+    const patch_line_t *src;
+    char kind;
+    bool no_newline;
+} patch_out_line_t;
+
+/**
+ * Rewrite one hunk's lines according to the selection
+ *
+ * Unselected '-' lines stay in the index, so they become context;
+ * unselected '+' lines never reach the index, so they are dropped.
+ * Within a change block the selected additions take the place of the
+ * last selected deletion, so "-b -c +B" with only -b and +B picked
+ * yields "B c", not "c B".
+ *
+ * @param out Output lines (room for twice the hunk's lines)
+ * @return int Number of output lines
+ */
+static int select_hunk_lines(const patch_set_t *set, const patch_hunk_t *hunk,
+                             patch_out_line_t *out) {
+    int n = 0;
+    int i = 0;
+
+    while (i < hunk->line_count) {
+        const patch_line_t *lines = &set->lines[hunk->first_line];
+
+        if (lines[i].kind == ' ') {
+            out[n++] = (patch_out_line_t){ &lines[i], ' ', lines[i].no_newline };
+            i++;
+            continue;
+        }
+
+        /* A change block: every '-' then every '+' until the next context */
+        int block_end = i;
+        int last_removed = -1;
+        while (block_end < hunk->line_count && lines[block_end].kind != ' ') {
+            if (lines[block_end].kind == '-' && lines[block_end].selected) {
+                last_removed = block_end;
+            }
+            block_end++;
+        }
+
+        int first_added = i;
+        while (first_added < block_end && lines[first_added].kind == '-') first_added++;
+        int adds_after = (last_removed >= 0) ? last_removed : first_added - 1;
+
+        for (int k = i; k < first_added; k++) {
+            out[n++] = (patch_out_line_t){ &lines[k], lines[k].selected ? '-' : ' ',
+                                           lines[k].no_newline };
+            if (k == adds_after) {
+                for (int a = first_added; a < block_end; a++) {
+                    if (lines[a].selected) {
+                        out[n++] = (patch_out_line_t){ &lines[a], '+', lines[a].no_newline };
+                    }
+                }
+            }
+        }
+        if (adds_after < i) {
+            for (int a = first_added; a < block_end; a++) {
+                if (lines[a].selected) {
+                    out[n++] = (patch_out_line_t){ &lines[a], '+', lines[a].no_newline };
+                }
+            }
+        }
+
+        i = block_end;
+    }
+
+    /*
+     * Only the last new-side line may lack a newline. A kept old line
+     * without one that gains a successor must be rewritten with one.
+     */
+    bool new_side_follows = false;
+    for (int k = n - 1; k >= 0; k--) {
+        if (out[k].kind == '+' && new_side_follows) {
+            out[k].no_newline = false;
+        } else if (out[k].kind == ' ' && out[k].no_newline && new_side_follows) {
+            memmove(&out[k + 2], &out[k + 1], (size_t)(n - k - 1) * sizeof(patch_out_line_t));
+            out[k].kind = '-';
+            out[k + 1] = (patch_out_line_t){ out[k].src, '+', false };
+            n++;
+        }
+        if (out[k].kind != '-') new_side_follows = true;
+    }
+
+    return n;
+}
+
+/**
+ * Emit the selected part of one hunk as one or more minimal hunks
+ *
+ * Changes further apart than twice the context are split into
+ * separate hunks, and every header is recounted from what is emitted.
+ *
+ * @param delta In/out: lines added minus removed by earlier hunks of the file
+ */
+static void emit_partial_hunk(const patch_set_t *set, const patch_hunk_t *hunk,
+                              patch_out_line_t *out, patch_buf_t *buf, int *delta) {
+    int n = select_hunk_lines(set, hunk, out);
+
+    /* Old-side line number of each output line, for header starts
+     * ("-0,0" and "-5,0" name the line before an empty range) */
+    int old_line = (hunk->old_count == 0) ? hunk->old_start + 1 : hunk->old_start;
+    int i = 0;
+
+    while (i < n) {
+        /* Find the next change */
+        int first_change = i;
+        while (first_change < n && out[first_change].kind == ' ') first_change++;
+        if (first_change == n) break;
+
+        /* Extend through changes separated by at most 2 * context lines */
+        int last_change = first_change;
+        int j = first_change + 1;
+        while (j < n) {
+            if (out[j].kind != ' ') {
+                last_change = j;
+                j++;
+                continue;
+            }
+            int run = j;
+            while (run < n && out[run].kind == ' ') run++;
+            if (run == n || run - j > 2 * PATCH_CONTEXT_LINES) break;
+            j = run;
+        }
+
+        int start = first_change - PATCH_CONTEXT_LINES;
+        if (start < i) start = i;
+        int end = last_change + 1 + PATCH_CONTEXT_LINES;
+        if (end > n) end = n;
+
+        /* Advance the old-side counter to the sub-hunk start */
+        for (int k = i; k < start; k++) {
+            if (out[k].kind != '+') old_line++;
+        }
+
+        int old_count = 0, new_count = 0;
+        for (int k = start; k < end; k++) {
+            if (out[k].kind != '+') old_count++;
+            if (out[k].kind != '-') new_count++;
+        }
+
+        /* A zero count names the line before the (empty) range */
+        int old_start = (old_count == 0) ? old_line - 1 : old_line;
+        int new_start = old_line + *delta;
+        if (new_count == 0) new_start--;
+
+        char header[128];
+        int header_len = snprintf(header, sizeof(header), "@@ -%d,%d +%d,%d @@\n",
+                                  old_start, old_count, new_start, new_count);
+        patch_buf_put(buf, header, (size_t)header_len);
+
+        for (int k = start; k < end; k++) {
+            const patch_line_t *src = out[k].src;
+            char kind = out[k].kind;
+            patch_buf_put(buf, &kind, 1);
+            patch_buf_put(buf, set->text + src->offset, src->length);
+            patch_buf_put(buf, "\n", 1);
+            if (out[k].no_newline) {
+                patch_buf_put(buf, "\\ No newline at end of file\n", 28);
+            }
+            if (kind != '+') old_line++;
+        }
+
+        *delta += new_count - old_count;
+        i = end;
+    }
+}
+
+/**
+ * Build a minimal patch containing only the selected lines
+ *
+ * Binary files are skipped. Deletions are all-or-nothing, since a
+ * partial "deleted file" patch cannot apply.
+ *
+ * @param set Patch set with selections
+ * @param len_out Output: patch length (may be NULL)
+ * @return char* Patch text (must be freed), or NULL if nothing is selected
+ */
+char* build_partial_patch(const patch_set_t *set, size_t *len_out) {
+    if (set == NULL) return NULL;
+
+    patch_buf_t buf = { NULL, 0, 0, false };
+    patch_out_line_t *out = NULL;
+    int out_cap = 0;
+
+    for (int f = 0; f < set->file_count; f++) {
+        const patch_file_t *file = &set->files[f];
+        bool any = false;
+        bool all = true;
+
+        for (int h = 0; h < file->hunk_count; h++) {
+            const patch_hunk_t *hunk = &set->hunks[file->first_hunk + h];
+            for (int i = 0; i < hunk->line_count; i++) {
+                const patch_line_t *line = &set->lines[hunk->first_line + i];
+                if (line->kind == ' ') continue;
+                if (line->selected) any = true; else all = false;
+            }
+        }
+
+        if (!any || file->is_binary || (file->is_deleted && !all)) {
+            continue;
+        }
+
+        patch_buf_put(&buf, set->text + file->header_offset, file->header_length);
+
+        int delta = 0;
+        for (int h = 0; h < file->hunk_count; h++) {
+            const patch_hunk_t *hunk = &set->hunks[file->first_hunk + h];
+
+            if (2 * hunk->line_count > out_cap) {
+                out_cap = 2 * hunk->line_count;
+                patch_out_line_t *grown = safe_realloc(out,
+                                          (size_t)out_cap * sizeof(patch_out_line_t));
+                if (grown == NULL) {
+                    buf.failed = true;
+                    break;
+                }
+                out = grown;
+            }
+
+            emit_partial_hunk(set, hunk, out, &buf, &delta);
+        }
+    }
+
+    free(out);
+
+    if (buf.failed || buf.len == 0) {
+        free(buf.data);
+        return NULL;
+    }
+
+    if (len_out != NULL) *len_out = buf.len;
+    return buf.data;
+}
+
+/**
+ * Apply a patch to the index through a pipe
+ *
+ * @param patch Patch text
+ * @param len Length of patch
+ * @return gm_error_t Error code
+ */
+gm_error_t apply_patch_to_index(const char *patch, size_t len) {
+    if (patch == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    cmd_result_t *result = exec_git_command_input("apply --cached --whitespace=nowarn -",
+                                                  patch, len);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Failed to stage selection: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    free_cmd_result(result);
+    return GM_SUCCESS;
+}
+
+/**
+ * Stage the selected hunks and lines of a patch set
+ *
+ * @param set Patch set with selections
+ * @return gm_error_t Error code
+ */
+gm_error_t stage_patch_selection(const patch_set_t *set) {
+    size_t len = 0;
+    char *patch = build_partial_patch(set, &len);
+
+    if (patch == NULL) {
+        PRINT_WARNING("Nothing selected to stage");
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    gm_error_t err = apply_patch_to_index(patch, len);
+    free(patch);
+
+    if (err == GM_SUCCESS) {
+        PRINT_SUCCESS("Staged selected changes");
+    }
+    return err;
+}
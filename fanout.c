@@ -0,0 +1,449 @@
+/**
+ * fanout.c - Multi-Repository Runner for Git Master
+ *
+ * Runs one operation (status, fetch, fast-forward or merge check) across
+ * many repositories on a bounded pool of worker threads. Every command
+ * addresses its repository with `git -C`, so workers never touch the
+ * shared working directory. Each repository's line is printed as soon
+ * as it finishes, followed by a summary table in input order.
+ */
+
+#include "config.h"
+#include <pthread.h>
+
+/* ============================================================================
+ * Job State
+ * ============================================================================ */
+
+typedef enum {
+    FANOUT_OK = 0,
+    FANOUT_ATTENTION = 1,       /* Needs a person: conflicts, divergence, no upstream */
+    FANOUT_FAILED = 2           /* Not a repository, or git failed */
+} fanout_outcome_t;
+
+typedef struct {
+    const char *path;
+    char branch[MAX_BRANCH_NAME];
+    fanout_outcome_t outcome;
+    char detail[256];
+    double duration_ms;
+} fanout_result_t;
+
+typedef void (*fanout_op_fn)(const char *path, const char *arg, fanout_result_t *result);
+
+typedef struct {
+    fanout_op_fn run;
+    const char *arg;
+    fanout_result_t *results;
+    int count;
+    int next;                   /* Next repository to start */
+    int finished;
+    pthread_mutex_t lock;       /* Guards next/finished and stdout */
+} fanout_pool_t;
+
+/* Branch and change counts of one repository, from load_change_list_at */
+typedef struct {
+    char branch[MAX_BRANCH_NAME];
+    bool detached;
+    bool has_upstream;
+    int ahead;
+    int behind;
+    int staged;
+    int modified;
+    int untracked;
+    int conflicted;
+} fanout_state_t;
+
+/* ============================================================================
+ * Helpers
+ * ============================================================================ */
+
+/**
+ * Can a path be spliced into a shell command between double quotes?
+ */
+static bool path_is_quotable(const char *path) {
+    return strpbrk(path, "\"$`\\") == NULL;
+}
+
+/**
+ * Run git in a repository without changing directory
+ */
+static cmd_result_t* repo_git(const char *path, const char *args) {
+    char cmd[MAX_COMMAND_LEN];
+    if (!path_is_quotable(path)) {
+        return NULL;
+    }
+    if (snprintf(cmd, sizeof(cmd), "-C \"%s\" %s", path, args) >= (int)sizeof(cmd)) {
+        return NULL;
+    }
+    return exec_git_command_input(cmd, NULL, 0);
+}
+
+/**
+ * Record a failed command: the first line git wrote to stderr
+ */
+static void set_failure(fanout_result_t *result, const cmd_result_t *cmd, const char *fallback) {
+    result->outcome = FANOUT_FAILED;
+
+    const char *message = (cmd != NULL && cmd->error != NULL && cmd->error[0] != '\0') ?
+                          cmd->error : fallback;
+    int len = (int)strcspn(message, "\n");
+    snprintf(result->detail, sizeof(result->detail), "%.*s", len, message);
+}
+
+/**
+ * Read the branch and change counts of a repository
+ */
+static gm_error_t read_state(const char *path, bool untracked, fanout_state_t *state,
+                             fanout_result_t *result) {
+    memset(state, 0, sizeof(*state));
+
+    change_list_t changes;
+    gm_error_t err = load_change_list_at(path, &changes, untracked ? "normal" : "no");
+    if (err != GM_SUCCESS) {
+        /* Run git again for the message: it is worth a second spawn only on failure */
+        cmd_result_t *cmd = (err == GM_ERR_COMMAND_FAILED) ? repo_git(path, "rev-parse --git-dir") : NULL;
+        set_failure(result, cmd, "git status failed");
+        if (cmd != NULL) free_cmd_result(cmd);
+        return GM_ERR_NOT_GIT_REPO;
+    }
+
+    /* load_change_list names a detached HEAD "HEAD" */
+    state->detached = (strcmp(changes.branch, "HEAD") == 0);
+    snprintf(state->branch, sizeof(state->branch), "%s",
+             state->detached ? "(detached)" : changes.branch);
+    state->has_upstream = changes.has_upstream;
+    state->ahead = changes.ahead;
+    state->behind = changes.behind;
+
+    for (int i = 0; i < changes.count; i++) {
+        const change_entry_t *entry = &changes.entries[i];
+        if (entry->kind == CHANGE_UNMERGED) {
+            state->conflicted++;
+        } else if (entry->kind == CHANGE_UNTRACKED) {
+            state->untracked++;
+        } else if (entry->kind != CHANGE_IGNORED) {
+            if (entry->index_state != '.') state->staged++;
+            if (entry->worktree_state != '.') state->modified++;
+        }
+    }
+
+    free_change_list(&changes);
+    snprintf(result->branch, sizeof(result->branch), "%s", state->branch);
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Operations
+ * ============================================================================ */
+
+static void op_status(const char *path, const char *arg, fanout_result_t *result) {
+    fanout_state_t state;
+    (void)arg;
+
+    if (read_state(path, true, &state, result) != GM_SUCCESS) {
+        return;
+    }
+
+    char changes[160] = "";
+    int len = 0;
+    const struct { int count; const char *label; } parts[] = {
+        { state.staged, "staged" }, { state.modified, "modified" },
+        { state.untracked, "untracked" }, { state.conflicted, "conflicted" }
+    };
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        if (parts[i].count > 0 && len < (int)sizeof(changes)) {
+            len += snprintf(changes + len, sizeof(changes) - (size_t)len, "%s%d %s",
+                            len > 0 ? ", " : "", parts[i].count, parts[i].label);
+        }
+    }
+
+    char sync[64];
+    if (!state.has_upstream) {
+        snprintf(sync, sizeof(sync), "no upstream");
+    } else if (state.ahead == 0 && state.behind == 0) {
+        snprintf(sync, sizeof(sync), "up to date");
+    } else {
+        snprintf(sync, sizeof(sync), "ahead %d, behind %d", state.ahead, state.behind);
+    }
+
+    result->outcome = (state.conflicted > 0) ? FANOUT_ATTENTION : FANOUT_OK;
+    snprintf(result->detail, sizeof(result->detail), "%s; %s", len > 0 ? changes : "clean", sync);
+}
+
+static void op_fetch(const char *path, const char *arg, fanout_result_t *result) {
+    (void)arg;
+
+    /* Without --quiet, git names each updated ref on stderr as "old..new  ref -> tracking" */
+    cmd_result_t *cmd = repo_git(path, "fetch --all");
+    if (cmd == NULL || cmd->exit_code != 0) {
+        set_failure(result, cmd, "git fetch failed");
+        if (cmd != NULL) free_cmd_result(cmd);
+        return;
+    }
+
+    int updated = 0;
+    for (const char *p = cmd->error; p != NULL && (p = strstr(p, " -> ")) != NULL; p += 4) {
+        updated++;
+    }
+    free_cmd_result(cmd);
+
+    result->outcome = FANOUT_OK;
+    if (updated > 0) {
+        snprintf(result->detail, sizeof(result->detail), "%d ref(s) updated", updated);
+    } else {
+        snprintf(result->detail, sizeof(result->detail), "up to date");
+    }
+}
+
+/**
+ * Fast-forward the checked-out branch to its (already fetched) upstream
+ */
+static void op_fast_forward(const char *path, const char *arg, fanout_result_t *result) {
+    fanout_state_t state;
+    (void)arg;
+
+    if (read_state(path, false, &state, result) != GM_SUCCESS) {
+        return;
+    }
+
+    result->outcome = FANOUT_ATTENTION;
+    if (state.detached) {
+        snprintf(result->detail, sizeof(result->detail), "detached HEAD");
+        return;
+    }
+    if (!state.has_upstream) {
+        snprintf(result->detail, sizeof(result->detail), "no upstream");
+        return;
+    }
+    if (state.behind == 0) {
+        result->outcome = FANOUT_OK;
+        if (state.ahead > 0) {
+            snprintf(result->detail, sizeof(result->detail), "up to date (ahead %d)", state.ahead);
+        } else {
+            snprintf(result->detail, sizeof(result->detail), "up to date");
+        }
+        return;
+    }
+    if (state.ahead > 0) {
+        snprintf(result->detail, sizeof(result->detail),
+                 "diverged: ahead %d, behind %d", state.ahead, state.behind);
+        return;
+    }
+
+    cmd_result_t *cmd = repo_git(path, "merge --ff-only --quiet @{upstream}");
+    if (cmd == NULL || cmd->exit_code != 0) {
+        set_failure(result, cmd, "fast-forward failed");
+        if (cmd != NULL) free_cmd_result(cmd);
+        return;
+    }
+    free_cmd_result(cmd);
+
+    result->outcome = FANOUT_OK;
+    snprintf(result->detail, sizeof(result->detail), "fast-forwarded %d commit(s)", state.behind);
+}
+
+/**
+ * Would merging a branch (default: the upstream) into HEAD conflict?
+ */
+static void op_merge_check(const char *path, const char *arg, fanout_result_t *result) {
+    const char *target = (arg != NULL) ? arg : "@{upstream}";
+    char args[MAX_COMMAND_LEN];
+    snprintf(args, sizeof(args), "merge-tree --write-tree --name-only HEAD \"%s\"", target);
+
+    /* Exit 0 is a clean merge, 1 a conflicted one; anything else is an error */
+    cmd_result_t *cmd = repo_git(path, args);
+    if (cmd == NULL || (cmd->exit_code != 0 && cmd->exit_code != 1)) {
+        set_failure(result, cmd, "git merge-tree failed");
+        if (cmd != NULL) free_cmd_result(cmd);
+        return;
+    }
+
+    if (cmd->exit_code == 0) {
+        free_cmd_result(cmd);
+        result->outcome = FANOUT_OK;
+        snprintf(result->detail, sizeof(result->detail), "merges cleanly with %s", target);
+        return;
+    }
+
+    /* The tree ID line is followed by the conflicted paths, then a blank line */
+    char files[160] = "";
+    int len = 0;
+    int conflicts = 0;
+    char *paths = strchr(cmd->output, '\n');
+    char *end = (paths != NULL) ? strstr(paths, "\n\n") : NULL;
+    if (end != NULL) *end = '\0';
+
+    char *save = NULL;
+    for (char *line = (paths != NULL) ? strtok_r(paths, "\n", &save) : NULL; line != NULL;
+         line = strtok_r(NULL, "\n", &save)) {
+        if (conflicts < 3 && len < (int)sizeof(files)) {
+            len += snprintf(files + len, sizeof(files) - (size_t)len, "%s%s",
+                            conflicts > 0 ? ", " : "", line);
+        }
+        conflicts++;
+    }
+    free_cmd_result(cmd);
+
+    result->outcome = FANOUT_ATTENTION;
+    snprintf(result->detail, sizeof(result->detail), "%d conflicting file(s): %s%s",
+             conflicts, files, conflicts > 3 ? ", ..." : "");
+}
+
+static const struct {
+    const char *name;
+    fanout_op_fn run;
+} FANOUT_OPS[] = {
+    { "status",         op_status },
+    { "fetch",          op_fetch },
+    { "ff",             op_fast_forward },
+    { "merge-check",    op_merge_check },
+};
+
+/* ============================================================================
+ * Worker Pool
+ * ============================================================================ */
+
+static const char *const OUTCOME_LABELS[] = { "ok", "attention", "failed" };
+static const char *const OUTCOME_COLORS[] = { COLOR_GREEN, COLOR_YELLOW, COLOR_RED };
+
+/**
+ * Print one finished repository (called with the pool locked)
+ */
+static void print_fanout_result(const fanout_result_t *result) {
+    printf("  %s%-9s" COLOR_RESET " %-40s %s (%.0f ms)\n",
+           OUTCOME_COLORS[result->outcome], OUTCOME_LABELS[result->outcome],
+           result->path, result->detail, result->duration_ms);
+    fflush(stdout);
+}
+
+static void* fanout_worker(void *arg) {
+    fanout_pool_t *pool = (fanout_pool_t*)arg;
+
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        int index = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (index >= pool->count) break;
+
+        fanout_result_t *result = &pool->results[index];
+        double started = activity_clock_ms();
+        if (path_is_quotable(result->path)) {
+            pool->run(result->path, pool->arg, result);
+        } else {
+            result->outcome = FANOUT_FAILED;
+            snprintf(result->detail, sizeof(result->detail),
+                     "path contains a quote, '$', '`' or '\\'");
+        }
+        result->duration_ms = activity_clock_ms() - started;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->finished++;
+        print_fanout_result(result);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+/**
+ * Run an operation in every repository of a list
+ *
+ * @param op "status", "fetch", "ff" or "merge-check"
+ * @param arg Branch for merge-check (NULL for the upstream); unused otherwise
+ * @param paths Repository paths
+ * @param count Number of repositories
+ * @param jobs Concurrent repositories (<= 0 for FANOUT_DEFAULT_JOBS)
+ * @return int Exit status: 0 all ok, 1 some need attention, 2 some failed
+ */
+int fanout_run(const char *op, const char *arg, const char *const *paths, int count, int jobs) {
+    fanout_op_fn run = NULL;
+    for (size_t i = 0; i < sizeof(FANOUT_OPS) / sizeof(FANOUT_OPS[0]); i++) {
+        if (strcmp(FANOUT_OPS[i].name, op) == 0) {
+            run = FANOUT_OPS[i].run;
+        }
+    }
+    if (run == NULL) {
+        PRINT_ERROR("Unknown operation '%s' (status, fetch, ff, merge-check)", op);
+        return FANOUT_FAILED;
+    }
+    if (arg != NULL && strpbrk(arg, "\"$`\\") != NULL) {
+        PRINT_ERROR("Invalid branch name: %s", arg);
+        return FANOUT_FAILED;
+    }
+    if (paths == NULL || count <= 0) {
+        PRINT_INFO("No repositories");
+        return FANOUT_OK;
+    }
+
+    fanout_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.run = run;
+    pool.arg = arg;
+    pool.count = count;
+    pool.results = (fanout_result_t*)safe_calloc((size_t)count, sizeof(fanout_result_t));
+    if (pool.results == NULL) {
+        return FANOUT_FAILED;
+    }
+    for (int i = 0; i < count; i++) {
+        pool.results[i].path = paths[i];
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+
+    if (jobs <= 0) jobs = FANOUT_DEFAULT_JOBS;
+    if (jobs > FANOUT_MAX_JOBS) jobs = FANOUT_MAX_JOBS;
+    if (jobs > count) jobs = count;
+
+    PRINT_INFO("Running %s in %d repositories, %d at a time...", op, count, jobs);
+    double started = activity_clock_ms();
+
+    pthread_t threads[FANOUT_MAX_JOBS];
+    int running = 0;
+    for (int i = 0; i < jobs; i++) {
+        if (pthread_create(&threads[running], NULL, fanout_worker, &pool) == 0) {
+            running++;
+        }
+    }
+    if (running == 0) {
+        fanout_worker(&pool);  /* No threads available: run serially */
+    }
+    for (int i = 0; i < running; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool.lock);
+
+    double elapsed = activity_clock_ms() - started;
+
+    /* Summary in input order; the activity feed gets one event per repository */
+    activity_ring_t *ring = activity_open("cli");
+    int totals[3] = { 0, 0, 0 };
+    int worst = FANOUT_OK;
+
+    printf("\n" COLOR_BOLD "%-40s %-24s %-9s %8s  %s" COLOR_RESET "\n",
+           "Repository", "Branch", "Result", "ms", "Detail");
+    for (int i = 0; i < count; i++) {
+        const fanout_result_t *result = &pool.results[i];
+        printf("%-40s %-24.24s %s%-9s" COLOR_RESET " %8.0f  %s\n",
+               result->path, result->branch[0] ? result->branch : "-",
+               OUTCOME_COLORS[result->outcome], OUTCOME_LABELS[result->outcome],
+               result->duration_ms, result->detail);
+
+        totals[result->outcome]++;
+        if ((int)result->outcome > worst) worst = (int)result->outcome;
+        activity_push(ring, op, result->path, result->duration_ms,
+                      result->outcome == FANOUT_FAILED ? GM_ERR_COMMAND_FAILED : GM_SUCCESS,
+                      result->detail);
+    }
+    activity_close(ring);
+
+    printf("\n%d ok, %d need attention, %d failed (%.1f s)\n",
+           totals[FANOUT_OK], totals[FANOUT_ATTENTION], totals[FANOUT_FAILED], elapsed / 1000.0);
+
+    free(pool.results);
+    return worst;
+}
@@ -0,0 +1,551 @@
+/**
+ * fetch.c - Parallel Fetch Orchestrator for Git Master
+ *
+ * Fetches every remote of one or more repositories with bounded
+ * parallelism. Each child's stderr progress is parsed as it streams in
+ * and folded into one combined display, and every fetch reports a
+ * structured result: refs updated, pack bytes received and duration.
+ */
+
+#include "config.h"
+#include <pthread.h>
+#include <sys/time.h>
+
+/* ============================================================================
+ * Job State
+ * ============================================================================ */
+
+/* Progress redraw interval */
+#define FETCH_REDRAW_MS     100
+
+/* One (repository, remote) fetch */
+typedef struct fetch_pool fetch_pool_t;
+
+typedef struct {
+    fetch_pool_t *pool;
+    fetch_result_t *result;
+    bool shared_repo;           /* Other remotes of the repo are fetched concurrently */
+    bool running;
+    bool done;
+    char phase[48];             /* e.g. "Receiving objects" */
+    int percent;
+    char line[512];             /* Partial stderr line */
+    size_t line_len;
+} fetch_job_t;
+
+struct fetch_pool {
+    fetch_job_t *jobs;
+    int count;
+    int next;                   /* Next job to start */
+    int finished;
+    pthread_mutex_t lock;
+};
+
+static double now_ms(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1000.0 + (double)tv.tv_usec / 1000.0;
+}
+
+/* ============================================================================
+ * Progress Parsing
+ * ============================================================================ */
+
+/**
+ * Parse a size such as "1.23 MiB" or "220 bytes"
+ */
+static long long parse_size(const char *text) {
+    char *end;
+    double value = strtod(text, &end);
+    if (end == text) return 0;
+
+    while (*end == ' ') end++;
+    if (strncmp(end, "KiB", 3) == 0) value *= 1024.0;
+    else if (strncmp(end, "MiB", 3) == 0) value *= 1024.0 * 1024.0;
+    else if (strncmp(end, "GiB", 3) == 0) value *= 1024.0 * 1024.0 * 1024.0;
+
+    return (long long)value;
+}
+
+/**
+ * Handle one complete line of fetch stderr (called with the pool locked)
+ *
+ * Progress meters look like "Receiving objects:  45% (450/1000), 1.20 MiB | ...";
+ * with --verbose, each ref gets a line such as
+ * "   f7b4535..781ae2d  main -> origin/main" whose second column is a flag.
+ */
+static void parse_fetch_line(fetch_job_t *job, const char *line) {
+    fetch_result_t *result = job->result;
+    const char *percent = strstr(line, "% (");
+
+    if (percent != NULL) {
+        const char *colon = strchr(line, ':');
+        if (colon != NULL && colon < percent) {
+            int len = (int)(colon - line);
+            snprintf(job->phase, sizeof(job->phase), "%.*s", len, line);
+
+            const char *digits = percent;
+            while (digits > colon + 1 && digits[-1] >= '0' && digits[-1] <= '9') digits--;
+            job->percent = atoi(digits);
+        }
+
+        /* The pack size rides on the receiving (or local unpacking) meter */
+        const char *size = strstr(percent, "), ");
+        if (size != NULL && (strncmp(line, "Receiving objects", 17) == 0 ||
+                             strncmp(line, "Unpacking objects", 17) == 0)) {
+            long long bytes = parse_size(size + 3);
+            if (bytes > result->pack_bytes) {
+                result->pack_bytes = bytes;
+            }
+        }
+        return;
+    }
+
+    if (line[0] == ' ' && line[1] != '\0' && line[2] == ' ' && strstr(line, " -> ") != NULL) {
+        switch (line[1]) {
+            case '*':
+                result->refs_new++;
+                break;
+            case ' ':
+            case '+':
+            case 't':
+                result->refs_updated++;
+                break;
+            case '-':
+                result->refs_pruned++;
+                break;
+            case '!':
+                result->refs_rejected++;
+                break;
+            default: /* '=' up to date */
+                break;
+        }
+        return;
+    }
+
+    if (strncmp(line, "fatal: ", 7) == 0 || strncmp(line, "error: ", 7) == 0) {
+        snprintf(result->error, sizeof(result->error), "%s", line + 7);
+    }
+}
+
+/**
+ * Stream callback: split stderr into '\r'/'\n' terminated lines
+ */
+static void on_fetch_stderr(const char *data, size_t len, void *ctx) {
+    fetch_job_t *job = (fetch_job_t*)ctx;
+
+    pthread_mutex_lock(&job->pool->lock);
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        if (c == '\r' || c == '\n') {
+            job->line[job->line_len] = '\0';
+            if (job->line_len > 0) {
+                parse_fetch_line(job, job->line);
+            }
+            job->line_len = 0;
+        } else if (job->line_len + 1 < sizeof(job->line)) {
+            job->line[job->line_len++] = c;
+        }
+    }
+    pthread_mutex_unlock(&job->pool->lock);
+}
+
+/* ============================================================================
+ * Workers
+ * ============================================================================ */
+
+/**
+ * Run one fetch to completion
+ */
+static void run_fetch_job(fetch_job_t *job) {
+    fetch_result_t *result = job->result;
+    char cmd[MAX_COMMAND_LEN];
+
+    /*
+     * Fetches of the same repository share FETCH_HEAD and the gc lock:
+     * like `git fetch --all`, they append to a FETCH_HEAD emptied up
+     * front, and skip auto-gc rather than race for its lock.
+     */
+    snprintf(cmd, sizeof(cmd),
+             "git -C \"%s\" fetch --progress --verbose %s\"%s\"",
+             result->repo_path,
+             job->shared_repo ? "--append --no-auto-gc " : "",
+             result->remote);
+
+    double start = now_ms();
+    cmd_result_t *cmd_result = exec_command_stream(cmd, on_fetch_stderr, job);
+    double elapsed = now_ms() - start;
+
+    pthread_mutex_lock(&job->pool->lock);
+    result->duration_ms = elapsed;
+
+    if (cmd_result == NULL) {
+        result->success = false;
+        snprintf(result->error, sizeof(result->error), "failed to run git");
+    } else {
+        /* A last line without a trailing newline */
+        if (job->line_len > 0) {
+            job->line[job->line_len] = '\0';
+            parse_fetch_line(job, job->line);
+            job->line_len = 0;
+        }
+
+        result->exit_code = cmd_result->exit_code;
+        result->success = (cmd_result->exit_code == 0);
+        if (!result->success && strlen(result->error) == 0) {
+            snprintf(result->error, sizeof(result->error), "git fetch exited with %d",
+                     cmd_result->exit_code);
+        }
+        free_cmd_result(cmd_result);
+    }
+
+    job->running = false;
+    job->done = true;
+    job->pool->finished++;
+    pthread_mutex_unlock(&job->pool->lock);
+}
+
+/**
+ * Worker thread: take jobs until none are left
+ */
+static void* fetch_worker(void *arg) {
+    fetch_pool_t *pool = (fetch_pool_t*)arg;
+
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        if (pool->next >= pool->count) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        fetch_job_t *job = &pool->jobs[pool->next++];
+        job->running = true;
+        pthread_mutex_unlock(&pool->lock);
+
+        run_fetch_job(job);
+    }
+
+    return NULL;
+}
+
+/* ============================================================================
+ * Display
+ * ============================================================================ */
+
+/**
+ * Short display name for a job: "<repo dir>:<remote>"
+ */
+static void job_label(const fetch_result_t *result, char *out, size_t len) {
+    const char *base = strrchr(result->repo_path, '/');
+    base = (base != NULL && base[1] != '\0') ? base + 1 : result->repo_path;
+    if (snprintf(out, len, "%s:%s", base, result->remote) >= (int)len) {
+        out[len - 1] = '\0';
+    }
+}
+
+/**
+ * Redraw the combined progress view (called with the pool locked)
+ *
+ * @param drawn In/out: lines drawn last time, erased before redrawing
+ */
+static void render_progress(const fetch_pool_t *pool, int *drawn) {
+    if (*drawn > 0) {
+        printf("\033[%dA", *drawn);
+    }
+    printf("\033[J");
+
+    int lines = 0;
+    for (int i = 0; i < pool->count; i++) {
+        const fetch_job_t *job = &pool->jobs[i];
+        if (!job->running) continue;
+
+        char label[64];
+        job_label(job->result, label, sizeof(label));
+        printf("  " COLOR_CYAN "%-28.28s" COLOR_RESET " %-20.20s %3d%%\n", label,
+               job->phase[0] ? job->phase : "connecting", job->percent);
+        lines++;
+    }
+
+    printf("  %d/%d fetches complete\n", pool->finished, pool->count);
+    fflush(stdout);
+    *drawn = lines + 1;
+}
+
+/**
+ * Print one finished fetch
+ */
+static void print_fetch_result(const fetch_result_t *result) {
+    char label[64];
+    job_label(result, label, sizeof(label));
+
+    if (result->success) {
+        printf("  " COLOR_GREEN "%-28.28s" COLOR_RESET " %d updated, %d new, %lld KiB, %.0f ms\n",
+               label, result->refs_updated, result->refs_new,
+               (result->pack_bytes + 1023) / 1024, result->duration_ms);
+    } else {
+        printf("  " COLOR_RED "%-28.28s" COLOR_RESET " failed: %s\n", label, result->error);
+    }
+}
+
+/**
+ * Empty a repository's FETCH_HEAD before its remotes append to it
+ */
+static void truncate_fetch_head(const char *path) {
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "-C \"%s\" rev-parse --git-path FETCH_HEAD", path);
+
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result != NULL && result->exit_code == 0) {
+        /* Relative to the repository unless it lives elsewhere */
+        const char *fetch_head = trim_whitespace(result->output);
+        char full[2 * MAX_PATH_LEN];
+        if (snprintf(full, sizeof(full), "%s%s%s", fetch_head[0] == '/' ? "" : path,
+                     fetch_head[0] == '/' ? "" : "/", fetch_head) < (int)sizeof(full)) {
+            FILE *file = fopen(full, "w");
+            if (file != NULL) fclose(file);
+        }
+    }
+    if (result != NULL) free_cmd_result(result);
+}
+
+/**
+ * Record one activity event per finished fetch
+ *
+ * These are per-remote details under their own producer and operation
+ * name: the caller (the GUI, say) records the fetch as a whole itself.
+ */
+static void record_fetch_activity(const fetch_result_t *results, int count) {
+    activity_ring_t *ring = activity_open("fetch");
+    if (ring == NULL) return;
+
+    for (int i = 0; i < count; i++) {
+        char detail[64];
+        if (results[i].success) {
+            snprintf(detail, sizeof(detail), "%.24s: %d updated, %d new",
+                     results[i].remote, results[i].refs_updated, results[i].refs_new);
+        } else {
+            snprintf(detail, sizeof(detail), "%.24s: exit %d",
+                     results[i].remote, results[i].exit_code);
+        }
+        activity_push(ring, "fetch-remote", results[i].repo_path, results[i].duration_ms,
+                      results[i].success ? GM_SUCCESS : GM_ERR_COMMAND_FAILED, detail);
+    }
+
+    activity_close(ring);
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+/**
+ * Fetch every remote of the given repositories in parallel
+ *
+ * @param repo_paths Repository paths (NULL entries mean the current directory)
+ * @param repo_count Number of repositories
+ * @param max_parallel Concurrent fetches (<= 0 for FETCH_DEFAULT_PARALLEL)
+ * @param show_progress Draw the combined progress view
+ * @param results Output: one result per fetch (must be freed)
+ * @param result_count Output: number of results
+ * @return gm_error_t GM_SUCCESS if every fetch succeeded
+ */
+gm_error_t fetch_parallel(const char *const *repo_paths, int repo_count, int max_parallel,
+                          bool show_progress, fetch_result_t **results, int *result_count) {
+    if (repo_paths == NULL || repo_count <= 0 || results == NULL || result_count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *results = NULL;
+    *result_count = 0;
+
+    /* Plan: one job per (repository, remote) */
+    int capacity = 0;
+    int count = 0;
+    fetch_result_t *planned = NULL;
+    bool *shared = NULL;
+
+    for (int r = 0; r < repo_count; r++) {
+        const char *path = (repo_paths[r] != NULL && repo_paths[r][0] != '\0') ?
+                           repo_paths[r] : ".";
+        char cmd[MAX_COMMAND_LEN];
+        snprintf(cmd, sizeof(cmd), "-C \"%s\" remote", path);
+
+        cmd_result_t *remotes = exec_git_command(cmd);
+        if (remotes == NULL || remotes->exit_code != 0) {
+            PRINT_WARNING("Skipping '%s': not a git repository", path);
+            if (remotes != NULL) free_cmd_result(remotes);
+            continue;
+        }
+
+        int first = count;
+        char *save = NULL;
+        for (char *name = strtok_r(remotes->output, "\n", &save); name != NULL;
+             name = strtok_r(NULL, "\n", &save)) {
+            if (count == capacity) {
+                capacity = (capacity == 0) ? 16 : capacity * 2;
+                fetch_result_t *grown = (fetch_result_t*)safe_realloc(
+                    planned, (size_t)capacity * sizeof(fetch_result_t));
+                bool *grown_shared = (grown != NULL) ?
+                    (bool*)safe_realloc(shared, (size_t)capacity * sizeof(bool)) : NULL;
+                if (grown != NULL) planned = grown;
+                if (grown_shared == NULL) {
+                    free_cmd_result(remotes);
+                    free(planned);
+                    free(shared);
+                    return GM_ERR_MEMORY_ALLOC;
+                }
+                shared = grown_shared;
+            }
+
+            fetch_result_t *result = &planned[count++];
+            memset(result, 0, sizeof(*result));
+            snprintf(result->repo_path, sizeof(result->repo_path), "%s", path);
+            snprintf(result->remote, sizeof(result->remote), "%s", name);
+        }
+        free_cmd_result(remotes);
+
+        for (int i = first; i < count; i++) {
+            shared[i] = (count - first > 1);
+        }
+        if (count - first > 1) {
+            truncate_fetch_head(path);
+        }
+    }
+
+    if (count == 0) {
+        free(planned);
+        free(shared);
+        return GM_SUCCESS;
+    }
+
+    fetch_pool_t pool;
+    memset(&pool, 0, sizeof(pool));
+    pool.count = count;
+    pool.jobs = (fetch_job_t*)safe_calloc((size_t)count, sizeof(fetch_job_t));
+    if (pool.jobs == NULL) {
+        free(planned);
+        free(shared);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    pthread_mutex_init(&pool.lock, NULL);
+
+    for (int i = 0; i < count; i++) {
+        pool.jobs[i].pool = &pool;
+        pool.jobs[i].result = &planned[i];
+        pool.jobs[i].shared_repo = shared[i];
+    }
+    free(shared);
+
+    if (max_parallel <= 0) max_parallel = FETCH_DEFAULT_PARALLEL;
+    int workers = (max_parallel < count) ? max_parallel : count;
+
+    pthread_t threads[FETCH_MAX_PARALLEL];
+    if (workers > FETCH_MAX_PARALLEL) workers = FETCH_MAX_PARALLEL;
+
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[started], NULL, fetch_worker, &pool) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        fetch_worker(&pool);  /* No threads available: fetch serially */
+    }
+
+    /* Draw until every job is done; finished jobs scroll up as results */
+    bool tty = show_progress && isatty(STDOUT_FILENO);
+    bool *reported = (bool*)safe_calloc((size_t)count, sizeof(bool));
+    int drawn = 0;
+
+    while (true) {
+        pthread_mutex_lock(&pool.lock);
+        bool all_done = (pool.finished == pool.count);
+
+        if (show_progress) {
+            if (tty && drawn > 0) {
+                printf("\033[%dA\033[J", drawn);
+                drawn = 0;
+            }
+            for (int i = 0; i < count && reported != NULL; i++) {
+                if (pool.jobs[i].done && !reported[i]) {
+                    print_fetch_result(&planned[i]);
+                    reported[i] = true;
+                }
+            }
+            if (tty && !all_done) {
+                render_progress(&pool, &drawn);
+            }
+            fflush(stdout);
+        }
+        pthread_mutex_unlock(&pool.lock);
+
+        if (all_done) break;
+        usleep(FETCH_REDRAW_MS * 1000);
+    }
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool.lock);
+    free(pool.jobs);
+    free(reported);
+
+    gm_error_t err = GM_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        if (!planned[i].success) err = GM_ERR_COMMAND_FAILED;
+    }
+    record_fetch_activity(planned, count);
+
+    *results = planned;
+    *result_count = count;
+    return err;
+}
+
+/**
+ * Fetch every active monitored repository at once
+ *
+ * @param config Configuration holding the monitored repositories
+ * @param max_parallel Concurrent fetches (<= 0 for the default)
+ * @return gm_error_t Error code
+ */
+gm_error_t fetch_monitored_repos(config_t *config, int max_parallel) {
+    if (config == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    const char *paths[CONFIG_MAX_REPOS];
+    int count = 0;
+
+    pthread_mutex_lock(&config->lock);
+    for (int i = 0; i < config->repo_count && count < CONFIG_MAX_REPOS; i++) {
+        if (config->repos[i].active) {
+            paths[count++] = config->repos[i].path;
+        }
+    }
+    pthread_mutex_unlock(&config->lock);
+
+    if (count == 0) {
+        PRINT_INFO("No monitored repositories");
+        return GM_SUCCESS;
+    }
+
+    PRINT_INFO("Fetching %d repositories...", count);
+
+    fetch_result_t *results = NULL;
+    int result_count = 0;
+    gm_error_t err = fetch_parallel(paths, count, max_parallel, true, &results, &result_count);
+
+    int failed = 0;
+    for (int i = 0; i < result_count; i++) {
+        if (!results[i].success) failed++;
+    }
+    free(results);
+
+    if (failed == 0) {
+        PRINT_SUCCESS("Fetched %d remote(s)", result_count);
+    } else {
+        PRINT_ERROR("%d of %d fetches failed", failed, result_count);
+    }
+
+    return err;
+}
@@ -32,6 +32,11 @@
 #define MAX_OUTPUT_LEN      65536
 #define MAX_BRANCHES        1024
 #define MAX_REMOTES         64
+#define MAX_OID_LEN         65      /* Hex SHA-256 plus terminator */
+
+#define FETCH_DEFAULT_PARALLEL  4
+#define FETCH_MAX_PARALLEL      16
+#define PULL_PREFETCH_MAX_AGE   300     /* Seconds a fetched ref is reused by pulls */
 
 /* Error codes */
 typedef enum {
@@ -118,6 +123,151 @@ typedef struct {
     int remote_count;
 } repo_status_t;
 
+/* Outcome of one ref in a push set */
+typedef enum {
+    PUSH_REF_PENDING = 0,
+    PUSH_REF_OK = 1,
+    PUSH_REF_UP_TO_DATE = 2,
+    PUSH_REF_REJECTED = 3,
+    PUSH_REF_SKIPPED = 4        /* Diverged; left out so the atomic push can succeed */
+} push_ref_status_t;
+
+/* A local branch to push to its upstream */
+typedef struct {
+    char branch[MAX_BRANCH_NAME];
+    char remote[MAX_BRANCH_NAME];
+    char remote_ref[MAX_BRANCH_NAME];   /* e.g. refs/heads/main on the remote */
+    int ahead;
+    int behind;
+    push_ref_status_t status;
+    char summary[128];                  /* "abc..def", or the rejection reason */
+} push_ref_t;
+
+/* Commits each side of a pair has that the other lacks */
+typedef struct {
+    char left[MAX_OID_LEN];
+    char right[MAX_OID_LEN];
+    int ahead;                  /* Reachable from left only */
+    int behind;                 /* Reachable from right only */
+} ahead_behind_t;
+
+/* One branch/remote cell of the sync matrix */
+typedef struct {
+    bool present;               /* The remote has a same-named branch */
+    int ahead;
+    int behind;
+    bool diverged;
+    time_t last_push;           /* 0 when the reflog records no push */
+} sync_cell_t;
+
+/* A ref name and the object it points at */
+typedef struct {
+    char name[MAX_BRANCH_NAME];
+    char oid[MAX_OID_LEN];
+} ref_entry_t;
+
+/* How a remote-tracking ref moved between two fetches */
+typedef enum {
+    REF_CREATED = 0,
+    REF_UPDATED = 1,            /* Fast-forward */
+    REF_FORCED = 2,             /* The old tip is no longer contained */
+    REF_DELETED = 3
+} ref_change_t;
+
+typedef struct {
+    char refname[MAX_BRANCH_NAME];      /* Relative to refs/remotes/<remote>/ */
+    char old_oid[MAX_OID_LEN];          /* Empty when created */
+    char new_oid[MAX_OID_LEN];          /* Empty when deleted */
+    ref_change_t change;
+} ref_delta_t;
+
+/* What a pull has to do once the remote branch is known */
+typedef enum {
+    PULL_UP_TO_DATE = 0,        /* Nothing to bring in (the branch may be ahead) */
+    PULL_FAST_FORWARD = 1,
+    PULL_DIVERGED = 2           /* Needs a merge or a rebase */
+} pull_action_t;
+
+/* A pull of a remote branch into the current branch */
+typedef struct {
+    char remote[MAX_BRANCH_NAME];
+    char branch[MAX_BRANCH_NAME];
+    char head_ref[MAX_BRANCH_NAME];             /* e.g. refs/heads/main */
+    char tracking_ref[2 * MAX_BRANCH_NAME + 16];
+    char head_oid[MAX_OID_LEN];
+    char remote_oid[MAX_OID_LEN];
+    bool fetched;               /* False when the prefetched ref was fresh */
+    int ahead;
+    int behind;
+    pull_action_t action;
+} pull_plan_t;
+
+/* Every local branch against every remote */
+typedef struct {
+    char **branches;
+    int branch_count;
+    char **remotes;
+    int remote_count;
+    sync_cell_t *cells;         /* branch_count x remote_count, row-major */
+} sync_matrix_t;
+
+/* Outcome of one (repository, remote) fetch */
+typedef struct {
+    char repo_path[MAX_PATH_LEN];
+    char remote[MAX_BRANCH_NAME];
+    bool success;
+    int exit_code;
+    int refs_updated;           /* Fast-forwarded, forced or retagged */
+    int refs_new;
+    int refs_pruned;
+    int refs_rejected;
+    long long pack_bytes;       /* From the progress meter; 0 if git unpacked
+                                   a small fetch without showing one */
+    double duration_ms;
+    char error[256];
+} fetch_result_t;
+
+/* Kind of entry reported by `status --porcelain=v2` */
+typedef enum {
+    CHANGE_ORDINARY = 0,
+    CHANGE_RENAMED = 1,
+    CHANGE_COPIED = 2,
+    CHANGE_UNMERGED = 3,
+    CHANGE_UNTRACKED = 4,
+    CHANGE_IGNORED = 5
+} change_kind_t;
+
+/* Submodule flags of a change entry */
+#define CHANGE_SUBMODULE            0x01
+#define CHANGE_SUBMODULE_COMMIT     0x02    /* Checked-out commit differs */
+#define CHANGE_SUBMODULE_MODIFIED   0x04    /* Tracked changes inside */
+#define CHANGE_SUBMODULE_UNTRACKED  0x08    /* Untracked files inside */
+
+/* One changed path; paths are offsets into change_list_t.paths */
+typedef struct {
+    unsigned int path_offset;
+    unsigned int orig_offset;   /* Rename/copy source (valid if has_orig) */
+    char index_state;           /* X: '.', 'M', 'A', 'D', 'R', 'C', 'T', 'U', '?' */
+    char worktree_state;        /* Y */
+    unsigned char kind;         /* change_kind_t */
+    unsigned char submodule;    /* CHANGE_SUBMODULE* flags */
+    unsigned char score;        /* Rename/copy similarity percentage */
+    bool has_orig;
+} change_entry_t;
+
+/* Parsed `status --porcelain=v2 -z --branch` output */
+typedef struct {
+    change_entry_t *entries;
+    int count;
+    char *paths;                /* NUL-terminated paths, owned by the list */
+    size_t paths_len;
+    char branch[MAX_BRANCH_NAME];
+    char upstream[MAX_BRANCH_NAME];
+    bool has_upstream;
+    int ahead;
+    int behind;
+} change_list_t;
+
 /* Merge result */
 typedef struct {
     bool success;
@@ -128,6 +278,126 @@ typedef struct {
     char error_message[MAX_COMMIT_MSG];
 } merge_result_t;
 
+/* Batch staging operations */
+typedef enum {
+    STAGE_MODE_ADD = 0,         /* Add new, update modified, drop deleted */
+    STAGE_MODE_UPDATE,          /* Tracked paths only */
+    STAGE_MODE_REMOVE,          /* Drop from the index, keep the file */
+    STAGE_MODE_INTENT_TO_ADD    /* Record an empty placeholder (add -N) */
+} stage_mode_t;
+
+typedef enum {
+    STAGE_STATUS_PENDING = 0,
+    STAGE_STATUS_STAGED,        /* Path content recorded in the index */
+    STAGE_STATUS_REMOVED,       /* Path absent from the worktree / dropped */
+    STAGE_STATUS_FAILED
+} stage_status_t;
+
+/* Per-path outcome of stage_paths */
+typedef struct {
+    stage_status_t status;
+    char error[160];
+} stage_result_t;
+
+/* One line of a parsed patch; text is an offset into patch_set_t.text */
+typedef struct {
+    size_t offset;          /* Line text, after the ' ', '+' or '-' marker */
+    size_t length;          /* Excluding the newline */
+    char kind;              /* ' ', '+' or '-' */
+    bool no_newline;        /* Followed by "\ No newline at end of file" */
+    bool selected;          /* Include this change when staging */
+} patch_line_t;
+
+typedef struct {
+    int old_start;
+    int old_count;
+    int new_start;
+    int new_count;
+    size_t header_offset;   /* "@@ ... @@" line */
+    size_t header_length;
+    int first_line;         /* Index into patch_set_t.lines */
+    int line_count;
+} patch_hunk_t;
+
+typedef struct {
+    size_t header_offset;   /* "diff --git" through "+++" */
+    size_t header_length;
+    size_t path_offset;
+    size_t path_length;
+    bool is_new;
+    bool is_deleted;
+    bool is_binary;
+    int first_hunk;         /* Index into patch_set_t.hunks */
+    int hunk_count;
+    int additions;
+    int deletions;
+} patch_file_t;
+
+/* Exact, selectable model of a unified diff (owns its text) */
+typedef struct {
+    char *text;
+    size_t text_len;
+    patch_file_t *files;
+    int file_count;
+    patch_hunk_t *hunks;
+    int hunk_count;
+    patch_line_t *lines;
+    int line_count;
+} patch_set_t;
+
+/* Checkout profile and phase timings for large-repository switches */
+typedef struct {
+    bool large;             /* Use the parallel checkout path */
+    bool sparse;            /* core.sparseCheckout is enabled */
+    bool cone_mode;         /* Sparse patterns are cone-shaped */
+    bool sparse_index;      /* index.sparse value, if set */
+    bool sparse_index_set;
+    int cone_count;         /* Recursive cone directories, -1 if not cone mode */
+    long long index_bytes;
+    int workers;            /* checkout.workers to use */
+    const char *disk_type;  /* "ssd", "hdd", "network" or "unknown" */
+    int files_updated;
+    double index_read_ms;
+    double refresh_ms;
+    double unpack_ms;
+    double write_files_ms;
+    double index_write_ms;
+    double total_ms;
+} checkout_stats_t;
+
+/* Receives chunks of a child's stderr as they arrive */
+typedef void (*stream_callback_t)(const char *chunk, size_t len, void *ctx);
+
+/* Compact in-memory branch table used by the fuzzy finder */
+typedef struct {
+    char *names;            /* All names, NUL-separated, in one arena */
+    char *folded;           /* Lower-cased copy of names (same offsets) */
+    unsigned int *offsets;  /* Offset of each name in the arenas */
+    unsigned short *lengths;
+    unsigned long long *char_masks; /* Characters present, for quick reject */
+    long long *commit_times;
+    int *recency;           /* Position in checkout history, -1 if never */
+    int count;
+    int current;            /* Index of the checked-out branch, -1 if detached */
+} branch_table_t;
+
+/* One ranked fuzzy-finder hit */
+typedef struct {
+    int index;              /* Row in the branch table */
+    int score;
+    long long sort_key;     /* Score, then commit time, packed for sorting */
+} branch_match_t;
+
+/* Incremental filter state, reused between keystrokes */
+typedef struct {
+    branch_match_t *matches;
+    int count;
+    int ranked;             /* Leading matches that are sorted best-first */
+    int capacity;
+    char query[MAX_BRANCH_NAME];
+    bool valid;
+} branch_filter_t;
+
 /* Application state */
 typedef struct {
     repo_status_t *repo;
@@ -144,6 +414,9 @@ typedef struct {
 /* Command execution */
 cmd_result_t* exec_command(const char *command);
 cmd_result_t* exec_git_command(const char *git_args);
+cmd_result_t* exec_command_input(const char *command, const char *input, size_t input_len);
+cmd_result_t* exec_git_command_input(const char *git_args, const char *input, size_t input_len);
+cmd_result_t* exec_command_stream(const char *command, stream_callback_t on_stderr, void *ctx);
 void free_cmd_result(cmd_result_t *result);
 
 /* Error handling */
@@ -164,6 +437,31 @@ void* safe_malloc(size_t size);
 void* safe_realloc(void *ptr, size_t size);
 void* safe_calloc(size_t nmemb, size_t size);
 
+/* Repository metadata (read without spawning git) */
+gm_error_t find_git_dir(char *git_dir, size_t len);
+gm_error_t resolve_ref_oid(const char *ref, char *oid, size_t len);
+gm_error_t read_index_entry_count(unsigned int *count);
+gm_error_t find_common_dir(char *common_dir, size_t len);
+gm_error_t read_refs(const char *prefix, ref_entry_t **refs, int *count);
+gm_error_t read_reflog_time(const char *ref, const char *message_prefix, time_t *when);
+gm_error_t find_missing_objects(char (*oids)[MAX_OID_LEN], int count, int *missing);
+
+/* ============================================================================
+ * Function Declarations - Git Config Functions
+ * ============================================================================ */
+
+gm_error_t git_config_load(void);
+bool git_config_get(const char *key, char *value, size_t len);
+gm_error_t git_config_get_all(const char *key, char ***values, int *count);
+bool git_config_get_bool(const char *key, bool default_value);
+gm_error_t git_config_list_remotes(char ***remotes, int *count);
+gm_error_t git_config_remote_url(const char *remote, char *url, size_t len);
+gm_error_t git_config_branch_upstream(const char *branch, char *remote, size_t remote_len,
+                                      char *merge, size_t merge_len);
+gm_error_t git_config_tracking_ref(const char *remote, const char *ref, char *tracking, size_t len);
+gm_error_t resolve_upstream_ref(const char *branch, char *ref, size_t len);
+const char* short_ref_name(const char *ref);
+
 /* ============================================================================
  * Function Declarations - Repository Functions
  * ============================================================================ */
@@ -187,8 +485,24 @@ gm_error_t rename_branch(const char *old_name, const char *new_name);
 gm_error_t list_branches(branch_info_t **branches, int *count, bool include_remote);
 gm_error_t get_current_branch(char *branch_name, size_t max_len);
 gm_error_t get_branch_info(const char *branch_name, branch_info_t *info);
+gm_error_t get_upstream_status(const char *branch_name, char *upstream, size_t len,
+                               int *ahead, int *behind);
 bool branch_exists(const char *branch_name);
 
+/* Large-repository checkout */
+gm_error_t plan_checkout(checkout_stats_t *stats);
+gm_error_t switch_branch_large(const char *branch_name, checkout_stats_t *stats);
+void print_checkout_stats(const checkout_stats_t *stats);
+
+/* Fuzzy branch finder */
+gm_error_t load_branch_table(branch_table_t *table);
+void free_branch_table(branch_table_t *table);
+int fuzzy_match_score(const char *pattern, size_t pattern_len,
+                      const char *text, size_t text_len);
+gm_error_t branch_filter_update(const branch_table_t *table, branch_filter_t *filter,
+                                const char *query);
+void free_branch_filter(branch_filter_t *filter);
+
 /* ============================================================================
  * Function Declarations - Commit Management
  * ============================================================================ */
@@ -197,14 +511,36 @@ bool branch_exists(const char *branch_name);
 gm_error_t stage_all_changes(void);
 gm_error_t stage_file(const char *file_path);
 gm_error_t unstage_file(const char *file_path);
+gm_error_t stage_paths(const char *const *paths, int count, stage_mode_t mode,
+                       stage_result_t *results);
 gm_error_t commit_changes(const char *message);
+gm_error_t commit_changes_oid(const char *message, char *oid, size_t oid_len);
 gm_error_t amend_commit(const char *new_message);
 gm_error_t get_uncommitted_changes(char ***files, int *count);
+gm_error_t load_change_list(change_list_t *list, bool include_untracked);
+gm_error_t load_change_list_at(const char *repo_path, change_list_t *list,
+                               const char *untracked_mode);
+void free_change_list(change_list_t *list);
 gm_error_t discard_changes(const char *file_path);
 gm_error_t discard_all_changes(void);
 gm_error_t stash_changes(const char *message);
 gm_error_t pop_stash(void);
 
+/* Snapshots (working state saved without touching the checkout) */
+gm_error_t create_snapshot(const char *reason, char *oid, size_t oid_len);
+gm_error_t snapshot_before(const char *reason);
+int list_snapshots(void);
+gm_error_t restore_snapshot(int index);
+
+/* Partial staging (diff_viewer.c) */
+gm_error_t parse_patch(char *text, size_t text_len, patch_set_t *set);
+gm_error_t load_worktree_patch(const char *file_path, patch_set_t *set);
+void free_patch_set(patch_set_t *set);
+void patch_select_hunk(patch_set_t *set, int hunk_index, bool selected);
+char* build_partial_patch(const patch_set_t *set, size_t *len_out);
+gm_error_t apply_patch_to_index(const char *patch, size_t len);
+gm_error_t stage_patch_selection(const patch_set_t *set);
+
 /* ============================================================================
  * Function Declarations - Merge Operations
  * ============================================================================ */
@@ -228,12 +564,42 @@ gm_error_t remove_remote(const char *name);
 gm_error_t fetch_remote(const char *remote_name);
 gm_error_t fetch_all(void);
 
+/* Remote state between fetches */
+gm_error_t update_remote_state(const char *remote, ref_delta_t **delta, int *count);
+gm_error_t load_remote_delta(const char *remote, ref_delta_t **delta, int *count, time_t *fetched_at);
+void summarize_ref_delta(const ref_delta_t *delta, int count, char *buf, size_t len);
+void print_ref_delta(const char *remote, const ref_delta_t *delta, int count);
+gm_error_t show_remote_changes(void);
+
+/* Partial clone */
+bool is_valid_filter_spec(const char *spec);
+gm_error_t clone_repository(const char *url, const char *directory, const char *filter);
+gm_error_t get_promisor_remote(char *remote, size_t remote_len, char *filter, size_t filter_len);
+gm_error_t fetch_remote_filtered(const char *remote_name, const char *filter);
+gm_error_t prefetch_diff_blobs(const char *commit1, const char *commit2);
+gm_error_t prefetch_path_blobs(const char *commit, const char *path);
+
 /* Push and pull */
 gm_error_t push_branch(const char *remote, const char *branch, bool set_upstream);
 gm_error_t push_with_force(const char *remote, const char *branch);
+gm_error_t fetch_parallel(const char *const *repo_paths, int repo_count, int max_parallel,
+                          bool show_progress, fetch_result_t **results, int *result_count);
+gm_error_t collect_push_set(push_ref_t **refs, int *count);
+gm_error_t push_ref_set(push_ref_t *refs, int count);
+gm_error_t push_all_ahead(void);
 gm_error_t pull_branch(const char *remote, const char *branch);
 gm_error_t set_upstream(const char *remote, const char *branch);
 
+/* Pull planning */
+gm_error_t plan_pull(const char *remote, const char *branch, pull_plan_t *plan);
+gm_error_t execute_pull_plan(const pull_plan_t *plan, bool rebase);
+
+/* Sync status */
+gm_error_t compute_ahead_behind(ahead_behind_t *pairs, int count);
+gm_error_t build_sync_matrix(sync_matrix_t *matrix);
+void free_sync_matrix(sync_matrix_t *matrix);
+gm_error_t show_sync_matrix(void);
+
 /* ============================================================================
  * Function Declarations - History and Restore
  * ============================================================================ */
@@ -0,0 +1,1194 @@
+/**
+ * gitconfig.c - Git Configuration Reader for Git Master
+ *
+ * Reads the system, global, repository and worktree git config files
+ * in process, following include.path and includeIf, so upstream,
+ * remote and URL lookups do not have to spawn git.
+ */
+
+#include "git_master.h"
+#include <ctype.h>
+#include <limits.h>
+#include <strings.h>
+
+/* git stops following include.path after this many levels */
+#define CONFIG_MAX_INCLUDE_DEPTH    10
+
+/* One key/value pair, in the order git reads them */
+typedef struct {
+    char *key;              /* section[.subsection].name; section and name lowercased */
+    char *value;            /* NULL for a bare key, which reads as true */
+} config_entry_t;
+
+/* A file the parsed config depends on; missing files are tracked too */
+typedef struct {
+    char path[MAX_PATH_LEN];
+    bool exists;
+    time_t mtime;
+    off_t size;
+} config_source_t;
+
+/* Parsed config of the current repository, reused while no source changes */
+static struct {
+    bool loaded;
+    bool native;            /* False when git must interpret the config */
+    char git_dir[MAX_PATH_LEN];
+    config_source_t *sources;
+    int source_count;
+    int source_capacity;
+    config_entry_t *entries;
+    int count;
+    int capacity;
+    int *sorted;            /* Entry indexes ordered by key, then position */
+} config_cache;
+
+/* Cursor over one config file or value list */
+typedef struct {
+    const char *p;
+    const char *end;
+    const char *path;       /* NULL when not read from a file */
+    int depth;
+} config_parser_t;
+
+/* Growable string used while parsing */
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t capacity;
+} config_buf_t;
+
+static bool parse_config_file(const char *path, int depth);
+
+/* ============================================================================
+ * Parsing
+ * ============================================================================ */
+
+static bool buf_add(config_buf_t *sb, char c) {
+    if (sb->len + 1 >= sb->capacity) {
+        size_t capacity = (sb->capacity == 0) ? 64 : sb->capacity * 2;
+        char *grown = (char*)safe_realloc(sb->buf, capacity);
+        if (grown == NULL) {
+            return false;
+        }
+        sb->buf = grown;
+        sb->capacity = capacity;
+    }
+    sb->buf[sb->len++] = c;
+    sb->buf[sb->len] = '\0';
+    return true;
+}
+
+/**
+ * Next character of the file, with CRLF folded to LF; EOF at the end
+ */
+static int next_char(config_parser_t *ps) {
+    if (ps->p >= ps->end) {
+        return EOF;
+    }
+
+    int c = (unsigned char)*ps->p++;
+    if (c == '\r' && ps->p < ps->end && *ps->p == '\n') {
+        c = (unsigned char)*ps->p++;
+    }
+    return c;
+}
+
+/**
+ * Record a file the cache has to revalidate, present or not
+ */
+static bool add_config_source(const char *path) {
+    for (int i = 0; i < config_cache.source_count; i++) {
+        if (strcmp(config_cache.sources[i].path, path) == 0) {
+            return true;
+        }
+    }
+
+    if (config_cache.source_count == config_cache.source_capacity) {
+        int capacity = (config_cache.source_capacity == 0) ? 8 : config_cache.source_capacity * 2;
+        config_source_t *grown = (config_source_t*)safe_realloc(config_cache.sources,
+                                                                (size_t)capacity * sizeof(config_source_t));
+        if (grown == NULL) {
+            return false;
+        }
+        config_cache.sources = grown;
+        config_cache.source_capacity = capacity;
+    }
+
+    config_source_t *source = &config_cache.sources[config_cache.source_count++];
+    memset(source, 0, sizeof(*source));
+    snprintf(source->path, sizeof(source->path), "%s", path);
+
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        source->exists = true;
+        source->mtime = st.st_mtime;
+        source->size = st.st_size;
+    }
+    return true;
+}
+
+static bool add_config_entry(const char *key, const char *value) {
+    if (config_cache.count == config_cache.capacity) {
+        int capacity = (config_cache.capacity == 0) ? 64 : config_cache.capacity * 2;
+        config_entry_t *grown = (config_entry_t*)safe_realloc(config_cache.entries,
+                                                              (size_t)capacity * sizeof(config_entry_t));
+        if (grown == NULL) {
+            return false;
+        }
+        config_cache.entries = grown;
+        config_cache.capacity = capacity;
+    }
+
+    config_entry_t *entry = &config_cache.entries[config_cache.count];
+    entry->key = safe_strdup(key);
+    entry->value = (value != NULL) ? safe_strdup(value) : NULL;
+    if (entry->key == NULL || (value != NULL && entry->value == NULL)) {
+        free(entry->key);
+        free(entry->value);
+        return false;
+    }
+
+    config_cache.count++;
+    return true;
+}
+
+/**
+ * Match a path against a glob where "**" also crosses '/'
+ */
+static bool config_wildmatch(const char *pattern, const char *text, bool icase) {
+    while (*pattern != '\0') {
+        char p = *pattern;
+
+        if (p == '*') {
+            if (pattern[1] == '*') {
+                const char *rest = pattern + 2;
+                /* "**" followed by '/' may also match no directory at all */
+                if (*rest == '/' && config_wildmatch(rest + 1, text, icase)) {
+                    return true;
+                }
+                for (const char *t = text; ; t++) {
+                    if (config_wildmatch(rest, t, icase)) return true;
+                    if (*t == '\0') return false;
+                }
+            }
+            for (const char *t = text; ; t++) {
+                if (config_wildmatch(pattern + 1, t, icase)) return true;
+                if (*t == '\0' || *t == '/') return false;
+            }
+        }
+
+        if (*text == '\0') {
+            return false;
+        }
+
+        int tc = icase ? tolower((unsigned char)*text) : (unsigned char)*text;
+
+        if (p == '?') {
+            if (*text == '/') return false;
+        } else if (p == '[') {
+            const char *q = pattern + 1;
+            bool negate = (*q == '!' || *q == '^');
+            if (negate) q++;
+
+            const char *start = q;
+            bool matched = false;
+            while (*q != '\0' && (*q != ']' || q == start)) {
+                int lo = (unsigned char)*q;
+                int hi = lo;
+                if (q[1] == '-' && q[2] != '\0' && q[2] != ']') {
+                    hi = (unsigned char)q[2];
+                    q += 2;
+                }
+                if (icase) {
+                    lo = tolower(lo);
+                    hi = tolower(hi);
+                }
+                if (tc >= lo && tc <= hi) matched = true;
+                q++;
+            }
+            if (*q != ']' || matched == negate || *text == '/') {
+                return false;
+            }
+            pattern = q;
+        } else {
+            if (p == '\\' && pattern[1] != '\0') {
+                p = *++pattern;
+            }
+            int pc = icase ? tolower((unsigned char)p) : (unsigned char)p;
+            if (pc != tc) return false;
+        }
+
+        pattern++;
+        text++;
+    }
+
+    return *text == '\0';
+}
+
+/**
+ * Directory part of a config file path, for relative includes
+ */
+static void config_file_dir(const char *path, char *dir, size_t len) {
+    snprintf(dir, len, "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+        snprintf(dir, len, ".");
+    } else if (slash == dir) {
+        slash[1] = '\0';
+    } else {
+        *slash = '\0';
+    }
+}
+
+/**
+ * Expand "~/" and, for includes, paths relative to the including file
+ */
+static bool expand_config_path(const config_parser_t *ps, const char *value, char *path, size_t len) {
+    if (strncmp(value, "~/", 2) == 0) {
+        const char *home = getenv("HOME");
+        if (home == NULL) return false;
+        return snprintf(path, len, "%s/%s", home, value + 2) < (int)len;
+    }
+
+    if (value[0] == '/') {
+        return snprintf(path, len, "%s", value) < (int)len;
+    }
+
+    /* Relative includes only make sense from a file */
+    if (ps->path == NULL) {
+        return false;
+    }
+
+    char dir[MAX_PATH_LEN];
+    config_file_dir(ps->path, dir, sizeof(dir));
+    return snprintf(path, len, "%s/%s", dir, value) < (int)len;
+}
+
+/**
+ * Evaluate the condition of an includeIf section
+ */
+static bool include_condition_holds(const config_parser_t *ps, const char *condition) {
+    bool icase = false;
+    const char *pattern = NULL;
+
+    if (strncmp(condition, "gitdir:", 7) == 0) {
+        pattern = condition + 7;
+    } else if (strncmp(condition, "gitdir/i:", 9) == 0) {
+        pattern = condition + 9;
+        icase = true;
+    } else if (strncmp(condition, "onbranch:", 9) == 0) {
+        if (config_cache.git_dir[0] == '\0') {
+            return false;
+        }
+
+        char head_path[MAX_PATH_LEN + 8];
+        snprintf(head_path, sizeof(head_path), "%s/HEAD", config_cache.git_dir);
+        add_config_source(head_path);
+
+        char line[MAX_PATH_LEN];
+        FILE *fp = fopen(head_path, "r");
+        if (fp == NULL) return false;
+        bool read = (fgets(line, sizeof(line), fp) != NULL);
+        fclose(fp);
+
+        if (!read || strncmp(line, "ref: refs/heads/", 16) != 0) {
+            return false;
+        }
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char branch_pattern[MAX_PATH_LEN];
+        size_t plen = strlen(condition + 9);
+        snprintf(branch_pattern, sizeof(branch_pattern), "%s%s", condition + 9,
+                 (plen > 0 && condition[9 + plen - 1] == '/') ? "**" : "");
+        return config_wildmatch(branch_pattern, line + 16, false);
+    } else if (strncmp(condition, "hasconfig:", 10) == 0) {
+        /* Depends on the whole config; leave it to git */
+        config_cache.native = false;
+        return false;
+    } else {
+        return false;
+    }
+
+    if (config_cache.git_dir[0] == '\0' || *pattern == '\0') {
+        return false;
+    }
+
+    char full[MAX_PATH_LEN * 2];
+    if (strncmp(pattern, "~/", 2) == 0 || pattern[0] == '/') {
+        if (!expand_config_path(ps, pattern, full, sizeof(full))) return false;
+    } else if (strncmp(pattern, "./", 2) == 0) {
+        if (ps->path == NULL) return false;
+        char dir[MAX_PATH_LEN];
+        config_file_dir(ps->path, dir, sizeof(dir));
+        snprintf(full, sizeof(full), "%s/%s", dir, pattern + 2);
+    } else {
+        snprintf(full, sizeof(full), "**/%s", pattern);
+    }
+
+    size_t flen = strlen(full);
+    if (flen > 0 && full[flen - 1] == '/' && flen + 2 < sizeof(full)) {
+        memcpy(full + flen, "**", 3);
+    }
+
+    /* git tries the git dir as given and then its real path */
+    if (config_wildmatch(full, config_cache.git_dir, icase)) {
+        return true;
+    }
+
+    char real[PATH_MAX];
+    return realpath(config_cache.git_dir, real) != NULL && config_wildmatch(full, real, icase);
+}
+
+/**
+ * Follow include.path and includeIf.<condition>.path entries
+ */
+static bool handle_include(const config_parser_t *ps, const char *key, const char *value) {
+    if (value == NULL) {
+        return true;
+    }
+
+    bool include = (strcmp(key, "include.path") == 0);
+
+    if (!include && strncmp(key, "includeif.", 10) == 0) {
+        size_t klen = strlen(key);
+        if (klen > 15 && strcmp(key + klen - 5, ".path") == 0) {
+            char condition[MAX_PATH_LEN];
+            snprintf(condition, sizeof(condition), "%.*s", (int)(klen - 15), key + 10);
+            include = include_condition_holds(ps, condition);
+        }
+    }
+
+    if (!include || value[0] == '\0') {
+        return true;
+    }
+
+    if (ps->depth >= CONFIG_MAX_INCLUDE_DEPTH) {
+        return false;
+    }
+
+    char path[MAX_PATH_LEN];
+    if (!expand_config_path(ps, value, path, sizeof(path))) {
+        return false;
+    }
+    return parse_config_file(path, ps->depth + 1);
+}
+
+/**
+ * Parse a double-quoted subsection name up to the closing ']'
+ */
+static bool parse_subsection(config_parser_t *ps, config_buf_t *var) {
+    int c;
+
+    do {
+        c = next_char(ps);
+    } while (c == ' ' || c == '\t');
+    if (c != '"' || !buf_add(var, '.')) {
+        return false;
+    }
+
+    for (;;) {
+        c = next_char(ps);
+        if (c == '\n' || c == EOF) return false;
+        if (c == '"') break;
+        if (c == '\\') {
+            c = next_char(ps);
+            if (c == '\n' || c == EOF) return false;
+        }
+        if (!buf_add(var, (char)c)) return false;
+    }
+
+    return next_char(ps) == ']';
+}
+
+/**
+ * Parse a "[section]", "[section "sub"]" or "[section.sub]" header
+ */
+static bool parse_section_header(config_parser_t *ps, config_buf_t *var) {
+    var->len = 0;
+
+    for (;;) {
+        int c = next_char(ps);
+        if (c == ']') {
+            return var->len > 0;
+        }
+        if (c == ' ' || c == '\t') {
+            return var->len > 0 && parse_subsection(ps, var);
+        }
+        if (c == EOF || !(isalnum(c) || c == '-' || c == '.')) {
+            return false;
+        }
+        if (!buf_add(var, (char)tolower(c))) {
+            return false;
+        }
+    }
+}
+
+/**
+ * Parse a value after '=' up to the end of the line
+ */
+static bool parse_value(config_parser_t *ps, config_buf_t *value) {
+    bool quoted = false;
+    bool comment = false;
+    int spaces = 0;
+
+    /* An empty value still needs a buffer */
+    value->len = 0;
+    if (!buf_add(value, '\0')) return false;
+    value->len = 0;
+
+    for (;;) {
+        int c = next_char(ps);
+
+        if (c == '\n' || c == EOF) {
+            return !quoted;
+        }
+        if (comment) continue;
+
+        if (isspace(c) && !quoted) {
+            if (value->len > 0) spaces++;
+            continue;
+        }
+        if (!quoted && (c == ';' || c == '#')) {
+            comment = true;
+            continue;
+        }
+
+        for (; spaces > 0; spaces--) {
+            if (!buf_add(value, ' ')) return false;
+        }
+
+        if (c == '\\') {
+            c = next_char(ps);
+            switch (c) {
+                case '\n': continue;
+                case 't': c = '\t'; break;
+                case 'b': c = '\b'; break;
+                case 'n': c = '\n'; break;
+                case '\\':
+                case '"': break;
+                default: return false;
+            }
+            if (!buf_add(value, (char)c)) return false;
+            continue;
+        }
+        if (c == '"') {
+            quoted = !quoted;
+            continue;
+        }
+        if (!buf_add(value, (char)c)) return false;
+    }
+}
+
+/**
+ * Parse config text, adding its entries and following includes
+ */
+static bool parse_config_text(config_parser_t *ps) {
+    config_buf_t section = {0};
+    config_buf_t var = {0};
+    config_buf_t value = {0};
+    bool comment = false;
+    bool ok = true;
+
+    /* A UTF-8 byte order mark is allowed before the first line */
+    if (ps->end - ps->p >= 3 && memcmp(ps->p, "\xef\xbb\xbf", 3) == 0) {
+        ps->p += 3;
+    }
+
+    while (ok) {
+        int c = next_char(ps);
+
+        if (c == EOF) break;
+        if (c == '\n') {
+            comment = false;
+            continue;
+        }
+        if (comment || isspace(c)) continue;
+        if (c == '#' || c == ';') {
+            comment = true;
+            continue;
+        }
+
+        if (c == '[') {
+            ok = parse_section_header(ps, &section);
+            continue;
+        }
+
+        if (!isalpha(c) || section.len == 0) {
+            ok = false;
+            break;
+        }
+
+        /* Key: section prefix plus the lowercased variable name */
+        var.len = 0;
+        for (size_t i = 0; ok && i < section.len; i++) {
+            ok = buf_add(&var, section.buf[i]);
+        }
+        ok = ok && buf_add(&var, '.');
+
+        while (ok && (isalnum(c) || c == '-')) {
+            ok = buf_add(&var, (char)tolower(c));
+            c = next_char(ps);
+        }
+        while (c == ' ' || c == '\t') {
+            c = next_char(ps);
+        }
+        if (!ok) break;
+
+        if (c == '\n' || c == EOF) {
+            ok = add_config_entry(var.buf, NULL);
+        } else if (c == '=') {
+            ok = parse_value(ps, &value) && add_config_entry(var.buf, value.buf) &&
+                 handle_include(ps, var.buf, value.buf);
+        } else {
+            ok = false;
+        }
+    }
+
+    free(section.buf);
+    free(var.buf);
+    free(value.buf);
+    return ok;
+}
+
+/**
+ * Parse one config file; a missing file is not an error
+ */
+static bool parse_config_file(const char *path, int depth) {
+    if (!add_config_source(path)) {
+        return false;
+    }
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return errno == ENOENT || errno == ENOTDIR;
+    }
+
+    struct stat st;
+    if (fstat(fileno(fp), &st) != 0 || S_ISDIR(st.st_mode)) {
+        fclose(fp);
+        return false;
+    }
+
+    char *text = (char*)safe_malloc((size_t)st.st_size + 1);
+    if (text == NULL) {
+        fclose(fp);
+        return false;
+    }
+
+    size_t len = fread(text, 1, (size_t)st.st_size, fp);
+    fclose(fp);
+
+    config_parser_t ps = { text, text + len, path, depth };
+    bool ok = parse_config_text(&ps);
+
+    free(text);
+    return ok;
+}
+
+/**
+ * Canonical form of a lookup key: section and name lowercased,
+ * the subsection kept as written
+ */
+static bool canonical_key(const char *key, char *out, size_t len) {
+    const char *first = strchr(key, '.');
+    const char *last = strrchr(key, '.');
+    if (first == NULL || first == key || last[1] == '\0' || strlen(key) >= len) {
+        return false;
+    }
+
+    for (size_t i = 0; key[i] != '\0'; i++) {
+        bool folded = (key + i < first || key + i > last);
+        out[i] = folded ? (char)tolower((unsigned char)key[i]) : key[i];
+    }
+    out[strlen(key)] = '\0';
+    return true;
+}
+
+/**
+ * Add "git -c"-style settings from GIT_CONFIG_COUNT/KEY_n/VALUE_n
+ */
+static bool add_env_config(void) {
+    const char *env = getenv("GIT_CONFIG_COUNT");
+    if (env == NULL || *env == '\0') {
+        return true;
+    }
+
+    int count = atoi(env);
+    for (int i = 0; i < count; i++) {
+        char name[64];
+        char key[MAX_PATH_LEN];
+
+        snprintf(name, sizeof(name), "GIT_CONFIG_KEY_%d", i);
+        const char *raw_key = getenv(name);
+        snprintf(name, sizeof(name), "GIT_CONFIG_VALUE_%d", i);
+        const char *value = getenv(name);
+
+        if (raw_key == NULL || value == NULL || !canonical_key(raw_key, key, sizeof(key)) ||
+            !add_config_entry(key, value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Cache
+ * ============================================================================ */
+
+static void free_config_cache(void) {
+    for (int i = 0; i < config_cache.count; i++) {
+        free(config_cache.entries[i].key);
+        free(config_cache.entries[i].value);
+    }
+    free(config_cache.entries);
+    free(config_cache.sources);
+    free(config_cache.sorted);
+    memset(&config_cache, 0, sizeof(config_cache));
+}
+
+static int compare_config_entries(const void *a, const void *b) {
+    int ia = *(const int*)a;
+    int ib = *(const int*)b;
+    int cmp = strcmp(config_cache.entries[ia].key, config_cache.entries[ib].key);
+    return (cmp != 0) ? cmp : (ia - ib);
+}
+
+/**
+ * Last value of a key among the entries read so far
+ */
+static const config_entry_t *scan_config_entry(const char *key) {
+    for (int i = config_cache.count - 1; i >= 0; i--) {
+        if (strcmp(config_cache.entries[i].key, key) == 0) {
+            return &config_cache.entries[i];
+        }
+    }
+    return NULL;
+}
+
+static bool config_cache_is_current(const char *git_dir) {
+    if (!config_cache.loaded || strcmp(config_cache.git_dir, git_dir) != 0) {
+        return false;
+    }
+
+    for (int i = 0; i < config_cache.source_count; i++) {
+        const config_source_t *source = &config_cache.sources[i];
+        struct stat st;
+        bool exists = (stat(source->path, &st) == 0);
+
+        if (exists != source->exists ||
+            (exists && (st.st_mtime != source->mtime || st.st_size != source->size))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Load the git config of the current repository, reusing the parsed
+ * copy while none of the files it was read from have changed
+ *
+ * Files are read in git's order: system, global, repository and
+ * worktree, then GIT_CONFIG_COUNT settings; later values win.
+ *
+ * @return gm_error_t GM_ERR_IO_ERROR when the config is malformed or
+ *         needs git to interpret it; callers then spawn git instead
+ */
+gm_error_t git_config_load(void) {
+    char git_dir[MAX_PATH_LEN] = "";
+    if (find_git_dir(git_dir, sizeof(git_dir)) != GM_SUCCESS) {
+        git_dir[0] = '\0';
+    }
+
+    if (config_cache_is_current(git_dir)) {
+        return config_cache.native ? GM_SUCCESS : GM_ERR_IO_ERROR;
+    }
+
+    free_config_cache();
+    snprintf(config_cache.git_dir, sizeof(config_cache.git_dir), "%s", git_dir);
+    config_cache.native = true;
+
+    bool ok = true;
+    char path[MAX_PATH_LEN + 32];
+    const char *env = getenv("GIT_CONFIG_NOSYSTEM");
+
+    if (env == NULL || *env == '\0' || strcmp(env, "0") == 0 || strcasecmp(env, "false") == 0) {
+        env = getenv("GIT_CONFIG_SYSTEM");
+        ok = parse_config_file((env != NULL) ? env : "/etc/gitconfig", 0);
+    }
+
+    env = getenv("GIT_CONFIG_GLOBAL");
+    if (ok && env != NULL) {
+        ok = parse_config_file(env, 0);
+    } else if (ok) {
+        const char *xdg = getenv("XDG_CONFIG_HOME");
+        const char *home = getenv("HOME");
+
+        if (xdg != NULL && *xdg != '\0') {
+            snprintf(path, sizeof(path), "%s/git/config", xdg);
+            ok = parse_config_file(path, 0);
+        } else if (home != NULL) {
+            snprintf(path, sizeof(path), "%s/.config/git/config", home);
+            ok = parse_config_file(path, 0);
+        }
+        if (ok && home != NULL) {
+            snprintf(path, sizeof(path), "%s/.gitconfig", home);
+            ok = parse_config_file(path, 0);
+        }
+    }
+
+    if (ok && git_dir[0] != '\0') {
+        char common_dir[MAX_PATH_LEN];
+        ok = (find_common_dir(common_dir, sizeof(common_dir)) == GM_SUCCESS);
+        if (ok) {
+            snprintf(path, sizeof(path), "%s/config", common_dir);
+            ok = parse_config_file(path, 0);
+        }
+
+        const config_entry_t *worktree = scan_config_entry("extensions.worktreeconfig");
+        if (ok && worktree != NULL &&
+            (worktree->value == NULL || strcasecmp(worktree->value, "true") == 0)) {
+            snprintf(path, sizeof(path), "%s/config.worktree", git_dir);
+            ok = parse_config_file(path, 0);
+        }
+    }
+
+    ok = ok && add_env_config();
+
+    if (ok && config_cache.count > 0) {
+        config_cache.sorted = (int*)safe_malloc((size_t)config_cache.count * sizeof(int));
+        ok = (config_cache.sorted != NULL);
+        if (ok) {
+            for (int i = 0; i < config_cache.count; i++) {
+                config_cache.sorted[i] = i;
+            }
+            qsort(config_cache.sorted, (size_t)config_cache.count, sizeof(int), compare_config_entries);
+        }
+    }
+
+    if (!ok) {
+        config_cache.native = false;
+    }
+    config_cache.loaded = true;
+    return config_cache.native ? GM_SUCCESS : GM_ERR_IO_ERROR;
+}
+
+/**
+ * First position of a key in the sorted index, or -1
+ */
+static int find_config_key(const char *key) {
+    char canonical[MAX_PATH_LEN];
+    if (git_config_load() != GM_SUCCESS || !canonical_key(key, canonical, sizeof(canonical))) {
+        return -1;
+    }
+
+    int lo = 0;
+    int hi = config_cache.count;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(config_cache.entries[config_cache.sorted[mid]].key, canonical) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo < config_cache.count &&
+        strcmp(config_cache.entries[config_cache.sorted[lo]].key, canonical) == 0) {
+        return lo;
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * Lookups
+ * ============================================================================ */
+
+/**
+ * Entry holding the effective value of a key; the last one wins, as in git
+ */
+static const config_entry_t *lookup_config_entry(const char *key) {
+    int pos = find_config_key(key);
+    if (pos < 0) {
+        return NULL;
+    }
+
+    const char *canonical = config_cache.entries[config_cache.sorted[pos]].key;
+    while (pos + 1 < config_cache.count &&
+           strcmp(config_cache.entries[config_cache.sorted[pos + 1]].key, canonical) == 0) {
+        pos++;
+    }
+    return &config_cache.entries[config_cache.sorted[pos]];
+}
+
+/**
+ * Get the value of a config key
+ *
+ * @param key Key such as "remote.origin.url"
+ * @param value Output buffer; a bare key reads as ""
+ * @param len Size of value
+ * @return bool True if the key is set
+ */
+bool git_config_get(const char *key, char *value, size_t len) {
+    if (key == NULL || value == NULL || len == 0) {
+        return false;
+    }
+
+    const config_entry_t *entry = lookup_config_entry(key);
+    if (entry == NULL) {
+        return false;
+    }
+
+    snprintf(value, len, "%s", (entry->value != NULL) ? entry->value : "");
+    return true;
+}
+
+/**
+ * Get every value of a multi-valued key, in config order
+ *
+ * @param key Key such as "remote.origin.fetch"
+ * @param values Output: array of values, freed with free_string_array()
+ * @param count Output: number of values (0 if unset)
+ * @return gm_error_t GM_ERR_IO_ERROR if the config could not be read
+ */
+gm_error_t git_config_get_all(const char *key, char ***values, int *count) {
+    if (key == NULL || values == NULL || count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *values = NULL;
+    *count = 0;
+
+    if (git_config_load() != GM_SUCCESS) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    int pos = find_config_key(key);
+    if (pos < 0) {
+        return GM_SUCCESS;
+    }
+
+    const char *canonical = config_cache.entries[config_cache.sorted[pos]].key;
+    int end = pos;
+    while (end < config_cache.count &&
+           strcmp(config_cache.entries[config_cache.sorted[end]].key, canonical) == 0) {
+        end++;
+    }
+
+    *values = (char**)safe_calloc((size_t)(end - pos) + 1, sizeof(char*));
+    if (*values == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    for (int i = pos; i < end; i++) {
+        const char *value = config_cache.entries[config_cache.sorted[i]].value;
+        (*values)[i - pos] = safe_strdup((value != NULL) ? value : "");
+        if ((*values)[i - pos] == NULL) {
+            free_string_array(*values, i - pos);
+            *values = NULL;
+            return GM_ERR_MEMORY_ALLOC;
+        }
+    }
+
+    *count = end - pos;
+    return GM_SUCCESS;
+}
+
+/**
+ * Get a boolean config key, read the way git reads it
+ *
+ * @param key Config key
+ * @param default_value Returned when the key is unset or not a boolean
+ * @return bool Value of the key
+ */
+bool git_config_get_bool(const char *key, bool default_value) {
+    if (key == NULL) {
+        return default_value;
+    }
+
+    const config_entry_t *entry = lookup_config_entry(key);
+    if (entry == NULL) {
+        return default_value;
+    }
+
+    /* A bare key is true, but an explicit empty value is false */
+    const char *value = entry->value;
+    if (value == NULL) {
+        return true;
+    }
+    if (strcasecmp(value, "true") == 0 || strcasecmp(value, "yes") == 0 ||
+        strcasecmp(value, "on") == 0) {
+        return true;
+    }
+    if (value[0] == '\0' || strcasecmp(value, "false") == 0 || strcasecmp(value, "no") == 0 ||
+        strcasecmp(value, "off") == 0) {
+        return false;
+    }
+
+    char *end = NULL;
+    long number = strtol(value, &end, 10);
+    return (*end == '\0') ? (number != 0) : default_value;
+}
+
+/**
+ * List configured remotes in the order they first appear
+ *
+ * @param remotes Output: array of remote names, freed with free_string_array()
+ * @param count Output: number of remotes
+ * @return gm_error_t GM_ERR_IO_ERROR if the config could not be read
+ */
+gm_error_t git_config_list_remotes(char ***remotes, int *count) {
+    if (remotes == NULL || count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *remotes = NULL;
+    *count = 0;
+
+    if (git_config_load() != GM_SUCCESS) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    *remotes = (char**)safe_calloc(MAX_REMOTES + 1, sizeof(char*));
+    if (*remotes == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    for (int i = 0; i < config_cache.count && *count < MAX_REMOTES; i++) {
+        const char *key = config_cache.entries[i].key;
+        const char *last = strrchr(key, '.');
+        if (strncmp(key, "remote.", 7) != 0 || last == key + 6) {
+            continue;
+        }
+
+        size_t name_len = (size_t)(last - (key + 7));
+        bool seen = false;
+        for (int j = 0; j < *count && !seen; j++) {
+            seen = (strlen((*remotes)[j]) == name_len && strncmp((*remotes)[j], key + 7, name_len) == 0);
+        }
+        if (seen || name_len == 0) {
+            continue;
+        }
+
+        (*remotes)[*count] = strndup(key + 7, name_len);
+        if ((*remotes)[*count] == NULL) {
+            free_string_array(*remotes, *count);
+            *remotes = NULL;
+            *count = 0;
+            return GM_ERR_MEMORY_ALLOC;
+        }
+        (*count)++;
+    }
+
+    return GM_SUCCESS;
+}
+
+/**
+ * Get the fetch URL of a remote, rewritten by url.<base>.insteadOf
+ *
+ * @param remote Remote name
+ * @param url Output buffer
+ * @param len Size of url
+ * @return gm_error_t GM_ERR_REMOTE_NOT_FOUND if the remote has no URL
+ */
+gm_error_t git_config_remote_url(const char *remote, char *url, size_t len) {
+    if (remote == NULL || url == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char key[MAX_BRANCH_NAME + 16];
+    snprintf(key, sizeof(key), "remote.%s.url", remote);
+
+    /* The first url is the one git fetches from */
+    char **urls = NULL;
+    int count = 0;
+    gm_error_t err = git_config_get_all(key, &urls, &count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    if (count == 0) {
+        free(urls);
+        return GM_ERR_REMOTE_NOT_FOUND;
+    }
+
+    /* The longest matching insteadOf prefix wins */
+    const config_entry_t *rewrite = NULL;
+    size_t best = 0;
+    for (int i = 0; i < config_cache.count; i++) {
+        const config_entry_t *entry = &config_cache.entries[i];
+        size_t klen = strlen(entry->key);
+
+        if (entry->value == NULL || strncmp(entry->key, "url.", 4) != 0 || klen <= 14 ||
+            strcmp(entry->key + klen - 10, ".insteadof") != 0) {
+            continue;
+        }
+
+        size_t plen = strlen(entry->value);
+        if (plen > best && strncmp(urls[0], entry->value, plen) == 0) {
+            best = plen;
+            rewrite = entry;
+        }
+    }
+
+    if (rewrite != NULL) {
+        /* The base is the subsection of "url.<base>.insteadof" */
+        snprintf(url, len, "%.*s%s", (int)(strlen(rewrite->key) - 14), rewrite->key + 4,
+                 urls[0] + best);
+    } else {
+        snprintf(url, len, "%s", urls[0]);
+    }
+
+    free_string_array(urls, count);
+    return GM_SUCCESS;
+}
+
+/**
+ * Get the configured upstream of a branch
+ *
+ * @param branch Local branch name
+ * @param remote Output: branch.<name>.remote ("." for a local upstream)
+ * @param remote_len Size of remote
+ * @param merge Output: branch.<name>.merge, a ref on that remote
+ * @param merge_len Size of merge
+ * @return gm_error_t GM_ERR_BRANCH_NOT_FOUND if no upstream is configured
+ */
+gm_error_t git_config_branch_upstream(const char *branch, char *remote, size_t remote_len,
+                                      char *merge, size_t merge_len) {
+    if (branch == NULL || remote == NULL || merge == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    if (git_config_load() != GM_SUCCESS) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    char key[MAX_BRANCH_NAME + 16];
+    snprintf(key, sizeof(key), "branch.%s.remote", branch);
+    if (!git_config_get(key, remote, remote_len) || remote[0] == '\0') {
+        return GM_ERR_BRANCH_NOT_FOUND;
+    }
+
+    snprintf(key, sizeof(key), "branch.%s.merge", branch);
+    if (!git_config_get(key, merge, merge_len) || merge[0] == '\0') {
+        return GM_ERR_BRANCH_NOT_FOUND;
+    }
+
+    return GM_SUCCESS;
+}
+
+/**
+ * Map a ref on a remote to its remote-tracking ref through the
+ * remote's fetch refspecs
+ *
+ * @param remote Remote name
+ * @param ref Ref on the remote, e.g. "refs/heads/main"
+ * @param tracking Output: local ref, e.g. "refs/remotes/origin/main"
+ * @param len Size of tracking
+ * @return gm_error_t GM_ERR_BRANCH_NOT_FOUND if no refspec stores the ref
+ */
+gm_error_t git_config_tracking_ref(const char *remote, const char *ref, char *tracking, size_t len) {
+    if (remote == NULL || ref == NULL || tracking == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char key[MAX_BRANCH_NAME + 16];
+    snprintf(key, sizeof(key), "remote.%s.fetch", remote);
+
+    char **refspecs = NULL;
+    int count = 0;
+    gm_error_t err = git_config_get_all(key, &refspecs, &count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    /* A negative refspec excludes the ref whatever else matches */
+    for (int i = 0; i < count; i++) {
+        if (refspecs[i][0] == '^' && config_wildmatch(refspecs[i] + 1, ref, false)) {
+            free_string_array(refspecs, count);
+            return GM_ERR_BRANCH_NOT_FOUND;
+        }
+    }
+
+    err = GM_ERR_BRANCH_NOT_FOUND;
+    for (int i = 0; i < count && err != GM_SUCCESS; i++) {
+        char *src = refspecs[i];
+        if (*src == '+') src++;
+
+        char *dst = strchr(src, ':');
+        if (*src == '^' || dst == NULL || dst[1] == '\0') continue;
+        *dst++ = '\0';
+
+        char *star = strchr(src, '*');
+        char *dst_star = strchr(dst, '*');
+
+        if (star == NULL) {
+            if (strcmp(src, ref) == 0) {
+                snprintf(tracking, len, "%s", dst);
+                err = GM_SUCCESS;
+            }
+            continue;
+        }
+
+        /* Glob refspec: keep what the star matched */
+        size_t prefix = (size_t)(star - src);
+        size_t suffix = strlen(star + 1);
+        size_t rlen = strlen(ref);
+        if (dst_star == NULL || rlen < prefix + suffix || strncmp(ref, src, prefix) != 0 ||
+            strcmp(ref + rlen - suffix, star + 1) != 0) {
+            continue;
+        }
+
+        snprintf(tracking, len, "%.*s%.*s%s", (int)(dst_star - dst), dst,
+                 (int)(rlen - prefix - suffix), ref + prefix, dst_star + 1);
+        err = GM_SUCCESS;
+    }
+
+    free_string_array(refspecs, count);
+    return err;
+}
+
+/**
+ * Resolve a branch's upstream to the local ref that tracks it,
+ * the way "<branch>@{upstream}" does
+ *
+ * @param branch Local branch name
+ * @param ref Output: full ref name, e.g. "refs/remotes/origin/main"
+ * @param len Size of ref
+ * @return gm_error_t GM_ERR_BRANCH_NOT_FOUND if there is no upstream,
+ *         GM_ERR_IO_ERROR if git must be asked instead
+ */
+gm_error_t resolve_upstream_ref(const char *branch, char *ref, size_t len) {
+    if (branch == NULL || ref == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char remote[MAX_BRANCH_NAME];
+    char merge[MAX_PATH_LEN];
+    gm_error_t err = git_config_branch_upstream(branch, remote, sizeof(remote), merge, sizeof(merge));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    /* "." tracks a local branch directly */
+    if (strcmp(remote, ".") == 0) {
+        snprintf(ref, len, "%s", merge);
+        return GM_SUCCESS;
+    }
+
+    return git_config_tracking_ref(remote, merge, ref, len);
+}
+
+/**
+ * Shorten a full ref name for display, e.g. "refs/remotes/origin/main"
+ * to "origin/main"
+ */
+const char* short_ref_name(const char *ref) {
+    static const char *prefixes[] = { "refs/heads/", "refs/remotes/", "refs/tags/", "refs/" };
+
+    for (size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); i++) {
+        size_t plen = strlen(prefixes[i]);
+        if (strncmp(ref, prefixes[i], plen) == 0 && ref[plen] != '\0') {
+            return ref + plen;
+        }
+    }
+    return ref;
+}
@@ -14,7 +14,12 @@
 #include "raygui.h"
 
 #include "config.h"
+#include <ctype.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <pthread.h>
+#include <stdatomic.h>
+#include <sys/inotify.h>
 
 /* ============================================================================
  * GUI Constants
@@ -26,8 +31,22 @@
 #define GUI_BUTTON_HEIGHT   30
 #define GUI_PANEL_WIDTH     250
 #define GUI_STATUS_HEIGHT   150
-#define GUI_MAX_LOG_LINES   100
+#define GUI_ACTIVITY_LINES  5       /* Operations listed on the main view */
 #define GUI_SCROLL_SPEED    20
+#define GUI_JOB_QUEUE_SIZE  32
+#define GUI_LIST_FONT_SIZE  14
+#define GUI_BRANCH_ROW      28
+#define GUI_COMMIT_ROW      20
+#define GUI_RECENT_COMMITS  10      /* Commits loaded for the Recent Commits panel */
+#define GUI_HISTORY_COMMITS 100000  /* Commits loaded by the History view */
+#define GUI_DIFF_ROW        18
+#define GUI_DIFF_TAB_WIDTH  4       /* Spaces per tab in the Diff view */
+
+/* On-demand redraw */
+#define GUI_INPUT_POLL_MS       25      /* Input polling interval while idle */
+#define GUI_ACTIVE_SECONDS      0.25    /* Full frame rate after the last input */
+#define GUI_KEEPALIVE_SECONDS   2.0     /* Redraw at least this often */
+#define GUI_REPO_QUIET_SECONDS  0.5     /* Ignore .git changes this soon after a job */
 
 /* Colors */
 #define COLOR_BG            (Color){ 30, 30, 35, 255 }
@@ -38,6 +57,10 @@
 #define COLOR_ERROR         (Color){ 220, 80, 80, 255 }
 #define COLOR_TEXT          (Color){ 220, 220, 225, 255 }
 #define COLOR_TEXT_DIM      (Color){ 150, 150, 160, 255 }
+#define COLOR_DIFF_ADD      (Color){ 40, 70, 48, 255 }
+#define COLOR_DIFF_DEL      (Color){ 80, 40, 44, 255 }
+#define COLOR_DIFF_ADD_SPAN (Color){ 60, 125, 75, 255 }
+#define COLOR_DIFF_DEL_SPAN (Color){ 145, 55, 62, 255 }
 
 /* ============================================================================
  * GUI State
@@ -53,7 +76,116 @@ typedef enum {
     GUI_VIEW_SETTINGS
 } gui_view_t;
 
+/* Immutable list of strings, shared between snapshots by reference count */
+typedef struct {
+    atomic_int refs;
+    unsigned id;                /* Distinguishes lists for render-side caches */
+    int count;
+    int current;                /* Row of the current branch, or -1 */
+    char **items;               /* Point into text */
+    char *text;
+} gui_list_t;
+
+/* One row of the Diff view: a file header, a hunk header or a diff line */
+typedef struct {
+    char kind;                  /* 'F' file, '@' hunk, or the line's ' ', '+' or '-' */
+    int index;                  /* Into patch.files, patch.hunks or patch.lines */
+    int old_line;               /* Line numbers for the gutter, 0 for none */
+    int new_line;
+    int span_start;             /* Changed bytes of a paired -/+ line */
+    int span_length;            /* 0: no intra-line highlight */
+} gui_diff_row_t;
+
+/* Parsed diff shown by the Diff view, shared between snapshots like a list */
+typedef struct {
+    atomic_int refs;
+    unsigned id;
+    bool staged;
+    patch_set_t patch;
+    gui_diff_row_t *rows;
+    int row_count;
+    int additions;
+    int deletions;
+} gui_diff_t;
+
+/*
+ * Everything the render thread draws from the repository. The worker
+ * builds a new snapshot after each job; a published snapshot is never
+ * modified, so drawing needs no lock.
+ */
 typedef struct {
+    bool is_repo;
+    char repo_path[MAX_PATH_LEN];
+    char current_branch[MAX_BRANCH_NAME];
+    int staged_count;
+    int modified_count;
+    int untracked_count;
+    gui_list_t *branches;
+    gui_list_t *commits;
+    gui_diff_t *diff;           /* NULL until the Diff view is opened */
+    
+    /* Outcome of the last job: a new status_seq is a new message */
+    unsigned status_seq;
+    char status_message[256];
+    Color status_color;
+    unsigned commit_seq;        /* Bumped by each successful commit */
+} gui_snapshot_t;
+
+typedef enum {
+    GUI_JOB_REFRESH = 0,
+    GUI_JOB_REFRESH_BRANCHES,
+    GUI_JOB_REFRESH_COMMITS,
+    GUI_JOB_REFRESH_DIFF,
+    GUI_JOB_STAGE_ALL,
+    GUI_JOB_COMMIT,
+    GUI_JOB_STAGE_ALL_COMMIT,
+    GUI_JOB_SWITCH_BRANCH,
+    GUI_JOB_PUSH,
+    GUI_JOB_PULL,
+    GUI_JOB_FETCH,
+    GUI_JOB_STASH,
+    GUI_JOB_STASH_POP
+} gui_job_kind_t;
+
+typedef struct {
+    gui_job_kind_t kind;
+    int count;                  /* Commits to list (also after an operation), or GUI_DIFF_* */
+    char arg[512];              /* Commit message or branch name */
+} gui_job_t;
+
+/* Changes a GUI_JOB_REFRESH_DIFF loads (nonzero, so a queued refresh can be retargeted) */
+enum {
+    GUI_DIFF_UNSTAGED = 1,
+    GUI_DIFF_STAGED = 2
+};
+
+/* Scroll position and text measurements of one on-screen list */
+typedef struct {
+    float scroll;
+    unsigned list_id;           /* gui_list_t.id the caches belong to */
+    int *widths;                /* MeasureText of each row, -1 until drawn */
+    int *fit;                   /* Characters that fit fit_width with "...", or -1 */
+    int fit_width;
+} gui_list_view_t;
+
+/* Where one Diff view row is cut off and highlighted, in pixels */
+typedef struct {
+    int fit;                    /* Bytes of the row text that fit, -1 until laid out */
+    int span_x;
+    int span_width;
+} gui_diff_layout_t;
+
+/* Scroll position, glyph cache and row layouts of the Diff view */
+typedef struct {
+    float scroll;
+    unsigned diff_id;           /* gui_diff_t.id the layouts belong to */
+    gui_diff_layout_t *layouts;
+    int layout_width;
+    int advance[128];           /* MeasureText advance of each ASCII glyph */
+    bool glyphs_measured;
+} gui_diff_view_t;
+
+typedef struct gui_state {
     /* Window state */
     int width;
     int height;
@@ -63,52 +195,71 @@ typedef struct {
     /* Current view */
     gui_view_t current_view;
     
-    /* Repository state */
-    char repo_path[MAX_PATH_LEN];
-    char current_branch[MAX_BRANCH_NAME];
-    bool is_repo;
-    int staged_count;
-    int modified_count;
-    int untracked_count;
-    int commits_ahead;
-    int commits_behind;
+    /* Repository state, as of the last snapshot swapped in */
+    const gui_snapshot_t *view;
     
     /* UI state */
-    float scroll_offset;
+    gui_list_view_t branch_list;
+    gui_list_view_t commit_list;
     int selected_branch;
     int selected_commit;
     char input_text[512];
     bool input_active;
     char status_message[256];
     Color status_color;
-    float status_timer;
-    
-    /* Branches list */
-    char **branches;
-    int branch_count;
-    
-    /* Commits list */
-    char **commits;
-    int commit_count;
+    double status_until;        /* GetTime() the status message expires */
+    unsigned seen_status_seq;
+    unsigned seen_commit_seq;
     
-    /* Diff content */
-    char *diff_content;
+    /* Diff view */
+    gui_diff_view_t diff_view;
+    bool diff_staged;
     
-    /* Log output */
-    char log_lines[GUI_MAX_LOG_LINES][256];
-    int log_line_count;
-    float log_scroll;
+    /* Activity feed: the worker pushes, the main view reads */
+    activity_ring_t *activity;
     
     /* Configuration */
     config_t *config;
     
-    /* Threading */
-    pthread_mutex_t state_lock;
+    /* Job queue: the lock guards the ring only, never a git command */
+    pthread_t worker;
+    bool worker_started;
+    bool worker_stop;
+    pthread_mutex_t job_lock;
+    pthread_cond_t job_ready;
+    gui_job_t jobs[GUI_JOB_QUEUE_SIZE];
+    int job_head;
+    int job_count;
+    atomic_int jobs_pending;    /* Queued or running */
+    
+    /*
+     * Snapshot double buffer. The worker publishes into back; the render
+     * thread swaps it into front and hands the old front back through
+     * retired for the worker to free.
+     */
+    _Atomic(gui_snapshot_t*) back;
+    _Atomic(gui_snapshot_t*) retired;
+    gui_snapshot_t *front;
+    
+    /* Worker-only: the model the next snapshot is built from */
+    gui_snapshot_t model;
+    
     volatile bool refresh_needed;
+    
+    /* On-demand redraw */
+    bool redraw_on_demand;
+    int wake_pipe[2];           /* Worker writes a byte after publishing */
+    int repo_watch;             /* inotify on .git, or -1 */
+    double active_until;        /* Draw every frame until then */
+    double last_frame;
+    double last_swap;
 } gui_state_t;
 
 static gui_state_t *g_gui = NULL;
 
+/* Shown until the worker publishes its first snapshot */
+static const gui_snapshot_t GUI_EMPTY_SNAPSHOT = { .current_branch = "Loading..." };
+
 /* ============================================================================
  * GUI Initialization
  * ============================================================================ */
@@ -129,7 +280,17 @@ gui_state_t* gui_init(config_t *config) {
     gui->width = config != NULL ? config->gui.window_width : 1200;
     gui->height = config != NULL ? config->gui.window_height : 800;
     
-    pthread_mutex_init(&gui->state_lock, NULL);
+    gui->view = &GUI_EMPTY_SNAPSHOT;
+    pthread_mutex_init(&gui->job_lock, NULL);
+    pthread_cond_init(&gui->job_ready, NULL);
+    
+    gui->redraw_on_demand = config != NULL ? config->gui.redraw_on_demand : true;
+    gui->repo_watch = -1;
+    if (pipe2(gui->wake_pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+        gui->wake_pipe[0] = gui->wake_pipe[1] = -1;
+    }
+    
+    gui->activity = activity_open("gui");
     
     g_gui = gui;
     
@@ -142,28 +303,21 @@ gui_state_t* gui_init(config_t *config) {
 void gui_cleanup(gui_state_t *gui) {
     if (gui == NULL) return;
     
-    /* Free branch list */
-    if (gui->branches != NULL) {
-        for (int i = 0; i < gui->branch_count; i++) {
-            free(gui->branches[i]);
-        }
-        free(gui->branches);
-    }
+    /* Free list view caches */
+    free(gui->branch_list.widths);
+    free(gui->branch_list.fit);
+    free(gui->commit_list.widths);
+    free(gui->commit_list.fit);
+    free(gui->diff_view.layouts);
     
-    /* Free commits list */
-    if (gui->commits != NULL) {
-        for (int i = 0; i < gui->commit_count; i++) {
-            free(gui->commits[i]);
-        }
-        free(gui->commits);
-    }
+    pthread_cond_destroy(&gui->job_ready);
     
-    /* Free diff content */
-    if (gui->diff_content != NULL) {
-        free(gui->diff_content);
+    if (gui->wake_pipe[0] >= 0) {
+        close(gui->wake_pipe[0]);
+        close(gui->wake_pipe[1]);
     }
-    
-    pthread_mutex_destroy(&gui->state_lock);
+    pthread_mutex_destroy(&gui->job_lock);
+    activity_close(gui->activity);
     
     free(gui);
     
@@ -182,160 +336,906 @@ void gui_cleanup(gui_state_t *gui) {
 static void gui_set_status(gui_state_t *gui, const char *message, Color color) {
     if (gui == NULL) return;
     
-    strncpy(gui->status_message, message, sizeof(gui->status_message) - 1);
+    snprintf(gui->status_message, sizeof(gui->status_message), "%s", message);
     gui->status_color = color;
-    gui->status_timer = 5.0f; /* Show for 5 seconds */
+    gui->status_until = GetTime() + 5.0; /* Show for 5 seconds */
+}
+
+/* ============================================================================
+ * View Model
+ * ============================================================================ */
+
+/* Distinguishes lists and diffs for render-side caches */
+static unsigned gui_model_id(void) {
+    static atomic_uint next_id = 1;
+    return atomic_fetch_add(&next_id, 1);
 }
 
 /**
- * Add log line
+ * Build a list from newline-separated text, taking ownership of it
+ * 
+ * @param text Heap buffer; split in place
+ * @return gui_list_t* List with one reference, or NULL
  */
-static void gui_log(gui_state_t *gui, const char *message) {
-    if (gui == NULL) return;
+static gui_list_t* gui_list_from_text(char *text) {
+    gui_list_t *list = calloc(1, sizeof(gui_list_t));
+    if (list == NULL) {
+        free(text);
+        return NULL;
+    }
+    
+    int lines = 0;
+    for (char *p = text; *p; p++) {
+        if (*p == '\n') lines++;
+    }
     
-    /* Shift lines up if full */
-    if (gui->log_line_count >= GUI_MAX_LOG_LINES) {
-        for (int i = 0; i < GUI_MAX_LOG_LINES - 1; i++) {
-            strcpy(gui->log_lines[i], gui->log_lines[i + 1]);
+    list->items = calloc((size_t)lines + 1, sizeof(char*));
+    if (list->items == NULL) {
+        free(text);
+        free(list);
+        return NULL;
+    }
+    
+    char *line = text;
+    while (*line != '\0') {
+        char *end = strchr(line, '\n');
+        if (end != NULL) *end = '\0';
+        if (*line != '\0') {
+            list->items[list->count++] = line;
         }
-        gui->log_line_count = GUI_MAX_LOG_LINES - 1;
+        if (end == NULL) break;
+        line = end + 1;
     }
     
-    strncpy(gui->log_lines[gui->log_line_count], message, 255);
-    gui->log_line_count++;
+    list->text = text;
+    list->current = -1;
+    list->id = gui_model_id();
+    atomic_init(&list->refs, 1);
+    return list;
 }
 
-/* ============================================================================
- * Repository Refresh
- * ============================================================================ */
+static gui_list_t* gui_list_retain(gui_list_t *list) {
+    if (list != NULL) {
+        atomic_fetch_add_explicit(&list->refs, 1, memory_order_relaxed);
+    }
+    return list;
+}
+
+static void gui_list_release(gui_list_t *list) {
+    if (list == NULL) return;
+    
+    if (atomic_fetch_sub_explicit(&list->refs, 1, memory_order_acq_rel) == 1) {
+        free(list->items);
+        free(list->text);
+        free(list);
+    }
+}
+
+static int gui_list_count(const gui_list_t *list) {
+    return list != NULL ? list->count : 0;
+}
+
+static gui_diff_t* gui_diff_retain(gui_diff_t *diff) {
+    if (diff != NULL) {
+        atomic_fetch_add_explicit(&diff->refs, 1, memory_order_relaxed);
+    }
+    return diff;
+}
+
+static void gui_diff_release(gui_diff_t *diff) {
+    if (diff == NULL) return;
+    
+    if (atomic_fetch_sub_explicit(&diff->refs, 1, memory_order_acq_rel) == 1) {
+        free_patch_set(&diff->patch);
+        free(diff->rows);
+        free(diff);
+    }
+}
 
 /**
- * Refresh repository status
+ * Highlight the changed middle of a deleted line and the added line
+ * that replaces it
+ * 
+ * Lines with nothing in common keep only their row color.
  */
-static void gui_refresh_repo(gui_state_t *gui) {
-    if (gui == NULL) return;
+static void gui_diff_pair_spans(const patch_set_t *patch, gui_diff_row_t *del, gui_diff_row_t *add) {
+    const patch_line_t *old_line = &patch->lines[del->index];
+    const patch_line_t *new_line = &patch->lines[add->index];
+    const char *a = patch->text + old_line->offset;
+    const char *b = patch->text + new_line->offset;
+    size_t shorter = old_line->length < new_line->length ? old_line->length : new_line->length;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    
+    while (prefix < shorter && a[prefix] == b[prefix]) {
+        prefix++;
+    }
+    while (suffix < shorter - prefix &&
+           a[old_line->length - 1 - suffix] == b[new_line->length - 1 - suffix]) {
+        suffix++;
+    }
+    if (prefix + suffix == 0) return;
+    
+    del->span_start = (int)prefix;
+    del->span_length = (int)(old_line->length - prefix - suffix);
+    add->span_start = (int)prefix;
+    add->span_length = (int)(new_line->length - prefix - suffix);
+}
+
+/**
+ * Build the Diff view's rows from a parsed patch, taking ownership of it
+ * 
+ * Runs on the worker: line numbers and intra-line spans are worked out
+ * once here, not per frame. Within a hunk, the n-th line of a run of
+ * deletions is paired with the n-th line of the additions that follow.
+ * 
+ * @return gui_diff_t* Diff with one reference, or NULL
+ */
+static gui_diff_t* gui_diff_from_patch(patch_set_t *patch, bool staged) {
+    gui_diff_t *diff = calloc(1, sizeof(gui_diff_t));
+    int total = patch->file_count + patch->hunk_count + patch->line_count;
+    
+    if (diff == NULL || (total > 0 && (diff->rows = calloc((size_t)total, sizeof(gui_diff_row_t))) == NULL)) {
+        free(diff);
+        free_patch_set(patch);
+        return NULL;
+    }
     
-    pthread_mutex_lock(&gui->state_lock);
+    diff->patch = *patch;
+    diff->staged = staged;
     
-    /* Check if git repo */
+    for (int f = 0; f < patch->file_count; f++) {
+        const patch_file_t *file = &patch->files[f];
+        
+        diff->rows[diff->row_count++] = (gui_diff_row_t){ .kind = 'F', .index = f };
+        diff->additions += file->additions;
+        diff->deletions += file->deletions;
+        
+        for (int h = file->first_hunk; h < file->first_hunk + file->hunk_count; h++) {
+            const patch_hunk_t *hunk = &patch->hunks[h];
+            int old_no = hunk->old_start;
+            int new_no = hunk->new_start;
+            int del_first = 0, del_count = 0, add_count = 0;
+            
+            diff->rows[diff->row_count++] = (gui_diff_row_t){ .kind = '@', .index = h };
+            
+            for (int l = hunk->first_line; l < hunk->first_line + hunk->line_count; l++) {
+                int r = diff->row_count++;
+                gui_diff_row_t *row = &diff->rows[r];
+                
+                row->kind = patch->lines[l].kind;
+                row->index = l;
+                
+                if (row->kind == '-') {
+                    if (add_count > 0 || del_count == 0) {
+                        del_first = r;
+                        del_count = add_count = 0;
+                    }
+                    del_count++;
+                    row->old_line = old_no++;
+                } else if (row->kind == '+') {
+                    if (add_count < del_count) {
+                        gui_diff_pair_spans(patch, &diff->rows[del_first + add_count], row);
+                    }
+                    add_count++;
+                    row->new_line = new_no++;
+                } else {
+                    del_count = add_count = 0;
+                    row->old_line = old_no++;
+                    row->new_line = new_no++;
+                }
+            }
+        }
+    }
+    
+    memset(patch, 0, sizeof(*patch));
+    diff->id = gui_model_id();
+    atomic_init(&diff->refs, 1);
+    return diff;
+}
+
+static int gui_diff_count(const gui_diff_t *diff) {
+    return diff != NULL ? diff->row_count : 0;
+}
+
+static void gui_snapshot_free(gui_snapshot_t *snapshot) {
+    if (snapshot == NULL) return;
+    
+    gui_list_release(snapshot->branches);
+    gui_list_release(snapshot->commits);
+    gui_diff_release(snapshot->diff);
+    free(snapshot);
+}
+
+/* ============================================================================
+ * Background Worker
+ * ============================================================================ */
+
+/*
+ * Git commands and core operations run on one worker thread. After each
+ * job it copies its model into a new snapshot (lists are shared, not
+ * copied) and publishes it; the render thread picks the newest one up
+ * with an atomic exchange at the top of a frame and never waits on a
+ * subprocess.
+ */
+
+static void gui_model_set_status(gui_snapshot_t *model, const char *message, Color color) {
+    snprintf(model->status_message, sizeof(model->status_message), "%s", message);
+    model->status_color = color;
+    model->status_seq++;
+}
+
+/**
+ * Refresh branch, path and file counts
+ */
+static void gui_model_refresh_repo(gui_snapshot_t *model) {
     bool is_repo = false;
     check_git_repository(NULL, &is_repo);
-    gui->is_repo = is_repo;
+    model->is_repo = is_repo;
     
     if (!is_repo) {
-        strcpy(gui->current_branch, "Not a repository");
-        pthread_mutex_unlock(&gui->state_lock);
+        snprintf(model->current_branch, sizeof(model->current_branch), "Not a repository");
+        model->staged_count = model->modified_count = model->untracked_count = 0;
         return;
     }
     
-    /* Get current branch */
-    get_current_branch(gui->current_branch, sizeof(gui->current_branch));
-    
-    /* Get repo path */
-    getcwd(gui->repo_path, sizeof(gui->repo_path));
+    if (get_current_branch(model->current_branch, sizeof(model->current_branch)) != GM_SUCCESS) {
+        model->current_branch[0] = '\0';
+    }
+    if (getcwd(model->repo_path, sizeof(model->repo_path)) == NULL) {
+        model->repo_path[0] = '\0';
+    }
     
-    /* Get status counts */
     repo_status_t *status = get_repo_status();
     if (status != NULL) {
-        gui->staged_count = status->staged_files_count;
-        gui->modified_count = status->modified_files_count;
-        gui->untracked_count = status->untracked_files_count;
+        model->staged_count = status->staged_files_count;
+        model->modified_count = status->modified_files_count;
+        model->untracked_count = status->untracked_files_count;
         free_repo_status(status);
     }
+}
+
+/**
+ * Refresh the local branch list
+ */
+static void gui_model_refresh_branches(gui_snapshot_t *model) {
+    branch_info_t *branches = NULL;
+    int count = 0;
+    
+    if (list_branches(&branches, &count, false) != GM_SUCCESS) {
+        return;
+    }
     
-    gui->refresh_needed = false;
+    size_t size = 1;
+    for (int i = 0; i < count; i++) {
+        size += strlen(branches[i].name) + 1;
+    }
     
-    pthread_mutex_unlock(&gui->state_lock);
+    char *text = malloc(size);
+    if (text == NULL) {
+        free(branches);
+        return;
+    }
+    
+    size_t pos = 0;
+    int current = -1;
+    for (int i = 0; i < count; i++) {
+        size_t len = strlen(branches[i].name);
+        memcpy(text + pos, branches[i].name, len);
+        text[pos + len] = '\n';
+        pos += len + 1;
+        if (branches[i].is_current) {
+            current = i;
+        }
+    }
+    text[pos] = '\0';
+    free(branches);
+    
+    gui_list_t *list = gui_list_from_text(text);
+    if (list != NULL) {
+        list->current = current;
+        gui_list_release(model->branches);
+        model->branches = list;
+    }
 }
 
 /**
- * Refresh branch list
+ * Refresh the one-line commit list
  */
-static void gui_refresh_branches(gui_state_t *gui) {
-    if (gui == NULL) return;
+static void gui_model_refresh_commits(gui_snapshot_t *model, int count) {
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "log --oneline -n %d", count);
     
-    pthread_mutex_lock(&gui->state_lock);
+    /* Uncapped read: the History view lists up to GUI_HISTORY_COMMITS */
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
     
-    /* Free old list */
-    if (gui->branches != NULL) {
-        for (int i = 0; i < gui->branch_count; i++) {
-            free(gui->branches[i]);
+    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
+        gui_list_t *list = gui_list_from_text(result->output);
+        result->output = NULL;
+        if (list != NULL) {
+            gui_list_release(model->commits);
+            model->commits = list;
         }
-        free(gui->branches);
-        gui->branches = NULL;
-        gui->branch_count = 0;
     }
     
-    /* Get new list */
-    branch_info_t *branches = NULL;
-    int count = 0;
+    if (result != NULL) {
+        free_cmd_result(result);
+    }
+}
+
+/**
+ * Load the unstaged or staged diff
+ */
+static void gui_model_refresh_diff(gui_snapshot_t *model, bool staged) {
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "diff%s --no-color --no-ext-diff --no-renames",
+             staged ? " --cached" : "");
     
-    if (list_branches(&branches, &count, false) == GM_SUCCESS && count > 0) {
-        gui->branches = calloc(count, sizeof(char*));
-        if (gui->branches != NULL) {
-            for (int i = 0; i < count; i++) {
-                gui->branches[i] = strdup(branches[i].name);
-                if (branches[i].is_current) {
-                    gui->selected_branch = i;
-                }
+    /* Uncapped read: diffs can be megabytes */
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
+    if (result == NULL) return;
+    
+    if (result->exit_code == 0 && result->output != NULL) {
+        patch_set_t patch;
+        char *text = result->output;
+        result->output = NULL;
+        
+        if (parse_patch(text, result->output_len, &patch) == GM_SUCCESS) {
+            gui_diff_t *diff = gui_diff_from_patch(&patch, staged);
+            if (diff != NULL) {
+                gui_diff_release(model->diff);
+                model->diff = diff;
             }
-            gui->branch_count = count;
         }
-        free(branches);
+    } else {
+        gui_model_set_status(model, "Failed to read diff", COLOR_ERROR);
     }
     
-    pthread_mutex_unlock(&gui->state_lock);
+    free_cmd_result(result);
 }
 
 /**
- * Refresh commit list
+ * Report an operation's outcome and refresh what it may have changed
  */
-static void gui_refresh_commits(gui_state_t *gui, int count) {
-    if (gui == NULL) return;
+static void gui_model_finish(gui_state_t *gui, gm_error_t err,
+                             const char *success, const char *failure) {
+    gui_model_set_status(&gui->model, err == GM_SUCCESS ? success : failure,
+                         err == GM_SUCCESS ? COLOR_SUCCESS : COLOR_ERROR);
+    gui_model_refresh_repo(&gui->model);
+    
+    /* Keep a loaded diff current */
+    if (gui->model.diff != NULL) {
+        gui_model_refresh_diff(&gui->model, gui->model.diff->staged);
+    }
+}
+
+/* Operation names in the activity feed, by gui_job_kind_t */
+static const char *GUI_JOB_NAMES[] = {
+    "refresh", "refresh-branches", "refresh-commits", "refresh-diff",
+    "stage-all", "commit", "stage-all-commit", "switch-branch",
+    "push", "pull", "fetch", "stash", "stash-pop"
+};
+
+/**
+ * Run one job against the model
+ * 
+ * @return gm_error_t Outcome of the operation (refreshes always succeed)
+ */
+static gm_error_t gui_worker_run_job(gui_state_t *gui, const gui_job_t *job) {
+    gui_snapshot_t *model = &gui->model;
+    gm_error_t err = GM_SUCCESS;
+    
+    switch (job->kind) {
+        case GUI_JOB_REFRESH:
+            gui_model_refresh_repo(model);
+            break;
+            
+        case GUI_JOB_REFRESH_BRANCHES:
+            gui_model_refresh_branches(model);
+            break;
+            
+        case GUI_JOB_REFRESH_COMMITS:
+            gui_model_refresh_commits(model, job->count);
+            break;
+            
+        case GUI_JOB_REFRESH_DIFF:
+            gui_model_refresh_diff(model, job->count == GUI_DIFF_STAGED);
+            break;
+            
+        case GUI_JOB_STAGE_ALL:
+            err = stage_all_changes();
+            gui_model_finish(gui, err, "Staged all changes", "Stage failed");
+            break;
+            
+        case GUI_JOB_STAGE_ALL_COMMIT:
+        case GUI_JOB_COMMIT:
+            if (job->kind == GUI_JOB_STAGE_ALL_COMMIT) {
+                stage_all_changes();
+            }
+            err = commit_changes(job->arg);
+            if (err == GM_SUCCESS) {
+                model->commit_seq++;
+                gui_model_refresh_commits(model, job->count);
+            }
+            gui_model_finish(gui, err, job->kind == GUI_JOB_COMMIT ?
+                             "Committed successfully" : "Staged and committed",
+                             "Commit failed");
+            break;
+            
+        case GUI_JOB_SWITCH_BRANCH:
+            err = switch_branch(job->arg);
+            if (err == GM_SUCCESS) {
+                gui_model_refresh_branches(model);
+                gui_model_refresh_commits(model, job->count);
+            }
+            gui_model_finish(gui, err, "Switched branch", "Switch failed");
+            break;
+            
+        case GUI_JOB_PUSH:
+            err = push_branch(NULL, NULL, false);
+            gui_model_finish(gui, err, "Pushed successfully", "Push failed");
+            break;
+            
+        case GUI_JOB_PULL:
+            err = pull_branch(NULL, NULL);
+            if (err == GM_SUCCESS) {
+                gui_model_refresh_commits(model, job->count);
+            }
+            gui_model_finish(gui, err, "Pulled successfully", "Pull failed");
+            break;
+            
+        case GUI_JOB_FETCH:
+            err = fetch_all();
+            gui_model_finish(gui, err, "Fetched all remotes", "Fetch failed");
+            break;
+            
+        case GUI_JOB_STASH:
+            err = stash_changes(NULL);
+            gui_model_finish(gui, err, "Stashed changes", "Stash failed");
+            break;
+            
+        case GUI_JOB_STASH_POP:
+            err = pop_stash();
+            gui_model_finish(gui, err, "Popped stash", "Stash pop failed");
+            break;
+    }
+    
+    return err;
+}
+
+/**
+ * Publish the model as a new snapshot
+ * 
+ * A snapshot the render thread has not picked up yet is replaced and
+ * freed here; it was never visible.
+ */
+static void gui_worker_publish(gui_state_t *gui) {
+    gui_snapshot_t *snapshot = malloc(sizeof(gui_snapshot_t));
+    if (snapshot == NULL) return;
     
-    pthread_mutex_lock(&gui->state_lock);
+    *snapshot = gui->model;
+    gui_list_retain(snapshot->branches);
+    gui_list_retain(snapshot->commits);
+    gui_diff_retain(snapshot->diff);
+    
+    gui_snapshot_free(atomic_exchange_explicit(&gui->back, snapshot, memory_order_acq_rel));
+}
+
+/**
+ * Tell the render loop a snapshot was published so it draws a frame
+ */
+static void gui_wake(gui_state_t *gui) {
+    if (gui->wake_pipe[1] >= 0) {
+        ssize_t n = write(gui->wake_pipe[1], "", 1);
+        (void)n;    /* A full pipe already holds a wakeup */
+    }
+}
+
+static void* gui_worker_main(void *arg) {
+    gui_state_t *gui = (gui_state_t*)arg;
     
-    /* Free old list */
-    if (gui->commits != NULL) {
-        for (int i = 0; i < gui->commit_count; i++) {
-            free(gui->commits[i]);
+    for (;;) {
+        pthread_mutex_lock(&gui->job_lock);
+        while (gui->job_count == 0 && !gui->worker_stop) {
+            pthread_cond_wait(&gui->job_ready, &gui->job_lock);
+        }
+        if (gui->worker_stop) {
+            pthread_mutex_unlock(&gui->job_lock);
+            break;
         }
-        free(gui->commits);
-        gui->commits = NULL;
-        gui->commit_count = 0;
+        gui_job_t job = gui->jobs[gui->job_head];
+        gui->job_head = (gui->job_head + 1) % GUI_JOB_QUEUE_SIZE;
+        gui->job_count--;
+        pthread_mutex_unlock(&gui->job_lock);
+        
+        /* Free the snapshot the render thread has let go of */
+        gui_snapshot_free(atomic_exchange_explicit(&gui->retired, NULL, memory_order_acq_rel));
+        
+        /* The worker is the ring's only producer; push before the wakeup */
+        double started = activity_clock_ms();
+        gm_error_t err = gui_worker_run_job(gui, &job);
+        activity_push(gui->activity, GUI_JOB_NAMES[job.kind], gui->model.repo_path,
+                      activity_clock_ms() - started, err, job.arg);
+        
+        gui_worker_publish(gui);
+        gui_wake(gui);
+        atomic_fetch_sub(&gui->jobs_pending, 1);
     }
     
-    /* Get commits */
-    char cmd[128];
-    snprintf(cmd, sizeof(cmd), "log --oneline -n %d", count);
-    cmd_result_t *result = exec_git_command(cmd);
+    return NULL;
+}
+
+/**
+ * Queue a job for the worker
+ * 
+ * Only takes the queue lock, which the worker never holds across a git
+ * command. A refresh already waiting in the queue is not queued twice.
+ * Commit refreshes and operations given a count of 0 reload as many
+ * commits as the current view shows, so only History pays for a long log.
+ * 
+ * @return bool False if the queue is full
+ */
+static bool gui_submit(gui_state_t *gui, gui_job_kind_t kind, int count, const char *arg) {
+    bool queued = true;
     
-    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-        /* Count lines */
-        int lines = 0;
-        for (char *p = result->output; *p; p++) {
-            if (*p == '\n') lines++;
-        }
-        if (lines > 0) {
-            gui->commits = calloc(lines, sizeof(char*));
-            if (gui->commits != NULL) {
-                char *line = strtok(result->output, "\n");
-                int i = 0;
-                while (line != NULL && i < lines) {
-                    gui->commits[i] = strdup(line);
-                    i++;
-                    line = strtok(NULL, "\n");
+    if (count == 0 && (kind == GUI_JOB_REFRESH_COMMITS || kind > GUI_JOB_REFRESH_DIFF)) {
+        count = (gui->current_view == GUI_VIEW_HISTORY) ? GUI_HISTORY_COMMITS : GUI_RECENT_COMMITS;
+    }
+    
+    pthread_mutex_lock(&gui->job_lock);
+    
+    if (kind <= GUI_JOB_REFRESH_DIFF) {
+        for (int i = 0; i < gui->job_count; i++) {
+            gui_job_t *pending = &gui->jobs[(gui->job_head + i) % GUI_JOB_QUEUE_SIZE];
+            if (pending->kind == kind) {
+                if (count > 0) {
+                    pending->count = count;
                 }
-                gui->commit_count = i;
+                pthread_mutex_unlock(&gui->job_lock);
+                return true;
             }
         }
     }
     
-    if (result != NULL) {
-        free_cmd_result(result);
+    if (gui->job_count >= GUI_JOB_QUEUE_SIZE) {
+        queued = false;
+    } else {
+        gui_job_t *job = &gui->jobs[(gui->job_head + gui->job_count) % GUI_JOB_QUEUE_SIZE];
+        job->kind = kind;
+        job->count = count;
+        snprintf(job->arg, sizeof(job->arg), "%s", arg != NULL ? arg : "");
+        gui->job_count++;
+        atomic_fetch_add(&gui->jobs_pending, 1);
+        pthread_cond_signal(&gui->job_ready);
+    }
+    
+    pthread_mutex_unlock(&gui->job_lock);
+    
+    if (!queued) {
+        gui_set_status(gui, "Busy: too many pending operations", COLOR_WARNING);
+    }
+    return queued;
+}
+
+/**
+ * Swap in the newest snapshot, if the worker published one
+ * 
+ * Called once per frame before drawing; never blocks.
+ */
+static void gui_swap_snapshot(gui_state_t *gui) {
+    gui_snapshot_t *next = atomic_exchange_explicit(&gui->back, NULL, memory_order_acq_rel);
+    if (next == NULL) return;
+    
+    gui_snapshot_t *old = gui->front;
+    gui->front = next;
+    gui->view = next;
+    gui->last_swap = GetTime();
+    
+    /* Normally the worker frees it; if it has not collected the last one yet, do it here */
+    gui_snapshot_free(atomic_exchange_explicit(&gui->retired, old, memory_order_acq_rel));
+    
+    if (next->status_seq != gui->seen_status_seq) {
+        gui->seen_status_seq = next->status_seq;
+        gui_set_status(gui, next->status_message, next->status_color);
+    }
+    if (next->commit_seq != gui->seen_commit_seq) {
+        gui->seen_commit_seq = next->commit_seq;
+        gui->input_text[0] = '\0';
+    }
+}
+
+static void gui_worker_start(gui_state_t *gui) {
+    gui->worker_started = (pthread_create(&gui->worker, NULL, gui_worker_main, gui) == 0);
+}
+
+/**
+ * Stop the worker after its current job and free every snapshot
+ */
+static void gui_worker_stop(gui_state_t *gui) {
+    if (gui->worker_started) {
+        pthread_mutex_lock(&gui->job_lock);
+        gui->worker_stop = true;
+        pthread_cond_signal(&gui->job_ready);
+        pthread_mutex_unlock(&gui->job_lock);
+        pthread_join(gui->worker, NULL);
+        gui->worker_started = false;
     }
     
-    pthread_mutex_unlock(&gui->state_lock);
+    gui_snapshot_free(atomic_exchange(&gui->back, NULL));
+    gui_snapshot_free(atomic_exchange(&gui->retired, NULL));
+    gui_snapshot_free(gui->front);
+    gui->front = NULL;
+    gui->view = &GUI_EMPTY_SNAPSHOT;
+    
+    gui_list_release(gui->model.branches);
+    gui_list_release(gui->model.commits);
+    gui_diff_release(gui->model.diff);
+    gui->model.branches = NULL;
+    gui->model.commits = NULL;
+    gui->model.diff = NULL;
+}
+
+/* ============================================================================
+ * List Views
+ * ============================================================================ */
+
+/*
+ * Lists are virtualized: only the rows inside the visible window are laid
+ * out and drawn, so the cost of a frame depends on the window height, not
+ * on the number of branches or commits. Text widths are measured once per
+ * row and kept until the worker publishes a different list.
+ */
+
+/**
+ * Point the view at the list currently shown, resetting its caches when
+ * the list changed
+ */
+static void gui_list_view_sync(gui_list_view_t *lv, const gui_list_t *list) {
+    unsigned id = list != NULL ? list->id : 0;
+    
+    if (lv->list_id == id && (lv->widths != NULL || gui_list_count(list) == 0)) {
+        return;
+    }
+    
+    free(lv->widths);
+    free(lv->fit);
+    lv->widths = NULL;
+    lv->fit = NULL;
+    lv->list_id = id;
+    lv->fit_width = -1;
+    
+    int count = gui_list_count(list);
+    if (count > 0) {
+        /* All bits set is -1: not measured yet */
+        lv->widths = malloc((size_t)count * sizeof(int));
+        lv->fit = malloc((size_t)count * sizeof(int));
+        if (lv->widths == NULL || lv->fit == NULL) {
+            free(lv->widths);
+            free(lv->fit);
+            lv->widths = NULL;
+            lv->fit = NULL;
+            return;
+        }
+        memset(lv->widths, 0xff, (size_t)count * sizeof(int));
+        memset(lv->fit, 0xff, (size_t)count * sizeof(int));
+    }
+}
+
+/**
+ * Scroll a view with the mouse wheel and work out the visible rows
+ * 
+ * @param scroll Scroll offset of the view, in pixels
+ * @param bounds Area the rows are drawn in
+ * @param count Number of rows
+ * @param row_height Height of one row
+ * @param first Output: first visible row
+ * @param last Output: one past the last visible row
+ */
+static void gui_list_view_range(float *scroll, Rectangle bounds, int count,
+                                float row_height, int *first, int *last) {
+    if (CheckCollisionPointRec(GetMousePosition(), bounds)) {
+        *scroll -= GetMouseWheelMove() * GUI_SCROLL_SPEED;
+    }
+    
+    /* Clamp every frame: the list may have shrunk since the last one */
+    float max_scroll = count * row_height - bounds.height;
+    if (max_scroll < 0) max_scroll = 0;
+    if (*scroll > max_scroll) *scroll = max_scroll;
+    if (*scroll < 0) *scroll = 0;
+    
+    *first = (int)(*scroll / row_height);
+    *last = (int)((*scroll + bounds.height) / row_height) + 1;
+    if (*last > count) *last = count;
+}
+
+/**
+ * Text of a row, shortened with "..." if it is wider than max_width
+ * 
+ * @param buf Scratch space for a shortened copy
+ * @return const char* Text to draw (the row itself or buf)
+ */
+static const char* gui_list_view_text(gui_list_view_t *lv, const gui_list_t *list, int row,
+                                      int max_width, char *buf, size_t buflen) {
+    const char *text = list->items[row];
+    
+    if (lv->widths == NULL) {
+        return text;
+    }
+    if (lv->widths[row] < 0) {
+        lv->widths[row] = MeasureText(text, GUI_LIST_FONT_SIZE);
+    }
+    if (lv->widths[row] <= max_width) {
+        return text;
+    }
+    
+    if (lv->fit_width != max_width) {
+        memset(lv->fit, 0xff, (size_t)list->count * sizeof(int));
+        lv->fit_width = max_width;
+    }
+    
+    size_t len = strlen(text);
+    if (len + 4 > buflen) {
+        len = buflen - 4;
+    }
+    
+    if (lv->fit[row] < 0) {
+        /* Longest prefix that still fits with the ellipsis */
+        int lo = 0;
+        int hi = (int)len;
+        while (lo < hi) {
+            int mid = (lo + hi + 1) / 2;
+            memcpy(buf, text, (size_t)mid);
+            memcpy(buf + mid, "...", 4);
+            if (MeasureText(buf, GUI_LIST_FONT_SIZE) <= max_width) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        lv->fit[row] = lo;
+    }
+    
+    memcpy(buf, text, (size_t)lv->fit[row]);
+    memcpy(buf + lv->fit[row], "...", 4);
+    return buf;
+}
+
+/* ============================================================================
+ * Diff Layout
+ * ============================================================================ */
+
+/*
+ * The Diff view draws from the parsed patch in the snapshot. Glyph
+ * advances are measured once; a row is laid out from them the first time
+ * it is visible (how many bytes fit, where its highlight span starts and
+ * ends) and the layout is kept until the diff or the width changes. A
+ * frame only copies and draws the visible rows, so scrolling a
+ * multi-megabyte diff never measures text.
+ */
+
+/**
+ * Character drawn for a byte of diff text: '?' for non-ASCII, 0 to skip
+ */
+static char gui_diff_glyph(unsigned char c) {
+    if (c >= 0x80) return '?';
+    if (c < 0x20 || c == 0x7f) return 0;
+    return (char)c;
+}
+
+static void gui_diff_view_measure_glyphs(gui_diff_view_t *dv) {
+    if (dv->glyphs_measured) return;
+    
+    for (int c = 0; c < 128; c++) {
+        char one[2] = { gui_diff_glyph((unsigned char)c), '\0' };
+        char two[3] = { one[0], one[0], '\0' };
+        
+        /* The second copy adds exactly one advance, spacing included */
+        dv->advance[c] = one[0] != 0 ?
+            MeasureText(two, GUI_LIST_FONT_SIZE) - MeasureText(one, GUI_LIST_FONT_SIZE) : 0;
+    }
+    dv->glyphs_measured = true;
+}
+
+/**
+ * Point the view at the diff currently shown, dropping layouts made for
+ * another diff or width
+ */
+static void gui_diff_view_sync(gui_diff_view_t *dv, const gui_diff_t *diff, int width) {
+    unsigned id = diff != NULL ? diff->id : 0;
+    int count = gui_diff_count(diff);
+    
+    if (dv->diff_id == id && dv->layout_width == width &&
+        (dv->layouts != NULL || count == 0)) {
+        return;
+    }
+    
+    if (dv->diff_id != id) {
+        free(dv->layouts);
+        dv->layouts = count > 0 ? malloc((size_t)count * sizeof(gui_diff_layout_t)) : NULL;
+        dv->diff_id = id;
+    }
+    dv->layout_width = width;
+    
+    if (dv->layouts != NULL) {
+        /* All bits set: fit is -1, not laid out yet */
+        memset(dv->layouts, 0xff, (size_t)count * sizeof(gui_diff_layout_t));
+    }
+}
+
+/**
+ * Text of a row: a line or hunk header in the patch, or a file header in buf
+ */
+static const char* gui_diff_row_text(const gui_diff_t *diff, const gui_diff_row_t *row,
+                                     char *buf, size_t buflen, size_t *len) {
+    const patch_set_t *patch = &diff->patch;
+    
+    if (row->kind == 'F') {
+        const patch_file_t *file = &patch->files[row->index];
+        int n = snprintf(buf, buflen, "%.*s%s  +%d -%d",
+                         (int)file->path_length, patch->text + file->path_offset,
+                         file->is_binary ? " (binary)" :
+                         file->is_new ? " (new)" : file->is_deleted ? " (deleted)" : "",
+                         file->additions, file->deletions);
+        *len = n < 0 ? 0 : ((size_t)n < buflen ? (size_t)n : buflen - 1);
+        return buf;
+    }
+    if (row->kind == '@') {
+        *len = patch->hunks[row->index].header_length;
+        return patch->text + patch->hunks[row->index].header_offset;
+    }
+    *len = patch->lines[row->index].length;
+    return patch->text + patch->lines[row->index].offset;
+}
+
+static int gui_diff_advance(const gui_diff_view_t *dv, unsigned char c) {
+    if (c == '\t') return dv->advance[' '] * GUI_DIFF_TAB_WIDTH;
+    return dv->advance[(unsigned char)gui_diff_glyph(c) & 0x7f];
+}
+
+/**
+ * Lay out one row within max_width pixels using the glyph cache
+ */
+static void gui_diff_layout_row(const gui_diff_view_t *dv, const gui_diff_row_t *row,
+                                const char *text, size_t len, int max_width,
+                                gui_diff_layout_t *layout) {
+    size_t span_end = (size_t)row->span_start + (size_t)row->span_length;
+    int x = 0;
+    size_t i;
+    
+    layout->span_x = 0;
+    layout->span_width = 0;
+    
+    for (i = 0; i < len; i++) {
+        int w = gui_diff_advance(dv, (unsigned char)text[i]);
+        if (x + w > max_width) break;
+        
+        if (row->span_length > 0 && i == (size_t)row->span_start) layout->span_x = x;
+        x += w;
+        if (row->span_length > 0 && i + 1 == span_end) layout->span_width = x - layout->span_x;
+    }
+    
+    /* A span running past the edge is highlighted up to it */
+    if (row->span_length > 0 && (size_t)row->span_start < i && span_end > i) {
+        layout->span_width = x - layout->span_x;
+    }
+    layout->fit = (int)i;
+}
+
+/**
+ * Copy the part of a row that fits into buf for DrawText
+ */
+static void gui_diff_copy_text(const char *text, int fit, char *buf, size_t buflen) {
+    size_t out = 0;
+    
+    for (int i = 0; i < fit && out + GUI_DIFF_TAB_WIDTH < buflen; i++) {
+        if (text[i] == '\t') {
+            for (int t = 0; t < GUI_DIFF_TAB_WIDTH; t++) buf[out++] = ' ';
+        } else {
+            char c = gui_diff_glyph((unsigned char)text[i]);
+            if (c != 0) buf[out++] = c;
+        }
+    }
+    buf[out] = '\0';
 }
 
 /* ============================================================================
@@ -365,7 +1265,7 @@ static void draw_sidebar(gui_state_t *gui, Rectangle bounds) {
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING, y, button_width, GUI_BUTTON_HEIGHT },
                   "Branches")) {
         gui->current_view = GUI_VIEW_BRANCHES;
-        gui_refresh_branches(gui);
+        gui_submit(gui, GUI_JOB_REFRESH_BRANCHES, 0, NULL);
     }
     y += GUI_BUTTON_HEIGHT + 5;
     
@@ -378,7 +1278,7 @@ static void draw_sidebar(gui_state_t *gui, Rectangle bounds) {
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING, y, button_width, GUI_BUTTON_HEIGHT },
                   "History")) {
         gui->current_view = GUI_VIEW_HISTORY;
-        gui_refresh_commits(gui, 50);
+        gui_submit(gui, GUI_JOB_REFRESH_COMMITS, GUI_HISTORY_COMMITS, NULL);
     }
     y += GUI_BUTTON_HEIGHT + 5;
     
@@ -391,6 +1291,8 @@ static void draw_sidebar(gui_state_t *gui, Rectangle bounds) {
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING, y, button_width, GUI_BUTTON_HEIGHT },
                   "Diff")) {
         gui->current_view = GUI_VIEW_DIFF;
+        gui_submit(gui, GUI_JOB_REFRESH_DIFF,
+                   gui->diff_staged ? GUI_DIFF_STAGED : GUI_DIFF_UNSTAGED, NULL);
     }
     y += GUI_BUTTON_HEIGHT + 5;
     
@@ -409,12 +1311,12 @@ static void draw_sidebar(gui_state_t *gui, Rectangle bounds) {
     
     DrawText("Current Branch:", bounds.x + GUI_PADDING, y, 12, COLOR_TEXT_DIM);
     y += 16;
-    DrawText(gui->current_branch, bounds.x + GUI_PADDING, y, 14, COLOR_SUCCESS);
+    DrawText(gui->view->current_branch, bounds.x + GUI_PADDING, y, 14, COLOR_SUCCESS);
     y += 20;
     
     char status_text[64];
     snprintf(status_text, sizeof(status_text), "S:%d M:%d U:%d", 
-             gui->staged_count, gui->modified_count, gui->untracked_count);
+             gui->view->staged_count, gui->view->modified_count, gui->view->untracked_count);
     DrawText(status_text, bounds.x + GUI_PADDING, y, 12, COLOR_TEXT);
 }
 
@@ -422,6 +1324,7 @@ static void draw_sidebar(gui_state_t *gui, Rectangle bounds) {
  * Draw main view
  */
 static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
+    const gui_snapshot_t *view = gui->view;
     float y = bounds.y + GUI_PADDING;
     
     /* Quick actions */
@@ -432,9 +1335,7 @@ static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
     float x = bounds.x + GUI_PADDING;
     
     if (GuiButton((Rectangle){ x, y, button_width, GUI_BUTTON_HEIGHT }, "Stage All")) {
-        stage_all_changes();
-        gui_set_status(gui, "Staged all changes", COLOR_SUCCESS);
-        gui->refresh_needed = true;
+        gui_submit(gui, GUI_JOB_STAGE_ALL, 0, NULL);
     }
     x += button_width + 10;
     
@@ -444,21 +1345,12 @@ static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
     x += button_width + 10;
     
     if (GuiButton((Rectangle){ x, y, button_width, GUI_BUTTON_HEIGHT }, "Push")) {
-        if (push_branch(NULL, NULL, false) == GM_SUCCESS) {
-            gui_set_status(gui, "Pushed successfully", COLOR_SUCCESS);
-        } else {
-            gui_set_status(gui, "Push failed", COLOR_ERROR);
-        }
+        gui_submit(gui, GUI_JOB_PUSH, 0, NULL);
     }
     x += button_width + 10;
     
     if (GuiButton((Rectangle){ x, y, button_width, GUI_BUTTON_HEIGHT }, "Pull")) {
-        if (pull_branch(NULL, NULL) == GM_SUCCESS) {
-            gui_set_status(gui, "Pulled successfully", COLOR_SUCCESS);
-            gui->refresh_needed = true;
-        } else {
-            gui_set_status(gui, "Pull failed", COLOR_ERROR);
-        }
+        gui_submit(gui, GUI_JOB_PULL, 0, NULL);
     }
     
     y += GUI_BUTTON_HEIGHT + 30;
@@ -475,31 +1367,31 @@ static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
     float status_x = bounds.x + GUI_PADDING * 2;
     
     DrawText("Path:", status_x, status_y, 14, COLOR_TEXT_DIM);
-    DrawText(gui->repo_path, status_x + 80, status_y, 14, COLOR_TEXT);
+    DrawText(view->repo_path, status_x + 80, status_y, 14, COLOR_TEXT);
     status_y += 20;
     
     DrawText("Branch:", status_x, status_y, 14, COLOR_TEXT_DIM);
-    DrawText(gui->current_branch, status_x + 80, status_y, 14, COLOR_SUCCESS);
+    DrawText(view->current_branch, status_x + 80, status_y, 14, COLOR_SUCCESS);
     status_y += 20;
     
     char count_text[64];
     
     DrawText("Staged:", status_x, status_y, 14, COLOR_TEXT_DIM);
-    snprintf(count_text, sizeof(count_text), "%d file(s)", gui->staged_count);
+    snprintf(count_text, sizeof(count_text), "%d file(s)", view->staged_count);
     DrawText(count_text, status_x + 80, status_y, 14, 
-             gui->staged_count > 0 ? COLOR_SUCCESS : COLOR_TEXT);
+             view->staged_count > 0 ? COLOR_SUCCESS : COLOR_TEXT);
     status_y += 20;
     
     DrawText("Modified:", status_x, status_y, 14, COLOR_TEXT_DIM);
-    snprintf(count_text, sizeof(count_text), "%d file(s)", gui->modified_count);
+    snprintf(count_text, sizeof(count_text), "%d file(s)", view->modified_count);
     DrawText(count_text, status_x + 80, status_y, 14,
-             gui->modified_count > 0 ? COLOR_WARNING : COLOR_TEXT);
+             view->modified_count > 0 ? COLOR_WARNING : COLOR_TEXT);
     status_y += 20;
     
     DrawText("Untracked:", status_x, status_y, 14, COLOR_TEXT_DIM);
-    snprintf(count_text, sizeof(count_text), "%d file(s)", gui->untracked_count);
+    snprintf(count_text, sizeof(count_text), "%d file(s)", view->untracked_count);
     DrawText(count_text, status_x + 80, status_y, 14,
-             gui->untracked_count > 0 ? COLOR_TEXT_DIM : COLOR_TEXT);
+             view->untracked_count > 0 ? COLOR_TEXT_DIM : COLOR_TEXT);
     
     y += GUI_STATUS_HEIGHT + 20;
     
@@ -507,9 +1399,42 @@ static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
     DrawText("Recent Commits", bounds.x + GUI_PADDING, y, 20, COLOR_TEXT);
     y += 30;
     
-    for (int i = 0; i < gui->commit_count && i < 5; i++) {
-        DrawText(gui->commits[i], bounds.x + GUI_PADDING, y, 14, COLOR_TEXT);
+    for (int i = 0; i < gui_list_count(view->commits) && i < 5; i++) {
+        DrawText(view->commits->items[i], bounds.x + GUI_PADDING, y, 14, COLOR_TEXT);
+        y += 18;
+    }
+    
+    y += 20;
+    
+    /* Recent operations, straight from the worker's ring; refreshes are left out */
+    DrawText("Recent Activity", bounds.x + GUI_PADDING, y, 20, COLOR_TEXT);
+    y += 30;
+    
+    activity_event_t events[32];
+    int count = activity_read(gui->activity, events, 32);
+    int shown = 0;
+    
+    for (int i = count - 1; i >= 0 && shown < GUI_ACTIVITY_LINES; i--) {
+        const activity_event_t *event = &events[i];
+        if (strncmp(event->op, "refresh", 7) == 0) continue;
+        
+        time_t when = (time_t)(event->timestamp_ms / 1000);
+        struct tm tm;
+        char clock_text[16];
+        char line[160];
+        
+        localtime_r(&when, &tm);
+        strftime(clock_text, sizeof(clock_text), "%H:%M:%S", &tm);
+        snprintf(line, sizeof(line), "%s  %-16s %6u ms  %s", clock_text, event->op,
+                 (unsigned)event->duration_ms,
+                 event->result == GM_SUCCESS ? "ok" : gm_error_string(event->result));
+        DrawText(line, bounds.x + GUI_PADDING, y, 14,
+                 event->result == GM_SUCCESS ? COLOR_TEXT : COLOR_ERROR);
         y += 18;
+        shown++;
+    }
+    if (shown == 0) {
+        DrawText("No operations yet", bounds.x + GUI_PADDING, y, 14, COLOR_TEXT_DIM);
     }
 }
 
@@ -517,6 +1442,7 @@ static void draw_main_view(gui_state_t *gui, Rectangle bounds) {
  * Draw branches view
  */
 static void draw_branches_view(gui_state_t *gui, Rectangle bounds) {
+    const gui_list_t *branches = gui->view->branches;
     float y = bounds.y + GUI_PADDING;
     
     DrawText("Branches", bounds.x + GUI_PADDING, y, 20, COLOR_TEXT);
@@ -532,7 +1458,7 @@ static void draw_branches_view(gui_state_t *gui, Rectangle bounds) {
     
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING + button_width + 10, y, 
                                button_width, GUI_BUTTON_HEIGHT }, "Refresh")) {
-        gui_refresh_branches(gui);
+        gui_submit(gui, GUI_JOB_REFRESH_BRANCHES, 0, NULL);
     }
     
     y += GUI_BUTTON_HEIGHT + 20;
@@ -544,33 +1470,43 @@ static void draw_branches_view(gui_state_t *gui, Rectangle bounds) {
     
     DrawRectangleRec(list_bounds, COLOR_PANEL);
     
-    float list_y = y + 5;
-    for (int i = 0; i < gui->branch_count; i++) {
-        bool is_current = (i == gui->selected_branch);
-        bool is_selected = (strcmp(gui->branches[i], gui->current_branch) == 0);
+    Rectangle rows = { list_bounds.x + 5, list_bounds.y + 5,
+                       list_bounds.width - 10, list_bounds.height - 10 };
+    int first, last;
+    char elided[MAX_BRANCH_NAME + 4];
+    
+    gui_list_view_sync(&gui->branch_list, branches);
+    gui_list_view_range(&gui->branch_list.scroll, rows, gui_list_count(branches),
+                        GUI_BRANCH_ROW, &first, &last);
+    
+    BeginScissorMode((int)rows.x, (int)rows.y, (int)rows.width, (int)rows.height);
+    
+    for (int i = first; i < last; i++) {
+        bool is_selected = (i == branches->current);
         
-        Rectangle item = { list_bounds.x + 5, list_y, list_bounds.width - 10, 25 };
+        Rectangle item = { rows.x, rows.y + i * GUI_BRANCH_ROW - gui->branch_list.scroll,
+                           rows.width, 25 };
         
         if (is_selected) {
             DrawRectangleRec(item, COLOR_ACCENT);
         }
         
-        DrawText(gui->branches[i], item.x + 10, item.y + 5, 14,
+        /* Leave room for the Switch button */
+        const char *name = gui_list_view_text(&gui->branch_list, branches, i,
+                                              (int)item.width - 100, elided, sizeof(elided));
+        DrawText(name, item.x + 10, item.y + 5, GUI_LIST_FONT_SIZE,
                 is_selected ? COLOR_BG : COLOR_TEXT);
         
         /* Switch button */
         if (!is_selected) {
             Rectangle switch_btn = { item.x + item.width - 80, item.y + 2, 70, 21 };
             if (GuiButton(switch_btn, "Switch")) {
-                switch_branch(gui->branches[i]);
-                gui_set_status(gui, "Switched branch", COLOR_SUCCESS);
-                gui->refresh_needed = true;
+                gui_submit(gui, GUI_JOB_SWITCH_BRANCH, 0, branches->items[i]);
             }
         }
-        
-        list_y += 28;
-        if (list_y > list_bounds.y + list_bounds.height - 30) break;
     }
+    
+    EndScissorMode();
 }
 
 /**
@@ -607,13 +1543,7 @@ static void draw_commits_view(gui_state_t *gui, Rectangle bounds) {
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING, y, button_width, GUI_BUTTON_HEIGHT },
                   "Commit")) {
         if (strlen(gui->input_text) > 0) {
-            if (commit_changes(gui->input_text) == GM_SUCCESS) {
-                gui_set_status(gui, "Committed successfully", COLOR_SUCCESS);
-                gui->input_text[0] = '\0';
-                gui->refresh_needed = true;
-            } else {
-                gui_set_status(gui, "Commit failed", COLOR_ERROR);
-            }
+            gui_submit(gui, GUI_JOB_COMMIT, 0, gui->input_text);
         } else {
             gui_set_status(gui, "Enter a commit message", COLOR_WARNING);
         }
@@ -622,14 +1552,7 @@ static void draw_commits_view(gui_state_t *gui, Rectangle bounds) {
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING + button_width + 10, y,
                                button_width, GUI_BUTTON_HEIGHT }, "Stage All & Commit")) {
         if (strlen(gui->input_text) > 0) {
-            stage_all_changes();
-            if (commit_changes(gui->input_text) == GM_SUCCESS) {
-                gui_set_status(gui, "Staged and committed", COLOR_SUCCESS);
-                gui->input_text[0] = '\0';
-                gui->refresh_needed = true;
-            } else {
-                gui_set_status(gui, "Commit failed", COLOR_ERROR);
-            }
+            gui_submit(gui, GUI_JOB_STAGE_ALL_COMMIT, 0, gui->input_text);
         } else {
             gui_set_status(gui, "Enter a commit message", COLOR_WARNING);
         }
@@ -640,13 +1563,14 @@ static void draw_commits_view(gui_state_t *gui, Rectangle bounds) {
  * Draw history view
  */
 static void draw_history_view(gui_state_t *gui, Rectangle bounds) {
+    const gui_list_t *commits = gui->view->commits;
     float y = bounds.y + GUI_PADDING;
     
     DrawText("Commit History", bounds.x + GUI_PADDING, y, 20, COLOR_TEXT);
     y += 35;
     
     if (GuiButton((Rectangle){ bounds.x + GUI_PADDING, y, 100, GUI_BUTTON_HEIGHT }, "Refresh")) {
-        gui_refresh_commits(gui, 50);
+        gui_submit(gui, GUI_JOB_REFRESH_COMMITS, GUI_HISTORY_COMMITS, NULL);
     }
     
     y += GUI_BUTTON_HEIGHT + 10;
@@ -658,27 +1582,128 @@ static void draw_history_view(gui_state_t *gui, Rectangle bounds) {
     
     DrawRectangleRec(list_bounds, COLOR_PANEL);
     
-    float list_y = y + 5 - gui->scroll_offset;
+    Rectangle rows = { list_bounds.x + 10, list_bounds.y + 5,
+                       list_bounds.width - 20, list_bounds.height - 10 };
+    int first, last;
+    char elided[512];
     
-    for (int i = 0; i < gui->commit_count; i++) {
-        if (list_y > list_bounds.y + list_bounds.height) break;
-        if (list_y > list_bounds.y - 20) {
-            DrawText(gui->commits[i], list_bounds.x + 10, list_y, 14, COLOR_TEXT);
-        }
-        list_y += 20;
+    gui_list_view_sync(&gui->commit_list, commits);
+    gui_list_view_range(&gui->commit_list.scroll, rows, gui_list_count(commits),
+                        GUI_COMMIT_ROW, &first, &last);
+    
+    BeginScissorMode((int)rows.x, (int)rows.y, (int)rows.width, (int)rows.height);
+    
+    for (int i = first; i < last; i++) {
+        const char *line = gui_list_view_text(&gui->commit_list, commits, i,
+                                              (int)rows.width, elided, sizeof(elided));
+        DrawText(line, rows.x, rows.y + i * GUI_COMMIT_ROW - gui->commit_list.scroll,
+                 GUI_LIST_FONT_SIZE, COLOR_TEXT);
     }
     
-    /* Scrolling */
-    if (CheckCollisionPointRec(GetMousePosition(), list_bounds)) {
-        float wheel = GetMouseWheelMove();
-        gui->scroll_offset -= wheel * GUI_SCROLL_SPEED;
+    EndScissorMode();
+}
+
+/**
+ * Draw the diff view
+ */
+static void draw_diff_view(gui_state_t *gui, Rectangle bounds) {
+    const gui_diff_t *diff = gui->view->diff;
+    gui_diff_view_t *dv = &gui->diff_view;
+    float y = bounds.y + GUI_PADDING;
+    float x = bounds.x + GUI_PADDING;
+    char text[1024];
+    
+    DrawText(gui->diff_staged ? "Staged Changes" : "Unstaged Changes", x, y, 20, COLOR_TEXT);
+    y += 35;
+    
+    if (GuiButton((Rectangle){ x, y, 100, GUI_BUTTON_HEIGHT }, "Unstaged")) {
+        gui->diff_staged = false;
+        gui_submit(gui, GUI_JOB_REFRESH_DIFF, GUI_DIFF_UNSTAGED, NULL);
+    }
+    if (GuiButton((Rectangle){ x + 110, y, 100, GUI_BUTTON_HEIGHT }, "Staged")) {
+        gui->diff_staged = true;
+        gui_submit(gui, GUI_JOB_REFRESH_DIFF, GUI_DIFF_STAGED, NULL);
+    }
+    if (GuiButton((Rectangle){ x + 220, y, 100, GUI_BUTTON_HEIGHT }, "Refresh")) {
+        gui_submit(gui, GUI_JOB_REFRESH_DIFF,
+                   gui->diff_staged ? GUI_DIFF_STAGED : GUI_DIFF_UNSTAGED, NULL);
+    }
+    if (diff != NULL) {
+        snprintf(text, sizeof(text), "%d files  +%d -%d",
+                 diff->patch.file_count, diff->additions, diff->deletions);
+        DrawText(text, x + 340, y + 8, 14, COLOR_TEXT_DIM);
+    }
+    
+    y += GUI_BUTTON_HEIGHT + 10;
+    
+    Rectangle list_bounds = { x, y, bounds.width - GUI_PADDING * 2,
+                              bounds.height - y - GUI_PADDING };
+    DrawRectangleRec(list_bounds, COLOR_PANEL);
+    
+    if (gui_diff_count(diff) == 0) {
+        DrawText(diff == NULL ? "Loading..." : "No changes",
+                 list_bounds.x + 10, list_bounds.y + 10, 14, COLOR_TEXT_DIM);
+        return;
+    }
+    
+    Rectangle rows = { list_bounds.x + 5, list_bounds.y + 5,
+                       list_bounds.width - 10, list_bounds.height - 10 };
+    int first, last;
+    
+    gui_diff_view_measure_glyphs(dv);
+    gui_diff_view_sync(dv, diff, (int)rows.width);
+    gui_list_view_range(&dv->scroll, rows, diff->row_count, GUI_DIFF_ROW, &first, &last);
+    
+    /* "12345 12345 +" */
+    int gutter = dv->advance['0'] * 13 + 10;
+    
+    BeginScissorMode((int)rows.x, (int)rows.y, (int)rows.width, (int)rows.height);
+    
+    for (int i = first; i < last; i++) {
+        const gui_diff_row_t *row = &diff->rows[i];
+        bool is_line = (row->kind != 'F' && row->kind != '@');
+        float row_y = rows.y + i * GUI_DIFF_ROW - dv->scroll;
+        float text_x = rows.x + (is_line ? gutter : 0);
+        size_t len;
+        const char *line = gui_diff_row_text(diff, row, text, sizeof(text), &len);
         
-        float max_scroll = (gui->commit_count * 20) - list_bounds.height + 20;
-        if (max_scroll < 0) max_scroll = 0;
+        if (row->kind == '+' || row->kind == '-') {
+            DrawRectangleRec((Rectangle){ rows.x, row_y, rows.width, GUI_DIFF_ROW },
+                             row->kind == '+' ? COLOR_DIFF_ADD : COLOR_DIFF_DEL);
+        } else if (row->kind == 'F') {
+            DrawRectangleRec((Rectangle){ rows.x, row_y, rows.width, GUI_DIFF_ROW }, COLOR_BG);
+        }
         
-        if (gui->scroll_offset < 0) gui->scroll_offset = 0;
-        if (gui->scroll_offset > max_scroll) gui->scroll_offset = max_scroll;
+        gui_diff_layout_t scratch = { -1, 0, 0 };
+        gui_diff_layout_t *layout = dv->layouts != NULL ? &dv->layouts[i] : &scratch;
+        if (layout->fit < 0) {
+            gui_diff_layout_row(dv, row, line, len, (int)(rows.x + rows.width - text_x), layout);
+        }
+        
+        if (layout->span_width > 0) {
+            DrawRectangleRec((Rectangle){ text_x + layout->span_x, row_y,
+                                          layout->span_width, GUI_DIFF_ROW },
+                             row->kind == '+' ? COLOR_DIFF_ADD_SPAN : COLOR_DIFF_DEL_SPAN);
+        }
+        
+        if (is_line) {
+            char gutter_text[32];
+            char old_no[12] = "", new_no[12] = "";
+            if (row->old_line > 0) snprintf(old_no, sizeof(old_no), "%d", row->old_line);
+            if (row->new_line > 0) snprintf(new_no, sizeof(new_no), "%d", row->new_line);
+            snprintf(gutter_text, sizeof(gutter_text), "%5s %5s %c", old_no, new_no, row->kind);
+            DrawText(gutter_text, rows.x, row_y + 2, GUI_LIST_FONT_SIZE, COLOR_TEXT_DIM);
+        }
+        
+        /* The row text may already be in text; copy through a second buffer */
+        char drawn[1024];
+        gui_diff_copy_text(line, layout->fit, drawn, sizeof(drawn));
+        DrawText(drawn, text_x, row_y + 2, GUI_LIST_FONT_SIZE,
+                 row->kind == 'F' ? COLOR_ACCENT :
+                 row->kind == '@' ? COLOR_TEXT_DIM : COLOR_TEXT);
     }
+    
+    EndScissorMode();
 }
 
 /**
@@ -687,10 +1712,290 @@ static void draw_history_view(gui_state_t *gui, Rectangle bounds) {
 static void draw_status_bar(gui_state_t *gui, Rectangle bounds) {
     DrawRectangleRec(bounds, COLOR_PANEL);
     
-    if (gui->status_timer > 0) {
+    if (GetTime() < gui->status_until) {
         DrawText(gui->status_message, bounds.x + GUI_PADDING, 
                 bounds.y + (bounds.height - 14) / 2, 14, gui->status_color);
     }
+    
+    if (atomic_load(&gui->jobs_pending) > 0) {
+        DrawText("Working...", bounds.x + bounds.width - 100,
+                 bounds.y + (bounds.height - 14) / 2, 14, COLOR_TEXT_DIM);
+    }
+}
+
+/* ============================================================================
+ * Keyboard Shortcuts
+ * ============================================================================ */
+
+/**
+ * Key code of a raylib key with the modifiers currently held
+ * 
+ * @return int Key code for config_dispatch_key(), or -1 for keys that
+ *             cannot be bound (modifiers themselves, keypad, ...)
+ */
+static int gui_key_code(int key) {
+    int mods = 0;
+    int code;
+    
+    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) mods |= SHORTCUT_MOD_CTRL;
+    if (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) mods |= SHORTCUT_MOD_ALT;
+    if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) mods |= SHORTCUT_MOD_SHIFT;
+    
+    /* Printable keys are reported as their unshifted ASCII (letters uppercase) */
+    if (key >= KEY_SPACE && key < 0x7f) {
+        return SHORTCUT_CODE(mods, tolower(key));
+    }
+    if (key >= KEY_F1 && key <= KEY_F12) {
+        return SHORTCUT_CODE(mods, SHORTCUT_KEY_F1 + (key - KEY_F1));
+    }
+    
+    switch (key) {
+        case KEY_ESCAPE:    code = SHORTCUT_KEY_ESCAPE; break;
+        case KEY_ENTER:     code = SHORTCUT_KEY_ENTER; break;
+        case KEY_TAB:       code = SHORTCUT_KEY_TAB; break;
+        case KEY_BACKSPACE: code = SHORTCUT_KEY_BACKSPACE; break;
+        case KEY_INSERT:    code = SHORTCUT_KEY_INSERT; break;
+        case KEY_DELETE:    code = SHORTCUT_KEY_DELETE; break;
+        case KEY_RIGHT:     code = SHORTCUT_KEY_RIGHT; break;
+        case KEY_LEFT:      code = SHORTCUT_KEY_LEFT; break;
+        case KEY_DOWN:      code = SHORTCUT_KEY_DOWN; break;
+        case KEY_UP:        code = SHORTCUT_KEY_UP; break;
+        case KEY_PAGE_UP:   code = SHORTCUT_KEY_PAGE_UP; break;
+        case KEY_PAGE_DOWN: code = SHORTCUT_KEY_PAGE_DOWN; break;
+        case KEY_HOME:      code = SHORTCUT_KEY_HOME; break;
+        case KEY_END:       code = SHORTCUT_KEY_END; break;
+        default:            return -1;
+    }
+    
+    return SHORTCUT_CODE(mods, code);
+}
+
+/**
+ * Perform a shortcut action, as the matching button or view would
+ */
+static void gui_run_action(gui_state_t *gui, shortcut_action_t action) {
+    switch (action) {
+        case ACTION_STATUS:
+            gui->current_view = GUI_VIEW_MAIN;
+            gui->refresh_needed = true;
+            break;
+            
+        case ACTION_STAGE_ALL:
+            gui_submit(gui, GUI_JOB_STAGE_ALL, 0, NULL);
+            break;
+            
+        case ACTION_COMMIT:
+            gui->current_view = GUI_VIEW_COMMITS;
+            break;
+            
+        case ACTION_PUSH:
+            gui_submit(gui, GUI_JOB_PUSH, 0, NULL);
+            break;
+            
+        case ACTION_PULL:
+            gui_submit(gui, GUI_JOB_PULL, 0, NULL);
+            break;
+            
+        case ACTION_FETCH:
+            gui_submit(gui, GUI_JOB_FETCH, 0, NULL);
+            break;
+            
+        case ACTION_STASH:
+            gui_submit(gui, GUI_JOB_STASH, 0, NULL);
+            break;
+            
+        case ACTION_STASH_POP:
+            gui_submit(gui, GUI_JOB_STASH_POP, 0, NULL);
+            break;
+            
+        case ACTION_BRANCH_LIST:
+        case ACTION_BRANCH_CREATE:
+        case ACTION_BRANCH_SWITCH:
+        case ACTION_BRANCH_DELETE:
+        case ACTION_MERGE:
+            gui->current_view = GUI_VIEW_BRANCHES;
+            gui_submit(gui, GUI_JOB_REFRESH_BRANCHES, 0, NULL);
+            break;
+            
+        case ACTION_LOG:
+        case ACTION_REVERT:
+        case ACTION_RESET_SOFT:
+        case ACTION_RESET_HARD:
+        case ACTION_CHERRY_PICK:
+        case ACTION_REFLOG:
+            gui->current_view = GUI_VIEW_HISTORY;
+            gui_submit(gui, GUI_JOB_REFRESH_COMMITS, GUI_HISTORY_COMMITS, NULL);
+            break;
+            
+        case ACTION_DIFF:
+        case ACTION_DIFF_STAGED:
+            gui->current_view = GUI_VIEW_DIFF;
+            gui->diff_staged = (action == ACTION_DIFF_STAGED);
+            gui_submit(gui, GUI_JOB_REFRESH_DIFF,
+                       gui->diff_staged ? GUI_DIFF_STAGED : GUI_DIFF_UNSTAGED, NULL);
+            break;
+            
+        case ACTION_QUIT:
+            gui->running = false;
+            break;
+            
+        default:
+            break;
+    }
+}
+
+/**
+ * Dispatch the keys pressed this frame
+ * 
+ * Each key is turned into a key code and looked up in the config's
+ * compiled shortcut table: no lock and no string compare per key.
+ * Keys go to the text field instead while it has focus.
+ */
+static void gui_handle_shortcuts(gui_state_t *gui) {
+    int key;
+    
+    while ((key = GetKeyPressed()) != 0) {
+        if (gui->input_active) {
+            continue;
+        }
+        
+        shortcut_action_t action = config_dispatch_key(gui->config, gui_key_code(key));
+        if (action != ACTION_NONE) {
+            gui_run_action(gui, action);
+        }
+    }
+}
+
+/* ============================================================================
+ * On-Demand Redraw
+ * ============================================================================ */
+
+/*
+ * With gui.redraw_on_demand the loop draws a frame only when something
+ * changed: input, a snapshot from the worker, a change under .git, or a
+ * scheduled redraw (a status message expiring, a slow keepalive). While
+ * the user scrolls, drags or holds a key it draws every frame as before.
+ * In between it sleeps in poll() on the worker's wake pipe and the .git
+ * watch, waking every GUI_INPUT_POLL_MS to poll window input.
+ */
+
+/**
+ * Watch the git directory, so commits, checkouts and fetches made
+ * outside the GUI trigger a refresh
+ */
+static void gui_watch_repo(gui_state_t *gui) {
+    char git_dir[MAX_PATH_LEN];
+    char refs_dir[MAX_PATH_LEN + 16];
+    
+    gui->repo_watch = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (gui->repo_watch < 0) {
+        return;
+    }
+    
+    uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+    
+    if (find_git_dir(git_dir, sizeof(git_dir)) == GM_SUCCESS) {
+        inotify_add_watch(gui->repo_watch, git_dir, mask);
+    }
+    if (find_common_dir(git_dir, sizeof(git_dir)) == GM_SUCCESS) {
+        snprintf(refs_dir, sizeof(refs_dir), "%s/refs/heads", git_dir);
+        inotify_add_watch(gui->repo_watch, refs_dir, mask);
+    }
+}
+
+static void gui_drain_fd(int fd) {
+    char buf[4096];
+    while (read(fd, buf, sizeof(buf)) > 0) {
+        /* Discard */
+    }
+}
+
+/**
+ * Whether the user is interacting with the window right now
+ */
+static bool gui_input_active(void) {
+    Vector2 delta = GetMouseDelta();
+    
+    if (delta.x != 0 || delta.y != 0 || GetMouseWheelMove() != 0) {
+        return true;
+    }
+    for (int button = MOUSE_LEFT_BUTTON; button <= MOUSE_MIDDLE_BUTTON; button++) {
+        if (IsMouseButtonDown(button) || IsMouseButtonReleased(button)) {
+            return true;
+        }
+    }
+    for (int key = KEY_SPACE; key <= KEY_KB_MENU; key++) {
+        if (IsKeyDown(key) || IsKeyReleased(key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Sleep until the next frame is needed
+ * 
+ * @return bool False if the window was asked to close while waiting
+ */
+static bool gui_wait_for_frame(gui_state_t *gui) {
+    for (;;) {
+        double now = GetTime();
+        
+        /* Scrolling or holding input: draw at the full frame rate */
+        if (now < gui->active_until) {
+            return true;
+        }
+        
+        PollInputEvents();
+        if (WindowShouldClose()) {
+            return false;
+        }
+        if (IsWindowResized() || gui_input_active()) {
+            gui->active_until = now + GUI_ACTIVE_SECONDS;
+            return true;
+        }
+        
+        double deadline = gui->last_frame + GUI_KEEPALIVE_SECONDS;
+        if (gui->status_until > gui->last_frame && gui->status_until < deadline) {
+            deadline = gui->status_until;
+        }
+        if (now >= deadline) {
+            return true;
+        }
+        
+        int timeout = (int)((deadline - now) * 1000) + 1;
+        if (timeout > GUI_INPUT_POLL_MS) {
+            timeout = GUI_INPUT_POLL_MS;
+        }
+        
+        struct pollfd fds[2] = {
+            { gui->wake_pipe[0], POLLIN, 0 },
+            { gui->repo_watch, POLLIN, 0 }
+        };
+        if (poll(fds, 2, timeout) <= 0) {
+            continue;
+        }
+        
+        if (fds[1].revents & POLLIN) {
+            gui_drain_fd(gui->repo_watch);
+            
+            /* Our own jobs touch .git too; only react to changes made elsewhere */
+            if (atomic_load(&gui->jobs_pending) == 0 &&
+                now - gui->last_swap > GUI_REPO_QUIET_SECONDS) {
+                gui_submit(gui, GUI_JOB_REFRESH, 0, NULL);
+                gui_submit(gui, GUI_JOB_REFRESH_BRANCHES, 0, NULL);
+                gui_submit(gui, GUI_JOB_REFRESH_COMMITS, 0, NULL);
+                if (gui->current_view == GUI_VIEW_DIFF) {
+                    gui_submit(gui, GUI_JOB_REFRESH_DIFF,
+                               gui->diff_staged ? GUI_DIFF_STAGED : GUI_DIFF_UNSTAGED, NULL);
+                }
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            gui_drain_fd(gui->wake_pipe[0]);
+            return true;
+        }
+    }
 }
 
 /* ============================================================================
@@ -716,24 +2021,36 @@ void gui_run(gui_state_t *gui) {
     GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, ColorToInt(COLOR_ACCENT));
     GuiSetStyle(BUTTON, TEXT_COLOR_NORMAL, ColorToInt(COLOR_BG));
     
-    /* Initial refresh */
-    gui_refresh_repo(gui);
-    gui_refresh_commits(gui, 10);
-    gui_refresh_branches(gui);
+    /* Initial refresh, in the background */
+    gui_worker_start(gui);
+    gui_submit(gui, GUI_JOB_REFRESH, 0, NULL);
+    gui_submit(gui, GUI_JOB_REFRESH_COMMITS, GUI_RECENT_COMMITS, NULL);
+    gui_submit(gui, GUI_JOB_REFRESH_BRANCHES, 0, NULL);
+    
+    if (gui->redraw_on_demand) {
+        gui_watch_repo(gui);
+    }
     
     while (!WindowShouldClose() && gui->running) {
+        if (gui->redraw_on_demand && !gui_wait_for_frame(gui)) {
+            break;
+        }
+        
         /* Update */
         gui->width = GetScreenWidth();
         gui->height = GetScreenHeight();
         
-        /* Update status timer */
-        if (gui->status_timer > 0) {
-            gui->status_timer -= GetFrameTime();
-        }
+        gui_swap_snapshot(gui);
+        gui_handle_shortcuts(gui);
         
         /* Refresh if needed */
         if (gui->refresh_needed) {
-            gui_refresh_repo(gui);
+            gui->refresh_needed = false;
+            gui_submit(gui, GUI_JOB_REFRESH, 0, NULL);
+            if (gui->current_view == GUI_VIEW_DIFF) {
+                gui_submit(gui, GUI_JOB_REFRESH_DIFF,
+                           gui->diff_staged ? GUI_DIFF_STAGED : GUI_DIFF_UNSTAGED, NULL);
+            }
         }
         
         /* Draw */
@@ -763,6 +2080,9 @@ void gui_run(gui_state_t *gui) {
             case GUI_VIEW_HISTORY:
                 draw_history_view(gui, content);
                 break;
+            case GUI_VIEW_DIFF:
+                draw_diff_view(gui, content);
+                break;
             default:
                 DrawText("View not implemented", content.x + 20, content.y + 20, 20, COLOR_TEXT_DIM);
                 break;
@@ -771,8 +2091,14 @@ void gui_run(gui_state_t *gui) {
         draw_status_bar(gui, status_bar);
         
         EndDrawing();
+        gui->last_frame = GetTime();
     }
     
+    gui_worker_stop(gui);
+    if (gui->repo_watch >= 0) {
+        close(gui->repo_watch);
+        gui->repo_watch = -1;
+    }
     CloseWindow();
 }
 
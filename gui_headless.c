@@ -0,0 +1,975 @@
+/**
+ * gui_headless.c - Headless render harness for the GUI
+ *
+ * Runs the real GUI (gui.c) without a window or GPU. The raylib and
+ * raygui calls gui.c makes are implemented here as a draw-command
+ * recorder, and a script of interactions (clicks, scrolling, typing,
+ * shortcuts) stands in for the user. Every frame's time and draw calls
+ * are recorded per script phase and reported as percentiles, so GUI
+ * performance can be measured - and regressions caught - on a machine
+ * with no display.
+ *
+ * Build with: make gui-headless
+ * Run with:   build/git_master_gui_headless [--fixture DIR | --repo DIR] [--script FILE]
+ */
+
+#include "raylib.h"
+#include "raygui.h"
+#include "config.h"
+#include <ctype.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/* gui.c entry points (gui.c has no header) */
+typedef struct gui_state gui_state_t;
+gui_state_t* gui_init(config_t *config);
+void gui_run(gui_state_t *gui);
+void gui_cleanup(gui_state_t *gui);
+
+/* ============================================================================
+ * Harness Constants
+ * ============================================================================ */
+
+#define HEADLESS_MAX_STEPS          256
+#define HEADLESS_MAX_PHASES         32
+#define HEADLESS_STEP_TIMEOUT       120.0   /* Seconds a click or wait may take */
+#define HEADLESS_FIXTURE_DIR        "/tmp/git_master_gui_bench"
+#define HEADLESS_FIXTURE_BRANCHES   10000
+#define HEADLESS_FIXTURE_COMMITS    100000
+#define HEADLESS_GLYPH_WIDTH        0.6     /* Default font advance per pixel of size */
+
+/* Browsing only: safe to run against any repository */
+static const char *HEADLESS_BROWSE_SCRIPT =
+    "phase startup\n"
+    "wait-no-text Loading...\n"
+    "wait-no-text Working...\n"
+    "phase idle\n"
+    "sleep 3000\n"
+    "phase branches\n"
+    "click Branches\n"
+    "wait-no-text Working...\n"
+    "scroll -3 300\n"
+    "phase history\n"
+    "click History\n"
+    "wait-no-text Working...\n"
+    "scroll -3 300\n";
+
+/* Commits to the repository: only appended for fixtures */
+static const char *HEADLESS_COMMIT_SCRIPT =
+    "phase commit\n"
+    "click Commits\n"
+    "type Headless benchmark commit\n"
+    "touch headless_bench.txt\n"
+    "click Stage All & Commit\n"
+    "wait-no-text Working...\n";
+
+/* ============================================================================
+ * Harness State
+ * ============================================================================ */
+
+typedef enum {
+    DRAW_CLEAR,
+    DRAW_RECT,
+    DRAW_LINE,
+    DRAW_TEXT,
+    DRAW_WIDGET,
+    DRAW_SCISSOR,
+    DRAW_KIND_COUNT
+} draw_kind_t;
+
+typedef enum {
+    STEP_PHASE,         /* phase NAME: start a new metrics bucket */
+    STEP_WAIT,          /* wait FRAMES */
+    STEP_SLEEP,         /* sleep MS: let time pass, drawing only what the GUI wants */
+    STEP_CLICK,         /* click LABEL: the next button with this label is clicked */
+    STEP_SCROLL,        /* scroll AMOUNT FRAMES: mouse wheel movement per frame */
+    STEP_TYPE,          /* type TEXT: the next text box receives TEXT */
+    STEP_KEY,           /* key SPEC: press a shortcut, e.g. "ctrl+s" */
+    STEP_WAIT_TEXT,     /* wait-text TEXT: until a frame draws TEXT */
+    STEP_WAIT_NO_TEXT,  /* wait-no-text TEXT: until a frame does not draw TEXT */
+    STEP_TOUCH,         /* touch FILE: write FILE so there is something to commit */
+    STEP_QUIT
+} step_kind_t;
+
+typedef struct {
+    step_kind_t kind;
+    int count;                  /* Frames (wait, scroll) or milliseconds (sleep) */
+    float amount;               /* Wheel movement per frame (scroll) */
+    char arg[256];              /* Label, text, key or file name */
+    int line;
+} step_t;
+
+typedef struct {
+    char name[32];
+    double *frame_ms;
+    int *frame_draws;
+    int frames;
+    int capacity;
+    long kind_totals[DRAW_KIND_COUNT];
+    long measure_calls;
+} phase_t;
+
+typedef struct {
+    /* Window */
+    int width;
+    int height;
+    int target_fps;
+    bool should_close;
+    struct timespec origin;
+
+    /* Current frame */
+    double work_start;          /* End of the last frame or idle poll */
+    double frame_start;         /* BeginDrawing(), for pacing */
+    float frame_time;
+    int draws[DRAW_KIND_COUNT];
+    int measures;
+    bool text_seen;
+
+    /* Scripted input */
+    Vector2 mouse;
+    float wheel;
+    bool click_pending;
+    bool type_pending;
+    int key;                    /* raylib key held by a key step, or 0 */
+    unsigned key_mods;
+    bool key_queued;
+
+    /* Script */
+    step_t steps[HEADLESS_MAX_STEPS];
+    int step_count;
+    int step;
+    bool step_started;
+    int step_frames;
+    double step_deadline;
+    bool failed;
+
+    /* Metrics */
+    phase_t phases[HEADLESS_MAX_PHASES];
+    int phase_count;
+} headless_t;
+
+static headless_t g_headless;
+
+static double headless_now(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)(ts.tv_sec - g_headless.origin.tv_sec) +
+           (double)(ts.tv_nsec - g_headless.origin.tv_nsec) / 1e9;
+}
+
+/* ============================================================================
+ * Script
+ * ============================================================================ */
+
+/**
+ * Parse a script into steps
+ *
+ * One step per line; blank lines and lines starting with '#' are skipped.
+ *
+ * @param script Script text
+ * @return bool False on a malformed line or too many steps
+ */
+static bool headless_parse_script(const char *script) {
+    static const struct { const char *name; step_kind_t kind; } STEP_NAMES[] = {
+        { "phase", STEP_PHASE },         { "wait", STEP_WAIT },
+        { "sleep", STEP_SLEEP },         { "click", STEP_CLICK },
+        { "scroll", STEP_SCROLL },       { "type", STEP_TYPE },
+        { "key", STEP_KEY },             { "wait-text", STEP_WAIT_TEXT },
+        { "wait-no-text", STEP_WAIT_NO_TEXT }, { "touch", STEP_TOUCH },
+        { "quit", STEP_QUIT }
+    };
+    const char *p = script;
+    int line_no = 0;
+
+    while (*p != '\0') {
+        const char *eol = strchr(p, '\n');
+        size_t len = eol != NULL ? (size_t)(eol - p) : strlen(p);
+        char line[512];
+
+        line_no++;
+        if (len >= sizeof(line)) {
+            PRINT_ERROR("Script line %d is too long", line_no);
+            return false;
+        }
+        memcpy(line, p, len);
+        line[len] = '\0';
+        p += len + (eol != NULL ? 1 : 0);
+
+        char *cmd = trim_whitespace(line);
+        if (*cmd == '\0' || *cmd == '#') continue;
+
+        char *arg = cmd;
+        while (*arg != '\0' && !isspace((unsigned char)*arg)) arg++;
+        if (*arg != '\0') *arg++ = '\0';
+        arg = trim_whitespace(arg);
+
+        if (g_headless.step_count >= HEADLESS_MAX_STEPS) {
+            PRINT_ERROR("Script has more than %d steps", HEADLESS_MAX_STEPS);
+            return false;
+        }
+        step_t *step = &g_headless.steps[g_headless.step_count];
+        bool known = false;
+
+        memset(step, 0, sizeof(*step));
+        step->line = line_no;
+        for (size_t i = 0; i < sizeof(STEP_NAMES) / sizeof(STEP_NAMES[0]); i++) {
+            if (strcmp(cmd, STEP_NAMES[i].name) == 0) {
+                step->kind = STEP_NAMES[i].kind;
+                known = true;
+                break;
+            }
+        }
+        if (!known) {
+            PRINT_ERROR("Script line %d: unknown step '%s'", line_no, cmd);
+            return false;
+        }
+
+        bool valid = true;
+        switch (step->kind) {
+            case STEP_WAIT:
+            case STEP_SLEEP:
+                valid = sscanf(arg, "%d", &step->count) == 1 && step->count >= 0;
+                break;
+            case STEP_SCROLL:
+                valid = sscanf(arg, "%f %d", &step->amount, &step->count) == 2 &&
+                        step->count > 0;
+                break;
+            case STEP_KEY:
+                valid = shortcut_parse_key(arg) >= 0;
+                break;
+            case STEP_QUIT:
+                break;
+            default:
+                valid = *arg != '\0';
+                break;
+        }
+        if (!valid || strlen(arg) >= sizeof(step->arg)) {
+            PRINT_ERROR("Script line %d: bad argument for '%s'", line_no, cmd);
+            return false;
+        }
+        strcpy(step->arg, arg);
+        g_headless.step_count++;
+    }
+
+    return true;
+}
+
+static void headless_start_phase(const char *name) {
+    if (g_headless.phase_count >= HEADLESS_MAX_PHASES) return;
+
+    phase_t *phase = &g_headless.phases[g_headless.phase_count++];
+    strncpy(phase->name, name, sizeof(phase->name) - 1);
+}
+
+/**
+ * Map a shortcut spec back to the raylib key and modifiers that produce it
+ */
+static int headless_raylib_key(const char *spec, unsigned *mods) {
+    static const struct { int code; int key; } NAMED[] = {
+        { SHORTCUT_KEY_TAB, KEY_TAB },             { SHORTCUT_KEY_ENTER, KEY_ENTER },
+        { SHORTCUT_KEY_ESCAPE, KEY_ESCAPE },       { SHORTCUT_KEY_BACKSPACE, KEY_BACKSPACE },
+        { SHORTCUT_KEY_UP, KEY_UP },               { SHORTCUT_KEY_DOWN, KEY_DOWN },
+        { SHORTCUT_KEY_LEFT, KEY_LEFT },           { SHORTCUT_KEY_RIGHT, KEY_RIGHT },
+        { SHORTCUT_KEY_HOME, KEY_HOME },           { SHORTCUT_KEY_END, KEY_END },
+        { SHORTCUT_KEY_PAGE_UP, KEY_PAGE_UP },     { SHORTCUT_KEY_PAGE_DOWN, KEY_PAGE_DOWN },
+        { SHORTCUT_KEY_INSERT, KEY_INSERT },       { SHORTCUT_KEY_DELETE, KEY_DELETE }
+    };
+    int code = shortcut_parse_key(spec);
+    int key = code % SHORTCUT_KEY_COUNT;
+
+    *mods = (unsigned)(code / SHORTCUT_KEY_COUNT);
+
+    if (key >= SHORTCUT_KEY_F1 && key < SHORTCUT_KEY_F1 + 12) {
+        return KEY_F1 + (key - SHORTCUT_KEY_F1);
+    }
+    for (size_t i = 0; i < sizeof(NAMED) / sizeof(NAMED[0]); i++) {
+        if (NAMED[i].code == key) return NAMED[i].key;
+    }
+    return toupper(key);
+}
+
+/**
+ * Write a file with changing content
+ */
+static bool headless_touch(const char *path) {
+    FILE *fp = fopen(path, "a");
+
+    if (fp == NULL) {
+        PRINT_ERROR("Cannot write %s: %s", path, strerror(errno));
+        return false;
+    }
+    fprintf(fp, "headless run at %ld\n", (long)time(NULL));
+    fclose(fp);
+    return true;
+}
+
+/**
+ * Apply the current step's input
+ *
+ * @return bool True if the step is already complete
+ */
+static bool headless_begin_step(step_t *step) {
+    g_headless.step_started = true;
+    g_headless.step_frames = 0;
+    g_headless.step_deadline = headless_now() + HEADLESS_STEP_TIMEOUT;
+
+    switch (step->kind) {
+        case STEP_PHASE:
+            headless_start_phase(step->arg);
+            return true;
+        case STEP_SLEEP:
+            g_headless.step_deadline = headless_now() + step->count / 1000.0;
+            return false;
+        case STEP_CLICK:
+            g_headless.click_pending = true;
+            return false;
+        case STEP_SCROLL:
+            g_headless.wheel = step->amount;
+            return false;
+        case STEP_TYPE:
+            g_headless.type_pending = true;
+            return false;
+        case STEP_KEY:
+            g_headless.key = headless_raylib_key(step->arg, &g_headless.key_mods);
+            g_headless.key_queued = true;
+            return false;
+        case STEP_TOUCH:
+            if (!headless_touch(step->arg)) {
+                g_headless.failed = true;
+                g_headless.should_close = true;
+            }
+            return true;
+        case STEP_QUIT:
+            g_headless.should_close = true;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void headless_end_step(void) {
+    g_headless.wheel = 0;
+    g_headless.click_pending = false;
+    g_headless.type_pending = false;
+    g_headless.key = 0;
+    g_headless.key_mods = 0;
+    g_headless.key_queued = false;
+    g_headless.step_started = false;
+    g_headless.step++;
+}
+
+/**
+ * Advance the script
+ *
+ * Called after every frame and from every idle input poll, so timed steps
+ * progress while the GUI is not drawing.
+ *
+ * @param frame_done True right after a frame was drawn
+ */
+static void headless_advance(bool frame_done) {
+    while (!g_headless.should_close) {
+        if (g_headless.step >= g_headless.step_count) {
+            g_headless.should_close = true;
+            return;
+        }
+
+        step_t *step = &g_headless.steps[g_headless.step];
+
+        if (!g_headless.step_started) {
+            if (headless_begin_step(step)) {
+                headless_end_step();
+                continue;
+            }
+            /* The frame just drawn predates this step */
+            return;
+        }
+
+        if (frame_done) {
+            g_headless.step_frames++;
+        }
+
+        bool done = false;
+        switch (step->kind) {
+            case STEP_WAIT:
+            case STEP_SCROLL:
+                done = g_headless.step_frames >= step->count;
+                break;
+            case STEP_SLEEP:
+                done = headless_now() >= g_headless.step_deadline;
+                break;
+            case STEP_CLICK:
+                done = frame_done && !g_headless.click_pending;
+                break;
+            case STEP_TYPE:
+                done = frame_done && !g_headless.type_pending;
+                break;
+            case STEP_KEY:
+                done = frame_done && !g_headless.key_queued;
+                break;
+            case STEP_WAIT_TEXT:
+                done = frame_done && g_headless.text_seen;
+                break;
+            case STEP_WAIT_NO_TEXT:
+                done = frame_done && !g_headless.text_seen;
+                break;
+            default:
+                done = true;
+                break;
+        }
+
+        if (!done) {
+            if (step->kind != STEP_SLEEP && headless_now() >= g_headless.step_deadline) {
+                PRINT_ERROR("Script line %d timed out: %s", step->line, step->arg);
+                g_headless.failed = true;
+                g_headless.should_close = true;
+            }
+            return;
+        }
+
+        headless_end_step();
+        frame_done = false;
+    }
+}
+
+/* ============================================================================
+ * Draw-Command Recorder
+ * ============================================================================ */
+
+static void headless_record(draw_kind_t kind) {
+    g_headless.draws[kind]++;
+}
+
+static void headless_check_text(const char *text) {
+    if (!g_headless.step_started || g_headless.step >= g_headless.step_count) return;
+
+    const step_t *step = &g_headless.steps[g_headless.step];
+    if ((step->kind == STEP_WAIT_TEXT || step->kind == STEP_WAIT_NO_TEXT) &&
+        strstr(text, step->arg) != NULL) {
+        g_headless.text_seen = true;
+    }
+}
+
+/**
+ * Add the finished frame to the current phase
+ */
+static void headless_record_frame(double ms) {
+    if (g_headless.phase_count == 0) {
+        headless_start_phase("default");
+    }
+
+    phase_t *phase = &g_headless.phases[g_headless.phase_count - 1];
+    int draws = 0;
+
+    if (phase->frames == phase->capacity) {
+        phase->capacity = phase->capacity > 0 ? phase->capacity * 2 : 1024;
+        phase->frame_ms = safe_realloc(phase->frame_ms, phase->capacity * sizeof(double));
+        phase->frame_draws = safe_realloc(phase->frame_draws, phase->capacity * sizeof(int));
+    }
+    for (int kind = 0; kind < DRAW_KIND_COUNT; kind++) {
+        phase->kind_totals[kind] += g_headless.draws[kind];
+        draws += g_headless.draws[kind];
+    }
+    phase->measure_calls += g_headless.measures;
+    phase->frame_ms[phase->frames] = ms;
+    phase->frame_draws[phase->frames] = draws;
+    phase->frames++;
+}
+
+void InitWindow(int width, int height, const char *title) {
+    (void)title;
+    if (g_headless.width == 0) g_headless.width = width;
+    if (g_headless.height == 0) g_headless.height = height;
+    g_headless.mouse = (Vector2){ g_headless.width * 0.6f, g_headless.height * 0.6f };
+    g_headless.work_start = headless_now();
+}
+
+void CloseWindow(void) {
+}
+
+bool WindowShouldClose(void) {
+    return g_headless.should_close;
+}
+
+bool IsWindowResized(void) {
+    return false;
+}
+
+int GetScreenWidth(void) {
+    return g_headless.width;
+}
+
+int GetScreenHeight(void) {
+    return g_headless.height;
+}
+
+void SetConfigFlags(unsigned int flags) {
+    (void)flags;
+}
+
+void SetTargetFPS(int fps) {
+    g_headless.target_fps = fps;
+}
+
+double GetTime(void) {
+    return headless_now();
+}
+
+float GetFrameTime(void) {
+    return g_headless.frame_time;
+}
+
+void PollInputEvents(void) {
+    headless_advance(false);
+    g_headless.work_start = headless_now();
+}
+
+void BeginDrawing(void) {
+    g_headless.frame_start = headless_now();
+    memset(g_headless.draws, 0, sizeof(g_headless.draws));
+    g_headless.measures = 0;
+    g_headless.text_seen = false;
+}
+
+/**
+ * Finish the frame: record it, advance the script, and pace like raylib
+ */
+void EndDrawing(void) {
+    double now = headless_now();
+
+    headless_record_frame((now - g_headless.work_start) * 1000.0);
+    headless_advance(true);
+
+    if (g_headless.target_fps > 0) {
+        double next = g_headless.frame_start + 1.0 / g_headless.target_fps;
+        double wait = next - headless_now();
+        if (wait > 0) {
+            struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+            nanosleep(&ts, NULL);
+        }
+    }
+
+    now = headless_now();
+    g_headless.frame_time = (float)(now - g_headless.frame_start);
+    g_headless.work_start = now;
+}
+
+void ClearBackground(Color color) {
+    (void)color;
+    headless_record(DRAW_CLEAR);
+}
+
+void BeginScissorMode(int x, int y, int width, int height) {
+    (void)x; (void)y; (void)width; (void)height;
+    headless_record(DRAW_SCISSOR);
+}
+
+void EndScissorMode(void) {
+}
+
+void DrawLine(int start_x, int start_y, int end_x, int end_y, Color color) {
+    (void)start_x; (void)start_y; (void)end_x; (void)end_y; (void)color;
+    headless_record(DRAW_LINE);
+}
+
+void DrawRectangleRec(Rectangle rec, Color color) {
+    (void)rec; (void)color;
+    headless_record(DRAW_RECT);
+}
+
+void DrawText(const char *text, int x, int y, int font_size, Color color) {
+    (void)x; (void)y; (void)font_size; (void)color;
+    headless_record(DRAW_TEXT);
+    headless_check_text(text);
+}
+
+/* Approximates the default font; walks the text like the real one does */
+int MeasureText(const char *text, int font_size) {
+    g_headless.measures++;
+    return (int)(strlen(text) * font_size * HEADLESS_GLYPH_WIDTH);
+}
+
+int ColorToInt(Color color) {
+    return (int)(((unsigned)color.r << 24) | ((unsigned)color.g << 16) |
+                 ((unsigned)color.b << 8) | (unsigned)color.a);
+}
+
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec) {
+    return point.x >= rec.x && point.x < rec.x + rec.width &&
+           point.y >= rec.y && point.y < rec.y + rec.height;
+}
+
+bool IsKeyDown(int key) {
+    if (key != 0 && key == g_headless.key) return true;
+
+    switch (key) {
+        case KEY_LEFT_CONTROL: return (g_headless.key_mods & SHORTCUT_MOD_CTRL) != 0;
+        case KEY_LEFT_ALT:     return (g_headless.key_mods & SHORTCUT_MOD_ALT) != 0;
+        case KEY_LEFT_SHIFT:   return (g_headless.key_mods & SHORTCUT_MOD_SHIFT) != 0;
+        default:               return false;
+    }
+}
+
+bool IsKeyReleased(int key) {
+    (void)key;
+    return false;
+}
+
+int GetKeyPressed(void) {
+    if (!g_headless.key_queued) return 0;
+
+    g_headless.key_queued = false;
+    return g_headless.key;
+}
+
+/* Scripted clicks go through the button label, never through coordinates */
+bool IsMouseButtonPressed(int button) {
+    (void)button;
+    return false;
+}
+
+bool IsMouseButtonDown(int button) {
+    return button == MOUSE_BUTTON_LEFT && g_headless.click_pending;
+}
+
+bool IsMouseButtonReleased(int button) {
+    (void)button;
+    return false;
+}
+
+Vector2 GetMousePosition(void) {
+    return g_headless.mouse;
+}
+
+Vector2 GetMouseDelta(void) {
+    return (Vector2){ 0, 0 };
+}
+
+float GetMouseWheelMove(void) {
+    return g_headless.wheel;
+}
+
+void GuiSetStyle(int control, int property, int value) {
+    (void)control; (void)property; (void)value;
+}
+
+int GuiButton(Rectangle bounds, const char *text) {
+    (void)bounds;
+    headless_record(DRAW_WIDGET);
+    headless_check_text(text);
+
+    if (g_headless.click_pending && g_headless.step_started &&
+        strcmp(text, g_headless.steps[g_headless.step].arg) == 0) {
+        g_headless.click_pending = false;
+        return 1;
+    }
+    return 0;
+}
+
+int GuiTextBox(Rectangle bounds, char *text, int text_size, bool edit_mode) {
+    (void)bounds; (void)edit_mode;
+    headless_record(DRAW_WIDGET);
+
+    if (g_headless.type_pending) {
+        snprintf(text, (size_t)text_size, "%s", g_headless.steps[g_headless.step].arg);
+        g_headless.type_pending = false;
+    }
+    headless_check_text(text);
+    return 0;
+}
+
+/* ============================================================================
+ * Fixture Repository
+ * ============================================================================ */
+
+/**
+ * Create a repository with many commits and branches, or reuse it
+ *
+ * The history is written with git fast-import, so a 100k-commit fixture
+ * takes seconds. Branches point at commits spread over the history.
+ */
+static bool headless_make_fixture(const char *dir, int branches, int commits) {
+    char git_dir[MAX_PATH_LEN];
+    struct stat st;
+
+    snprintf(git_dir, sizeof(git_dir), "%s/.git", dir);
+    if (stat(git_dir, &st) == 0) {
+        PRINT_INFO("Reusing fixture %s", dir);
+        return chdir(dir) == 0;
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        PRINT_ERROR("Cannot create %s: %s", dir, strerror(errno));
+        return false;
+    }
+    if (chdir(dir) != 0) {
+        PRINT_ERROR("Cannot enter %s: %s", dir, strerror(errno));
+        return false;
+    }
+
+    PRINT_INFO("Creating fixture %s (%d commits, %d branches)...", dir, commits, branches);
+
+    const char *setup[] = {
+        "init -q",
+        "symbolic-ref HEAD refs/heads/main",
+        "config user.name \"Git Master Bench\"",
+        "config user.email bench@example.com"
+    };
+    for (size_t i = 0; i < sizeof(setup) / sizeof(setup[0]); i++) {
+        cmd_result_t *result = exec_git_command(setup[i]);
+        bool ok = result != NULL && result->exit_code == 0;
+        free_cmd_result(result);
+        if (!ok) {
+            PRINT_ERROR("git %s failed", setup[i]);
+            return false;
+        }
+    }
+
+    char *stream = NULL;
+    size_t stream_len = 0;
+    FILE *fp = open_memstream(&stream, &stream_len);
+    if (fp == NULL) return false;
+
+    long when = 1700000000L;
+    for (int i = 1; i <= commits; i++) {
+        char message[64];
+        int message_len = snprintf(message, sizeof(message), "Bench commit %d", i);
+
+        fprintf(fp, "commit refs/heads/main\nmark :%d\n"
+                    "committer Git Master Bench <bench@example.com> %ld +0000\n"
+                    "data %d\n%s\n",
+                i, when + i * 60L, message_len, message);
+        if (i == 1) {
+            fprintf(fp, "M 644 inline README\ndata 15\nBench fixture.\n\n");
+        }
+    }
+    for (int i = 0; i < branches; i++) {
+        int mark = commits > 0 ? 1 + (int)((long)i * commits / (branches > 0 ? branches : 1)) : 0;
+        if (mark == 0) break;
+        fprintf(fp, "reset refs/heads/bench/branch-%05d\nfrom :%d\n\n", i, mark);
+    }
+    fclose(fp);
+
+    cmd_result_t *result = exec_git_command_input("fast-import --quiet", stream, stream_len);
+    bool ok = result != NULL && result->exit_code == 0;
+    free_cmd_result(result);
+    free(stream);
+    if (!ok) {
+        PRINT_ERROR("git fast-import failed");
+        return false;
+    }
+
+    result = exec_git_command("reset -q --hard");
+    ok = result != NULL && result->exit_code == 0;
+    free_cmd_result(result);
+    return ok;
+}
+
+/* ============================================================================
+ * Report
+ * ============================================================================ */
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of a sorted array */
+static double percentile(const double *sorted, int count, double p) {
+    int rank = (int)(p / 100.0 * count + 0.999999);
+
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return sorted[rank - 1];
+}
+
+/**
+ * Print frame time percentiles and draw calls per phase
+ *
+ * @param max_p99 Budget for the p99 frame time in ms, or 0 for none
+ * @return bool False if a phase is over budget
+ */
+static bool headless_report(double max_p99) {
+    bool within_budget = true;
+
+    printf("\n" COLOR_BOLD "%-10s %7s %8s %8s %8s %8s %8s %8s %8s %8s" COLOR_RESET "\n",
+           "phase", "frames", "p50 ms", "p95 ms", "p99 ms", "max ms",
+           "draws", "max", "text", "measure");
+
+    for (int i = 0; i < g_headless.phase_count; i++) {
+        phase_t *phase = &g_headless.phases[i];
+
+        if (phase->frames == 0) {
+            printf("%-10s %7d\n", phase->name, 0);
+            continue;
+        }
+
+        int max_draws = 0;
+        for (int f = 0; f < phase->frames; f++) {
+            if (phase->frame_draws[f] > max_draws) max_draws = phase->frame_draws[f];
+        }
+
+        long total_draws = 0;
+        for (int kind = 0; kind < DRAW_KIND_COUNT; kind++) {
+            total_draws += phase->kind_totals[kind];
+        }
+
+        qsort(phase->frame_ms, phase->frames, sizeof(double), compare_double);
+        double p99 = percentile(phase->frame_ms, phase->frames, 99);
+
+        printf("%-10s %7d %8.3f %8.3f %8.3f %8.3f %8.1f %8d %8.1f %8.1f\n",
+               phase->name, phase->frames,
+               percentile(phase->frame_ms, phase->frames, 50),
+               percentile(phase->frame_ms, phase->frames, 95),
+               p99, phase->frame_ms[phase->frames - 1],
+               (double)total_draws / phase->frames, max_draws,
+               (double)phase->kind_totals[DRAW_TEXT] / phase->frames,
+               (double)phase->measure_calls / phase->frames);
+
+        if (max_p99 > 0 && p99 > max_p99) {
+            PRINT_WARNING("Phase %s: p99 frame time %.3f ms is over the %.3f ms budget",
+                          phase->name, p99, max_p99);
+            within_budget = false;
+        }
+
+        free(phase->frame_ms);
+        free(phase->frame_draws);
+    }
+
+    printf("\ndraws = draw calls per frame (rects, lines, text, widgets, scissor, clear);\n"
+           "text = DrawText calls per frame; measure = MeasureText calls per frame\n");
+    return within_budget;
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+static void headless_usage(const char *program) {
+    printf("Usage: %s [options]\n\n", program);
+    printf("Render the GUI without a display, replay a script of interactions\n");
+    printf("and report frame times and draw calls per phase.\n\n");
+    printf("Options:\n");
+    printf("  --fixture DIR     Generated repository to run in (default %s)\n", HEADLESS_FIXTURE_DIR);
+    printf("  --branches N      Fixture branches (default %d)\n", HEADLESS_FIXTURE_BRANCHES);
+    printf("  --commits N       Fixture commits (default %d)\n", HEADLESS_FIXTURE_COMMITS);
+    printf("  --repo DIR        Existing repository to run in (browsing only by default)\n");
+    printf("  --script FILE     Interaction script instead of the built-in one\n");
+    printf("  --size WxH        Window size (default from the config)\n");
+    printf("  --continuous      Draw every frame instead of on demand\n");
+    printf("  --max-p99 MS      Exit with status 1 if a phase's p99 frame time exceeds MS\n\n");
+    printf("Script steps, one per line:\n");
+    printf("  phase NAME, wait FRAMES, sleep MS, click LABEL, scroll AMOUNT FRAMES,\n");
+    printf("  type TEXT, key SPEC, wait-text TEXT, wait-no-text TEXT, touch FILE, quit\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *fixture = NULL;
+    const char *repo = NULL;
+    const char *script_path = NULL;
+    int branches = HEADLESS_FIXTURE_BRANCHES;
+    int commits = HEADLESS_FIXTURE_COMMITS;
+    bool continuous = false;
+    double max_p99 = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &g_headless.origin);
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            headless_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "--continuous") == 0) {
+            continuous = true;
+            continue;
+        } else if (value == NULL) {
+            PRINT_ERROR("Unknown option or missing value: %s", argv[i]);
+            return 1;
+        } else if (strcmp(argv[i], "--fixture") == 0) {
+            fixture = value;
+        } else if (strcmp(argv[i], "--repo") == 0) {
+            repo = value;
+        } else if (strcmp(argv[i], "--script") == 0) {
+            script_path = value;
+        } else if (strcmp(argv[i], "--branches") == 0) {
+            branches = atoi(value);
+        } else if (strcmp(argv[i], "--commits") == 0) {
+            commits = atoi(value);
+        } else if (strcmp(argv[i], "--size") == 0) {
+            if (sscanf(value, "%dx%d", &g_headless.width, &g_headless.height) != 2) {
+                PRINT_ERROR("Invalid size: %s", value);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--max-p99") == 0) {
+            max_p99 = atof(value);
+        } else {
+            PRINT_ERROR("Unknown option: %s", argv[i]);
+            return 1;
+        }
+        i++;
+    }
+
+    /* Load the script before changing directory */
+    bool parsed;
+    if (script_path != NULL) {
+        FILE *fp = fopen(script_path, "r");
+        char *text = NULL;
+        size_t text_len = 0;
+
+        if (fp == NULL) {
+            PRINT_ERROR("Cannot open %s: %s", script_path, strerror(errno));
+            return 1;
+        }
+        FILE *out = open_memstream(&text, &text_len);
+        int c;
+        while ((c = fgetc(fp)) != EOF) fputc(c, out);
+        fclose(out);
+        fclose(fp);
+        parsed = headless_parse_script(text);
+        free(text);
+    } else {
+        parsed = headless_parse_script(HEADLESS_BROWSE_SCRIPT) &&
+                 (repo != NULL || headless_parse_script(HEADLESS_COMMIT_SCRIPT));
+    }
+    if (!parsed) return 1;
+
+    if (repo != NULL) {
+        if (chdir(repo) != 0) {
+            PRINT_ERROR("Cannot enter %s: %s", repo, strerror(errno));
+            return 1;
+        }
+    } else if (!headless_make_fixture(fixture != NULL ? fixture : HEADLESS_FIXTURE_DIR,
+                                      branches, commits)) {
+        return 1;
+    }
+
+    config_t *config = config_create_with_defaults();
+    if (config == NULL) return 1;
+    config->gui.redraw_on_demand = !continuous;
+
+    gui_state_t *gui = gui_init(config);
+    if (gui == NULL) {
+        config_destroy(config);
+        return 1;
+    }
+
+    /* Start the script, so leading phase steps cover the first frame */
+    double started = headless_now();
+    headless_advance(false);
+    gui_run(gui);
+    gui_cleanup(gui);
+    config_destroy(config);
+
+    PRINT_INFO("Replayed %d steps in %.1f s (%s redraw)", g_headless.step,
+               headless_now() - started, continuous ? "continuous" : "on-demand");
+
+    bool within_budget = headless_report(max_p99);
+    if (g_headless.failed) {
+        PRINT_ERROR("Script did not complete");
+        return 1;
+    }
+    return within_budget ? 0 : 1;
+}
@@ -0,0 +1,32 @@
+/**
+ * raygui.h - Headless subset of the raygui API
+ *
+ * Declares the raygui controls gui.c uses. gui_headless.c implements
+ * them, so RAYGUI_IMPLEMENTATION has no effect in the headless build.
+ */
+
+#ifndef GM_HEADLESS_RAYGUI_H
+#define GM_HEADLESS_RAYGUI_H
+
+#include "raylib.h"
+
+typedef enum {
+    DEFAULT = 0,
+    BUTTON  = 2
+} GuiControl;
+
+typedef enum {
+    BASE_COLOR_NORMAL   = 1,
+    TEXT_COLOR_NORMAL   = 2
+} GuiControlProperty;
+
+typedef enum {
+    TEXT_SIZE           = 16,
+    BACKGROUND_COLOR    = 19
+} GuiDefaultProperty;
+
+void GuiSetStyle(int control, int property, int value);
+int GuiButton(Rectangle bounds, const char *text);
+int GuiTextBox(Rectangle bounds, char *text, int text_size, bool edit_mode);
+
+#endif /* GM_HEADLESS_RAYGUI_H */
@@ -0,0 +1,133 @@
+/**
+ * raylib.h - Headless subset of the raylib API
+ *
+ * Declares the part of raylib that gui.c uses, so gui.c can be built
+ * against the draw-command recorder in gui_headless.c instead of a
+ * window and a GPU. Values match raylib 4.x/5.x.
+ *
+ * Only the gui-headless build puts this directory on the include path.
+ */
+
+#ifndef GM_HEADLESS_RAYLIB_H
+#define GM_HEADLESS_RAYLIB_H
+
+#include <stdbool.h>
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+typedef struct Color {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+} Color;
+
+typedef struct Rectangle {
+    float x;
+    float y;
+    float width;
+    float height;
+} Rectangle;
+
+typedef struct Vector2 {
+    float x;
+    float y;
+} Vector2;
+
+/* ============================================================================
+ * Flags and Input Codes
+ * ============================================================================ */
+
+typedef enum {
+    FLAG_WINDOW_RESIZABLE = 0x00000004
+} ConfigFlags;
+
+typedef enum {
+    KEY_NULL            = 0,
+    KEY_SPACE           = 32,
+    KEY_A               = 65,
+    KEY_Z               = 90,
+    KEY_ESCAPE          = 256,
+    KEY_ENTER           = 257,
+    KEY_TAB             = 258,
+    KEY_BACKSPACE       = 259,
+    KEY_INSERT          = 260,
+    KEY_DELETE          = 261,
+    KEY_RIGHT           = 262,
+    KEY_LEFT            = 263,
+    KEY_DOWN            = 264,
+    KEY_UP              = 265,
+    KEY_PAGE_UP         = 266,
+    KEY_PAGE_DOWN       = 267,
+    KEY_HOME            = 268,
+    KEY_END             = 269,
+    KEY_F1              = 290,
+    KEY_F12             = 301,
+    KEY_LEFT_SHIFT      = 340,
+    KEY_LEFT_CONTROL    = 341,
+    KEY_LEFT_ALT        = 342,
+    KEY_RIGHT_SHIFT     = 344,
+    KEY_RIGHT_CONTROL   = 345,
+    KEY_RIGHT_ALT       = 346,
+    KEY_KB_MENU         = 348
+} KeyboardKey;
+
+typedef enum {
+    MOUSE_BUTTON_LEFT   = 0,
+    MOUSE_BUTTON_RIGHT  = 1,
+    MOUSE_BUTTON_MIDDLE = 2
+} MouseButton;
+
+#define MOUSE_LEFT_BUTTON   MOUSE_BUTTON_LEFT
+#define MOUSE_RIGHT_BUTTON  MOUSE_BUTTON_RIGHT
+#define MOUSE_MIDDLE_BUTTON MOUSE_BUTTON_MIDDLE
+
+/* ============================================================================
+ * Window and Timing
+ * ============================================================================ */
+
+void InitWindow(int width, int height, const char *title);
+void CloseWindow(void);
+bool WindowShouldClose(void);
+bool IsWindowResized(void);
+int GetScreenWidth(void);
+int GetScreenHeight(void);
+void SetConfigFlags(unsigned int flags);
+void SetTargetFPS(int fps);
+double GetTime(void);
+float GetFrameTime(void);
+void PollInputEvents(void);
+
+/* ============================================================================
+ * Drawing
+ * ============================================================================ */
+
+void BeginDrawing(void);
+void EndDrawing(void);
+void ClearBackground(Color color);
+void BeginScissorMode(int x, int y, int width, int height);
+void EndScissorMode(void);
+void DrawLine(int start_x, int start_y, int end_x, int end_y, Color color);
+void DrawRectangleRec(Rectangle rec, Color color);
+void DrawText(const char *text, int x, int y, int font_size, Color color);
+int MeasureText(const char *text, int font_size);
+int ColorToInt(Color color);
+bool CheckCollisionPointRec(Vector2 point, Rectangle rec);
+
+/* ============================================================================
+ * Input
+ * ============================================================================ */
+
+bool IsKeyDown(int key);
+bool IsKeyReleased(int key);
+int GetKeyPressed(void);
+bool IsMouseButtonPressed(int button);
+bool IsMouseButtonDown(int button);
+bool IsMouseButtonReleased(int button);
+Vector2 GetMousePosition(void);
+Vector2 GetMouseDelta(void);
+float GetMouseWheelMove(void);
+
+#endif /* GM_HEADLESS_RAYLIB_H */
@@ -188,6 +188,8 @@ gm_error_t show_commit_diff(const char *commit_hash) {
         return GM_ERR_INVALID_INPUT;
     }
     
+    prefetch_diff_blobs(commit_hash, NULL);
+    
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "show --format='' \"%s\"", commit_hash);
     
@@ -314,6 +316,9 @@ gm_error_t restore_file_from_commit(const char *commit_hash, const char *file_pa
     }
     free_cmd_result(result);
     
+    /* One batched fetch instead of one lazy fetch per file in a partial clone */
+    prefetch_path_blobs(commit_hash, file_path);
+    
     /* Restore the file */
     snprintf(cmd, sizeof(cmd), "checkout \"%s\" -- \"%s\"", commit_hash, file_path);
     result = exec_git_command(cmd);
@@ -422,10 +427,15 @@ gm_error_t reset_to_commit(const char *commit_hash, const char *mode) {
     if (strcmp(reset_mode, "hard") == 0) {
         repo_status_t *status = get_repo_status();
         if (status != NULL) {
-            if (status->has_uncommitted_changes) {
-                PRINT_WARNING("Hard reset will PERMANENTLY DELETE all uncommitted changes!");
+            if (status->has_staged_changes || status->modified_files_count > 0) {
                 free_repo_status(status);
-                /* Caller should confirm before calling this function */
+                
+                char reason[MAX_COMMIT_MSG];
+                snprintf(reason, sizeof(reason), "before reset --hard %s", commit_hash);
+                if (snapshot_before(reason) != GM_SUCCESS) {
+                    PRINT_ERROR("Could not save a snapshot; reset cancelled");
+                    return GM_ERR_COMMAND_FAILED;
+                }
             } else {
                 free_repo_status(status);
             }
@@ -539,6 +549,8 @@ gm_error_t compare_commits(const char *commit1, const char *commit2) {
         return GM_ERR_INVALID_INPUT;
     }
     
+    prefetch_diff_blobs(commit1, commit2);
+    
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "diff --stat \"%s\" \"%s\"", commit1, commit2);
     
@@ -13,6 +13,7 @@
 #include <signal.h>
 #include <termios.h>
 #include <fcntl.h>
+#include <ctype.h>
 
 /* Forward declarations for daemon functions */
 extern daemon_state_t* daemon_init(config_t *config);
@@ -36,6 +37,39 @@ extern bool remote_exists(const char *name);
 static app_state_t *g_app_state = NULL;
 static volatile sig_atomic_t g_running = 1;
 
+/* ============================================================================
+ * Configuration Helpers
+ * ============================================================================ */
+
+/**
+ * Load the user's configuration if one exists
+ *
+ * Unlike config_load_or_create, this never writes a default file, so
+ * the interactive menu does not leave files behind on first use.
+ *
+ * @return config_t* Loaded configuration (free with config_free), or NULL
+ */
+static config_t* load_existing_config(void) {
+    struct stat st;
+    const char *path = config_get_default_path();
+
+    if (stat(path, &st) != 0) {
+        return NULL;
+    }
+
+    config_t *config = config_create();
+    if (config == NULL) {
+        return NULL;
+    }
+
+    if (config_load(config, path) != GM_SUCCESS) {
+        config_destroy(config);
+        return NULL;
+    }
+
+    return config;
+}
+
 /* ============================================================================
  * Signal Handlers
  * ============================================================================ */
@@ -150,6 +184,490 @@ int get_menu_choice(int min, int max) {
     return choice;
 }
 
+/**
+ * Disable a terminal control character when a shortcut is bound to it
+ *
+ * Lets e.g. a "ctrl+c" or "ctrl+z" shortcut reach the menu instead of
+ * raising a signal, while unbound keys keep their usual meaning.
+ */
+static void release_bound_control_char(const config_t *config, struct termios *raw,
+                                       int index, unsigned char c) {
+    if (config_dispatch_key(config, shortcut_code_from_terminal(&c, 1)) != ACTION_NONE) {
+        raw->c_cc[index] = _POSIX_VDISABLE;
+    }
+}
+
+/**
+ * Get a menu choice, or a configured shortcut, from the user
+ *
+ * On a terminal with a configuration loaded, keys are read raw: digits
+ * are echoed and confirmed with Enter as with get_menu_choice(), and any
+ * other key is looked up in the compiled shortcut table by key code, so
+ * a shortcut acts on the key press without a lock or string compare.
+ * Otherwise this is get_menu_choice().
+ *
+ * @param config Loaded configuration, or NULL
+ * @param min Minimum valid choice
+ * @param max Maximum valid choice
+ * @param action Output: shortcut pressed, or ACTION_NONE
+ * @return int User's choice, or -1 for invalid input or a shortcut
+ */
+static int get_menu_choice_or_shortcut(const config_t *config, int min, int max,
+                                       shortcut_action_t *action) {
+    struct termios saved, raw;
+
+    *action = ACTION_NONE;
+    if (config == NULL || !isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &saved) != 0) {
+        return get_menu_choice(min, max);
+    }
+
+    raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    release_bound_control_char(config, &raw, VINTR, 0x03);
+    release_bound_control_char(config, &raw, VQUIT, 0x1c);
+    release_bound_control_char(config, &raw, VSUSP, 0x1a);
+    if (config_dispatch_key(config, SHORTCUT_CODE(SHORTCUT_MOD_CTRL, 's')) != ACTION_NONE ||
+        config_dispatch_key(config, SHORTCUT_CODE(SHORTCUT_MOD_CTRL, 'q')) != ACTION_NONE) {
+        raw.c_iflag &= ~IXON;
+    }
+
+    printf("\n" COLOR_BOLD "Enter choice [%d-%d] or shortcut: " COLOR_RESET, min, max);
+    fflush(stdout);
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+    char input[16];
+    size_t input_len = 0;
+    bool done = false;
+
+    while (!done && g_running) {
+        unsigned char seq[8];
+        if (read(STDIN_FILENO, seq, 1) != 1) {
+            break;
+        }
+
+        size_t len = 1;
+        if (seq[0] == 0x1b) {
+            /* Pick up the rest of an escape sequence, if one follows */
+            struct termios peek = raw;
+            peek.c_cc[VMIN] = 0;
+            peek.c_cc[VTIME] = 1;
+            tcsetattr(STDIN_FILENO, TCSANOW, &peek);
+
+            ssize_t n = read(STDIN_FILENO, seq + 1, sizeof(seq) - 1);
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            if (n > 0) {
+                len += (size_t)n;
+            }
+        }
+
+        int code = shortcut_code_from_terminal(seq, len);
+
+        if (code >= '0' && code <= '9') {
+            if (input_len < sizeof(input) - 1) {
+                input[input_len++] = (char)code;
+                putchar(code);
+            }
+        } else if (code == SHORTCUT_KEY_BACKSPACE ||
+                   code == SHORTCUT_CODE(SHORTCUT_MOD_CTRL, 'h')) {
+            if (input_len > 0) {
+                input_len--;
+                printf("\b \b");
+            }
+        } else if (code == SHORTCUT_KEY_ENTER) {
+            done = true;
+        } else {
+            *action = config_dispatch_key(config, code);
+            done = (*action != ACTION_NONE);
+        }
+        fflush(stdout);
+    }
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    printf("\n");
+
+    if (*action != ACTION_NONE || input_len == 0) {
+        return -1;
+    }
+
+    input[input_len] = '\0';
+    int choice = atoi(input);
+    return (choice < min || choice > max) ? -1 : choice;
+}
+
+/**
+ * Parse a selection such as "1 3 5-9" or "a" into flags
+ *
+ * @param input Text typed by the user (numbers are 1-based)
+ * @param max Number of selectable items
+ * @param selected Output: max flags, set for chosen items
+ * @return int Number of items selected, or -1 if input is not a selection
+ */
+static int parse_selection(const char *input, int max, bool *selected) {
+    memset(selected, 0, (size_t)max * sizeof(bool));
+
+    const char *p = input;
+    while (isspace((unsigned char)*p)) p++;
+
+    if ((p[0] == 'a' || p[0] == 'A') && (p[1] == '\0' || isspace((unsigned char)p[1]))) {
+        for (int i = 0; i < max; i++) selected[i] = true;
+        return max;
+    }
+
+    int chosen = 0;
+    while (*p != '\0') {
+        if (isspace((unsigned char)*p) || *p == ',') {
+            p++;
+            continue;
+        }
+        if (!isdigit((unsigned char)*p)) {
+            return -1;
+        }
+
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        p = end;
+
+        if (*p == '-') {
+            p++;
+            if (!isdigit((unsigned char)*p)) {
+                return -1;
+            }
+            last = strtol(p, &end, 10);
+            p = end;
+        }
+
+        if (first < 1 || last > max || first > last) {
+            return -1;
+        }
+
+        for (long i = first; i <= last; i++) {
+            if (!selected[i - 1]) {
+                selected[i - 1] = true;
+                chosen++;
+            }
+        }
+    }
+
+    return chosen;
+}
+
+/* Lines of a hunk previewed before truncating */
+#define HUNK_PREVIEW_LINES 16
+
+/**
+ * Count the change ('+' or '-') lines of a hunk
+ */
+static int hunk_change_count(const patch_set_t *set, const patch_hunk_t *hunk) {
+    int changes = 0;
+    for (int i = 0; i < hunk->line_count; i++) {
+        if (set->lines[hunk->first_line + i].kind != ' ') changes++;
+    }
+    return changes;
+}
+
+/**
+ * Apply one selection token: "2" or "1-3" picks hunks, "2:4-7" picks
+ * change lines 4 to 7 of hunk 2
+ *
+ * @return bool true if the token was valid
+ */
+static bool apply_hunk_token(patch_set_t *set, const patch_file_t *file, char *token) {
+    char *colon = strchr(token, ':');
+
+    if (colon == NULL) {
+        bool *picked = (bool*)safe_calloc((size_t)file->hunk_count, sizeof(bool));
+        if (picked == NULL) return false;
+
+        int chosen = parse_selection(token, file->hunk_count, picked);
+        for (int h = 0; h < file->hunk_count && chosen > 0; h++) {
+            if (picked[h]) patch_select_hunk(set, file->first_hunk + h, true);
+        }
+        free(picked);
+        return chosen > 0;
+    }
+
+    *colon = '\0';
+    char *end;
+    long h = strtol(token, &end, 10);
+    if (*end != '\0' || h < 1 || h > file->hunk_count) {
+        return false;
+    }
+
+    const patch_hunk_t *hunk = &set->hunks[file->first_hunk + h - 1];
+    int changes = hunk_change_count(set, hunk);
+    bool *picked = (bool*)safe_calloc((size_t)changes, sizeof(bool));
+    if (picked == NULL) return false;
+
+    int chosen = parse_selection(colon + 1, changes, picked);
+    int change = 0;
+    for (int i = 0; i < hunk->line_count && chosen > 0; i++) {
+        patch_line_t *line = &set->lines[hunk->first_line + i];
+        if (line->kind == ' ') continue;
+        if (picked[change++]) line->selected = true;
+    }
+    free(picked);
+    return chosen > 0;
+}
+
+/**
+ * Stage individual hunks or lines of one file
+ */
+static void stage_hunks_interactive(void) {
+    patch_set_t set;
+    if (load_worktree_patch(NULL, &set) != GM_SUCCESS) {
+        return;
+    }
+
+    if (set.file_count == 0) {
+        PRINT_INFO("No unstaged changes");
+        free_patch_set(&set);
+        return;
+    }
+
+    printf("Changed files:\n");
+    for (int f = 0; f < set.file_count; f++) {
+        const patch_file_t *file = &set.files[f];
+        printf("  %3d. %.*s " COLOR_GREEN "+%d" COLOR_RESET " " COLOR_RED "-%d" COLOR_RESET "%s\n",
+               f + 1, (int)file->path_length, set.text + file->path_offset,
+               file->additions, file->deletions, file->is_binary ? " (binary)" : "");
+    }
+    printf("\n");
+
+    char *input = get_user_input("Select file: ", 16);
+    long f = (input != NULL) ? strtol(input, NULL, 10) : 0;
+    if (input) free(input);
+
+    if (f < 1 || f > set.file_count) {
+        PRINT_ERROR("Invalid file number");
+        free_patch_set(&set);
+        return;
+    }
+
+    const patch_file_t *file = &set.files[f - 1];
+    if (file->is_binary) {
+        PRINT_ERROR("Binary files can only be staged whole");
+        free_patch_set(&set);
+        return;
+    }
+
+    for (int h = 0; h < file->hunk_count; h++) {
+        const patch_hunk_t *hunk = &set.hunks[file->first_hunk + h];
+        printf("\n" COLOR_BOLD "[%d] " COLOR_RESET COLOR_CYAN "%.*s" COLOR_RESET "\n",
+               h + 1, (int)hunk->header_length, set.text + hunk->header_offset);
+
+        int change = 0;
+        int shown = 0;
+        for (int i = 0; i < hunk->line_count; i++) {
+            const patch_line_t *line = &set.lines[hunk->first_line + i];
+            if (line->kind != ' ') change++;
+            if (shown >= HUNK_PREVIEW_LINES) continue;
+
+            int width = line->length > 120 ? 120 : (int)line->length;
+            if (line->kind == ' ') {
+                printf("        %.*s\n", width, set.text + line->offset);
+            } else {
+                printf("  %4d %s%c%.*s" COLOR_RESET "\n", change,
+                       line->kind == '+' ? COLOR_GREEN : COLOR_RED,
+                       line->kind, width, set.text + line->offset);
+            }
+            shown++;
+        }
+        if (hunk->line_count > shown) {
+            printf(COLOR_YELLOW "  ... %d more lines (%d changes in hunk)" COLOR_RESET "\n",
+                   hunk->line_count - shown, change);
+        }
+    }
+    printf("\n");
+
+    input = get_user_input("Select hunks (e.g. 1 3, a = all) or lines (e.g. 2:4-7): ",
+                           MAX_COMMIT_MSG);
+    if (input == NULL || strlen(input) == 0) {
+        if (input) free(input);
+        free_patch_set(&set);
+        return;
+    }
+
+    bool valid = true;
+    char *save = NULL;
+    for (char *token = strtok_r(input, " \t", &save); token != NULL;
+         token = strtok_r(NULL, " \t", &save)) {
+        if (!apply_hunk_token(&set, file, token)) {
+            PRINT_ERROR("Invalid selection: %s", token);
+            valid = false;
+            break;
+        }
+    }
+    free(input);
+
+    if (valid) {
+        stage_patch_selection(&set);
+    }
+    free_patch_set(&set);
+}
+
+/* Number of finder results shown at once */
+#define FINDER_VISIBLE_ROWS 12
+
+/**
+ * Draw the fuzzy finder prompt and its top results
+ */
+static void draw_branch_finder(const branch_table_t *table, const branch_filter_t *filter,
+                               const char *query, int selected) {
+    /* Return to the saved cursor position and clear everything below */
+    printf("\0338\033[J");
+    printf(COLOR_BOLD "Switch to> " COLOR_RESET "%s\n", query);
+    printf(COLOR_CYAN "  %d/%d branches" COLOR_RESET "\n", filter->count, table->count);
+
+    int first = (selected >= FINDER_VISIBLE_ROWS) ? selected - FINDER_VISIBLE_ROWS + 1 : 0;
+    for (int i = first; i < filter->ranked && i < first + FINDER_VISIBLE_ROWS; i++) {
+        int row = filter->matches[i].index;
+        const char *name = table->names + table->offsets[row];
+
+        if (i == selected) {
+            printf(COLOR_BOLD COLOR_GREEN "> %s" COLOR_RESET, name);
+        } else {
+            printf("  %s", name);
+        }
+        if (row == table->current) {
+            printf(COLOR_YELLOW " (current)" COLOR_RESET);
+        }
+        printf("\n");
+    }
+
+    /* Park the cursor at the end of the query line */
+    printf("\0338\033[%zuC", strlen("Switch to> ") + strlen(query));
+    fflush(stdout);
+}
+
+/**
+ * Pick a branch with an incremental fuzzy finder
+ *
+ * Reads keys in raw mode and re-ranks the in-memory branch table on
+ * every keystroke. Falls back to a typed name when stdin is not a
+ * terminal.
+ *
+ * @return char* Chosen branch name (must be freed), or NULL if cancelled
+ */
+static char* pick_branch_interactive(void) {
+    if (!isatty(STDIN_FILENO)) {
+        return get_user_input("Enter branch name to switch to: ", MAX_BRANCH_NAME);
+    }
+
+    branch_table_t table;
+    if (load_branch_table(&table) != GM_SUCCESS) {
+        return NULL;
+    }
+    if (table.count == 0) {
+        PRINT_WARNING("No local branches found");
+        free_branch_table(&table);
+        return NULL;
+    }
+
+    struct termios saved, raw;
+    if (tcgetattr(STDIN_FILENO, &saved) != 0) {
+        free_branch_table(&table);
+        return get_user_input("Enter branch name to switch to: ", MAX_BRANCH_NAME);
+    }
+    raw = saved;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+    branch_filter_t filter;
+    memset(&filter, 0, sizeof(filter));
+
+    char query[MAX_BRANCH_NAME] = "";
+    size_t query_len = 0;
+    int selected = 0;
+    char *chosen = NULL;
+    bool done = false;
+
+    /* Reserve room below the prompt so scrolling cannot move the saved cursor */
+    printf(COLOR_CYAN "Type to filter, Up/Down to move, Enter to switch, Esc to cancel"
+           COLOR_RESET "\n");
+    for (int i = 0; i < FINDER_VISIBLE_ROWS + 2; i++) {
+        printf("\n");
+    }
+    printf("\033[%dA\0337", FINDER_VISIBLE_ROWS + 2);
+    branch_filter_update(&table, &filter, query);
+    draw_branch_finder(&table, &filter, query, selected);
+
+    while (!done && g_running) {
+        unsigned char c;
+        if (read(STDIN_FILENO, &c, 1) != 1) {
+            break;
+        }
+
+        bool changed = false;
+
+        if (c == '\r' || c == '\n') {
+            if (filter.count > 0) {
+                int row = filter.matches[selected].index;
+                chosen = safe_strdup(table.names + table.offsets[row]);
+            }
+            done = true;
+        } else if (c == 0x1b) {
+            /* Escape alone cancels; "ESC [ A/B" are the arrow keys */
+            struct termios peek = raw;
+            peek.c_cc[VMIN] = 0;
+            peek.c_cc[VTIME] = 1;
+            tcsetattr(STDIN_FILENO, TCSANOW, &peek);
+
+            unsigned char seq[2];
+            ssize_t n = read(STDIN_FILENO, seq, 2);
+            tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+            if (n == 2 && seq[0] == '[' && seq[1] == 'A') {
+                if (selected > 0) selected--;
+            } else if (n == 2 && seq[0] == '[' && seq[1] == 'B') {
+                if (selected + 1 < filter.ranked) selected++;
+            } else if (n <= 0) {
+                done = true;
+            }
+        } else if (c == 0x10) {         /* Ctrl-P */
+            if (selected > 0) selected--;
+        } else if (c == 0x0e) {         /* Ctrl-N */
+            if (selected + 1 < filter.ranked) selected++;
+        } else if (c == 0x03 || c == 0x07) {    /* Ctrl-C, Ctrl-G */
+            done = true;
+        } else if (c == 0x7f || c == 0x08) {
+            if (query_len > 0) {
+                query[--query_len] = '\0';
+                changed = true;
+            }
+        } else if (c == 0x15) {         /* Ctrl-U */
+            query_len = 0;
+            query[0] = '\0';
+            changed = true;
+        } else if (isprint(c) && query_len < sizeof(query) - 1) {
+            query[query_len++] = (char)c;
+            query[query_len] = '\0';
+            changed = true;
+        }
+
+        if (changed) {
+            branch_filter_update(&table, &filter, query);
+            selected = 0;
+        }
+
+        if (!done) {
+            draw_branch_finder(&table, &filter, query, selected);
+        }
+    }
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved);
+    printf("\0338\033[J\n");
+
+    free_branch_filter(&filter);
+    free_branch_table(&table);
+
+    return chosen;
+}
+
 /**
  * Display the application header
  */
@@ -241,6 +759,7 @@ void display_branch_menu(void) {
     printf("  4. " COLOR_RED "Delete Branch" COLOR_RESET "\n");
     printf("  5. " COLOR_MAGENTA "Rename Branch" COLOR_RESET "\n");
     printf("  6. " COLOR_CYAN "View Branch Details" COLOR_RESET "\n");
+    printf("  7. " COLOR_BLUE "Show Worktree Pool" COLOR_RESET "\n");
     printf("  0. " COLOR_YELLOW "Back to Main Menu" COLOR_RESET "\n");
 }
 
@@ -250,7 +769,7 @@ void display_branch_menu(void) {
 void display_commit_menu(void) {
     printf(COLOR_BOLD "\n=== Commit Management ===" COLOR_RESET "\n\n");
     printf("  1. " COLOR_GREEN "Stage All Changes" COLOR_RESET "\n");
-    printf("  2. " COLOR_GREEN "Stage Specific File" COLOR_RESET "\n");
+    printf("  2. " COLOR_GREEN "Stage Selected Files" COLOR_RESET "\n");
     printf("  3. " COLOR_CYAN "Commit Staged Changes" COLOR_RESET "\n");
     printf("  4. " COLOR_YELLOW "View Uncommitted Changes" COLOR_RESET "\n");
     printf("  5. " COLOR_YELLOW "View Diff" COLOR_RESET "\n");
@@ -258,6 +777,9 @@ void display_commit_menu(void) {
     printf("  7. " COLOR_MAGENTA "Stash Changes" COLOR_RESET "\n");
     printf("  8. " COLOR_MAGENTA "Pop Stash" COLOR_RESET "\n");
     printf("  9. " COLOR_MAGENTA "List Stash" COLOR_RESET "\n");
+    printf(" 10. " COLOR_GREEN "Stage Hunks / Lines" COLOR_RESET "\n");
+    printf(" 11. " COLOR_MAGENTA "Snapshot Changes" COLOR_RESET " (keeps the checkout as is)\n");
+    printf(" 12. " COLOR_MAGENTA "Restore Snapshot" COLOR_RESET "\n");
     printf("  0. " COLOR_YELLOW "Back to Main Menu" COLOR_RESET "\n");
 }
 
@@ -287,6 +809,12 @@ void display_remote_menu(void) {
     printf("  6. " COLOR_GREEN "Push (Set Upstream)" COLOR_RESET "\n");
     printf("  7. " COLOR_YELLOW "Pull from Remote" COLOR_RESET "\n");
     printf("  8. " COLOR_CYAN "Show Sync Status" COLOR_RESET "\n");
+    printf("  9. " COLOR_GREEN "Push All Ahead Branches" COLOR_RESET " (one atomic push)\n");
+    printf(" 10. " COLOR_CYAN "Fetch All Monitored Repos" COLOR_RESET " (in parallel)\n");
+    printf(" 11. " COLOR_GREEN "Clone Repository" COLOR_RESET " (optionally partial)\n");
+    printf(" 12. " COLOR_CYAN "Filtered Fetch" COLOR_RESET " (convert to partial clone)\n");
+    printf(" 13. " COLOR_CYAN "Sync Matrix" COLOR_RESET " (all branches x all remotes)\n");
+    printf(" 14. " COLOR_CYAN "Show Remote Changes" COLOR_RESET " (from the last fetch)\n");
     printf("  0. " COLOR_YELLOW "Back to Main Menu" COLOR_RESET "\n");
 }
 
@@ -313,7 +841,7 @@ void handle_branch_menu(void) {
         }
         
         display_branch_menu();
-        choice = get_menu_choice(0, 6);
+        choice = get_menu_choice(0, 7);
         
         printf("\n");
         
@@ -341,27 +869,22 @@ void handle_branch_menu(void) {
                 break;
                 
             case 2: /* Switch Branch */
-                /* List branches first */
-                {
-                    branch_info_t *branches = NULL;
-                    int count = 0;
+                input = pick_branch_interactive();
+                if (input != NULL && strlen(input) > 0) {
+                    config_t *config = load_existing_config();
                     
-                    if (list_branches(&branches, &count, false) == GM_SUCCESS && count > 0) {
-                        printf("Available branches:\n");
-                        for (int i = 0; i < count; i++) {
-                            printf("  %s%s%s\n", 
-                                   branches[i].is_current ? COLOR_GREEN "* " : "  ",
-                                   branches[i].name,
-                                   branches[i].is_current ? COLOR_RESET : "");
+                    if (config != NULL && config->worktree_pool.enabled) {
+                        char path[MAX_PATH_LEN];
+                        if (worktree_pool_switch(&config->worktree_pool, NULL, input,
+                                                 path, sizeof(path)) == GM_SUCCESS) {
+                            PRINT_SUCCESS("Branch '%s' is ready in a worktree", input);
+                            printf("\n  cd \"%s\"\n", path);
                         }
-                        printf("\n");
-                        free(branches);
+                    } else {
+                        switch_branch(input);
                     }
-                }
-                
-                input = get_user_input("Enter branch name to switch to: ", MAX_BRANCH_NAME);
-                if (input != NULL && strlen(input) > 0) {
-                    switch_branch(input);
+                    
+                    if (config != NULL) config_free(config);
                 }
                 if (input) { free(input); input = NULL; }
                 wait_for_enter();
@@ -443,6 +966,23 @@ void handle_branch_menu(void) {
                 wait_for_enter();
                 break;
                 
+            case 7: /* Show Worktree Pool */
+                {
+                    config_t *config = load_existing_config();
+                    
+                    if (config == NULL || !config->worktree_pool.enabled) {
+                        PRINT_INFO("The worktree pool is disabled");
+                        PRINT_INFO("Enable it under [worktree_pool] in %s",
+                                   config_get_default_path());
+                    } else {
+                        worktree_pool_show(&config->worktree_pool, NULL);
+                    }
+                    
+                    if (config != NULL) config_free(config);
+                }
+                wait_for_enter();
+                break;
+                
             default:
                 PRINT_ERROR("Invalid choice");
                 wait_for_enter();
@@ -469,7 +1009,7 @@ void handle_commit_menu(void) {
         }
         
         display_commit_menu();
-        choice = get_menu_choice(0, 9);
+        choice = get_menu_choice(0, 12);
         
         printf("\n");
         
@@ -482,24 +1022,59 @@ void handle_commit_menu(void) {
                 wait_for_enter();
                 break;
                 
-            case 2: /* Stage File */
-                /* Show unstaged files */
+            case 2: /* Stage Files */
                 {
-                    char **files = NULL;
+                    change_list_t changes;
                     int count = 0;
-                    if (get_uncommitted_changes(&files, &count) == GM_SUCCESS && count > 0) {
-                        printf("Modified files:\n");
+                    if (load_change_list(&changes, true) == GM_SUCCESS) {
+                        count = changes.count;
+                    } else {
+                        memset(&changes, 0, sizeof(changes));
+                    }
+                    
+                    if (count > 0) {
+                        printf("Changed files:\n");
                         for (int i = 0; i < count; i++) {
-                            printf("  %s\n", files[i]);
+                            const change_entry_t *entry = &changes.entries[i];
+                            printf("  %3d. " COLOR_GREEN "%c" COLOR_RED "%c" COLOR_RESET " %s",
+                                   i + 1, entry->index_state, entry->worktree_state,
+                                   changes.paths + entry->path_offset);
+                            if (entry->has_orig) {
+                                printf(" (from %s)", changes.paths + entry->orig_offset);
+                            }
+                            printf("%s\n", (entry->submodule & CHANGE_SUBMODULE) ?
+                                   " [submodule]" : "");
                         }
-                        free_string_array(files, count);
                         printf("\n");
                     }
-                }
-                
-                input = get_user_input("Enter file path to stage: ", MAX_PATH_LEN);
-                if (input != NULL && strlen(input) > 0) {
-                    stage_file(input);
+                    
+                    input = get_user_input("Select files (e.g. 1 3 5-9, a = all) or enter a path: ",
+                                           MAX_PATH_LEN);
+                    if (input != NULL && strlen(input) > 0) {
+                        bool *selected = (count > 0) ?
+                                         (bool*)safe_calloc((size_t)count, sizeof(bool)) : NULL;
+                        int chosen = (selected != NULL) ?
+                                     parse_selection(input, count, selected) : -1;
+                        
+                        if (chosen > 0) {
+                            const char **paths = (const char**)safe_malloc(
+                                                     (size_t)chosen * sizeof(char*));
+                            if (paths != NULL) {
+                                int n = 0;
+                                for (int i = 0; i < count; i++) {
+                                    if (selected[i]) {
+                                        paths[n++] = changes.paths + changes.entries[i].path_offset;
+                                    }
+                                }
+                                stage_paths(paths, n, STAGE_MODE_ADD, NULL);
+                                free(paths);
+                            }
+                        } else {
+                            stage_file(input);
+                        }
+                        free(selected);
+                    }
+                    free_change_list(&changes);
                 }
                 if (input) { free(input); input = NULL; }
                 wait_for_enter();
@@ -560,6 +1135,38 @@ void handle_commit_menu(void) {
                 wait_for_enter();
                 break;
                 
+            case 10: /* Stage Hunks / Lines */
+                stage_hunks_interactive();
+                wait_for_enter();
+                break;
+                
+            case 11: /* Snapshot Changes */
+                {
+                    input = get_user_input("Snapshot description (optional): ", MAX_COMMIT_MSG);
+                    char oid[MAX_OID_LEN];
+                    gm_error_t err = create_snapshot(input, oid, sizeof(oid));
+                    if (err == GM_SUCCESS && strlen(oid) > 0) {
+                        PRINT_SUCCESS("Saved snapshot %.7s", oid);
+                    } else if (err == GM_SUCCESS || err == GM_ERR_NO_COMMITS) {
+                        PRINT_INFO("No local changes to snapshot");
+                    }
+                }
+                if (input) { free(input); input = NULL; }
+                wait_for_enter();
+                break;
+                
+            case 12: /* Restore Snapshot */
+                if (list_snapshots() > 0) {
+                    printf("\n");
+                    input = get_user_input("Snapshot to restore (Enter to cancel): ", 16);
+                    if (input != NULL && strlen(input) > 0) {
+                        restore_snapshot(atoi(input));
+                    }
+                    if (input) { free(input); input = NULL; }
+                }
+                wait_for_enter();
+                break;
+                
             default:
                 PRINT_ERROR("Invalid choice");
                 wait_for_enter();
@@ -728,7 +1335,7 @@ void handle_remote_menu(void) {
         }
         
         display_remote_menu();
-        choice = get_menu_choice(0, 8);
+        choice = get_menu_choice(0, 14);
         
         printf("\n");
         
@@ -848,6 +1455,76 @@ void handle_remote_menu(void) {
                 wait_for_enter();
                 break;
                 
+            case 9: /* Push All Ahead Branches */
+                push_all_ahead();
+                wait_for_enter();
+                break;
+                
+            case 10: /* Fetch All Monitored Repos */
+                {
+                    config_t *config = load_existing_config();
+                    
+                    if (config == NULL || config->repo_count == 0) {
+                        PRINT_INFO("No monitored repositories");
+                        PRINT_INFO("Add them under [repos] in %s",
+                                   config_get_default_path());
+                    } else {
+                        fetch_monitored_repos(config, FETCH_DEFAULT_PARALLEL);
+                    }
+                    
+                    if (config != NULL) config_free(config);
+                }
+                wait_for_enter();
+                break;
+                
+            case 11: /* Clone Repository */
+                input = get_user_input("Repository URL or path: ", MAX_PATH_LEN);
+                if (input != NULL && strlen(input) > 0) {
+                    input2 = get_user_input("Target directory (Enter for default): ", MAX_PATH_LEN);
+                    printf("Filters: blob:none (no file contents), tree:0 (commits only), "
+                           "blob:limit=<size>\n");
+                    char *filter = get_user_input("Filter (Enter for a full clone): ", 64);
+                    clone_repository(input, input2, filter);
+                    if (filter) free(filter);
+                    if (input2) { free(input2); input2 = NULL; }
+                }
+                if (input) { free(input); input = NULL; }
+                wait_for_enter();
+                break;
+                
+            case 12: /* Filtered Fetch */
+                {
+                    char promisor[MAX_BRANCH_NAME];
+                    char current_filter[64];
+                    if (get_promisor_remote(promisor, sizeof(promisor),
+                                            current_filter, sizeof(current_filter)) == GM_SUCCESS) {
+                        PRINT_INFO("Already a partial clone of '%s' (filter %s)", promisor,
+                                   strlen(current_filter) > 0 ? current_filter : "none");
+                    }
+                }
+                input = get_user_input("Remote name (Enter for origin): ", MAX_BRANCH_NAME);
+                input2 = get_user_input("Filter (blob:none, tree:0, blob:limit=<size>): ", 64);
+                if (input2 != NULL && is_valid_filter_spec(input2)) {
+                    fetch_remote_filtered((input != NULL && strlen(input) > 0) ? input : "origin",
+                                          input2);
+                } else {
+                    PRINT_ERROR("Invalid filter");
+                }
+                if (input) { free(input); input = NULL; }
+                if (input2) { free(input2); input2 = NULL; }
+                wait_for_enter();
+                break;
+                
+            case 13: /* Sync Matrix */
+                show_sync_matrix();
+                wait_for_enter();
+                break;
+                
+            case 14: /* Show Remote Changes */
+                show_remote_changes();
+                wait_for_enter();
+                break;
+                
             default:
                 PRINT_ERROR("Invalid choice");
                 wait_for_enter();
@@ -1112,6 +1789,17 @@ void print_usage(const char *program_name) {
     printf("  --version       Show version information\n");
     printf("  --daemon        Run in background daemon mode (polls for remote changes)\n");
     printf("  --daemon-fg     Run daemon in foreground (for testing)\n");
+    printf("  --stats         Show recent activity and per-operation timings\n");
+    printf("  --serve         Answer JSON-lines requests on stdin (see README)\n");
+    printf("  --all-repos <status|fetch|ff|merge-check> [--jobs N] [--branch NAME] [PATH... | -]\n");
+    printf("                  Run an operation in many repositories (default: monitored ones)\n");
+    printf("  --socket <path> With --serve, listen on a Unix socket instead\n");
+    printf("  --worktree-switch <branch>\n");
+    printf("                  Print a pooled worktree path with <branch> checked out\n");
+    printf("\n");
+    printf("Worktree Pool:\n");
+    printf("  With [worktree_pool] enabled, switching becomes a directory change:\n");
+    printf("    gms() { cd \"$(%s --worktree-switch \"$1\")\"; }\n", program_name);
     printf("\n");
     printf("Daemon Mode:\n");
     printf("  The daemon monitors your git repositories and sends desktop notifications\n");
@@ -1218,6 +1906,279 @@ int run_daemon_mode(bool foreground) {
     return 0;
 }
 
+/**
+ * Switch through the worktree pool and print the target directory
+ *
+ * Only the path goes to stdout so the output can be fed to `cd`;
+ * progress and errors are sent to stderr.
+ */
+int run_worktree_switch(const char *branch_name) {
+    config_t *config = load_existing_config();
+    if (config == NULL) {
+        config = config_create();
+        if (config == NULL) {
+            return 1;
+        }
+    }
+
+    /* Keep stdout clean for the path */
+    fflush(stdout);
+    int saved_stdout = dup(STDOUT_FILENO);
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    char path[MAX_PATH_LEN];
+    gm_error_t err;
+
+    if (config->worktree_pool.enabled) {
+        err = worktree_pool_switch(&config->worktree_pool, NULL, branch_name,
+                                   path, sizeof(path));
+    } else {
+        /* Pool disabled: switch in place and stay where we are */
+        err = switch_branch(branch_name);
+        if (err == GM_SUCCESS) {
+            err = (getcwd(path, sizeof(path)) != NULL) ? GM_SUCCESS : GM_ERR_IO_ERROR;
+        }
+    }
+
+    fflush(stdout);
+    dup2(saved_stdout, STDOUT_FILENO);
+    close(saved_stdout);
+
+    config_free(config);
+
+    if (err != GM_SUCCESS) {
+        return 1;
+    }
+
+    printf("%s\n", path);
+    return 0;
+}
+
+/**
+ * Append a copy of a path to a growing list
+ */
+static bool add_repo_path(char ***paths, int *count, int *capacity, const char *path) {
+    if (*count == *capacity) {
+        int grown_capacity = (*capacity == 0) ? 32 : *capacity * 2;
+        char **grown = (char**)safe_realloc(*paths, (size_t)grown_capacity * sizeof(char*));
+        if (grown == NULL) {
+            return false;
+        }
+        *paths = grown;
+        *capacity = grown_capacity;
+    }
+
+    (*paths)[*count] = safe_strdup(path);
+    if ((*paths)[*count] == NULL) {
+        return false;
+    }
+    (*count)++;
+    return true;
+}
+
+/**
+ * Run one operation across many repositories
+ *
+ * Arguments: <op> [--jobs N] [--branch NAME] [PATH... | -]. Without
+ * paths the active monitored repositories are used; "-" reads one path
+ * per line from stdin.
+ */
+int run_all_repos(int argc, char *argv[]) {
+    if (argc < 1 || argv[0][0] == '-') {
+        PRINT_ERROR("--all-repos requires an operation: status, fetch, ff or merge-check");
+        return 2;
+    }
+
+    const char *op = argv[0];
+    const char *branch = NULL;
+    int jobs = 0;
+    char **paths = NULL;
+    int count = 0;
+    int capacity = 0;
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++) {
+        if (strcmp(argv[i], "--jobs") == 0 || strcmp(argv[i], "--branch") == 0) {
+            if (i + 1 >= argc) {
+                PRINT_ERROR("%s requires a value", argv[i]);
+                ok = false;
+            } else if (strcmp(argv[i], "--jobs") == 0) {
+                jobs = atoi(argv[++i]);
+            } else {
+                branch = argv[++i];
+            }
+        } else if (strcmp(argv[i], "-") == 0) {
+            char line[MAX_PATH_LEN];
+            while (ok && fgets(line, sizeof(line), stdin) != NULL) {
+                char *path = trim_whitespace(line);
+                if (path[0] != '\0' && path[0] != '#') {
+                    ok = add_repo_path(&paths, &count, &capacity, path);
+                }
+            }
+        } else {
+            ok = add_repo_path(&paths, &count, &capacity, argv[i]);
+        }
+    }
+
+    if (ok && count == 0) {
+        config_t *config = load_existing_config();
+        if (config != NULL) {
+            for (int i = 0; i < config->repo_count && ok; i++) {
+                if (config->repos[i].active) {
+                    ok = add_repo_path(&paths, &count, &capacity, config->repos[i].path);
+                }
+            }
+            config_free(config);
+        }
+        if (ok && count == 0) {
+            PRINT_ERROR("No repositories: pass paths, '-' for stdin, or add monitored repositories");
+            ok = false;
+        }
+    }
+
+    int status = ok ? fanout_run(op, branch, (const char *const *)paths, count, jobs) : 2;
+
+    free_string_array(paths, count);
+    return status;
+}
+
+/* Recent events listed by --stats */
+#define STATS_RECENT_EVENTS 20
+
+static int compare_duration(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Print the activity feed of every producer: the most recent events,
+ * then counts and latency percentiles per operation
+ */
+int run_stats(void) {
+    activity_event_t *events = NULL;
+    int count = activity_read_all(&events);
+
+    if (count < 0) {
+        PRINT_ERROR("Cannot read the activity directory");
+        return 1;
+    }
+    if (count == 0) {
+        PRINT_INFO("No activity recorded yet");
+        free(events);
+        return 0;
+    }
+
+    printf(COLOR_BOLD "Recent activity" COLOR_RESET "\n");
+    for (int i = (count > STATS_RECENT_EVENTS) ? count - STATS_RECENT_EVENTS : 0; i < count; i++) {
+        const activity_event_t *ev = &events[i];
+        time_t when = (time_t)(ev->timestamp_ms / 1000);
+        char stamp[32];
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", localtime(&when));
+
+        printf("  %s  %-7s %-16s %7u ms  %s%-10s" COLOR_RESET " %s",
+               stamp, ev->source, ev->op, ev->duration_ms,
+               ev->result == GM_SUCCESS ? COLOR_GREEN : COLOR_RED,
+               ev->result == GM_SUCCESS ? "ok" : gm_error_string((gm_error_t)ev->result),
+               ev->repo);
+        if (ev->detail[0]) printf("  (%s)", ev->detail);
+        printf("\n");
+    }
+
+    /* Group by operation: the durations of each op, sorted, give its percentiles */
+    uint32_t *durations = (uint32_t*)safe_malloc((size_t)count * sizeof(uint32_t));
+    bool *seen = (bool*)safe_calloc((size_t)count, sizeof(bool));
+    if (durations == NULL || seen == NULL) {
+        free(durations);
+        free(seen);
+        free(events);
+        return 1;
+    }
+
+    printf("\n" COLOR_BOLD "%-16s %7s %7s %9s %9s %9s" COLOR_RESET "\n",
+           "Operation", "Count", "Failed", "p50 ms", "p95 ms", "max ms");
+    for (int i = 0; i < count; i++) {
+        if (seen[i]) continue;
+
+        int n = 0;
+        int failed = 0;
+        for (int j = i; j < count; j++) {
+            if (!seen[j] && strcmp(events[j].op, events[i].op) == 0) {
+                seen[j] = true;
+                durations[n++] = events[j].duration_ms;
+                if (events[j].result != GM_SUCCESS) failed++;
+            }
+        }
+        qsort(durations, (size_t)n, sizeof(uint32_t), compare_duration);
+
+        printf("%-16s %7d %7d %9u %9u %9u\n", events[i].op, n, failed,
+               durations[(n - 1) / 2], durations[(n - 1) * 95 / 100], durations[n - 1]);
+    }
+
+    free(durations);
+    free(seen);
+    free(events);
+    return 0;
+}
+
+/**
+ * Run the action bound to a shortcut from the main menu
+ *
+ * Actions that need further input open the menu that asks for it.
+ */
+static void run_shortcut_action(shortcut_action_t action) {
+    printf("\n");
+
+    switch (action) {
+        case ACTION_STATUS:         show_status(); break;
+        case ACTION_STAGE_ALL:      stage_all_changes(); break;
+        case ACTION_PUSH:           push_branch(NULL, NULL, false); break;
+        case ACTION_PULL:           pull_branch(NULL, NULL); break;
+        case ACTION_FETCH:          fetch_all(); break;
+        case ACTION_STASH:          stash_changes(NULL); break;
+        case ACTION_STASH_POP:      pop_stash(); break;
+        case ACTION_LOG:            show_log(20); break;
+        case ACTION_DIFF:           show_diff(false); break;
+        case ACTION_DIFF_STAGED:    show_diff(true); break;
+        case ACTION_REFLOG:         show_reflog(15); break;
+
+        case ACTION_COMMIT:
+            handle_commit_menu();
+            return;
+
+        case ACTION_BRANCH_LIST:
+        case ACTION_BRANCH_CREATE:
+        case ACTION_BRANCH_SWITCH:
+        case ACTION_BRANCH_DELETE:
+            handle_branch_menu();
+            return;
+
+        case ACTION_MERGE:
+            handle_merge_menu();
+            return;
+
+        case ACTION_REVERT:
+        case ACTION_RESET_SOFT:
+        case ACTION_RESET_HARD:
+        case ACTION_CHERRY_PICK:
+            handle_history_menu();
+            return;
+
+        case ACTION_OPEN_GUI:
+            PRINT_INFO("The GUI is a separate build: run git_master_gui (make gui)");
+            break;
+
+        case ACTION_QUIT:
+            g_running = 0;
+            return;
+
+        default:
+            return;
+    }
+
+    wait_for_enter();
+}
+
 /**
  * Main entry point
  */
@@ -1225,6 +2186,10 @@ int main(int argc, char *argv[]) {
     bool verbose = false;
     bool daemon_mode = false;
     bool daemon_foreground = false;
+    const char *worktree_branch = NULL;
+    bool show_stats = false;
+    bool serve = false;
+    const char *socket_path = NULL;
     
     /* Parse command line arguments */
     for (int i = 1; i < argc; i++) {
@@ -1247,6 +2212,41 @@ int main(int argc, char *argv[]) {
             daemon_mode = true;
             daemon_foreground = true;
         }
+        if (strcmp(argv[i], "--stats") == 0) {
+            show_stats = true;
+        }
+        if (strcmp(argv[i], "--all-repos") == 0) {
+            return run_all_repos(argc - i - 1, argv + i + 1);
+        }
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve = true;
+        }
+        if (strcmp(argv[i], "--socket") == 0) {
+            if (i + 1 >= argc) {
+                PRINT_ERROR("--socket requires a path");
+                return 1;
+            }
+            socket_path = argv[++i];
+        }
+        if (strcmp(argv[i], "--worktree-switch") == 0) {
+            if (i + 1 >= argc) {
+                PRINT_ERROR("--worktree-switch requires a branch name");
+                return 1;
+            }
+            worktree_branch = argv[++i];
+        }
+    }
+    
+    if (worktree_branch != NULL) {
+        return run_worktree_switch(worktree_branch);
+    }
+    
+    if (show_stats) {
+        return run_stats();
+    }
+    
+    if (serve) {
+        return serve_run(socket_path) == GM_SUCCESS ? 0 : 1;
     }
     
     /* Set up signal handlers */
@@ -1292,8 +2292,15 @@ int main(int argc, char *argv[]) {
         }
     }
     
+    /* Shortcuts are compiled at load; key presses index the table directly */
+    config_t *config = load_existing_config();
+    
     /* Main menu loop */
     while (g_running) {
+        if (config != NULL) {
+            config_reload_if_changed(config);
+        }
+        
         clear_screen();
         display_header();
         
@@ -1305,7 +2312,13 @@ int main(int argc, char *argv[]) {
         }
         
         display_main_menu();
-        int choice = get_menu_choice(0, 7);
+        shortcut_action_t action;
+        int choice = get_menu_choice_or_shortcut(config, 0, 7, &action);
+        
+        if (action != ACTION_NONE) {
+            run_shortcut_action(action);
+            continue;
+        }
         
         switch (choice) {
             case 0:
@@ -1354,6 +2367,9 @@ int main(int argc, char *argv[]) {
     clear_screen();
     printf(COLOR_GREEN "\nThank you for using Git Master!\n" COLOR_RESET);
     
+    if (config != NULL) {
+        config_free(config);
+    }
     cleanup_app_state(g_app_state);
     
     return 0;
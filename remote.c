@@ -6,6 +6,419 @@
  */
 
 #include "git_master.h"
+#include <stdint.h>
+#include <strings.h>
+
+/* ============================================================================
+ * Remote State Cache
+ * ============================================================================ */
+
+/* Per-remote state kept between runs, under the common git dir */
+#define REMOTE_STATE_DIR "git-master/remotes"
+
+/**
+ * State file of a remote; '/' in remote names is escaped
+ */
+static void remote_state_path(const char *common_dir, const char *remote, char *path, size_t len) {
+    size_t out = (size_t)snprintf(path, len, "%s/" REMOTE_STATE_DIR "/", common_dir);
+    for (const char *p = remote; *p != '\0' && out + 4 < len; p++) {
+        if (*p == '/' || *p == '%') {
+            out += (size_t)snprintf(path + out, len - out, "%%%02X", (unsigned char)*p);
+        } else {
+            path[out++] = *p;
+        }
+    }
+    path[out < len ? out : len - 1] = '\0';
+}
+
+static const char *ref_change_names[] = { "created", "updated", "forced", "deleted" };
+
+/**
+ * Read a remote's saved state: the refs seen at the last fetch and
+ * the delta that fetch produced
+ */
+static gm_error_t read_remote_state(const char *remote, ref_entry_t **refs, int *ref_count,
+                                    ref_delta_t **delta, int *delta_count, time_t *fetched_at) {
+    *refs = NULL;
+    *ref_count = 0;
+    *delta = NULL;
+    *delta_count = 0;
+    *fetched_at = 0;
+    
+    char common_dir[MAX_PATH_LEN];
+    gm_error_t err = find_common_dir(common_dir, sizeof(common_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    char path[2 * MAX_PATH_LEN];
+    remote_state_path(common_dir, remote, path, sizeof(path));
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return GM_ERR_REMOTE_NOT_FOUND;     /* Never recorded */
+    }
+    
+    int ref_capacity = 0;
+    int delta_capacity = 0;
+    char line[MAX_PATH_LEN];
+    
+    while (fgets(line, sizeof(line), fp) != NULL && err == GM_SUCCESS) {
+        line[strcspn(line, "\n")] = '\0';
+        char a[MAX_OID_LEN], b[MAX_OID_LEN], kind[16], name[MAX_BRANCH_NAME];
+        long long stamp;
+        
+        if (sscanf(line, "fetched %lld", &stamp) == 1) {
+            *fetched_at = (time_t)stamp;
+        } else if (sscanf(line, "ref %64s %255s", a, name) == 2) {
+            if (*ref_count == ref_capacity) {
+                ref_capacity = (ref_capacity == 0) ? 64 : ref_capacity * 2;
+                ref_entry_t *grown = (ref_entry_t*)safe_realloc(*refs,
+                                                                (size_t)ref_capacity * sizeof(ref_entry_t));
+                if (grown == NULL) { err = GM_ERR_MEMORY_ALLOC; break; }
+                *refs = grown;
+            }
+            snprintf((*refs)[*ref_count].oid, MAX_OID_LEN, "%s", a);
+            snprintf((*refs)[*ref_count].name, MAX_BRANCH_NAME, "%s", name);
+            (*ref_count)++;
+        } else if (sscanf(line, "delta %15s %64s %64s %255s", kind, a, b, name) == 4) {
+            if (*delta_count == delta_capacity) {
+                delta_capacity = (delta_capacity == 0) ? 16 : delta_capacity * 2;
+                ref_delta_t *grown = (ref_delta_t*)safe_realloc(*delta,
+                                                                (size_t)delta_capacity * sizeof(ref_delta_t));
+                if (grown == NULL) { err = GM_ERR_MEMORY_ALLOC; break; }
+                *delta = grown;
+            }
+            ref_delta_t *d = &(*delta)[(*delta_count)++];
+            memset(d, 0, sizeof(*d));
+            for (int k = 0; k < 4; k++) {
+                if (strcmp(kind, ref_change_names[k]) == 0) d->change = (ref_change_t)k;
+            }
+            snprintf(d->old_oid, MAX_OID_LEN, "%s", strcmp(a, "-") == 0 ? "" : a);
+            snprintf(d->new_oid, MAX_OID_LEN, "%s", strcmp(b, "-") == 0 ? "" : b);
+            snprintf(d->refname, MAX_BRANCH_NAME, "%s", name);
+        }
+    }
+    
+    fclose(fp);
+    if (err != GM_SUCCESS) {
+        free(*refs);
+        free(*delta);
+        *refs = NULL;
+        *delta = NULL;
+        *ref_count = 0;
+        *delta_count = 0;
+    }
+    return err;
+}
+
+/**
+ * Write a remote's state file atomically
+ */
+static gm_error_t write_remote_state(const char *remote, const ref_entry_t *refs, int ref_count,
+                                     const ref_delta_t *delta, int delta_count) {
+    char common_dir[MAX_PATH_LEN];
+    gm_error_t err = find_common_dir(common_dir, sizeof(common_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    char dir[MAX_PATH_LEN + 32];
+    snprintf(dir, sizeof(dir), "%s/git-master", common_dir);
+    mkdir(dir, 0755);
+    snprintf(dir, sizeof(dir), "%s/" REMOTE_STATE_DIR, common_dir);
+    mkdir(dir, 0755);
+    
+    char path[2 * MAX_PATH_LEN];
+    char tmp_path[2 * MAX_PATH_LEN + 8];
+    remote_state_path(common_dir, remote, path, sizeof(path));
+    snprintf(tmp_path, sizeof(tmp_path), "%s.lock", path);
+    
+    FILE *fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        return GM_ERR_IO_ERROR;
+    }
+    
+    fprintf(fp, "fetched %lld\n", (long long)time(NULL));
+    for (int i = 0; i < ref_count; i++) {
+        fprintf(fp, "ref %s %s\n", refs[i].oid, refs[i].name);
+    }
+    for (int i = 0; i < delta_count; i++) {
+        fprintf(fp, "delta %s %s %s %s\n", ref_change_names[delta[i].change],
+                delta[i].old_oid[0] ? delta[i].old_oid : "-",
+                delta[i].new_oid[0] ? delta[i].new_oid : "-", delta[i].refname);
+    }
+    
+    bool ok = (fclose(fp) == 0);
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return GM_ERR_IO_ERROR;
+    }
+    return GM_SUCCESS;
+}
+
+static bool append_delta(ref_delta_t **delta, int *count, int *capacity, ref_change_t change,
+                         const char *refname, const char *old_oid, const char *new_oid) {
+    if (*count == *capacity) {
+        int new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        ref_delta_t *grown = (ref_delta_t*)safe_realloc(*delta, (size_t)new_capacity * sizeof(ref_delta_t));
+        if (grown == NULL) {
+            return false;
+        }
+        *delta = grown;
+        *capacity = new_capacity;
+    }
+    ref_delta_t *d = &(*delta)[(*count)++];
+    d->change = change;
+    snprintf(d->refname, sizeof(d->refname), "%s", refname);
+    snprintf(d->old_oid, sizeof(d->old_oid), "%s", old_oid);
+    snprintf(d->new_oid, sizeof(d->new_oid), "%s", new_oid);
+    return true;
+}
+
+/**
+ * Record what a remote's refs look like after a fetch and how they
+ * moved since the last recorded fetch
+ * 
+ * Refs are read from the ref store directly; forced updates are told
+ * apart from fast-forwards with one ahead/behind walk for all of them.
+ * The first call for a remote only records a baseline.
+ * 
+ * @param remote Remote name
+ * @param delta Output: changes (must be freed; may be NULL if unwanted)
+ * @param count Output: number of changes (may be NULL)
+ * @return gm_error_t Error code
+ */
+gm_error_t update_remote_state(const char *remote, ref_delta_t **delta, int *count) {
+    if (remote == NULL || strlen(remote) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    if (delta != NULL) *delta = NULL;
+    if (count != NULL) *count = 0;
+    
+    char prefix[MAX_BRANCH_NAME + 16];
+    snprintf(prefix, sizeof(prefix), "refs/remotes/%s/", remote);
+    
+    ref_entry_t *current = NULL;
+    int current_count = 0;
+    gm_error_t err = read_refs(prefix, &current, &current_count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    ref_entry_t *previous = NULL;
+    int previous_count = 0;
+    ref_delta_t *old_delta = NULL;
+    int old_delta_count = 0;
+    time_t fetched_at = 0;
+    bool baseline = (read_remote_state(remote, &previous, &previous_count,
+                                       &old_delta, &old_delta_count, &fetched_at) != GM_SUCCESS);
+    free(old_delta);
+    
+    ref_delta_t *changes = NULL;
+    int change_count = 0;
+    int change_capacity = 0;
+    size_t prefix_len = strlen(prefix);
+    
+    /* Both lists are sorted by name: merge them */
+    int i = 0, j = 0;
+    while (!baseline && (i < previous_count || j < current_count)) {
+        int cmp = (i >= previous_count) ? 1 : (j >= current_count) ? -1
+                : strcmp(previous[i].name, current[j].name);
+        bool ok = true;
+        
+        if (cmp < 0) {
+            ok = append_delta(&changes, &change_count, &change_capacity, REF_DELETED,
+                              previous[i].name + prefix_len, previous[i].oid, "");
+            i++;
+        } else if (cmp > 0) {
+            ok = append_delta(&changes, &change_count, &change_capacity, REF_CREATED,
+                              current[j].name + prefix_len, "", current[j].oid);
+            j++;
+        } else {
+            if (strcmp(previous[i].oid, current[j].oid) != 0) {
+                ok = append_delta(&changes, &change_count, &change_capacity, REF_UPDATED,
+                                  current[j].name + prefix_len, previous[i].oid, current[j].oid);
+            }
+            i++;
+            j++;
+        }
+        
+        if (!ok) {
+            err = GM_ERR_MEMORY_ALLOC;
+            break;
+        }
+    }
+    
+    /* An update is forced when the old tip is not contained in the new one */
+    int updated = 0;
+    for (int k = 0; k < change_count; k++) {
+        if (changes[k].change == REF_UPDATED) updated++;
+    }
+    if (err == GM_SUCCESS && updated > 0) {
+        ahead_behind_t *pairs = (ahead_behind_t*)safe_calloc((size_t)updated, sizeof(ahead_behind_t));
+        if (pairs != NULL) {
+            int p = 0;
+            for (int k = 0; k < change_count; k++) {
+                if (changes[k].change != REF_UPDATED) continue;
+                snprintf(pairs[p].left, MAX_OID_LEN, "%s", changes[k].new_oid);
+                snprintf(pairs[p].right, MAX_OID_LEN, "%s", changes[k].old_oid);
+                p++;
+            }
+            if (compute_ahead_behind(pairs, updated) == GM_SUCCESS) {
+                p = 0;
+                for (int k = 0; k < change_count; k++) {
+                    if (changes[k].change != REF_UPDATED) continue;
+                    if (pairs[p++].behind > 0) changes[k].change = REF_FORCED;
+                }
+            }
+            free(pairs);
+        }
+    }
+    
+    if (err == GM_SUCCESS) {
+        err = write_remote_state(remote, current, current_count, changes, change_count);
+    }
+    
+    free(current);
+    free(previous);
+    
+    if (err == GM_SUCCESS && delta != NULL && count != NULL) {
+        *delta = changes;
+        *count = change_count;
+    } else {
+        free(changes);
+    }
+    return err;
+}
+
+/**
+ * Load the delta recorded by a remote's last fetch, without touching
+ * the network or spawning git
+ * 
+ * @param remote Remote name
+ * @param delta Output: changes (must be freed)
+ * @param count Output: number of changes
+ * @param fetched_at Output: when that fetch was recorded (0 if never)
+ * @return gm_error_t GM_ERR_REMOTE_NOT_FOUND if nothing was recorded
+ */
+gm_error_t load_remote_delta(const char *remote, ref_delta_t **delta, int *count, time_t *fetched_at) {
+    if (remote == NULL || delta == NULL || count == NULL || fetched_at == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    ref_entry_t *refs = NULL;
+    int ref_count = 0;
+    gm_error_t err = read_remote_state(remote, &refs, &ref_count, delta, count, fetched_at);
+    free(refs);
+    return err;
+}
+
+/**
+ * One-line summary of a ref delta, e.g. "2 updated, 1 new"
+ * 
+ * @param delta Changes
+ * @param count Number of changes
+ * @param buf Output buffer ("no changes" when count is 0)
+ * @param len Size of buf
+ */
+void summarize_ref_delta(const ref_delta_t *delta, int count, char *buf, size_t len) {
+    int totals[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < count; i++) {
+        totals[delta[i].change]++;
+    }
+    
+    static const char *labels[] = { "new", "updated", "forced", "deleted" };
+    size_t used = 0;
+    buf[0] = '\0';
+    
+    for (int k = 0; k < 4; k++) {
+        if (totals[k] == 0 || used >= len) continue;
+        used += (size_t)snprintf(buf + used, len - used, "%s%d %s",
+                                 used > 0 ? ", " : "", totals[k], labels[k]);
+    }
+    
+    if (count == 0) {
+        snprintf(buf, len, "no changes");
+    }
+}
+
+/**
+ * Print a ref delta, one line per ref
+ * 
+ * @param remote Remote name
+ * @param delta Changes
+ * @param count Number of changes
+ */
+void print_ref_delta(const char *remote, const ref_delta_t *delta, int count) {
+    for (int i = 0; i < count; i++) {
+        const ref_delta_t *d = &delta[i];
+        switch (d->change) {
+            case REF_CREATED:
+                printf(COLOR_GREEN "  * [new]     " COLOR_RESET "%s/%s -> %.7s\n",
+                       remote, d->refname, d->new_oid);
+                break;
+            case REF_UPDATED:
+                printf(COLOR_CYAN "    updated   " COLOR_RESET "%s/%s %.7s..%.7s\n",
+                       remote, d->refname, d->old_oid, d->new_oid);
+                break;
+            case REF_FORCED:
+                printf(COLOR_YELLOW "  + forced    " COLOR_RESET "%s/%s %.7s...%.7s\n",
+                       remote, d->refname, d->old_oid, d->new_oid);
+                break;
+            case REF_DELETED:
+                printf(COLOR_RED "  - [deleted] " COLOR_RESET "%s/%s (was %.7s)\n",
+                       remote, d->refname, d->old_oid);
+                break;
+        }
+    }
+}
+
+/**
+ * Show what each remote's last recorded fetch changed
+ * 
+ * @return gm_error_t Error code
+ */
+gm_error_t show_remote_changes(void) {
+    char **remotes = NULL;
+    int remote_count = 0;
+    
+    gm_error_t err = list_remotes(&remotes, &remote_count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    if (remote_count == 0) {
+        PRINT_INFO("No remotes configured");
+        return GM_SUCCESS;
+    }
+    
+    printf("\n" COLOR_BOLD "Changes from the last fetch:" COLOR_RESET "\n\n");
+    
+    for (int r = 0; r < remote_count; r++) {
+        ref_delta_t *delta = NULL;
+        int count = 0;
+        time_t fetched_at = 0;
+        
+        if (load_remote_delta(remotes[r], &delta, &count, &fetched_at) != GM_SUCCESS) {
+            printf("  " COLOR_BOLD "%s" COLOR_RESET ": not fetched by git-master yet\n", remotes[r]);
+            continue;
+        }
+        
+        char summary[128];
+        char when[64];
+        summarize_ref_delta(delta, count, summary, sizeof(summary));
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M", localtime(&fetched_at));
+        
+        printf("  " COLOR_BOLD "%s" COLOR_RESET " (fetched %s): %s\n", remotes[r], when, summary);
+        print_ref_delta(remotes[r], delta, count);
+        free(delta);
+    }
+    
+    printf("\n");
+    free_string_array(remotes, remote_count);
+    return GM_SUCCESS;
+}
 
 /* ============================================================================
  * Remote Management Functions
@@ -26,6 +439,10 @@ gm_error_t list_remotes(char ***remotes, int *count) {
     *remotes = NULL;
     *count = 0;
     
+    if (git_config_list_remotes(remotes, count) == GM_SUCCESS) {
+        return GM_SUCCESS;
+    }
+    
     cmd_result_t *result = exec_git_command("remote");
     
     if (result == NULL) {
@@ -211,6 +628,11 @@ gm_error_t get_remote_url(const char *name, char *url, size_t max_len) {
         return GM_ERR_INVALID_INPUT;
     }
     
+    gm_error_t err = git_config_remote_url(name, url, max_len);
+    if (err != GM_ERR_IO_ERROR) {
+        return err;
+    }
+    
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "remote get-url \"%s\"", name);
     
@@ -283,7 +705,15 @@ gm_error_t fetch_remote(const char *remote_name) {
         return GM_ERR_REMOTE_NOT_FOUND;
     }
     
-    PRINT_INFO("Fetching from '%s'...", remote_name);
+    /* git applies a promisor remote's partialclonefilter on its own */
+    char promisor[MAX_BRANCH_NAME];
+    char filter[64];
+    if (get_promisor_remote(promisor, sizeof(promisor), filter, sizeof(filter)) == GM_SUCCESS &&
+        strcmp(promisor, remote_name) == 0 && strlen(filter) > 0) {
+        PRINT_INFO("Fetching from '%s' (partial clone, filter %s)...", remote_name, filter);
+    } else {
+        PRINT_INFO("Fetching from '%s'...", remote_name);
+    }
     
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "fetch \"%s\"", remote_name);
@@ -314,93 +744,192 @@ gm_error_t fetch_remote(const char *remote_name) {
     free_cmd_result(result);
     PRINT_SUCCESS("Fetched from '%s'", remote_name);
     
+    ref_delta_t *delta = NULL;
+    int delta_count = 0;
+    if (update_remote_state(remote_name, &delta, &delta_count) == GM_SUCCESS) {
+        print_ref_delta(remote_name, delta, delta_count);
+        free(delta);
+    }
+    
     return GM_SUCCESS;
 }
 
 /**
  * Fetch from all remotes
  * 
+ * Remotes are fetched in parallel with a combined progress display.
+ * 
  * @return gm_error_t Error code
  */
 gm_error_t fetch_all(void) {
     PRINT_INFO("Fetching from all remotes...");
     
-    cmd_result_t *result = exec_git_command("fetch --all");
+    const char *repo = NULL;
+    fetch_result_t *results = NULL;
+    int count = 0;
     
-    if (result == NULL) {
-        return GM_ERR_COMMAND_FAILED;
-    }
+    gm_error_t err = fetch_parallel(&repo, 1, FETCH_DEFAULT_PARALLEL, true, &results, &count);
     
-    if (result->exit_code != 0) {
-        if (result->error != NULL && strlen(result->error) > 0) {
-            PRINT_ERROR("Fetch failed: %s", result->error);
+    for (int i = 0; i < count; i++) {
+        ref_delta_t *delta = NULL;
+        int delta_count = 0;
+        if (results[i].success &&
+            update_remote_state(results[i].remote, &delta, &delta_count) == GM_SUCCESS) {
+            print_ref_delta(results[i].remote, delta, delta_count);
+            free(delta);
         }
-        free_cmd_result(result);
+    }
+    free(results);
+    
+    if (err != GM_SUCCESS) {
+        PRINT_ERROR("Fetch failed for one or more remotes");
         return GM_ERR_COMMAND_FAILED;
     }
     
-    free_cmd_result(result);
+    if (count == 0) {
+        PRINT_INFO("No remotes configured");
+        return GM_SUCCESS;
+    }
+    
     PRINT_SUCCESS("Fetched from all remotes");
     
     return GM_SUCCESS;
 }
 
 /* ============================================================================
- * Push Functions
+ * Partial Clone Functions
  * ============================================================================ */
 
+/* Upload-pack that accepts filters, for local remotes not configured to */
+#define FILTERED_UPLOAD_PACK "git -c uploadpack.allowFilter=true upload-pack"
+
 /**
- * Push a branch to a remote
+ * Check a partial clone filter spec
  * 
- * @param remote Remote name (NULL for default 'origin')
- * @param branch Branch name (NULL for current branch)
- * @param set_upstream Set upstream tracking
- * @return gm_error_t Error code
+ * Accepts "blob:none", "tree:<depth>" and "blob:limit=<n>[k|m|g]".
+ * 
+ * @param spec Filter spec
+ * @return bool True if git will accept the spec
  */
-gm_error_t push_branch(const char *remote, const char *branch, bool set_upstream) {
-    char remote_name[MAX_BRANCH_NAME] = "origin";
-    char branch_name[MAX_BRANCH_NAME];
-    
-    /* Use provided remote or default to origin */
-    if (remote != NULL && strlen(remote) > 0) {
-        strncpy(remote_name, remote, sizeof(remote_name) - 1);
-        remote_name[sizeof(remote_name) - 1] = '\0';
+bool is_valid_filter_spec(const char *spec) {
+    if (spec == NULL) {
+        return false;
     }
     
-    /* Use provided branch or current branch */
-    if (branch != NULL && strlen(branch) > 0) {
-        strncpy(branch_name, branch, sizeof(branch_name) - 1);
-        branch_name[sizeof(branch_name) - 1] = '\0';
+    const char *digits = NULL;
+    if (strcmp(spec, "blob:none") == 0) {
+        return true;
+    } else if (strncmp(spec, "tree:", 5) == 0) {
+        digits = spec + 5;
+    } else if (strncmp(spec, "blob:limit=", 11) == 0) {
+        digits = spec + 11;
     } else {
-        if (get_current_branch(branch_name, sizeof(branch_name)) != GM_SUCCESS) {
-            return GM_ERR_COMMAND_FAILED;
-        }
+        return false;
     }
     
-    /* Check if remote exists */
-    if (!remote_exists(remote_name)) {
-        PRINT_ERROR("Remote '%s' does not exist", remote_name);
-        PRINT_INFO("Use 'Add Remote' to configure a remote first");
-        return GM_ERR_REMOTE_NOT_FOUND;
+    size_t n = strspn(digits, "0123456789");
+    if (n == 0) {
+        return false;
+    }
+    if (digits[n] == '\0') {
+        return true;
+    }
+    /* Only blob:limit takes a unit suffix */
+    return digits != spec + 5 && strchr("kKmMgG", digits[n]) != NULL && digits[n + 1] == '\0';
+}
+
+/**
+ * Map a remote URL to a local repository path, if it is one
+ */
+static bool local_remote_path(const char *url, char *path, size_t len) {
+    if (strncmp(url, "file://", 7) == 0) {
+        snprintf(path, len, "%s", url + 7);
+        return true;
     }
     
-    /* Check for uncommitted changes */
-    repo_status_t *status = get_repo_status();
-    if (status != NULL) {
-        if (status->has_uncommitted_changes) {
-            PRINT_WARNING("You have uncommitted changes");
-            PRINT_INFO("Consider committing before pushing");
-        }
-        free_repo_status(status);
+    struct stat st;
+    if (strstr(url, "://") == NULL && stat(url, &st) == 0 && S_ISDIR(st.st_mode)) {
+        snprintf(path, len, "%s", url);
+        return true;
     }
+    return false;
+}
+
+/**
+ * Whether a local repository's upload-pack already serves filters
+ */
+static bool local_allows_filter(const char *path) {
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "-C \"%s\" config --bool uploadpack.allowFilter", path);
     
-    PRINT_INFO("Pushing '%s' to '%s'...", branch_name, remote_name);
+    cmd_result_t *result = exec_git_command(cmd);
+    bool allowed = (result != NULL && result->exit_code == 0 && result->output != NULL &&
+                    strcmp(trim_whitespace(result->output), "true") == 0);
+    if (result) free_cmd_result(result);
+    return allowed;
+}
+
+/**
+ * Clone a repository, optionally as a partial clone
+ * 
+ * Local paths are cloned over file:// so the filter is honored, and
+ * when the source does not set uploadpack.allowFilter the clone is
+ * served (and its later lazy fetches configured) with an upload-pack
+ * that does.
+ * 
+ * @param url Repository URL or local path
+ * @param directory Target directory (NULL or empty for git's default)
+ * @param filter Filter spec (NULL or empty for a full clone)
+ * @return gm_error_t Error code
+ */
+gm_error_t clone_repository(const char *url, const char *directory, const char *filter) {
+    if (url == NULL || strlen(url) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    bool partial = (filter != NULL && strlen(filter) > 0);
+    if (partial && !is_valid_filter_spec(filter)) {
+        PRINT_ERROR("Invalid filter '%s' (use blob:none, tree:0 or blob:limit=<size>)", filter);
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char source[MAX_PATH_LEN + 8];
+    char local_path[MAX_PATH_LEN];
+    char filter_opts[MAX_COMMAND_LEN / 2] = "";
+    snprintf(source, sizeof(source), "%s", url);
+    
+    if (partial) {
+        int n = snprintf(filter_opts, sizeof(filter_opts), "--filter=%s", filter);
+        
+        if (local_remote_path(url, local_path, sizeof(local_path))) {
+            char absolute[MAX_PATH_LEN];
+            if (realpath(local_path, absolute) == NULL) {
+                PRINT_ERROR("Repository '%s' not found", url);
+                return GM_ERR_IO_ERROR;
+            }
+            snprintf(source, sizeof(source), "file://%s", absolute);
+            
+            if (!local_allows_filter(absolute)) {
+                snprintf(filter_opts + n, sizeof(filter_opts) - (size_t)n,
+                         " --upload-pack=\"%s\" --config remote.origin.uploadpack=\"%s\"",
+                         FILTERED_UPLOAD_PACK, FILTERED_UPLOAD_PACK);
+            }
+        }
+    }
     
     char cmd[MAX_COMMAND_LEN];
-    if (set_upstream) {
-        snprintf(cmd, sizeof(cmd), "push -u \"%s\" \"%s\"", remote_name, branch_name);
+    int written = snprintf(cmd, sizeof(cmd), "clone %s \"%s\"", filter_opts, source);
+    if (directory != NULL && strlen(directory) > 0 && written > 0 && (size_t)written < sizeof(cmd)) {
+        written += snprintf(cmd + written, sizeof(cmd) - (size_t)written, " \"%s\"", directory);
+    }
+    if (written < 0 || (size_t)written >= sizeof(cmd)) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    if (partial) {
+        PRINT_INFO("Cloning '%s' with filter %s...", url, filter);
     } else {
-        snprintf(cmd, sizeof(cmd), "push \"%s\" \"%s\"", remote_name, branch_name);
+        PRINT_INFO("Cloning '%s'...", url);
     }
     
     cmd_result_t *result = exec_git_command(cmd);
@@ -411,30 +940,385 @@ gm_error_t push_branch(const char *remote, const char *branch, bool set_upstream
     
     if (result->exit_code != 0) {
         if (result->error != NULL && strlen(result->error) > 0) {
-            /* Analyze error */
-            if (strstr(result->error, "rejected") != NULL) {
-                PRINT_ERROR("Push rejected - remote has newer changes");
-                PRINT_INFO("Pull the latest changes first, or use force push (dangerous!)");
-                free_cmd_result(result);
-                return GM_ERR_PUSH_FAILED;
-            }
-            
-            if (strstr(result->error, "Could not resolve") != NULL ||
-                strstr(result->error, "unable to access") != NULL) {
-                PRINT_ERROR("Network error: Unable to reach remote '%s'", remote_name);
-                free_cmd_result(result);
-                return GM_ERR_PUSH_FAILED;
-            }
-            
-            if (strstr(result->error, "Authentication") != NULL ||
-                strstr(result->error, "Permission denied") != NULL ||
-                strstr(result->error, "denied") != NULL) {
-                PRINT_ERROR("Authentication failed for remote '%s'", remote_name);
-                PRINT_INFO("Check your credentials or SSH keys");
-                free_cmd_result(result);
-                return GM_ERR_PUSH_FAILED;
-            }
-            
+            PRINT_ERROR("Clone failed: %s", trim_whitespace(result->error));
+        }
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (partial && result->error != NULL && strstr(result->error, "filtering not recognized") != NULL) {
+        PRINT_WARNING("The server does not support filters; a full clone was made");
+    }
+    
+    free_cmd_result(result);
+    PRINT_SUCCESS("Cloned '%s'", url);
+    
+    return GM_SUCCESS;
+}
+
+/**
+ * Find the promisor remote of a partial clone
+ * 
+ * @param remote Output: remote name
+ * @param remote_len Size of remote
+ * @param filter Output: its partialclonefilter (may be empty); may be NULL
+ * @param filter_len Size of filter
+ * @return gm_error_t GM_ERR_REMOTE_NOT_FOUND if this is not a partial clone
+ */
+gm_error_t get_promisor_remote(char *remote, size_t remote_len, char *filter, size_t filter_len) {
+    if (remote == NULL || remote_len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    remote[0] = '\0';
+    if (filter != NULL && filter_len > 0) {
+        filter[0] = '\0';
+    }
+    
+    char **remotes = NULL;
+    int count = 0;
+    gm_error_t err = git_config_list_remotes(&remotes, &count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    /* extensions.partialClone names the remote of clones made by older git */
+    git_config_get("extensions.partialclone", remote, remote_len);
+    
+    char key[MAX_BRANCH_NAME + 32];
+    for (int i = 0; i < count && remote[0] == '\0'; i++) {
+        snprintf(key, sizeof(key), "remote.%s.promisor", remotes[i]);
+        if (git_config_get_bool(key, false)) {
+            snprintf(remote, remote_len, "%s", remotes[i]);
+        }
+    }
+    free_string_array(remotes, count);
+    
+    if (remote[0] != '\0' && filter != NULL && filter_len > 0) {
+        snprintf(key, sizeof(key), "remote.%s.partialclonefilter", remote);
+        git_config_get(key, filter, filter_len);
+    }
+    
+    return (remote[0] != '\0') ? GM_SUCCESS : GM_ERR_REMOTE_NOT_FOUND;
+}
+
+/**
+ * Fetch from a remote with a filter, making it a promisor remote
+ * 
+ * @param remote_name Remote to fetch from
+ * @param filter Filter spec
+ * @return gm_error_t Error code
+ */
+gm_error_t fetch_remote_filtered(const char *remote_name, const char *filter) {
+    if (remote_name == NULL || strlen(remote_name) == 0 || !is_valid_filter_spec(filter)) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char url[MAX_PATH_LEN];
+    if (get_remote_url(remote_name, url, sizeof(url)) != GM_SUCCESS) {
+        PRINT_ERROR("Remote '%s' does not exist", remote_name);
+        return GM_ERR_REMOTE_NOT_FOUND;
+    }
+    
+    /* A local remote needs an upload-pack that serves filters, now and for lazy fetches */
+    char local_path[MAX_PATH_LEN];
+    char upload_pack_opt[MAX_COMMAND_LEN / 4] = "";
+    bool override = (local_remote_path(url, local_path, sizeof(local_path)) &&
+                     !local_allows_filter(local_path));
+    if (override) {
+        snprintf(upload_pack_opt, sizeof(upload_pack_opt),
+                 "--upload-pack=\"%s\" ", FILTERED_UPLOAD_PACK);
+    }
+    
+    PRINT_INFO("Fetching from '%s' with filter %s...", remote_name, filter);
+    
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "fetch --filter=%s %s\"%s\"", filter, upload_pack_opt, remote_name);
+    
+    cmd_result_t *result = exec_git_command(cmd);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        if (result->error != NULL && strlen(result->error) > 0) {
+            PRINT_ERROR("Fetch failed: %s", trim_whitespace(result->error));
+        }
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    free_cmd_result(result);
+    
+    if (override) {
+        snprintf(cmd, sizeof(cmd), "config remote.\"%s\".uploadpack \"%s\"",
+                 remote_name, FILTERED_UPLOAD_PACK);
+        result = exec_git_command(cmd);
+        if (result) free_cmd_result(result);
+    }
+    
+    PRINT_SUCCESS("'%s' is now a promisor remote (filter %s)", remote_name, filter);
+    
+    return GM_SUCCESS;
+}
+
+/**
+ * Collect the object IDs a listing names and fetch the missing ones
+ * from the promisor remote in one request
+ * 
+ * The listing is either raw diff-tree output (":<modes> <oids> <status>")
+ * or ls-tree output ("<mode> <type> <oid>"). Gitlinks are skipped since
+ * submodule commits never live in this object store.
+ */
+static gm_error_t prefetch_listed_objects(const char *list_args) {
+    char remote[MAX_BRANCH_NAME];
+    if (get_promisor_remote(remote, sizeof(remote), NULL, 0) != GM_SUCCESS) {
+        return GM_SUCCESS;  /* Not a partial clone: everything is local */
+    }
+    
+    cmd_result_t *result = exec_git_command_input(list_args, NULL, 0);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    if (result->exit_code != 0 || result->output == NULL) {
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    char (*oids)[MAX_OID_LEN] = NULL;
+    int count = 0;
+    int capacity = 0;
+    
+    char *saveptr = NULL;
+    char *line = strtok_r(result->output, "\n", &saveptr);
+    while (line != NULL) {
+        char *tab = strchr(line, '\t');
+        if (tab != NULL) *tab = '\0';
+        
+        /* Combined diffs have one colon per parent, and as many extra mode/oid pairs */
+        int parents = (int)strspn(line, ":");
+        int columns = (parents > 0) ? parents + 1 : 1;
+        
+        char *fields[2 * (MAX_REMOTES + 1)];
+        int field_count = 0;
+        char *field_save = NULL;
+        char *field = strtok_r(line + parents, " ", &field_save);
+        while (field != NULL && field_count < (int)(sizeof(fields) / sizeof(fields[0]))) {
+            fields[field_count++] = field;
+            field = strtok_r(NULL, " ", &field_save);
+        }
+        
+        for (int c = 0; c < columns; c++) {
+            int mode_index = c;
+            int oid_index = (parents > 0) ? columns + c : 2;
+            if (oid_index >= field_count) break;
+            
+            const char *oid = fields[oid_index];
+            size_t oid_len = strlen(oid);
+            if (strcmp(fields[mode_index], "160000") == 0 ||
+                oid_len >= MAX_OID_LEN || strspn(oid, "0") == oid_len) {
+                continue;
+            }
+            
+            if (count == capacity) {
+                int new_capacity = (capacity == 0) ? 64 : capacity * 2;
+                char (*grown)[MAX_OID_LEN] = safe_realloc(oids, (size_t)new_capacity * MAX_OID_LEN);
+                if (grown == NULL) break;
+                oids = grown;
+                capacity = new_capacity;
+            }
+            memcpy(oids[count++], oid, oid_len + 1);
+        }
+        
+        line = strtok_r(NULL, "\n", &saveptr);
+    }
+    free_cmd_result(result);
+    
+    int missing = 0;
+    gm_error_t err = find_missing_objects(oids, count, &missing);
+    if (err != GM_SUCCESS || missing == 0) {
+        free(oids);
+        return err;
+    }
+    
+    /* One request for every missing object, as git's own lazy fetch does per object */
+    char *input = (char*)safe_malloc((size_t)missing * MAX_OID_LEN + 1);
+    if (input == NULL) {
+        free(oids);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    size_t input_len = 0;
+    for (int i = 0; i < missing; i++) {
+        size_t len = strlen(oids[i]);
+        memcpy(input + input_len, oids[i], len);
+        input_len += len;
+        input[input_len++] = '\n';
+    }
+    free(oids);
+    
+    PRINT_INFO("Prefetching %d object(s) from promisor remote '%s'...", missing, remote);
+    
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd),
+             "-c fetch.negotiationAlgorithm=noop fetch \"%s\" --no-tags --no-write-fetch-head "
+             "--recurse-submodules=no --filter=blob:none --stdin", remote);
+    
+    result = exec_git_command_input(cmd, input, input_len);
+    free(input);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    err = GM_SUCCESS;
+    if (result->exit_code != 0) {
+        /* Not fatal: git still fetches whatever it needs on demand */
+        PRINT_WARNING("Prefetch from '%s' failed; objects will be fetched on demand", remote);
+        err = GM_ERR_COMMAND_FAILED;
+    }
+    
+    free_cmd_result(result);
+    return err;
+}
+
+/**
+ * Prefetch the blobs a diff will read, in one batch
+ * 
+ * A no-op outside partial clones.
+ * 
+ * @param commit1 Commit (diffed against its parents when commit2 is NULL)
+ * @param commit2 Second commit, or NULL
+ * @return gm_error_t Error code
+ */
+gm_error_t prefetch_diff_blobs(const char *commit1, const char *commit2) {
+    if (commit1 == NULL || strlen(commit1) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char cmd[MAX_COMMAND_LEN];
+    if (commit2 != NULL && strlen(commit2) > 0) {
+        snprintf(cmd, sizeof(cmd), "diff-tree -r \"%s\" \"%s\"", commit1, commit2);
+    } else {
+        snprintf(cmd, sizeof(cmd), "diff-tree -r -c --root --no-commit-id \"%s\"", commit1);
+    }
+    
+    return prefetch_listed_objects(cmd);
+}
+
+/**
+ * Prefetch the blobs under a path in a commit, in one batch
+ * 
+ * A no-op outside partial clones.
+ * 
+ * @param commit Commit to read
+ * @param path File or directory (NULL or empty for the whole tree)
+ * @return gm_error_t Error code
+ */
+gm_error_t prefetch_path_blobs(const char *commit, const char *path) {
+    if (commit == NULL || strlen(commit) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char cmd[MAX_COMMAND_LEN];
+    if (path != NULL && strlen(path) > 0) {
+        snprintf(cmd, sizeof(cmd), "ls-tree -r \"%s\" -- \"%s\"", commit, path);
+    } else {
+        snprintf(cmd, sizeof(cmd), "ls-tree -r \"%s\"", commit);
+    }
+    
+    return prefetch_listed_objects(cmd);
+}
+
+/* ============================================================================
+ * Push Functions
+ * ============================================================================ */
+
+/**
+ * Push a branch to a remote
+ * 
+ * @param remote Remote name (NULL for default 'origin')
+ * @param branch Branch name (NULL for current branch)
+ * @param set_upstream Set upstream tracking
+ * @return gm_error_t Error code
+ */
+gm_error_t push_branch(const char *remote, const char *branch, bool set_upstream) {
+    char remote_name[MAX_BRANCH_NAME] = "origin";
+    char branch_name[MAX_BRANCH_NAME];
+    
+    /* Use provided remote or default to origin */
+    if (remote != NULL && strlen(remote) > 0) {
+        strncpy(remote_name, remote, sizeof(remote_name) - 1);
+        remote_name[sizeof(remote_name) - 1] = '\0';
+    }
+    
+    /* Use provided branch or current branch */
+    if (branch != NULL && strlen(branch) > 0) {
+        strncpy(branch_name, branch, sizeof(branch_name) - 1);
+        branch_name[sizeof(branch_name) - 1] = '\0';
+    } else {
+        if (get_current_branch(branch_name, sizeof(branch_name)) != GM_SUCCESS) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+    }
+    
+    /* Check if remote exists */
+    if (!remote_exists(remote_name)) {
+        PRINT_ERROR("Remote '%s' does not exist", remote_name);
+        PRINT_INFO("Use 'Add Remote' to configure a remote first");
+        return GM_ERR_REMOTE_NOT_FOUND;
+    }
+    
+    /* Check for uncommitted changes */
+    repo_status_t *status = get_repo_status();
+    if (status != NULL) {
+        if (status->has_uncommitted_changes) {
+            PRINT_WARNING("You have uncommitted changes");
+            PRINT_INFO("Consider committing before pushing");
+        }
+        free_repo_status(status);
+    }
+    
+    PRINT_INFO("Pushing '%s' to '%s'...", branch_name, remote_name);
+    
+    char cmd[MAX_COMMAND_LEN];
+    if (set_upstream) {
+        snprintf(cmd, sizeof(cmd), "push -u \"%s\" \"%s\"", remote_name, branch_name);
+    } else {
+        snprintf(cmd, sizeof(cmd), "push \"%s\" \"%s\"", remote_name, branch_name);
+    }
+    
+    cmd_result_t *result = exec_git_command(cmd);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        if (result->error != NULL && strlen(result->error) > 0) {
+            /* Analyze error */
+            if (strstr(result->error, "rejected") != NULL) {
+                PRINT_ERROR("Push rejected - remote has newer changes");
+                PRINT_INFO("Pull the latest changes first, or use force push (dangerous!)");
+                free_cmd_result(result);
+                return GM_ERR_PUSH_FAILED;
+            }
+            
+            if (strstr(result->error, "Could not resolve") != NULL ||
+                strstr(result->error, "unable to access") != NULL) {
+                PRINT_ERROR("Network error: Unable to reach remote '%s'", remote_name);
+                free_cmd_result(result);
+                return GM_ERR_PUSH_FAILED;
+            }
+            
+            if (strstr(result->error, "Authentication") != NULL ||
+                strstr(result->error, "Permission denied") != NULL ||
+                strstr(result->error, "denied") != NULL) {
+                PRINT_ERROR("Authentication failed for remote '%s'", remote_name);
+                PRINT_INFO("Check your credentials or SSH keys");
+                free_cmd_result(result);
+                return GM_ERR_PUSH_FAILED;
+            }
+            
             if (strstr(result->error, "no upstream branch") != NULL ||
                 strstr(result->error, "has no upstream") != NULL) {
                 PRINT_WARNING("Branch has no upstream tracking");
@@ -510,47 +1394,710 @@ gm_error_t push_with_force(const char *remote, const char *branch) {
         free_cmd_result(result);
         return GM_ERR_PUSH_FAILED;
     }
-    
+    
+    free_cmd_result(result);
+    PRINT_SUCCESS("Force pushed '%s' to '%s/%s'", branch_name, remote_name, branch_name);
+    
+    return GM_SUCCESS;
+}
+
+/**
+ * Collect every local branch that is ahead of its upstream
+ *
+ * Ahead/behind counts for all branches come from a single
+ * `for-each-ref` using %(upstream:track). Branches tracking a local
+ * branch, or whose upstream is gone, are left out.
+ *
+ * @param refs Output: array of branches (must be freed)
+ * @param count Output: number of branches
+ * @return gm_error_t Error code
+ */
+gm_error_t collect_push_set(push_ref_t **refs, int *count) {
+    if (refs == NULL || count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    *refs = NULL;
+    *count = 0;
+    
+    cmd_result_t *result = exec_git_command_input(
+        "for-each-ref --format=\"%(refname:lstrip=2)%09%(upstream:remotename)%09"
+        "%(upstream:remoteref)%09%(upstream:track,nobracket)\" refs/heads", NULL, 0);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Failed to read branches: %s", result->error);
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    int capacity = 0;
+    char *save = NULL;
+    
+    for (char *line = strtok_r(result->output, "\n", &save); line != NULL;
+         line = strtok_r(NULL, "\n", &save)) {
+        char *fields[4] = { line, NULL, NULL, NULL };
+        for (int i = 1; i < 4; i++) {
+            fields[i] = strchr(fields[i - 1], '\t');
+            if (fields[i] == NULL) break;
+            *fields[i]++ = '\0';
+        }
+        
+        /* No upstream, a local upstream, or nothing to push */
+        if (fields[3] == NULL || strlen(fields[1]) == 0 || strcmp(fields[1], ".") == 0 ||
+            strstr(fields[3], "ahead ") == NULL) {
+            continue;
+        }
+        
+        if (*count == capacity) {
+            capacity = (capacity == 0) ? 16 : capacity * 2;
+            push_ref_t *grown = (push_ref_t*)safe_realloc(*refs,
+                                                          (size_t)capacity * sizeof(push_ref_t));
+            if (grown == NULL) {
+                free(*refs);
+                *refs = NULL;
+                *count = 0;
+                free_cmd_result(result);
+                return GM_ERR_MEMORY_ALLOC;
+            }
+            *refs = grown;
+        }
+        
+        push_ref_t *ref = &(*refs)[(*count)++];
+        memset(ref, 0, sizeof(*ref));
+        snprintf(ref->branch, sizeof(ref->branch), "%s", fields[0]);
+        snprintf(ref->remote, sizeof(ref->remote), "%s", fields[1]);
+        snprintf(ref->remote_ref, sizeof(ref->remote_ref), "%s", fields[2]);
+        
+        /* "ahead N" or "ahead N, behind M" */
+        char *ahead = strstr(fields[3], "ahead ");
+        char *behind = strstr(fields[3], "behind ");
+        ref->ahead = atoi(ahead + 6);
+        ref->behind = (behind != NULL) ? atoi(behind + 7) : 0;
+    }
+    
+    free_cmd_result(result);
+    return GM_SUCCESS;
+}
+
+/**
+ * Record the per-ref outcome from `push --porcelain` output
+ *
+ * Lines look like "<flag>\t<from>:<to>\t<summary> (<reason>)".
+ */
+static void parse_push_porcelain(const char *output, push_ref_t *refs, int count,
+                                 const char *remote) {
+    const char *line = output;
+    
+    while (line != NULL && *line != '\0') {
+        const char *next = strchr(line, '\n');
+        size_t len = (next != NULL) ? (size_t)(next - line) : strlen(line);
+        
+        const char *tab = memchr(line, '\t', len);
+        const char *colon = (tab != NULL) ? memchr(tab, ':', len - (size_t)(tab - line)) : NULL;
+        const char *tab2 = (colon != NULL) ? memchr(colon, '\t', len - (size_t)(colon - line)) : NULL;
+        
+        if (tab == line + 1 && colon != NULL && tab2 != NULL) {
+            size_t to_len = (size_t)(tab2 - colon - 1);
+            
+            for (int i = 0; i < count; i++) {
+                push_ref_t *ref = &refs[i];
+                if (strcmp(ref->remote, remote) != 0 || strlen(ref->remote_ref) != to_len ||
+                    strncmp(ref->remote_ref, colon + 1, to_len) != 0) {
+                    continue;
+                }
+                
+                switch (line[0]) {
+                    case '=':
+                        ref->status = PUSH_REF_UP_TO_DATE;
+                        break;
+                    case '!':
+                        ref->status = PUSH_REF_REJECTED;
+                        break;
+                    default: /* ' ' fast-forward, '+' forced, '*' new */
+                        ref->status = PUSH_REF_OK;
+                        break;
+                }
+                
+                int summary_len = (int)(len - (size_t)(tab2 + 1 - line));
+                snprintf(ref->summary, sizeof(ref->summary), "%.*s", summary_len, tab2 + 1);
+                break;
+            }
+        }
+        
+        line = (next != NULL) ? next + 1 : NULL;
+    }
+}
+
+/**
+ * Push a set of branches, one atomic push per remote
+ *
+ * Every branch going to the same remote travels in a single
+ * `push --atomic` with explicit refspecs, so the whole set costs one
+ * connection and one pack negotiation per remote and either all refs
+ * update or none do. Diverged branches are skipped up front, since
+ * one rejection would fail the whole transaction.
+ *
+ * @param refs Branches to push; status and summary are filled in
+ * @param count Number of branches
+ * @return gm_error_t GM_SUCCESS if every pushed remote accepted its refs
+ */
+gm_error_t push_ref_set(push_ref_t *refs, int count) {
+    if (refs == NULL || count <= 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    gm_error_t err = GM_SUCCESS;
+    
+    for (int i = 0; i < count; i++) {
+        if (refs[i].behind > 0) {
+            refs[i].status = PUSH_REF_SKIPPED;
+            snprintf(refs[i].summary, sizeof(refs[i].summary),
+                     "diverged: %d behind, pull first", refs[i].behind);
+        }
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (refs[i].status != PUSH_REF_PENDING) {
+            continue;
+        }
+        
+        /* Gather the refspecs of every pending branch for this remote */
+        const char *remote = refs[i].remote;
+        size_t cap = 256 + 2 * MAX_BRANCH_NAME;
+        size_t len = 0;
+        char *cmd = (char*)safe_malloc(cap);
+        if (cmd == NULL) {
+            return GM_ERR_MEMORY_ALLOC;
+        }
+        len = (size_t)snprintf(cmd, cap, "git push --atomic --porcelain \"%s\"", remote);
+        
+        int refspecs = 0;
+        for (int j = i; j < count; j++) {
+            if (refs[j].status != PUSH_REF_PENDING || strcmp(refs[j].remote, remote) != 0) {
+                continue;
+            }
+            
+            size_t need = strlen(refs[j].branch) + strlen(refs[j].remote_ref) + 32;
+            if (len + need >= cap) {
+                cap = (cap + need) * 2;
+                char *grown = (char*)safe_realloc(cmd, cap);
+                if (grown == NULL) {
+                    free(cmd);
+                    return GM_ERR_MEMORY_ALLOC;
+                }
+                cmd = grown;
+            }
+            len += (size_t)snprintf(cmd + len, cap - len, " \"refs/heads/%s:%s\"",
+                                    refs[j].branch, refs[j].remote_ref);
+            refspecs++;
+        }
+        
+        PRINT_INFO("Pushing %d branch(es) to '%s' atomically...", refspecs, remote);
+        
+        cmd_result_t *result = exec_command_input(cmd, NULL, 0);
+        free(cmd);
+        
+        if (result == NULL) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+        
+        parse_push_porcelain(result->output, refs, count, remote);
+        
+        /* Refs the remote never reported on (e.g. connection failure) */
+        for (int j = i; j < count; j++) {
+            if (refs[j].status == PUSH_REF_PENDING && strcmp(refs[j].remote, remote) == 0) {
+                refs[j].status = PUSH_REF_REJECTED;
+                snprintf(refs[j].summary, sizeof(refs[j].summary), "%s",
+                         strlen(trim_whitespace(result->error)) > 0 ?
+                         result->error : "no response from remote");
+                refs[j].summary[strcspn(refs[j].summary, "\n")] = '\0';
+            }
+        }
+        
+        if (result->exit_code != 0) {
+            err = GM_ERR_PUSH_FAILED;
+        }
+        free_cmd_result(result);
+    }
+    
+    return err;
+}
+
+/**
+ * Push every branch that is ahead of its upstream
+ *
+ * @return gm_error_t Error code
+ */
+gm_error_t push_all_ahead(void) {
+    push_ref_t *refs = NULL;
+    int count = 0;
+    
+    gm_error_t err = collect_push_set(&refs, &count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    if (count == 0) {
+        PRINT_INFO("No branches are ahead of their upstream");
+        return GM_SUCCESS;
+    }
+    
+    err = push_ref_set(refs, count);
+    
+    printf("\n");
+    for (int i = 0; i < count; i++) {
+        const push_ref_t *ref = &refs[i];
+        const char *color = COLOR_GREEN;
+        const char *label = "pushed";
+        
+        if (ref->status == PUSH_REF_UP_TO_DATE) {
+            label = "up to date";
+        } else if (ref->status == PUSH_REF_REJECTED) {
+            color = COLOR_RED;
+            label = "rejected";
+        } else if (ref->status == PUSH_REF_SKIPPED) {
+            color = COLOR_YELLOW;
+            label = "skipped";
+        }
+        
+        printf("  %s%-10s" COLOR_RESET " %s -> %s/%s  %s\n", color, label, ref->branch,
+               ref->remote, ref->remote_ref + (strncmp(ref->remote_ref, "refs/heads/", 11) == 0 ? 11 : 0),
+               ref->summary);
+    }
+    printf("\n");
+    
+    if (err == GM_SUCCESS) {
+        PRINT_SUCCESS("Pushed all branches ahead of their upstream");
+    } else {
+        PRINT_ERROR("Push rejected; no refs were updated on the affected remote");
+    }
+    
+    free(refs);
+    return err;
+}
+
+/**
+ * Set upstream tracking for a branch
+ * 
+ * @param remote Remote name
+ * @param branch Branch name
+ * @return gm_error_t Error code
+ */
+gm_error_t set_upstream(const char *remote, const char *branch) {
+    if (remote == NULL || branch == NULL || 
+        strlen(remote) == 0 || strlen(branch) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "branch --set-upstream-to=\"%s/%s\" \"%s\"", 
+             remote, branch, branch);
+    
+    cmd_result_t *result = exec_git_command(cmd);
+    
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    if (result->exit_code != 0) {
+        if (result->error != NULL) {
+            PRINT_ERROR("Failed to set upstream: %s", result->error);
+        }
+        free_cmd_result(result);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    free_cmd_result(result);
+    PRINT_SUCCESS("Set upstream for '%s' to '%s/%s'", branch, remote, branch);
+    
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Pull Planner Functions
+ * ============================================================================ */
+
+/**
+ * Whether a remote-tracking ref was fetched recently enough to pull
+ * from without fetching again
+ * 
+ * The ref's own reflog records fetches that moved it; FETCH_HEAD
+ * (written by the daemon's poll) covers fetches that found it unchanged.
+ */
+static bool tracking_ref_is_fresh(const char *tracking_ref, const char *oid) {
+    time_t now = time(NULL);
+    time_t fetched = 0;
+    
+    if (read_reflog_time(tracking_ref, "fetch", &fetched) == GM_SUCCESS &&
+        fetched != 0 && now - fetched <= PULL_PREFETCH_MAX_AGE) {
+        return true;
+    }
+    
+    char git_dir[MAX_PATH_LEN];
+    if (find_git_dir(git_dir, sizeof(git_dir)) != GM_SUCCESS) {
+        return false;
+    }
+    
+    char path[MAX_PATH_LEN + 16];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/FETCH_HEAD", git_dir);
+    if (stat(path, &st) != 0 || now - st.st_mtime > PULL_PREFETCH_MAX_AGE) {
+        return false;
+    }
+    
+    /* Only trust it if that fetch saw the commit the ref points at */
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return false;
+    }
+    
+    char line[MAX_PATH_LEN];
+    size_t oid_len = strlen(oid);
+    bool seen = false;
+    while (!seen && fgets(line, sizeof(line), fp) != NULL) {
+        seen = (strncmp(line, oid, oid_len) == 0 && line[oid_len] == '\t');
+    }
+    fclose(fp);
+    return seen;
+}
+
+/**
+ * Work out what a pull of a remote branch into the current branch
+ * needs, fetching only when the prefetched ref is missing or stale
+ * 
+ * @param remote Remote name
+ * @param branch Remote branch to pull
+ * @param plan Output plan
+ * @return gm_error_t GM_ERR_BRANCH_NOT_FOUND when the pull cannot be
+ *         planned locally (detached HEAD, unborn branch, no tracking
+ *         ref); callers fall back to "git pull"
+ */
+gm_error_t plan_pull(const char *remote, const char *branch, pull_plan_t *plan) {
+    if (remote == NULL || branch == NULL || plan == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    memset(plan, 0, sizeof(*plan));
+    snprintf(plan->remote, sizeof(plan->remote), "%s", remote);
+    snprintf(plan->branch, sizeof(plan->branch), "%s", branch);
+    
+    /* Where the remote's fetch refspecs store the branch */
+    char remote_ref[MAX_BRANCH_NAME + 16];
+    snprintf(remote_ref, sizeof(remote_ref), "refs/heads/%s", branch);
+    if (git_config_tracking_ref(remote, remote_ref, plan->tracking_ref,
+                                sizeof(plan->tracking_ref)) != GM_SUCCESS) {
+        snprintf(plan->tracking_ref, sizeof(plan->tracking_ref), "refs/remotes/%s/%s", remote, branch);
+    }
+    
+    cmd_result_t *result = exec_git_command("symbolic-ref -q HEAD");
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    bool on_branch = (result->exit_code == 0 && result->output != NULL);
+    if (on_branch) {
+        snprintf(plan->head_ref, sizeof(plan->head_ref), "%s", trim_whitespace(result->output));
+    }
+    free_cmd_result(result);
+    
+    if (!on_branch || resolve_ref_oid("HEAD", plan->head_oid, sizeof(plan->head_oid)) != GM_SUCCESS) {
+        return GM_ERR_BRANCH_NOT_FOUND;
+    }
+    
+    bool have_ref = (resolve_ref_oid(plan->tracking_ref, plan->remote_oid,
+                                     sizeof(plan->remote_oid)) == GM_SUCCESS);
+    
+    if (!have_ref || !tracking_ref_is_fresh(plan->tracking_ref, plan->remote_oid)) {
+        char cmd[MAX_COMMAND_LEN];
+        snprintf(cmd, sizeof(cmd), "fetch --quiet \"%s\" \"%s\"", remote, branch);
+        
+        result = exec_git_command(cmd);
+        if (result == NULL) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+        if (result->exit_code != 0) {
+            if (result->error != NULL && strlen(result->error) > 0) {
+                PRINT_ERROR("Fetch failed: %s", trim_whitespace(result->error));
+            }
+            free_cmd_result(result);
+            return GM_ERR_PULL_FAILED;
+        }
+        free_cmd_result(result);
+        plan->fetched = true;
+        
+        /* A remote without the usual refspec has no tracking ref to plan from */
+        if (resolve_ref_oid(plan->tracking_ref, plan->remote_oid,
+                            sizeof(plan->remote_oid)) != GM_SUCCESS) {
+            return GM_ERR_BRANCH_NOT_FOUND;
+        }
+    }
+    
+    if (strcmp(plan->head_oid, plan->remote_oid) == 0) {
+        plan->action = PULL_UP_TO_DATE;
+        return GM_SUCCESS;
+    }
+    
+    ahead_behind_t pair;
+    memset(&pair, 0, sizeof(pair));
+    snprintf(pair.left, sizeof(pair.left), "%s", plan->head_oid);
+    snprintf(pair.right, sizeof(pair.right), "%s", plan->remote_oid);
+    
+    gm_error_t err = compute_ahead_behind(&pair, 1);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    plan->ahead = pair.ahead;
+    plan->behind = pair.behind;
+    if (plan->behind == 0) {
+        plan->action = PULL_UP_TO_DATE;
+    } else if (plan->ahead == 0) {
+        plan->action = PULL_FAST_FORWARD;
+    } else {
+        plan->action = PULL_DIVERGED;
+    }
+    
+    return GM_SUCCESS;
+}
+
+/**
+ * Fast-forward the current branch with a two-tree merge of the index
+ * and working tree, then a compare-and-swap of the branch ref
+ */
+static gm_error_t fast_forward_head(const pull_plan_t *plan) {
+    char cmd[MAX_COMMAND_LEN];
+    cmd_result_t *result;
+    
+    /* Stale stat data would make read-tree think files are modified */
+    result = exec_git_command("update-index -q --refresh");
+    if (result) free_cmd_result(result);
+    
+    snprintf(cmd, sizeof(cmd), "read-tree -u -m \"%s\" \"%s\"", plan->head_oid, plan->remote_oid);
+    result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    if (result->exit_code != 0) {
+        PRINT_ERROR("Fast-forward failed: %s",
+                    result->error != NULL ? trim_whitespace(result->error) : "read-tree failed");
+        free_cmd_result(result);
+        return GM_ERR_PULL_FAILED;
+    }
+    free_cmd_result(result);
+    
+    snprintf(cmd, sizeof(cmd), "update-ref -m \"pull %s %s: Fast-forward\" \"%s\" \"%s\" \"%s\"",
+             plan->remote, plan->branch, plan->head_ref, plan->remote_oid, plan->head_oid);
+    result = exec_git_command(cmd);
+    if (result == NULL || result->exit_code != 0) {
+        /* The branch moved underneath us: put the tree back where it was */
+        if (result) free_cmd_result(result);
+        snprintf(cmd, sizeof(cmd), "read-tree -u -m \"%s\" \"%s\"", plan->remote_oid, plan->head_oid);
+        result = exec_git_command(cmd);
+        if (result) free_cmd_result(result);
+        PRINT_ERROR("'%s' changed during the pull; nothing was updated", plan->head_ref);
+        return GM_ERR_PULL_FAILED;
+    }
+    free_cmd_result(result);
+    
+    snprintf(cmd, sizeof(cmd), "update-ref ORIG_HEAD \"%s\"", plan->head_oid);
+    result = exec_git_command(cmd);
+    if (result) free_cmd_result(result);
+    
+    return GM_SUCCESS;
+}
+
+/* How the user has told git to reconcile a pull */
+typedef struct {
+    bool configured;            /* pull.rebase, branch.<name>.rebase or pull.ff is set */
+    bool rebase;
+    bool rebase_merges;         /* pull.rebase=merges */
+    bool ff_only;               /* pull.ff=only */
+    bool no_ff;                 /* pull.ff=false */
+} pull_config_t;
+
+/**
+ * Read the pull settings for a branch
+ * 
+ * branch.<name>.rebase overrides pull.rebase, as in git. An interactive
+ * rebase cannot be driven from here, so pull.rebase=interactive rebases
+ * without stopping.
+ */
+static void read_pull_config(const char *branch, pull_config_t *settings) {
+    char key[MAX_BRANCH_NAME + 16];
+    char value[32];
+    
+    memset(settings, 0, sizeof(*settings));
+    
+    snprintf(key, sizeof(key), "branch.%s.rebase", branch);
+    const char *rebase_key = NULL;
+    if (git_config_get(key, value, sizeof(value))) {
+        rebase_key = key;
+    } else if (git_config_get("pull.rebase", value, sizeof(value))) {
+        rebase_key = "pull.rebase";
+    }
+    if (rebase_key != NULL) {
+        settings->configured = true;
+        settings->rebase_merges = (strcasecmp(value, "merges") == 0 || strcasecmp(value, "m") == 0);
+        settings->rebase = settings->rebase_merges ||
+                           strcasecmp(value, "interactive") == 0 || strcasecmp(value, "i") == 0 ||
+                           git_config_get_bool(rebase_key, false);
+    }
+    
+    if (git_config_get("pull.ff", value, sizeof(value))) {
+        settings->configured = true;
+        settings->ff_only = (strcasecmp(value, "only") == 0);
+        settings->no_ff = !settings->ff_only && !git_config_get_bool("pull.ff", true);
+    }
+}
+
+/**
+ * Run the post-merge hook after a fast-forward, as `git pull` would
+ * (the argument is the squash flag)
+ */
+static void run_post_merge_hook(void) {
+    cmd_result_t *result = exec_git_command("hook run --ignore-missing post-merge -- 0");
+    if (result == NULL) {
+        return;
+    }
+    if (result->exit_code != 0 && result->error != NULL && result->error[0] != '\0') {
+        PRINT_WARNING("post-merge hook: %s", trim_whitespace(result->error));
+    }
     free_cmd_result(result);
-    PRINT_SUCCESS("Force pushed '%s' to '%s/%s'", branch_name, remote_name, branch_name);
-    
-    return GM_SUCCESS;
 }
 
 /**
- * Set upstream tracking for a branch
+ * Carry out a pull plan without fetching again
  * 
- * @param remote Remote name
- * @param branch Branch name
+ * Fast-forwards skip the merge machinery entirely: the index and branch
+ * are moved directly and the post-merge hook is run. Diverged branches
+ * are merged with (or rebased onto) the tracking ref as pull.rebase and
+ * pull.ff say; like git, a divergence with neither set is refused
+ * rather than guessed at, and pull.ff=only refuses it outright.
+ * 
+ * @param plan Plan from plan_pull
+ * @param rebase Rebase when the branches diverged, whatever the config says
  * @return gm_error_t Error code
  */
-gm_error_t set_upstream(const char *remote, const char *branch) {
-    if (remote == NULL || branch == NULL || 
-        strlen(remote) == 0 || strlen(branch) == 0) {
+gm_error_t execute_pull_plan(const pull_plan_t *plan, bool rebase) {
+    if (plan == NULL) {
         return GM_ERR_INVALID_INPUT;
     }
     
+    const char *source = plan->fetched ? "fetched" : "prefetched";
+    const char *local_branch = (strncmp(plan->head_ref, "refs/heads/", 11) == 0) ?
+                               plan->head_ref + 11 : plan->head_ref;
+    
+    pull_config_t settings;
+    read_pull_config(local_branch, &settings);
+    bool merge_commit = false;
+    bool rebase_merges = !rebase && settings.rebase_merges;
+    
+    switch (plan->action) {
+        case PULL_UP_TO_DATE:
+            if (plan->ahead > 0) {
+                PRINT_INFO("Already up to date (%d local commit(s) not yet pushed)", plan->ahead);
+            } else {
+                PRINT_INFO("Already up to date");
+            }
+            return GM_SUCCESS;
+            
+        case PULL_FAST_FORWARD: {
+            /* pull.ff=false asks for a merge commit even here */
+            if (!rebase && !settings.rebase && settings.no_ff) {
+                merge_commit = true;
+                break;
+            }
+            gm_error_t err = fast_forward_head(plan);
+            if (err == GM_SUCCESS) {
+                run_post_merge_hook();
+                PRINT_SUCCESS("Fast-forwarded %d commit(s) from '%s/%s' (%s)",
+                              plan->behind, plan->remote, plan->branch, source);
+            }
+            return err;
+        }
+            
+        case PULL_DIVERGED:
+            if (rebase) {
+                break;
+            }
+            if (settings.ff_only) {
+                PRINT_ERROR("Branches diverged (%d local, %d remote); not possible to fast-forward",
+                            plan->ahead, plan->behind);
+                PRINT_INFO("pull.ff is 'only': merge or rebase '%s/%s' yourself",
+                           plan->remote, plan->branch);
+                return GM_ERR_PULL_FAILED;
+            }
+            if (!settings.configured) {
+                PRINT_ERROR("Branches diverged (%d local, %d remote) and no pull strategy is set",
+                            plan->ahead, plan->behind);
+                PRINT_INFO("Pull with rebase, or set one: git config pull.rebase false (merge) "
+                           "or git config pull.rebase true (rebase)");
+                return GM_ERR_PULL_FAILED;
+            }
+            rebase = settings.rebase;
+            break;
+    }
+    
     char cmd[MAX_COMMAND_LEN];
-    snprintf(cmd, sizeof(cmd), "branch --set-upstream-to=\"%s/%s\" \"%s\"", 
-             remote, branch, branch);
+    if (merge_commit) {
+        PRINT_INFO("Merging '%s/%s' with a merge commit (pull.ff is false)...",
+                   plan->remote, plan->branch);
+        snprintf(cmd, sizeof(cmd),
+                 "merge --no-ff --no-edit -m \"Merge remote-tracking branch '%s/%s'\" \"%s\"",
+                 plan->remote, plan->branch, plan->tracking_ref);
+    } else {
+        PRINT_INFO("Branches diverged (%d local, %d remote); %s '%s/%s'...",
+                   plan->ahead, plan->behind, rebase ? "rebasing onto" : "merging",
+                   plan->remote, plan->branch);
+        if (rebase) {
+            snprintf(cmd, sizeof(cmd), "rebase %s\"%s\"",
+                     rebase_merges ? "--rebase-merges " : "", plan->tracking_ref);
+        } else {
+            /* Merge the ref the plan checked (the refspec may map it anywhere),
+               but keep the usual message that names the remote branch */
+            snprintf(cmd, sizeof(cmd),
+                     "merge --no-edit -m \"Merge remote-tracking branch '%s/%s'\" \"%s\"",
+                     plan->remote, plan->branch, plan->tracking_ref);
+        }
+    }
     
     cmd_result_t *result = exec_git_command(cmd);
-    
     if (result == NULL) {
         return GM_ERR_COMMAND_FAILED;
     }
     
     if (result->exit_code != 0) {
+        const char *check_str = (result->output != NULL && strstr(result->output, "CONFLICT") != NULL)
+                                ? result->output : result->error;
+        if (check_str != NULL && strstr(check_str, "CONFLICT") != NULL) {
+            if (rebase) {
+                PRINT_ERROR("Rebase resulted in conflicts!");
+                PRINT_INFO("Resolve conflicts and run 'git rebase --continue'");
+                PRINT_INFO("Or abort with 'git rebase --abort'");
+            } else {
+                PRINT_ERROR("Pull resulted in merge conflicts!");
+                PRINT_INFO("Resolve conflicts and commit, or abort with 'git merge --abort'");
+            }
+            free_cmd_result(result);
+            return GM_ERR_MERGE_CONFLICT;
+        }
+        
         if (result->error != NULL) {
-            PRINT_ERROR("Failed to set upstream: %s", result->error);
+            PRINT_ERROR("Pull failed: %s", result->error);
         }
         free_cmd_result(result);
-        return GM_ERR_COMMAND_FAILED;
+        return GM_ERR_PULL_FAILED;
     }
     
     free_cmd_result(result);
-    PRINT_SUCCESS("Set upstream for '%s' to '%s/%s'", branch, remote, branch);
-    
+    if (rebase) {
+        PRINT_SUCCESS("Pulled and rebased from '%s/%s'", plan->remote, plan->branch);
+    } else {
+        PRINT_SUCCESS("Pulled latest changes from '%s/%s'", plan->remote, plan->branch);
+    }
     return GM_SUCCESS;
 }
 
@@ -597,6 +2144,13 @@ gm_error_t pull_branch(const char *remote, const char *branch) {
     
     PRINT_INFO("Pulling '%s' from '%s'...", branch_name, remote_name);
     
+    /* Plan locally first; "git pull" is only the fallback */
+    pull_plan_t plan;
+    gm_error_t err = plan_pull(remote_name, branch_name, &plan);
+    if (err != GM_ERR_BRANCH_NOT_FOUND) {
+        return (err == GM_SUCCESS) ? execute_pull_plan(&plan, false) : err;
+    }
+    
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "pull \"%s\" \"%s\"", remote_name, branch_name);
     
@@ -687,6 +2241,12 @@ gm_error_t pull_rebase(const char *remote, const char *branch) {
     
     PRINT_INFO("Pulling with rebase from '%s/%s'...", remote_name, branch_name);
     
+    pull_plan_t plan;
+    gm_error_t err = plan_pull(remote_name, branch_name, &plan);
+    if (err != GM_ERR_BRANCH_NOT_FOUND) {
+        return (err == GM_SUCCESS) ? execute_pull_plan(&plan, true) : err;
+    }
+    
     char cmd[MAX_COMMAND_LEN];
     snprintf(cmd, sizeof(cmd), "pull --rebase \"%s\" \"%s\"", remote_name, branch_name);
     
@@ -737,51 +2297,590 @@ gm_error_t show_sync_status(void) {
     printf("\n" COLOR_BOLD "Sync Status for branch '%s':" COLOR_RESET "\n\n", current_branch);
     
     /* Get upstream info */
-    char cmd[MAX_COMMAND_LEN];
-    snprintf(cmd, sizeof(cmd), "rev-parse --abbrev-ref \"%s@{upstream}\"", current_branch);
-    
-    cmd_result_t *result = exec_git_command(cmd);
+    char upstream[MAX_BRANCH_NAME];
+    int ahead = 0, behind = 0;
     
-    if (result == NULL || result->exit_code != 0) {
-        if (result) free_cmd_result(result);
+    if (get_upstream_status(current_branch, upstream, sizeof(upstream), &ahead, &behind) != GM_SUCCESS) {
         PRINT_INFO("No upstream branch configured");
         PRINT_INFO("Use 'Push with Set Upstream' to configure tracking");
         return GM_SUCCESS;
     }
     
-    char upstream[MAX_BRANCH_NAME];
-    strncpy(upstream, trim_whitespace(result->output), sizeof(upstream) - 1);
-    upstream[sizeof(upstream) - 1] = '\0';
+    printf("Upstream: " COLOR_CYAN "%s" COLOR_RESET "\n", upstream);
+    
+    if (ahead == 0 && behind == 0) {
+        printf("Status: " COLOR_GREEN "Up to date" COLOR_RESET "\n");
+    } else {
+        if (ahead > 0) {
+            printf("  " COLOR_YELLOW "%d commit(s) ahead" COLOR_RESET " - ready to push\n", ahead);
+        }
+        if (behind > 0) {
+            printf("  " COLOR_RED "%d commit(s) behind" COLOR_RESET " - need to pull\n", behind);
+        }
+    }
+    
+    printf("\n");
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Ahead/Behind Engine
+ * ============================================================================ */
+
+/* Tips per merge-base call when narrowing the walk */
+#define MERGE_BASE_CHUNK 128
+
+/* Commits seen by one walk, with a bit per tip that reaches each */
+typedef struct {
+    char (*oids)[MAX_OID_LEN];
+    uint64_t *bits;             /* slot_capacity x words */
+    int words;
+    int count;
+    int slot_capacity;
+    int *table;                 /* Open addressing: slot index or -1 */
+    int table_capacity;
+} commit_walk_t;
+
+static unsigned int walk_hash(const char *oid) {
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < 16 && oid[i] != '\0'; i++) {
+        hash = (hash ^ (unsigned char)oid[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static bool walk_grow_table(commit_walk_t *walk) {
+    int capacity = (walk->table_capacity == 0) ? 1024 : walk->table_capacity * 2;
+    int *table = (int*)safe_malloc((size_t)capacity * sizeof(int));
+    if (table == NULL) {
+        return false;
+    }
+    for (int i = 0; i < capacity; i++) table[i] = -1;
+    
+    for (int slot = 0; slot < walk->count; slot++) {
+        unsigned int h = walk_hash(walk->oids[slot]) & (unsigned int)(capacity - 1);
+        while (table[h] != -1) h = (h + 1) & (unsigned int)(capacity - 1);
+        table[h] = slot;
+    }
+    
+    free(walk->table);
+    walk->table = table;
+    walk->table_capacity = capacity;
+    return true;
+}
+
+/**
+ * Look a commit up, adding it with no tip bits if it is new
+ */
+static int walk_slot(commit_walk_t *walk, const char *oid) {
+    if ((walk->count + 1) * 2 > walk->table_capacity && !walk_grow_table(walk)) {
+        return -1;
+    }
+    
+    unsigned int mask = (unsigned int)(walk->table_capacity - 1);
+    unsigned int h = walk_hash(oid) & mask;
+    while (walk->table[h] != -1) {
+        if (strcmp(walk->oids[walk->table[h]], oid) == 0) {
+            return walk->table[h];
+        }
+        h = (h + 1) & mask;
+    }
+    
+    if (walk->count == walk->slot_capacity) {
+        int capacity = (walk->slot_capacity == 0) ? 256 : walk->slot_capacity * 2;
+        char (*oids)[MAX_OID_LEN] = safe_realloc(walk->oids, (size_t)capacity * MAX_OID_LEN);
+        if (oids == NULL) return -1;
+        walk->oids = oids;
+        
+        if (walk->words > 0) {
+            uint64_t *bits = (uint64_t*)safe_realloc(walk->bits,
+                                                     (size_t)capacity * walk->words * sizeof(uint64_t));
+            if (bits == NULL) return -1;
+            walk->bits = bits;
+        }
+        walk->slot_capacity = capacity;
+    }
+    
+    int slot = walk->count++;
+    snprintf(walk->oids[slot], MAX_OID_LEN, "%s", oid);
+    if (walk->words > 0) {
+        memset(walk->bits + (size_t)slot * walk->words, 0, (size_t)walk->words * sizeof(uint64_t));
+    }
+    walk->table[h] = slot;
+    return slot;
+}
+
+static void free_commit_walk(commit_walk_t *walk) {
+    free(walk->oids);
+    free(walk->bits);
+    free(walk->table);
+}
+
+/**
+ * Find commits every tip can reach, so the walk can stop at them
+ * 
+ * Folds "merge-base --octopus" over chunks of tips. Anything the result
+ * reaches is reachable from all tips and so never counts as ahead or
+ * behind. Returns the number of bases written (0 for unrelated histories).
+ */
+static int find_common_bases(char (*tips)[MAX_OID_LEN], int tip_count,
+                             char (*bases)[MAX_OID_LEN], int max_bases) {
+    char carry[MAX_OID_LEN];
+    snprintf(carry, sizeof(carry), "%s", tips[0]);
+    int base_count = 0;
+    
+    for (int start = 1; start < tip_count; start += MERGE_BASE_CHUNK) {
+        int end = (start + MERGE_BASE_CHUNK < tip_count) ? start + MERGE_BASE_CHUNK : tip_count;
+        
+        size_t cmd_len = 64 + (size_t)(end - start + 1) * MAX_OID_LEN;
+        char *cmd = (char*)safe_malloc(cmd_len);
+        if (cmd == NULL) return 0;
+        
+        size_t used = (size_t)snprintf(cmd, cmd_len, "git merge-base --octopus %s", carry);
+        for (int i = start; i < end; i++) {
+            used += (size_t)snprintf(cmd + used, cmd_len - used, " %s", tips[i]);
+        }
+        
+        cmd_result_t *result = exec_command_input(cmd, NULL, 0);
+        free(cmd);
+        
+        if (result == NULL || result->exit_code != 0 || result->output == NULL) {
+            if (result) free_cmd_result(result);
+            return 0;
+        }
+        
+        base_count = 0;
+        char *saveptr = NULL;
+        char *line = strtok_r(result->output, "\n", &saveptr);
+        while (line != NULL && base_count < max_bases) {
+            snprintf(bases[base_count++], MAX_OID_LEN, "%s", line);
+            line = strtok_r(NULL, "\n", &saveptr);
+        }
+        free_cmd_result(result);
+        
+        if (base_count == 0) return 0;
+        memcpy(carry, bases[0], sizeof(carry));
+    }
+    
+    return base_count;
+}
+
+/**
+ * Count ahead/behind commits for many pairs with a single history walk
+ * 
+ * Lists the commits between all tips and their common bases once
+ * ("rev-list --parents --topo-order"), then propagates a bit per tip
+ * from children to parents in process. Each pair is then a bit test
+ * per listed commit instead of a "rev-list --left-right --count" spawn.
+ * 
+ * @param pairs Pairs of commit IDs; ahead/behind are filled in
+ * @param count Number of pairs
+ * @return gm_error_t Error code
+ */
+gm_error_t compute_ahead_behind(ahead_behind_t *pairs, int count) {
+    if (pairs == NULL && count > 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+    
+    commit_walk_t walk;
+    memset(&walk, 0, sizeof(walk));
+    
+    /* Tips first, so tip t is slot t */
+    for (int i = 0; i < count; i++) {
+        pairs[i].ahead = 0;
+        pairs[i].behind = 0;
+        if (walk_slot(&walk, pairs[i].left) < 0 || walk_slot(&walk, pairs[i].right) < 0) {
+            free_commit_walk(&walk);
+            return GM_ERR_MEMORY_ALLOC;
+        }
+    }
+    
+    int tip_count = walk.count;
+    if (tip_count < 2) {
+        free_commit_walk(&walk);
+        return GM_SUCCESS;
+    }
+    
+    walk.words = (tip_count + 63) / 64;
+    walk.bits = (uint64_t*)safe_calloc((size_t)walk.slot_capacity * walk.words, sizeof(uint64_t));
+    if (walk.bits == NULL) {
+        free_commit_walk(&walk);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    for (int t = 0; t < tip_count; t++) {
+        walk.bits[(size_t)t * walk.words + t / 64] |= (uint64_t)1 << (t % 64);
+    }
+    
+    char bases[MAX_REMOTES][MAX_OID_LEN];
+    int base_count = find_common_bases(walk.oids, tip_count, bases, MAX_REMOTES);
+    
+    size_t input_cap = (size_t)(tip_count + base_count) * (MAX_OID_LEN + 1) + 1;
+    char *input = (char*)safe_malloc(input_cap);
+    if (input == NULL) {
+        free_commit_walk(&walk);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    size_t input_len = 0;
+    for (int t = 0; t < tip_count; t++) {
+        input_len += (size_t)snprintf(input + input_len, input_cap - input_len, "%s\n", walk.oids[t]);
+    }
+    for (int b = 0; b < base_count; b++) {
+        input_len += (size_t)snprintf(input + input_len, input_cap - input_len, "^%s\n", bases[b]);
+    }
+    
+    cmd_result_t *result = exec_git_command_input("rev-list --parents --topo-order --stdin",
+                                                  input, input_len);
+    free(input);
+    
+    if (result == NULL || result->exit_code != 0 || result->output == NULL) {
+        if (result) free_cmd_result(result);
+        free_commit_walk(&walk);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    /* Children come before parents, so a commit's bits are final when listed */
+    int *listed = NULL;
+    int listed_count = 0;
+    int listed_capacity = 0;
+    gm_error_t err = GM_SUCCESS;
+    
+    char *saveptr = NULL;
+    char *line = strtok_r(result->output, "\n", &saveptr);
+    while (line != NULL && err == GM_SUCCESS) {
+        char *field_save = NULL;
+        char *oid = strtok_r(line, " ", &field_save);
+        int slot = (oid != NULL) ? walk_slot(&walk, oid) : -1;
+        
+        if (slot < 0) {
+            err = GM_ERR_MEMORY_ALLOC;
+            break;
+        }
+        
+        if (listed_count == listed_capacity) {
+            listed_capacity = (listed_capacity == 0) ? 1024 : listed_capacity * 2;
+            int *grown = (int*)safe_realloc(listed, (size_t)listed_capacity * sizeof(int));
+            if (grown == NULL) {
+                err = GM_ERR_MEMORY_ALLOC;
+                break;
+            }
+            listed = grown;
+        }
+        listed[listed_count++] = slot;
+        
+        char *parent;
+        while ((parent = strtok_r(NULL, " ", &field_save)) != NULL) {
+            int parent_slot = walk_slot(&walk, parent);
+            if (parent_slot < 0) {
+                err = GM_ERR_MEMORY_ALLOC;
+                break;
+            }
+            uint64_t *dst = walk.bits + (size_t)parent_slot * walk.words;
+            const uint64_t *src = walk.bits + (size_t)slot * walk.words;
+            for (int w = 0; w < walk.words; w++) {
+                dst[w] |= src[w];
+            }
+        }
+        
+        line = strtok_r(NULL, "\n", &saveptr);
+    }
     free_cmd_result(result);
     
-    printf("Upstream: " COLOR_CYAN "%s" COLOR_RESET "\n", upstream);
+    if (err == GM_SUCCESS) {
+        for (int i = 0; i < count; i++) {
+            int left = walk_slot(&walk, pairs[i].left);
+            int right = walk_slot(&walk, pairs[i].right);
+            uint64_t left_mask = (uint64_t)1 << (left % 64);
+            uint64_t right_mask = (uint64_t)1 << (right % 64);
+            
+            for (int c = 0; c < listed_count; c++) {
+                const uint64_t *bits = walk.bits + (size_t)listed[c] * walk.words;
+                bool from_left = (bits[left / 64] & left_mask) != 0;
+                bool from_right = (bits[right / 64] & right_mask) != 0;
+                if (from_left && !from_right) pairs[i].ahead++;
+                else if (from_right && !from_left) pairs[i].behind++;
+            }
+        }
+    }
+    
+    free(listed);
+    free_commit_walk(&walk);
+    return err;
+}
+
+/* ============================================================================
+ * Sync Matrix Functions
+ * ============================================================================ */
+
+/* A remote-tracking ref, sorted by name for lookup */
+typedef struct {
+    char *refname;
+    char oid[MAX_OID_LEN];
+} tracking_ref_t;
+
+static int compare_tracking_refs(const void *a, const void *b) {
+    return strcmp(((const tracking_ref_t*)a)->refname, ((const tracking_ref_t*)b)->refname);
+}
+
+/**
+ * Build the sync matrix: every local branch against every remote that
+ * has a same-named branch
+ * 
+ * One for-each-ref scan supplies every tip, compute_ahead_behind
+ * counts all pairs in one walk, and last-push times come straight from
+ * the remote-tracking reflogs.
+ * 
+ * @param matrix Output matrix (free with free_sync_matrix)
+ * @return gm_error_t Error code
+ */
+gm_error_t build_sync_matrix(sync_matrix_t *matrix) {
+    if (matrix == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
     
-    /* Get ahead/behind count */
-    snprintf(cmd, sizeof(cmd), "rev-list --left-right --count \"%s\"...\"%s@{upstream}\"", 
-             current_branch, current_branch);
+    memset(matrix, 0, sizeof(*matrix));
     
-    result = exec_git_command(cmd);
+    gm_error_t err = list_remotes(&matrix->remotes, &matrix->remote_count);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    
+    cmd_result_t *result = exec_git_command_input(
+        "for-each-ref --format='%(objectname) %(refname)' refs/heads refs/remotes", NULL, 0);
+    if (result == NULL) {
+        free_sync_matrix(matrix);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    if (result->exit_code != 0 || result->output == NULL) {
+        free_cmd_result(result);
+        free_sync_matrix(matrix);
+        return GM_ERR_COMMAND_FAILED;
+    }
+    
+    int line_count = 1;
+    for (char *p = result->output; *p; p++) {
+        if (*p == '\n') line_count++;
+    }
+    
+    char (*branch_oids)[MAX_OID_LEN] = safe_calloc((size_t)line_count, MAX_OID_LEN);
+    tracking_ref_t *tracking = (tracking_ref_t*)safe_calloc((size_t)line_count, sizeof(tracking_ref_t));
+    matrix->branches = (char**)safe_calloc((size_t)line_count, sizeof(char*));
+    int tracking_count = 0;
     
-    if (result != NULL && result->exit_code == 0 && result->output != NULL) {
-        int ahead = 0, behind = 0;
-        if (sscanf(result->output, "%d\t%d", &ahead, &behind) == 2) {
-            if (ahead == 0 && behind == 0) {
-                printf("Status: " COLOR_GREEN "Up to date" COLOR_RESET "\n");
+    if (branch_oids == NULL || tracking == NULL || matrix->branches == NULL) {
+        free(branch_oids);
+        free(tracking);
+        free_cmd_result(result);
+        free_sync_matrix(matrix);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    
+    char *saveptr = NULL;
+    char *line = strtok_r(result->output, "\n", &saveptr);
+    while (line != NULL) {
+        char *refname = strchr(line, ' ');
+        if (refname != NULL) {
+            *refname++ = '\0';
+            if (strncmp(refname, "refs/heads/", 11) == 0) {
+                snprintf(branch_oids[matrix->branch_count], MAX_OID_LEN, "%s", line);
+                matrix->branches[matrix->branch_count++] = safe_strdup(refname + 11);
+            } else {
+                tracking[tracking_count].refname = refname;
+                snprintf(tracking[tracking_count].oid, MAX_OID_LEN, "%s", line);
+                tracking_count++;
+            }
+        }
+        line = strtok_r(NULL, "\n", &saveptr);
+    }
+    qsort(tracking, (size_t)tracking_count, sizeof(tracking_ref_t), compare_tracking_refs);
+    
+    int cell_count = matrix->branch_count * matrix->remote_count;
+    matrix->cells = (sync_cell_t*)safe_calloc((size_t)(cell_count > 0 ? cell_count : 1),
+                                              sizeof(sync_cell_t));
+    ahead_behind_t *pairs = (ahead_behind_t*)safe_calloc((size_t)(cell_count > 0 ? cell_count : 1),
+                                                         sizeof(ahead_behind_t));
+    int *pair_cells = (int*)safe_calloc((size_t)(cell_count > 0 ? cell_count : 1), sizeof(int));
+    int pair_count = 0;
+    
+    if (matrix->cells == NULL || pairs == NULL || pair_cells == NULL) {
+        err = GM_ERR_MEMORY_ALLOC;
+    }
+    
+    for (int b = 0; b < matrix->branch_count && err == GM_SUCCESS; b++) {
+        for (int r = 0; r < matrix->remote_count; r++) {
+            char name[2 * MAX_BRANCH_NAME + 16];
+            snprintf(name, sizeof(name), "refs/remotes/%s/%s", matrix->remotes[r], matrix->branches[b]);
+            
+            tracking_ref_t key = { name, "" };
+            tracking_ref_t *match = (tracking_ref_t*)bsearch(&key, tracking, (size_t)tracking_count,
+                                                             sizeof(tracking_ref_t),
+                                                             compare_tracking_refs);
+            if (match == NULL) continue;
+            
+            sync_cell_t *cell = &matrix->cells[b * matrix->remote_count + r];
+            cell->present = true;
+            read_reflog_time(name, "update by push", &cell->last_push);
+            
+            snprintf(pairs[pair_count].left, MAX_OID_LEN, "%s", branch_oids[b]);
+            snprintf(pairs[pair_count].right, MAX_OID_LEN, "%s", match->oid);
+            pair_cells[pair_count++] = b * matrix->remote_count + r;
+        }
+    }
+    
+    if (err == GM_SUCCESS) {
+        err = compute_ahead_behind(pairs, pair_count);
+    }
+    
+    if (err == GM_SUCCESS) {
+        for (int i = 0; i < pair_count; i++) {
+            sync_cell_t *cell = &matrix->cells[pair_cells[i]];
+            cell->ahead = pairs[i].ahead;
+            cell->behind = pairs[i].behind;
+            cell->diverged = (cell->ahead > 0 && cell->behind > 0);
+        }
+    }
+    
+    free(pairs);
+    free(pair_cells);
+    free(branch_oids);
+    free(tracking);
+    free_cmd_result(result);
+    
+    if (err != GM_SUCCESS) {
+        free_sync_matrix(matrix);
+    }
+    return err;
+}
+
+/**
+ * Free a sync matrix
+ * 
+ * @param matrix Matrix to free
+ */
+void free_sync_matrix(sync_matrix_t *matrix) {
+    if (matrix == NULL) {
+        return;
+    }
+    
+    if (matrix->branches != NULL) {
+        free_string_array(matrix->branches, matrix->branch_count);
+    }
+    if (matrix->remotes != NULL) {
+        free_string_array(matrix->remotes, matrix->remote_count);
+    }
+    free(matrix->cells);
+    memset(matrix, 0, sizeof(*matrix));
+}
+
+/**
+ * Compact age such as "5m", "3h" or "12d"
+ */
+static void format_age(time_t when, char *buf, size_t len) {
+    long long age = (long long)(time(NULL) - when);
+    if (age < 0) age = 0;
+    
+    if (age < 3600) {
+        snprintf(buf, len, "%lldm", age / 60);
+    } else if (age < 86400) {
+        snprintf(buf, len, "%lldh", age / 3600);
+    } else {
+        snprintf(buf, len, "%lldd", age / 86400);
+    }
+}
+
+/**
+ * Display the sync matrix of all branches against all remotes
+ * 
+ * @return gm_error_t Error code
+ */
+gm_error_t show_sync_matrix(void) {
+    sync_matrix_t matrix;
+    gm_error_t err = build_sync_matrix(&matrix);
+    
+    if (err != GM_SUCCESS) {
+        PRINT_ERROR("Failed to compute sync status");
+        return err;
+    }
+    
+    if (matrix.remote_count == 0 || matrix.branch_count == 0) {
+        if (matrix.remote_count == 0) {
+            PRINT_INFO("No remotes configured");
+        } else {
+            PRINT_INFO("No local branches");
+        }
+        free_sync_matrix(&matrix);
+        return GM_SUCCESS;
+    }
+    
+    char current[MAX_BRANCH_NAME] = "";
+    get_current_branch(current, sizeof(current));
+    
+    int name_width = 6;
+    for (int b = 0; b < matrix.branch_count; b++) {
+        int len = (int)strlen(matrix.branches[b]);
+        if (len > name_width) name_width = len;
+    }
+    if (name_width > 40) name_width = 40;
+    
+    const int cell_width = 16;
+    
+    printf("\n" COLOR_BOLD "Sync Matrix" COLOR_RESET " (ahead/behind, last push)\n\n");
+    printf(COLOR_BOLD "  %-*s", name_width, "Branch");
+    for (int r = 0; r < matrix.remote_count; r++) {
+        printf("  %-*.*s", cell_width, cell_width, matrix.remotes[r]);
+    }
+    printf(COLOR_RESET "\n");
+    
+    int diverged = 0;
+    int out_of_sync = 0;
+    
+    for (int b = 0; b < matrix.branch_count; b++) {
+        bool is_current = (strcmp(matrix.branches[b], current) == 0);
+        printf("%s %-*.*s", is_current ? "*" : " ", name_width, name_width, matrix.branches[b]);
+        
+        for (int r = 0; r < matrix.remote_count; r++) {
+            const sync_cell_t *cell = &matrix.cells[b * matrix.remote_count + r];
+            char text[64];
+            const char *color = COLOR_GREEN;
+            
+            if (!cell->present) {
+                snprintf(text, sizeof(text), ".");
+                color = "";
             } else {
-                if (ahead > 0) {
-                    printf("  " COLOR_YELLOW "%d commit(s) ahead" COLOR_RESET " - ready to push\n", ahead);
+                if (cell->diverged) {
+                    snprintf(text, sizeof(text), "+%d/-%d !", cell->ahead, cell->behind);
+                    color = COLOR_RED;
+                    diverged++;
+                } else if (cell->ahead > 0) {
+                    snprintf(text, sizeof(text), "+%d", cell->ahead);
+                    color = COLOR_YELLOW;
+                } else if (cell->behind > 0) {
+                    snprintf(text, sizeof(text), "-%d", cell->behind);
+                    color = COLOR_CYAN;
+                } else {
+                    snprintf(text, sizeof(text), "=");
+                }
+                
+                if (cell->ahead > 0 || cell->behind > 0) {
+                    out_of_sync++;
                 }
-                if (behind > 0) {
-                    printf("  " COLOR_RED "%d commit(s) behind" COLOR_RESET " - need to pull\n", behind);
+                
+                if (cell->last_push != 0) {
+                    char age[24];
+                    format_age(cell->last_push, age, sizeof(age));
+                    size_t used = strlen(text);
+                    snprintf(text + used, sizeof(text) - used, " %s", age);
                 }
             }
+            
+            printf("  %s%-*.*s%s", color, cell_width, cell_width, text, color[0] ? COLOR_RESET : "");
         }
+        printf("\n");
     }
     
-    if (result != NULL) {
-        free_cmd_result(result);
-    }
+    printf("\n  = in sync   +N ahead   -N behind   ! diverged   . no such branch\n");
+    printf("  %d branch(es), %d remote(s): %d out of sync, %d diverged\n\n",
+           matrix.branch_count, matrix.remote_count, out_of_sync, diverged);
     
-    printf("\n");
+    free_sync_matrix(&matrix);
     return GM_SUCCESS;
 }
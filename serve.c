@@ -0,0 +1,1138 @@
+/**
+ * serve.c - JSON-Lines Server for Git Master
+ *
+ * `git_master --serve` answers one JSON request per line with one JSON
+ * response per line, so scripts can drive the git_master.h API without
+ * the menus and without paying process start-up per call:
+ *
+ *   {"id":1,"op":"list_branches","repo":"/src/app"}
+ *   {"id":1,"ok":true,"ms":0.041,"result":[{"name":"main",...}]}
+ *
+ * Requests are flat objects; every key other than "id" and "op" is a
+ * parameter. Repository handles, their history pages and the git config
+ * cache stay warm between requests, and branch and ref queries read the
+ * ref store directly, so most requests never spawn git.
+ */
+
+#include "config.h"
+#include <ctype.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+/* ============================================================================
+ * Limits
+ * ============================================================================ */
+
+#define SERVE_MAX_LINE      65536   /* Longest request accepted */
+#define SERVE_MAX_FIELDS    16
+#define SERVE_MAX_ID        64      /* Raw JSON of the echoed id */
+#define SERVE_MAX_REPOS     32      /* Warm repository handles */
+#define SERVE_HISTORY_BATCH 256     /* Smallest history load */
+#define SERVE_HISTORY_LIMIT 1000    /* Most commits in one page */
+
+/* ============================================================================
+ * Server State
+ * ============================================================================ */
+
+/* One commit of a cached history; strings point into the load chunks */
+typedef struct {
+    const char *oid;
+    const char *author;
+    const char *subject;
+    long long time;
+} serve_commit_t;
+
+/* History of one tip, loaded a batch at a time as pages ask for it */
+typedef struct {
+    char tip[MAX_OID_LEN];
+    serve_commit_t *commits;
+    int count;
+    int capacity;
+    char **chunks;              /* git log outputs the commits point into */
+    int chunk_count;
+    bool complete;              /* Every commit reachable from tip is loaded */
+} serve_history_t;
+
+/* A repository named by requests, kept open between them */
+typedef struct {
+    char key[MAX_PATH_LEN];     /* "repo" as given; "" for the start directory */
+    char root[MAX_PATH_LEN];    /* Directory the API runs in */
+    serve_history_t history;
+    unsigned long last_used;
+    bool used;
+} serve_repo_t;
+
+typedef struct {
+    serve_repo_t repos[SERVE_MAX_REPOS];
+    serve_repo_t *current;      /* Handle whose root is the working directory */
+    char start_dir[MAX_PATH_LEN];
+    unsigned long tick;
+    activity_ring_t *activity;
+    bool stop;
+    char message[256];          /* Error detail for the current request */
+} serve_ctx_t;
+
+/* Growable response buffer */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t capacity;
+} serve_buf_t;
+
+typedef struct {
+    char *key;
+    char *value;                /* Decoded; numbers and literals as written */
+    bool is_string;
+} serve_field_t;
+
+typedef struct {
+    serve_field_t fields[SERVE_MAX_FIELDS];
+    int count;
+    char id[SERVE_MAX_ID];
+    const char *op;
+} serve_request_t;
+
+/* ============================================================================
+ * JSON Output
+ * ============================================================================ */
+
+static bool buf_reserve(serve_buf_t *buf, size_t extra) {
+    if (buf->len + extra + 1 <= buf->capacity) {
+        return true;
+    }
+
+    size_t capacity = (buf->capacity == 0) ? 4096 : buf->capacity;
+    while (buf->len + extra + 1 > capacity) {
+        capacity *= 2;
+    }
+    char *grown = (char*)safe_realloc(buf->data, capacity);
+    if (grown == NULL) {
+        return false;
+    }
+    buf->data = grown;
+    buf->capacity = capacity;
+    return true;
+}
+
+static void buf_append(serve_buf_t *buf, const char *text, size_t len) {
+    if (!buf_reserve(buf, len)) return;
+    memcpy(buf->data + buf->len, text, len);
+    buf->len += len;
+    buf->data[buf->len] = '\0';
+}
+
+static void buf_puts(serve_buf_t *buf, const char *text) {
+    buf_append(buf, text, strlen(text));
+}
+
+static void buf_printf(serve_buf_t *buf, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    if (n < 0 || !buf_reserve(buf, (size_t)n)) return;
+
+    va_start(args, format);
+    vsnprintf(buf->data + buf->len, (size_t)n + 1, format, args);
+    va_end(args);
+    buf->len += (size_t)n;
+}
+
+/**
+ * Append a string as a JSON string literal
+ */
+static void buf_json_string(serve_buf_t *buf, const char *text) {
+    if (text == NULL) {
+        buf_puts(buf, "null");
+        return;
+    }
+
+    buf_append(buf, "\"", 1);
+    const char *run = text;
+    for (const char *p = text; *p != '\0'; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        buf_append(buf, run, (size_t)(p - run));
+        switch (c) {
+            case '"':  buf_puts(buf, "\\\""); break;
+            case '\\': buf_puts(buf, "\\\\"); break;
+            case '\n': buf_puts(buf, "\\n"); break;
+            case '\r': buf_puts(buf, "\\r"); break;
+            case '\t': buf_puts(buf, "\\t"); break;
+            default:   buf_printf(buf, "\\u%04x", c); break;
+        }
+        run = p + 1;
+    }
+    buf_puts(buf, run);
+    buf_append(buf, "\"", 1);
+}
+
+/* ============================================================================
+ * JSON Input
+ * ============================================================================ */
+
+static char* skip_space(char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+    return p;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool read_hex4(const char *p, unsigned int *value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = hex_value(p[i]);
+        if (digit < 0) return false;
+        *value = (*value << 4) | (unsigned int)digit;
+    }
+    return true;
+}
+
+/**
+ * Decode a JSON string in place
+ *
+ * The decoded text is never longer than its escaped form, so it is
+ * written over the literal and terminated there.
+ *
+ * @param p Points at the opening quote
+ * @return char* Position after the closing quote, or NULL if malformed
+ */
+static char* decode_string(char *p, char **value) {
+    char *out = ++p;
+    *value = out;
+
+    while (*p != '"') {
+        unsigned char c = (unsigned char)*p;
+        if (c == '\0' || c < 0x20) {
+            return NULL;
+        }
+        if (c != '\\') {
+            *out++ = *p++;
+            continue;
+        }
+
+        p++;
+        switch (*p) {
+            case '"':  *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/':  *out++ = '/'; break;
+            case 'b':  *out++ = '\b'; break;
+            case 'f':  *out++ = '\f'; break;
+            case 'n':  *out++ = '\n'; break;
+            case 'r':  *out++ = '\r'; break;
+            case 't':  *out++ = '\t'; break;
+            case 'u': {
+                unsigned int cp;
+                if (!read_hex4(p + 1, &cp)) return NULL;
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    unsigned int low;
+                    if (p[1] != '\\' || p[2] != 'u' || !read_hex4(p + 3, &low) ||
+                        low < 0xDC00 || low > 0xDFFF) {
+                        return NULL;
+                    }
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                if (cp == 0) return NULL;
+
+                if (cp < 0x80) {
+                    *out++ = (char)cp;
+                } else if (cp < 0x800) {
+                    *out++ = (char)(0xC0 | (cp >> 6));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    *out++ = (char)(0xE0 | (cp >> 12));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                } else {
+                    *out++ = (char)(0xF0 | (cp >> 18));
+                    *out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    *out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *out++ = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            }
+            default:
+                return NULL;
+        }
+        p++;
+    }
+
+    *out = '\0';
+    return p + 1;
+}
+
+/**
+ * Is [p, end) a JSON literal: true, false, null, or a number in JSON's
+ * grammar -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+ *
+ * strtod alone would also take nan, inf, hex and "+1", none of which
+ * may be echoed back into a JSON response.
+ */
+static bool is_json_literal(const char *p, const char *end) {
+    size_t len = (size_t)(end - p);
+    if ((len == 4 && (strncmp(p, "true", 4) == 0 || strncmp(p, "null", 4) == 0)) ||
+        (len == 5 && strncmp(p, "false", 5) == 0)) {
+        return true;
+    }
+
+    if (p < end && *p == '-') p++;
+    if (p == end || !isdigit((unsigned char)*p)) return false;
+    if (*p == '0') {
+        p++;
+    } else {
+        while (p < end && isdigit((unsigned char)*p)) p++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        if (p == end || !isdigit((unsigned char)*p)) return false;
+        while (p < end && isdigit((unsigned char)*p)) p++;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '+' || *p == '-')) p++;
+        if (p == end || !isdigit((unsigned char)*p)) return false;
+        while (p < end && isdigit((unsigned char)*p)) p++;
+    }
+    return p == end;
+}
+
+/**
+ * Parse one request line in place
+ *
+ * Only flat objects are accepted: values are strings, numbers, true,
+ * false or null.
+ *
+ * @return const char* NULL on success, otherwise what was wrong
+ */
+static const char* parse_request(char *line, serve_request_t *req) {
+    memset(req, 0, sizeof(*req));
+    snprintf(req->id, sizeof(req->id), "null");
+
+    char *p = skip_space(line);
+    if (*p++ != '{') {
+        return "request is not a JSON object";
+    }
+
+    p = skip_space(p);
+    if (*p == '}') {
+        return "missing \"op\"";
+    }
+
+    while (true) {
+        if (*p != '"') return "expected a key";
+
+        char *key;
+        p = decode_string(p, &key);
+        if (p == NULL) return "malformed key";
+
+        p = skip_space(p);
+        if (*p++ != ':') return "expected ':'";
+        p = skip_space(p);
+
+        char *value;
+        char *raw = p;
+        bool is_string = (*p == '"');
+        if (is_string) {
+            p = decode_string(p, &value);
+            if (p == NULL) return "malformed string";
+        } else if (*p == '{' || *p == '[') {
+            return "nested values are not supported";
+        } else {
+            value = p;
+            while (*p != '\0' && strchr(",} \t\r\n", *p) == NULL) p++;
+            if (p == value) return "expected a value";
+            if (!is_json_literal(value, p)) return "invalid literal";
+        }
+
+        /* The id is echoed as written, so take it before the terminator lands */
+        if (strcmp(key, "id") == 0) {
+            if (p - raw >= (long)sizeof(req->id)) return "id is too long";
+            if (is_string) {
+                req->id[0] = '\0';
+            } else {
+                snprintf(req->id, sizeof(req->id), "%.*s", (int)(p - raw), raw);
+            }
+        }
+
+        char *end = p;
+        p = skip_space(p);
+        char next = *p;
+        *end = '\0';
+
+        if (strcmp(key, "id") == 0 && is_string) {
+            serve_buf_t id = { 0 };
+            buf_json_string(&id, value);
+            if (id.data == NULL || id.len >= sizeof(req->id)) {
+                free(id.data);
+                return "id is too long";
+            }
+            memcpy(req->id, id.data, id.len + 1);
+            free(id.data);
+        } else if (strcmp(key, "op") == 0) {
+            if (!is_string) return "\"op\" must be a string";
+            req->op = value;
+        } else if (strcmp(key, "id") != 0) {
+            if (req->count == SERVE_MAX_FIELDS) return "too many parameters";
+            req->fields[req->count].key = key;
+            req->fields[req->count].value = value;
+            req->fields[req->count].is_string = is_string;
+            req->count++;
+        }
+
+        p++;
+        if (next == '}') break;
+        if (next != ',') return "expected ',' or '}'";
+        p = skip_space(p);
+    }
+
+    if (*skip_space(p) != '\0') return "trailing characters after the object";
+    if (req->op == NULL) return "missing \"op\"";
+    return NULL;
+}
+
+static const serve_field_t* find_param(const serve_request_t *req, const char *key) {
+    for (int i = 0; i < req->count; i++) {
+        if (strcmp(req->fields[i].key, key) == 0) {
+            return &req->fields[i];
+        }
+    }
+    return NULL;
+}
+
+static const char* param_string(const serve_request_t *req, const char *key, const char *fallback) {
+    const serve_field_t *field = find_param(req, key);
+    return (field != NULL && field->is_string) ? field->value : fallback;
+}
+
+static long param_long(const serve_request_t *req, const char *key, long fallback) {
+    const serve_field_t *field = find_param(req, key);
+    if (field == NULL || field->is_string || strcmp(field->value, "null") == 0) {
+        return fallback;
+    }
+    return strtol(field->value, NULL, 10);
+}
+
+static bool param_bool(const serve_request_t *req, const char *key, bool fallback) {
+    const serve_field_t *field = find_param(req, key);
+    if (field == NULL || field->is_string) {
+        return fallback;
+    }
+    if (strcmp(field->value, "true") == 0) return true;
+    if (strcmp(field->value, "false") == 0) return false;
+    return fallback;
+}
+
+/* ============================================================================
+ * Repository Handles
+ * ============================================================================ */
+
+static void history_reset(serve_history_t *history) {
+    for (int i = 0; i < history->chunk_count; i++) {
+        free(history->chunks[i]);
+    }
+    free(history->chunks);
+    free(history->commits);
+    memset(history, 0, sizeof(*history));
+}
+
+/**
+ * Make a repository the working directory, opening a handle for it on
+ * first use
+ *
+ * Relative paths are taken from the directory the server started in.
+ * When every handle is taken, the least recently used one is dropped.
+ */
+static gm_error_t select_repo(serve_ctx_t *ctx, const char *key, serve_repo_t **out) {
+    serve_repo_t *repo = NULL;
+    serve_repo_t *oldest = &ctx->repos[0];
+
+    for (int i = 0; i < SERVE_MAX_REPOS; i++) {
+        serve_repo_t *candidate = &ctx->repos[i];
+        if (candidate->used && strcmp(candidate->key, key) == 0) {
+            repo = candidate;
+            break;
+        }
+        if (!candidate->used || (oldest->used && candidate->last_used < oldest->last_used)) {
+            oldest = candidate;
+        }
+    }
+
+    if (repo == NULL) {
+        char path[MAX_PATH_LEN];
+        if (key[0] == '\0') {
+            snprintf(path, sizeof(path), "%s", ctx->start_dir);
+        } else if (key[0] == '/') {
+            snprintf(path, sizeof(path), "%s", key);
+        } else if (snprintf(path, sizeof(path), "%s/%s", ctx->start_dir, key) >= (int)sizeof(path)) {
+            return GM_ERR_INVALID_INPUT;
+        }
+
+        char root[MAX_PATH_LEN];
+        if (realpath(path, root) == NULL) {
+            snprintf(ctx->message, sizeof(ctx->message), "%.200s: %s", key, strerror(errno));
+            return GM_ERR_NOT_GIT_REPO;
+        }
+
+        repo = oldest;
+        if (ctx->current == repo) {
+            ctx->current = NULL;
+        }
+        history_reset(&repo->history);
+        snprintf(repo->key, sizeof(repo->key), "%s", key);
+        memcpy(repo->root, root, sizeof(repo->root));
+        repo->used = true;
+    }
+
+    if (ctx->current != repo) {
+        char git_dir[MAX_PATH_LEN];
+        if (chdir(repo->root) != 0 || find_git_dir(git_dir, sizeof(git_dir)) != GM_SUCCESS) {
+            repo->used = false;
+            ctx->current = NULL;
+            snprintf(ctx->message, sizeof(ctx->message), "%.200s is not a git repository",
+                     key[0] ? key : ctx->start_dir);
+            return GM_ERR_NOT_GIT_REPO;
+        }
+        ctx->current = repo;
+    }
+
+    repo->last_used = ++ctx->tick;
+    *out = repo;
+    return GM_SUCCESS;
+}
+
+/**
+ * Resolve a branch, tag, full ref or revision to an object ID
+ *
+ * Names are looked up in the ref store directly; only revision syntax
+ * such as "HEAD~3" costs a rev-parse.
+ */
+static gm_error_t resolve_revision(const char *rev, char *oid, size_t len) {
+    static const char *const patterns[] = { "%s", "refs/heads/%s", "refs/tags/%s", "refs/remotes/%s" };
+    char ref[MAX_PATH_LEN];
+    bool full = (strcmp(rev, "HEAD") == 0 || strncmp(rev, "refs/", 5) == 0);
+
+    for (size_t i = full ? 0 : 1; i < (full ? 1 : sizeof(patterns) / sizeof(patterns[0])); i++) {
+        snprintf(ref, sizeof(ref), patterns[i], rev);
+        if (resolve_ref_oid(ref, oid, len) == GM_SUCCESS) {
+            return GM_SUCCESS;
+        }
+    }
+
+    if (rev[0] == '\0' || rev[0] == '-' || strpbrk(rev, "\"$`\\\n") != NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char cmd[MAX_COMMAND_LEN];
+    snprintf(cmd, sizeof(cmd), "rev-parse --verify --quiet \"%s^{commit}\"", rev);
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    gm_error_t err = GM_ERR_BRANCH_NOT_FOUND;
+    if (result->exit_code == 0 && result->output != NULL) {
+        snprintf(oid, len, "%s", trim_whitespace(result->output));
+        err = GM_SUCCESS;
+    }
+    free_cmd_result(result);
+    return err;
+}
+
+/**
+ * Load more of a history until it holds at least `needed` commits or
+ * reaches the root
+ *
+ * Each load asks git for at least as many commits as are already
+ * cached, so deep pages cost a logarithmic number of spawns.
+ */
+static gm_error_t history_extend(serve_history_t *history, int needed) {
+    while (!history->complete && history->count < needed) {
+        int batch = needed - history->count;
+        if (batch < history->count) batch = history->count;
+        if (batch < SERVE_HISTORY_BATCH) batch = SERVE_HISTORY_BATCH;
+
+        char cmd[MAX_COMMAND_LEN];
+        snprintf(cmd, sizeof(cmd), "log --format=%%H%%x1f%%an%%x1f%%at%%x1f%%s --skip=%d -n %d %s",
+                 history->count, batch, history->tip);
+
+        cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
+        if (result == NULL) {
+            return GM_ERR_COMMAND_FAILED;
+        }
+        if (result->exit_code != 0 || result->output == NULL) {
+            free_cmd_result(result);
+            return GM_ERR_COMMAND_FAILED;
+        }
+
+        char **chunks = (char**)safe_realloc(history->chunks,
+                                             (size_t)(history->chunk_count + 1) * sizeof(char*));
+        if (chunks == NULL) {
+            free_cmd_result(result);
+            return GM_ERR_MEMORY_ALLOC;
+        }
+        history->chunks = chunks;
+
+        /* The commits point into the output, so the history takes it over */
+        char *text = result->output;
+        result->output = NULL;
+        free_cmd_result(result);
+        history->chunks[history->chunk_count++] = text;
+
+        int loaded = 0;
+        char *save = NULL;
+        for (char *line = strtok_r(text, "\n", &save); line != NULL;
+             line = strtok_r(NULL, "\n", &save)) {
+            char *fields[4];
+            int n = 0;
+            fields[n++] = line;
+            for (char *p = line; *p != '\0' && n < 4; p++) {
+                if (*p == '\x1f') {
+                    *p = '\0';
+                    fields[n++] = p + 1;
+                }
+            }
+            if (n < 4) continue;
+
+            if (history->count == history->capacity) {
+                int capacity = (history->capacity == 0) ? SERVE_HISTORY_BATCH : history->capacity * 2;
+                serve_commit_t *grown = (serve_commit_t*)safe_realloc(
+                    history->commits, (size_t)capacity * sizeof(serve_commit_t));
+                if (grown == NULL) {
+                    return GM_ERR_MEMORY_ALLOC;
+                }
+                history->commits = grown;
+                history->capacity = capacity;
+            }
+
+            serve_commit_t *commit = &history->commits[history->count++];
+            commit->oid = fields[0];
+            commit->author = fields[1];
+            commit->time = strtoll(fields[2], NULL, 10);
+            commit->subject = fields[3];
+            loaded++;
+        }
+
+        if (loaded < batch) {
+            history->complete = true;
+        }
+    }
+
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Operations
+ * ============================================================================ */
+
+typedef gm_error_t (*serve_handler_t)(serve_ctx_t *ctx, serve_repo_t *repo,
+                                      const serve_request_t *req, serve_buf_t *out);
+
+static gm_error_t op_ping(serve_ctx_t *ctx, serve_repo_t *repo,
+                          const serve_request_t *req, serve_buf_t *out) {
+    (void)repo;
+    (void)req;
+
+    int open = 0;
+    for (int i = 0; i < SERVE_MAX_REPOS; i++) {
+        if (ctx->repos[i].used) open++;
+    }
+    buf_printf(out, "{\"version\":\"1.0.0\",\"pid\":%d,\"repos\":%d}", (int)getpid(), open);
+    return GM_SUCCESS;
+}
+
+static gm_error_t op_shutdown(serve_ctx_t *ctx, serve_repo_t *repo,
+                              const serve_request_t *req, serve_buf_t *out) {
+    (void)repo;
+    (void)req;
+
+    ctx->stop = true;
+    buf_puts(out, "null");
+    return GM_SUCCESS;
+}
+
+/**
+ * Branch, upstream and change counts from one `git status`
+ */
+static gm_error_t op_status(serve_ctx_t *ctx, serve_repo_t *repo,
+                            const serve_request_t *req, serve_buf_t *out) {
+    (void)ctx;
+
+    change_list_t changes;
+    gm_error_t err = load_change_list(&changes, param_bool(req, "untracked", true));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    int staged = 0, modified = 0, untracked = 0, conflicted = 0;
+    for (int i = 0; i < changes.count; i++) {
+        const change_entry_t *entry = &changes.entries[i];
+        if (entry->kind == CHANGE_UNTRACKED) {
+            untracked++;
+        } else if (entry->kind == CHANGE_UNMERGED) {
+            conflicted++;
+        } else if (entry->kind != CHANGE_IGNORED) {
+            if (entry->index_state != '.') staged++;
+            if (entry->worktree_state != '.') modified++;
+        }
+    }
+
+    buf_puts(out, "{\"path\":");
+    buf_json_string(out, repo->root);
+    buf_puts(out, ",\"branch\":");
+    buf_json_string(out, changes.branch);
+    buf_puts(out, ",\"upstream\":");
+    buf_json_string(out, changes.has_upstream ? changes.upstream : NULL);
+    buf_printf(out, ",\"ahead\":%d,\"behind\":%d,\"staged\":%d,\"modified\":%d,"
+               "\"untracked\":%d,\"conflicted\":%d,\"clean\":%s}",
+               changes.ahead, changes.behind, staged, modified, untracked, conflicted,
+               (staged + modified + untracked + conflicted == 0) ? "true" : "false");
+
+    free_change_list(&changes);
+    return GM_SUCCESS;
+}
+
+/**
+ * Every changed path, as `git status --porcelain=v2` reports it
+ */
+static gm_error_t op_changes(serve_ctx_t *ctx, serve_repo_t *repo,
+                             const serve_request_t *req, serve_buf_t *out) {
+    static const char *const kinds[] = {
+        "ordinary", "renamed", "copied", "unmerged", "untracked", "ignored"
+    };
+    (void)ctx;
+    (void)repo;
+
+    change_list_t changes;
+    gm_error_t err = load_change_list(&changes, param_bool(req, "untracked", true));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    buf_puts(out, "[");
+    for (int i = 0; i < changes.count; i++) {
+        const change_entry_t *entry = &changes.entries[i];
+        buf_puts(out, i > 0 ? ",{\"path\":" : "{\"path\":");
+        buf_json_string(out, changes.paths + entry->path_offset);
+        if (entry->has_orig) {
+            buf_puts(out, ",\"orig\":");
+            buf_json_string(out, changes.paths + entry->orig_offset);
+        }
+        buf_printf(out, ",\"kind\":\"%s\",\"index\":\"%c\",\"worktree\":\"%c\"}",
+                   entry->kind < sizeof(kinds) / sizeof(kinds[0]) ? kinds[entry->kind] : "unknown",
+                   entry->index_state, entry->worktree_state);
+    }
+    buf_puts(out, "]");
+
+    free_change_list(&changes);
+    return GM_SUCCESS;
+}
+
+/**
+ * Local (and optionally remote-tracking) branches, read from the ref store
+ */
+static gm_error_t op_list_branches(serve_ctx_t *ctx, serve_repo_t *repo,
+                                   const serve_request_t *req, serve_buf_t *out) {
+    (void)ctx;
+    (void)repo;
+
+    /* HEAD names the current branch; it is per-worktree, so it lives in the git dir */
+    char git_dir[MAX_PATH_LEN];
+    char head[MAX_PATH_LEN] = "";
+    if (find_git_dir(git_dir, sizeof(git_dir)) == GM_SUCCESS) {
+        char path[MAX_PATH_LEN + 8];
+        snprintf(path, sizeof(path), "%s/HEAD", git_dir);
+        FILE *fp = fopen(path, "r");
+        if (fp != NULL) {
+            if (fgets(head, sizeof(head), fp) == NULL) head[0] = '\0';
+            head[strcspn(head, "\r\n")] = '\0';
+            fclose(fp);
+        }
+    }
+    const char *current = (strncmp(head, "ref: ", 5) == 0) ? head + 5 : "";
+
+    static const char *const prefixes[] = { "refs/heads/", "refs/remotes/" };
+    int prefix_count = param_bool(req, "remote", false) ? 2 : 1;
+    bool first = true;
+
+    buf_puts(out, "[");
+    for (int p = 0; p < prefix_count; p++) {
+        ref_entry_t *refs = NULL;
+        int count = 0;
+        gm_error_t err = read_refs(prefixes[p], &refs, &count);
+        if (err != GM_SUCCESS) {
+            return err;
+        }
+
+        size_t prefix_len = strlen(prefixes[p]);
+        for (int i = 0; i < count; i++) {
+            buf_puts(out, first ? "{\"name\":" : ",{\"name\":");
+            buf_json_string(out, refs[i].name + prefix_len);
+            buf_printf(out, ",\"oid\":\"%s\",\"remote\":%s,\"current\":%s}", refs[i].oid,
+                       p == 1 ? "true" : "false",
+                       strcmp(refs[i].name, current) == 0 ? "true" : "false");
+            first = false;
+        }
+        free(refs);
+    }
+    buf_puts(out, "]");
+    return GM_SUCCESS;
+}
+
+static gm_error_t op_resolve(serve_ctx_t *ctx, serve_repo_t *repo,
+                             const serve_request_t *req, serve_buf_t *out) {
+    (void)ctx;
+    (void)repo;
+
+    char oid[MAX_OID_LEN];
+    gm_error_t err = resolve_revision(param_string(req, "ref", "HEAD"), oid, sizeof(oid));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    buf_printf(out, "{\"oid\":\"%s\"}", oid);
+    return GM_SUCCESS;
+}
+
+/**
+ * One page of `git log` from a ref, newest first
+ *
+ * Pages of the same tip come from the handle's cache; a moved tip
+ * starts a new one.
+ */
+static gm_error_t op_history(serve_ctx_t *ctx, serve_repo_t *repo,
+                             const serve_request_t *req, serve_buf_t *out) {
+    char oid[MAX_OID_LEN];
+    long skip = param_long(req, "skip", 0);
+    long limit = param_long(req, "limit", 50);
+
+    if (skip < 0 || limit < 1 || limit > SERVE_HISTORY_LIMIT || skip > INT_MAX - limit - 1) {
+        snprintf(ctx->message, sizeof(ctx->message),
+                 "\"skip\" must be >= 0 and \"limit\" between 1 and %d", SERVE_HISTORY_LIMIT);
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    gm_error_t err = resolve_revision(param_string(req, "ref", "HEAD"), oid, sizeof(oid));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    serve_history_t *history = &repo->history;
+    if (strcmp(history->tip, oid) != 0) {
+        history_reset(history);
+        snprintf(history->tip, sizeof(history->tip), "%s", oid);
+    }
+
+    /* One commit past the page tells whether another page follows */
+    err = history_extend(history, (int)(skip + limit + 1));
+    if (err != GM_SUCCESS) {
+        history_reset(history);
+        return err;
+    }
+
+    int end = (skip + limit < history->count) ? (int)(skip + limit) : history->count;
+    buf_printf(out, "{\"tip\":\"%s\",\"commits\":[", oid);
+    for (int i = (int)skip; i < end; i++) {
+        const serve_commit_t *commit = &history->commits[i];
+        buf_printf(out, "%s{\"oid\":\"%s\",\"time\":%lld,\"author\":",
+                   i > skip ? "," : "", commit->oid, commit->time);
+        buf_json_string(out, commit->author);
+        buf_puts(out, ",\"subject\":");
+        buf_json_string(out, commit->subject);
+        buf_puts(out, "}");
+    }
+    buf_printf(out, "],\"more\":%s}", history->count > end ? "true" : "false");
+    return GM_SUCCESS;
+}
+
+/**
+ * Dry-run merge of a branch into HEAD
+ */
+static gm_error_t op_merge_check(serve_ctx_t *ctx, serve_repo_t *repo,
+                                 const serve_request_t *req, serve_buf_t *out) {
+    (void)repo;
+
+    const char *branch = param_string(req, "branch", NULL);
+    if (branch == NULL) {
+        snprintf(ctx->message, sizeof(ctx->message), "\"branch\" is required");
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    bool has_conflicts = false;
+    gm_error_t err = check_merge_conflicts(branch, &has_conflicts);
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+    buf_printf(out, "{\"conflicts\":%s}", has_conflicts ? "true" : "false");
+    return GM_SUCCESS;
+}
+
+/**
+ * Read a git config value from the parsed config cache
+ */
+static gm_error_t op_config_get(serve_ctx_t *ctx, serve_repo_t *repo,
+                                const serve_request_t *req, serve_buf_t *out) {
+    (void)repo;
+
+    const char *key = param_string(req, "key", NULL);
+    if (key == NULL) {
+        snprintf(ctx->message, sizeof(ctx->message), "\"key\" is required");
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    gm_error_t err = git_config_load();
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    char value[MAX_PATH_LEN];
+    bool found = git_config_get(key, value, sizeof(value));
+    buf_puts(out, "{\"value\":");
+    buf_json_string(out, found ? value : NULL);
+    buf_puts(out, "}");
+    return GM_SUCCESS;
+}
+
+typedef struct {
+    const char *name;
+    serve_handler_t handler;
+    bool needs_repo;
+} serve_op_t;
+
+static const serve_op_t SERVE_OPS[] = {
+    { "ping",           op_ping,            false },
+    { "shutdown",       op_shutdown,        false },
+    { "status",         op_status,          true },
+    { "changes",        op_changes,         true },
+    { "list_branches",  op_list_branches,   true },
+    { "resolve",        op_resolve,         true },
+    { "history",        op_history,         true },
+    { "merge_check",    op_merge_check,     true },
+    { "config_get",     op_config_get,      true },
+};
+
+/* ============================================================================
+ * Request Loop
+ * ============================================================================ */
+
+/**
+ * Answer one request line
+ */
+static void serve_line(serve_ctx_t *ctx, char *line, serve_buf_t *out) {
+    double started = activity_clock_ms();
+    serve_request_t req;
+    serve_buf_t result = { 0 };
+    serve_repo_t *repo = NULL;
+    gm_error_t err = GM_SUCCESS;
+
+    ctx->message[0] = '\0';
+
+    const char *problem = parse_request(line, &req);
+    if (problem != NULL) {
+        snprintf(ctx->message, sizeof(ctx->message), "%s", problem);
+        err = GM_ERR_INVALID_INPUT;
+    } else {
+        const serve_op_t *op = NULL;
+        for (size_t i = 0; i < sizeof(SERVE_OPS) / sizeof(SERVE_OPS[0]); i++) {
+            if (strcmp(SERVE_OPS[i].name, req.op) == 0) {
+                op = &SERVE_OPS[i];
+                break;
+            }
+        }
+
+        if (op == NULL) {
+            snprintf(ctx->message, sizeof(ctx->message), "unknown op \"%.64s\"", req.op);
+            err = GM_ERR_INVALID_INPUT;
+        } else {
+            if (op->needs_repo) {
+                err = select_repo(ctx, param_string(&req, "repo", ""), &repo);
+            }
+            if (err == GM_SUCCESS) {
+                err = op->handler(ctx, repo, &req, &result);
+            }
+        }
+    }
+
+    double elapsed = activity_clock_ms() - started;
+
+    out->len = 0;
+    buf_printf(out, "{\"id\":%s,\"ok\":%s,\"ms\":%.3f,", req.id,
+               err == GM_SUCCESS ? "true" : "false", elapsed);
+    if (err == GM_SUCCESS) {
+        buf_puts(out, "\"result\":");
+        buf_puts(out, result.data != NULL ? result.data : "null");
+    } else {
+        buf_printf(out, "\"error\":{\"code\":%d,\"message\":", (int)err);
+        buf_json_string(out, ctx->message[0] ? ctx->message : gm_error_string(err));
+        buf_puts(out, "}");
+    }
+    buf_puts(out, "}\n");
+    free(result.data);
+
+    if (req.op != NULL) {
+        activity_push(ctx->activity, req.op, repo != NULL ? repo->root : NULL,
+                      elapsed, err, err != GM_SUCCESS ? ctx->message : NULL);
+    }
+}
+
+/**
+ * Serve requests from one stream until it ends or a shutdown request
+ */
+static void serve_stream(serve_ctx_t *ctx, FILE *in, FILE *out) {
+    char *line = NULL;
+    size_t line_cap = 0;
+    serve_buf_t response = { 0 };
+    ssize_t len;
+
+    while (!ctx->stop && (len = getline(&line, &line_cap, in)) >= 0) {
+        if (*skip_space(line) == '\0') {
+            continue;
+        }
+
+        if (len > SERVE_MAX_LINE) {
+            snprintf(line, line_cap, "{\"id\":null,\"ok\":false,\"error\":{\"code\":%d,"
+                     "\"message\":\"request longer than %d bytes\"}}\n",
+                     (int)GM_ERR_INVALID_INPUT, SERVE_MAX_LINE);
+            fputs(line, out);
+        } else {
+            serve_line(ctx, line, &response);
+            if (response.data != NULL) {
+                fwrite(response.data, 1, response.len, out);
+            }
+        }
+        fflush(out);
+    }
+
+    free(line);
+    free(response.data);
+}
+
+/**
+ * Accept connections on a Unix socket, one at a time
+ */
+static gm_error_t serve_socket(serve_ctx_t *ctx, const char *socket_path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+        PRINT_ERROR("Socket path is too long: %s", socket_path);
+        return GM_ERR_INVALID_INPUT;
+    }
+    memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        PRINT_ERROR("Cannot create socket: %s", strerror(errno));
+        return GM_ERR_IO_ERROR;
+    }
+
+    /* A socket file left by a server that was killed would block the bind;
+       anything else at the path is not ours to delete */
+    struct stat st;
+    if (lstat(socket_path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            PRINT_ERROR("Cannot listen on %s: path exists and is not a socket", socket_path);
+            close(listener);
+            return GM_ERR_INVALID_INPUT;
+        }
+        unlink(socket_path);
+    }
+
+    /* Owner-only from the start: whoever can connect can run git as us */
+    mode_t old_umask = umask(0177);
+    int bound = bind(listener, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old_umask);
+    if (bound != 0 || listen(listener, 8) != 0) {
+        PRINT_ERROR("Cannot listen on %s: %s", socket_path, strerror(errno));
+        close(listener);
+        return GM_ERR_IO_ERROR;
+    }
+    PRINT_INFO("Serving on %s", socket_path);
+
+    while (!ctx->stop) {
+        int fd = accept(listener, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        FILE *in = fdopen(fd, "r");
+        int out_fd = dup(fd);
+        FILE *out = (out_fd >= 0) ? fdopen(out_fd, "w") : NULL;
+        if (in != NULL && out != NULL) {
+            serve_stream(ctx, in, out);
+        }
+        if (out != NULL) fclose(out); else if (out_fd >= 0) close(out_fd);
+        if (in != NULL) fclose(in); else close(fd);
+    }
+
+    close(listener);
+    unlink(socket_path);
+    return GM_SUCCESS;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+/**
+ * Run the JSON-lines server
+ *
+ * With no socket, requests come from stdin and responses go to stdout;
+ * anything the API prints is sent to stderr so it cannot corrupt the
+ * response stream.
+ *
+ * @param socket_path Unix socket to listen on, or NULL for stdin/stdout
+ * @return gm_error_t Error code
+ */
+gm_error_t serve_run(const char *socket_path) {
+    serve_ctx_t *ctx = (serve_ctx_t*)safe_calloc(1, sizeof(serve_ctx_t));
+    if (ctx == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    if (getcwd(ctx->start_dir, sizeof(ctx->start_dir)) == NULL) {
+        free(ctx);
+        return GM_ERR_IO_ERROR;
+    }
+
+    /* A client that goes away mid-response must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+    ctx->activity = activity_open("serve");
+
+    gm_error_t err = GM_SUCCESS;
+    if (socket_path != NULL) {
+        err = serve_socket(ctx, socket_path);
+    } else {
+        fflush(stdout);
+        int out_fd = dup(STDOUT_FILENO);
+        FILE *out = (out_fd >= 0) ? fdopen(out_fd, "w") : NULL;
+        if (out == NULL) {
+            err = GM_ERR_IO_ERROR;
+        } else {
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+            serve_stream(ctx, stdin, out);
+            fclose(out);
+        }
+    }
+
+    for (int i = 0; i < SERVE_MAX_REPOS; i++) {
+        history_reset(&ctx->repos[i].history);
+    }
+    activity_close(ctx->activity);
+    if (chdir(ctx->start_dir) != 0) {
+        err = GM_ERR_IO_ERROR;
+    }
+    free(ctx);
+    return err;
+}
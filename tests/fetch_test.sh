@@ -0,0 +1,60 @@
+#!/bin/sh
+#
+# fetch_test.sh - Fetch all remotes against local bare repositories
+#
+# Builds a working repository with two bare remotes, moves both ahead,
+# then runs Remotes > Fetch > "all remotes" through the menu and checks
+# that every remote-tracking ref moved and that FETCH_HEAD lists both
+# remotes, as `git fetch --all` would leave it.
+#
+# Usage: tests/fetch_test.sh path/to/git_master
+
+set -eu
+
+GIT_MASTER=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# Keep the user's git and Git Master configuration out of the test
+export HOME="$TMP" XDG_CONFIG_HOME="$TMP/config" GIT_CONFIG_NOSYSTEM=1
+export GIT_AUTHOR_NAME=test GIT_AUTHOR_EMAIL=test@example.com
+export GIT_COMMITTER_NAME=test GIT_COMMITTER_EMAIL=test@example.com
+mkdir -p "$XDG_CONFIG_HOME"
+
+fail() {
+    echo "FAIL: $*"
+    exit 1
+}
+
+cd "$TMP"
+git init -q -b main seed
+git -C seed commit -q --allow-empty -m one
+git clone -q --bare seed origin.git
+git clone -q --bare seed upstream.git
+git clone -q origin.git work
+git -C work remote add upstream ../upstream.git
+
+# Both remotes move on after the clone
+git -C seed commit -q --allow-empty -m two
+git -C seed push -q ../origin.git main
+git -C seed push -q ../upstream.git main:side
+new=$(git -C seed rev-parse HEAD)
+
+fetch_all() {
+    # Remotes menu, Fetch, "all remotes", continue, back, quit
+    (cd work && printf '4\n4\ny\n\n0\n0\n' | "$GIT_MASTER" >"$TMP/out.txt" 2>&1) ||
+        fail "git_master exited with $?"
+}
+
+fetch_all
+[ "$(git -C work rev-parse origin/main)" = "$new" ] || fail "origin/main was not updated"
+[ "$(git -C work rev-parse upstream/side)" = "$new" ] || fail "upstream/side was not fetched"
+grep -q "of .*origin" work/.git/FETCH_HEAD || fail "FETCH_HEAD has no origin entries"
+grep -q "of .*upstream" work/.git/FETCH_HEAD || fail "FETCH_HEAD has no upstream entries"
+
+# A second fetch replaces FETCH_HEAD instead of appending to it
+lines=$(wc -l <work/.git/FETCH_HEAD)
+fetch_all
+[ "$(wc -l <work/.git/FETCH_HEAD)" -eq "$lines" ] || fail "FETCH_HEAD grew on a second fetch"
+
+echo "fetch: ok"
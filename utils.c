@@ -9,6 +9,10 @@
 #include <stdarg.h>
 #include <ctype.h>
 #include <signal.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/mman.h>
 
 /* ============================================================================
  * Command Execution Functions
@@ -145,6 +149,288 @@ cmd_result_t* exec_git_command(const char *git_args) {
     return exec_command(command);
 }
 
+/**
+ * Append bytes to a growable output buffer
+ */
+static bool append_output(char **buf, size_t *len, size_t *cap, const char *data, size_t n) {
+    if (*len + n + 1 > *cap) {
+        size_t new_cap = (*cap == 0) ? 16384 : *cap;
+        while (*len + n + 1 > new_cap) {
+            new_cap *= 2;
+        }
+        char *grown = (char*)safe_realloc(*buf, new_cap);
+        if (grown == NULL) {
+            return false;
+        }
+        *buf = grown;
+        *cap = new_cap;
+    }
+    memcpy(*buf + *len, data, n);
+    *len += n;
+    (*buf)[*len] = '\0';
+    return true;
+}
+
+/**
+ * Run a shell command with concurrent, uncapped stdout/stderr capture
+ *
+ * Shared by exec_command_input and exec_command_stream. stderr chunks
+ * are passed to on_stderr (if set) as they arrive, in addition to
+ * being collected in result->error.
+ */
+static cmd_result_t* exec_command_internal(const char *command, const char *input,
+                                           size_t input_len, stream_callback_t on_stderr,
+                                           void *ctx) {
+    if (command == NULL || strlen(command) == 0) {
+        return NULL;
+    }
+
+    cmd_result_t *result = (cmd_result_t*)safe_calloc(1, sizeof(cmd_result_t));
+    if (result == NULL) {
+        return NULL;
+    }
+
+    int stdin_pipe[2] = { -1, -1 };
+    int stdout_pipe[2];
+    int stderr_pipe[2];
+
+    if (pipe(stdout_pipe) == -1) {
+        free_cmd_result(result);
+        return NULL;
+    }
+    if (pipe(stderr_pipe) == -1) {
+        close(stdout_pipe[0]);
+        close(stdout_pipe[1]);
+        free_cmd_result(result);
+        return NULL;
+    }
+    if (input != NULL && pipe(stdin_pipe) == -1) {
+        close(stdout_pipe[0]);
+        close(stdout_pipe[1]);
+        close(stderr_pipe[0]);
+        close(stderr_pipe[1]);
+        free_cmd_result(result);
+        return NULL;
+    }
+
+    pid_t pid = fork();
+
+    if (pid == -1) {
+        close(stdout_pipe[0]);
+        close(stdout_pipe[1]);
+        close(stderr_pipe[0]);
+        close(stderr_pipe[1]);
+        if (input != NULL) {
+            close(stdin_pipe[0]);
+            close(stdin_pipe[1]);
+        }
+        free_cmd_result(result);
+        return NULL;
+    }
+
+    if (pid == 0) {
+        /* Child process */
+        close(stdout_pipe[0]);
+        close(stderr_pipe[0]);
+
+        if (input != NULL) {
+            close(stdin_pipe[1]);
+            dup2(stdin_pipe[0], STDIN_FILENO);
+            close(stdin_pipe[0]);
+        }
+
+        dup2(stdout_pipe[1], STDOUT_FILENO);
+        dup2(stderr_pipe[1], STDERR_FILENO);
+
+        close(stdout_pipe[1]);
+        close(stderr_pipe[1]);
+
+        /* An ignored SIGPIPE would be inherited across exec */
+        signal(SIGPIPE, SIG_DFL);
+
+        execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+        _exit(127);
+    }
+
+    /* Parent process */
+    close(stdout_pipe[1]);
+    close(stderr_pipe[1]);
+
+    int in_fd = -1;
+    if (input != NULL) {
+        close(stdin_pipe[0]);
+        in_fd = stdin_pipe[1];
+        if (input_len == 0) {
+            close(in_fd);
+            in_fd = -1;
+        } else {
+            fcntl(in_fd, F_SETFL, fcntl(in_fd, F_GETFL) | O_NONBLOCK);
+        }
+    }
+
+    /*
+     * A child that exits early must not kill us with SIGPIPE. Only
+     * writers need this, which keeps read-only callers (such as
+     * parallel fetch workers) from racing on the process-wide handler.
+     */
+    struct sigaction ignore_pipe, old_pipe;
+    if (in_fd >= 0) {
+        memset(&ignore_pipe, 0, sizeof(ignore_pipe));
+        ignore_pipe.sa_handler = SIG_IGN;
+        sigaction(SIGPIPE, &ignore_pipe, &old_pipe);
+    }
+
+    size_t out_cap = 0, err_cap = 0;
+    size_t written = 0;
+    int out_fd = stdout_pipe[0];
+    int err_fd = stderr_pipe[0];
+    bool ok = true;
+    char buffer[65536];
+
+    while (out_fd >= 0 || err_fd >= 0) {
+        struct pollfd fds[3];
+        int nfds = 0;
+        int out_idx = -1, err_idx = -1, in_idx = -1;
+
+        if (out_fd >= 0) {
+            fds[nfds] = (struct pollfd){ .fd = out_fd, .events = POLLIN };
+            out_idx = nfds++;
+        }
+        if (err_fd >= 0) {
+            fds[nfds] = (struct pollfd){ .fd = err_fd, .events = POLLIN };
+            err_idx = nfds++;
+        }
+        if (in_fd >= 0) {
+            fds[nfds] = (struct pollfd){ .fd = in_fd, .events = POLLOUT };
+            in_idx = nfds++;
+        }
+
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        if (in_idx >= 0 && fds[in_idx].revents != 0) {
+            ssize_t n = write(in_fd, input + written, input_len - written);
+            if (n > 0) {
+                written += (size_t)n;
+            }
+            if ((n < 0 && errno != EAGAIN && errno != EINTR) || written >= input_len) {
+                close(in_fd);
+                in_fd = -1;
+            }
+        }
+
+        if (out_idx >= 0 && fds[out_idx].revents != 0) {
+            ssize_t n = read(out_fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                ok = ok && append_output(&result->output, &result->output_len, &out_cap,
+                                         buffer, (size_t)n);
+            } else if (n == 0 || errno != EINTR) {
+                close(out_fd);
+                out_fd = -1;
+            }
+        }
+
+        if (err_idx >= 0 && fds[err_idx].revents != 0) {
+            ssize_t n = read(err_fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                ok = ok && append_output(&result->error, &result->error_len, &err_cap,
+                                         buffer, (size_t)n);
+                if (on_stderr != NULL) {
+                    on_stderr(buffer, (size_t)n, ctx);
+                }
+            } else if (n == 0 || errno != EINTR) {
+                close(err_fd);
+                err_fd = -1;
+            }
+        }
+    }
+
+    if (in_fd >= 0) close(in_fd);
+    if (out_fd >= 0) close(out_fd);
+    if (err_fd >= 0) close(err_fd);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if (input != NULL && input_len > 0) {
+        sigaction(SIGPIPE, &old_pipe, NULL);
+    }
+
+    if (WIFEXITED(status)) {
+        result->exit_code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        result->exit_code = -WTERMSIG(status);
+    } else {
+        result->exit_code = -1;
+    }
+
+    /* Callers expect non-NULL, NUL-terminated buffers */
+    if (result->output == NULL) result->output = (char*)safe_calloc(1, 1);
+    if (result->error == NULL) result->error = (char*)safe_calloc(1, 1);
+
+    if (!ok || result->output == NULL || result->error == NULL) {
+        free_cmd_result(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/**
+ * Execute a shell command, optionally feeding data to its stdin
+ *
+ * Unlike exec_command, stdout and stderr are read concurrently and
+ * are not capped at MAX_OUTPUT_LEN, so large listings and diffs come
+ * back complete. When input is NULL the child inherits stdin.
+ *
+ * @param command The command to execute
+ * @param input Data to write to the child's stdin (may be NULL)
+ * @param input_len Number of bytes in input
+ * @return cmd_result_t* Result structure (must be freed with free_cmd_result)
+ */
+cmd_result_t* exec_command_input(const char *command, const char *input, size_t input_len) {
+    return exec_command_internal(command, input, input_len, NULL, NULL);
+}
+
+/**
+ * Execute a shell command, reporting stderr as it is produced
+ *
+ * Used for long-running git commands whose progress meter is written
+ * to stderr. The full stderr is still available in result->error.
+ *
+ * @param command The command to execute
+ * @param on_stderr Called with each chunk read from stderr
+ * @param ctx Passed through to on_stderr
+ * @return cmd_result_t* Result structure (must be freed with free_cmd_result)
+ */
+cmd_result_t* exec_command_stream(const char *command, stream_callback_t on_stderr, void *ctx) {
+    return exec_command_internal(command, NULL, 0, on_stderr, ctx);
+}
+
+/**
+ * Execute a Git command with the "git" prefix, optionally feeding stdin
+ *
+ * @param git_args Arguments to pass to git
+ * @param input Data to write to git's stdin (may be NULL)
+ * @param input_len Number of bytes in input
+ * @return cmd_result_t* Result structure (must be freed with free_cmd_result)
+ */
+cmd_result_t* exec_git_command_input(const char *git_args, const char *input, size_t input_len) {
+    if (git_args == NULL || strlen(git_args) == 0) {
+        return NULL;
+    }
+
+    char command[MAX_COMMAND_LEN];
+    int written = snprintf(command, sizeof(command), "git %s", git_args);
+
+    if (written < 0 || (size_t)written >= sizeof(command)) {
+        return NULL;
+    }
+
+    return exec_command_input(command, input, input_len);
+}
+
 /**
  * Free a command result structure
  * 
@@ -579,6 +865,701 @@ void* safe_calloc(size_t nmemb, size_t size) {
     return ptr;
 }
 
+/* ============================================================================
+ * Repository Metadata Functions
+ * ============================================================================ */
+
+/* Symbolic refs followed before giving up */
+#define MAX_SYMREF_DEPTH 5
+#define MAX_ALTERNATES 8
+
+/**
+ * Read the first line of a small file
+ *
+ * @return bool true if the file exists and a line was read
+ */
+static bool read_first_line(const char *path, char *buffer, size_t len) {
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return false;
+    }
+
+    bool ok = (fgets(buffer, (int)len, fp) != NULL);
+    fclose(fp);
+
+    if (ok) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+    }
+    return ok;
+}
+
+/**
+ * Locate the repository's git directory without spawning git
+ *
+ * Honors $GIT_DIR, then walks up from the current directory looking
+ * for a .git directory or a "gitdir:" file (worktrees, submodules).
+ *
+ * @param git_dir Output buffer
+ * @param len Size of git_dir
+ * @return gm_error_t Error code
+ */
+gm_error_t find_git_dir(char *git_dir, size_t len) {
+    if (git_dir == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    const char *env = getenv("GIT_DIR");
+    if (env != NULL && strlen(env) > 0) {
+        snprintf(git_dir, len, "%s", env);
+        return GM_SUCCESS;
+    }
+
+    char dir[MAX_PATH_LEN];
+    if (getcwd(dir, sizeof(dir)) == NULL) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    while (true) {
+        char candidate[MAX_PATH_LEN + 8];
+        struct stat st;
+        snprintf(candidate, sizeof(candidate), "%s/.git", dir);
+
+        if (stat(candidate, &st) == 0) {
+            if (S_ISDIR(st.st_mode)) {
+                snprintf(git_dir, len, "%s", candidate);
+                return GM_SUCCESS;
+            }
+
+            char line[MAX_PATH_LEN];
+            if (read_first_line(candidate, line, sizeof(line)) &&
+                strncmp(line, "gitdir: ", 8) == 0) {
+                if (line[8] == '/') {
+                    snprintf(git_dir, len, "%s", line + 8);
+                } else {
+                    snprintf(git_dir, len, "%s/%s", dir, line + 8);
+                }
+                return GM_SUCCESS;
+            }
+        }
+
+        char *slash = strrchr(dir, '/');
+        if (slash == NULL || slash == dir) {
+            return GM_ERR_NOT_GIT_REPO;
+        }
+        *slash = '\0';
+    }
+}
+
+/**
+ * Directory holding refs shared by all worktrees
+ */
+static void get_common_dir(const char *git_dir, char *common_dir, size_t len) {
+    char path[MAX_PATH_LEN + 16];
+    char line[MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/commondir", git_dir);
+
+    if (!read_first_line(path, line, sizeof(line))) {
+        snprintf(common_dir, len, "%s", git_dir);
+    } else if (line[0] == '/') {
+        snprintf(common_dir, len, "%s", line);
+    } else if (snprintf(common_dir, len, "%s/%s", git_dir, line) >= (int)len) {
+        snprintf(common_dir, len, "%s", git_dir);
+    }
+}
+
+/**
+ * Locate the directory shared by all worktrees of the repository
+ *
+ * @param common_dir Output buffer
+ * @param len Size of common_dir
+ * @return gm_error_t Error code
+ */
+gm_error_t find_common_dir(char *common_dir, size_t len) {
+    if (common_dir == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    get_common_dir(git_dir, common_dir, len);
+    return GM_SUCCESS;
+}
+
+/**
+ * Look a ref up in packed-refs
+ */
+static bool read_packed_ref(const char *common_dir, const char *ref, char *oid, size_t len) {
+    char path[MAX_PATH_LEN + 16];
+    snprintf(path, sizeof(path), "%s/packed-refs", common_dir);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return false;
+    }
+
+    char line[MAX_PATH_LEN];
+    size_t ref_len = strlen(ref);
+    bool found = false;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (line[0] == '#' || line[0] == '^') continue;
+
+        char *space = strchr(line, ' ');
+        if (space == NULL) continue;
+
+        char *name = space + 1;
+        name[strcspn(name, "\r\n")] = '\0';
+        if (strlen(name) == ref_len && strcmp(name, ref) == 0) {
+            *space = '\0';
+            snprintf(oid, len, "%s", line);
+            found = true;
+            break;
+        }
+    }
+
+    fclose(fp);
+    return found;
+}
+
+/**
+ * Resolve a ref such as "HEAD" or "refs/heads/main" to an object ID
+ * by reading loose refs and packed-refs directly
+ *
+ * @param ref Full ref name
+ * @param oid Output: hex object ID
+ * @param len Size of oid (MAX_OID_LEN)
+ * @return gm_error_t GM_ERR_NO_COMMITS if the ref is unborn
+ */
+gm_error_t resolve_ref_oid(const char *ref, char *oid, size_t len) {
+    if (ref == NULL || oid == NULL || len == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    char common_dir[MAX_PATH_LEN];
+    get_common_dir(git_dir, common_dir, sizeof(common_dir));
+
+    char name[MAX_PATH_LEN];
+    snprintf(name, sizeof(name), "%s", ref);
+
+    for (int depth = 0; depth < MAX_SYMREF_DEPTH; depth++) {
+        /* Per-worktree refs (HEAD and friends) live in the git dir */
+        bool per_worktree = (strncmp(name, "refs/", 5) != 0);
+        char path[2 * MAX_PATH_LEN];
+        char line[MAX_PATH_LEN];
+        snprintf(path, sizeof(path), "%s/%s", per_worktree ? git_dir : common_dir, name);
+
+        if (read_first_line(path, line, sizeof(line))) {
+            if (strncmp(line, "ref: ", 5) == 0) {
+                memmove(name, line + 5, strlen(line + 5) + 1);
+                continue;
+            }
+            snprintf(oid, len, "%s", line);
+            return GM_SUCCESS;
+        }
+
+        if (!per_worktree && read_packed_ref(common_dir, name, oid, len)) {
+            return GM_SUCCESS;
+        }
+
+        return GM_ERR_NO_COMMITS;
+    }
+
+    return GM_ERR_UNKNOWN;
+}
+
+/**
+ * Read the number of entries in the index from its header
+ *
+ * @param count Output: number of index entries (0 if there is no index)
+ * @return gm_error_t Error code
+ */
+gm_error_t read_index_entry_count(unsigned int *count) {
+    if (count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    const char *index_file = getenv("GIT_INDEX_FILE");
+    char path[MAX_PATH_LEN + 16];
+    if (index_file != NULL && strlen(index_file) > 0) {
+        snprintf(path, sizeof(path), "%s", index_file);
+    } else {
+        snprintf(path, sizeof(path), "%s/index", git_dir);
+    }
+
+    *count = 0;
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        return (errno == ENOENT) ? GM_SUCCESS : GM_ERR_IO_ERROR;
+    }
+
+    /* Header: "DIRC", version, entry count; all big-endian */
+    unsigned char header[12];
+    bool ok = (fread(header, 1, sizeof(header), fp) == sizeof(header) &&
+               memcmp(header, "DIRC", 4) == 0);
+    fclose(fp);
+
+    if (!ok) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    *count = ((unsigned int)header[8] << 24) | ((unsigned int)header[9] << 16) |
+             ((unsigned int)header[10] << 8) | (unsigned int)header[11];
+    return GM_SUCCESS;
+}
+
+static int compare_ref_entries(const void *a, const void *b) {
+    return strcmp(((const ref_entry_t*)a)->name, ((const ref_entry_t*)b)->name);
+}
+
+static bool append_ref_entry(ref_entry_t **refs, int *count, int *capacity,
+                             const char *name, const char *oid) {
+    if (strlen(name) >= MAX_BRANCH_NAME || strlen(oid) >= MAX_OID_LEN) {
+        return true;    /* Skip what cannot be represented */
+    }
+    if (*count == *capacity) {
+        int new_capacity = (*capacity == 0) ? 64 : *capacity * 2;
+        ref_entry_t *grown = (ref_entry_t*)safe_realloc(*refs,
+                                                        (size_t)new_capacity * sizeof(ref_entry_t));
+        if (grown == NULL) {
+            return false;
+        }
+        *refs = grown;
+        *capacity = new_capacity;
+    }
+    snprintf((*refs)[*count].name, MAX_BRANCH_NAME, "%s", name);
+    snprintf((*refs)[*count].oid, MAX_OID_LEN, "%s", oid);
+    (*count)++;
+    return true;
+}
+
+/**
+ * Collect loose refs below a directory of the ref store
+ */
+static bool read_loose_refs(const char *common_dir, const char *name,
+                            ref_entry_t **refs, int *count, int *capacity) {
+    char path[2 * MAX_PATH_LEN];
+    snprintf(path, sizeof(path), "%s/%s", common_dir, name);
+
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+        return true;
+    }
+
+    bool ok = true;
+    struct dirent *entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.' || strstr(entry->d_name, ".lock") != NULL) {
+            continue;
+        }
+
+        char child[MAX_PATH_LEN];
+        if (snprintf(child, sizeof(child), "%s/%s", name, entry->d_name) >= (int)sizeof(child)) {
+            continue;
+        }
+
+        char child_path[2 * MAX_PATH_LEN + 256];
+        struct stat st;
+        snprintf(child_path, sizeof(child_path), "%s/%s", common_dir, child);
+        if (stat(child_path, &st) != 0) {
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            ok = read_loose_refs(common_dir, child, refs, count, capacity);
+        } else {
+            char line[MAX_PATH_LEN];
+            /* Symbolic refs such as origin/HEAD are not snapshots of anything */
+            if (read_first_line(child_path, line, sizeof(line)) && strncmp(line, "ref: ", 5) != 0) {
+                ok = append_ref_entry(refs, count, capacity, child, line);
+            }
+        }
+    }
+
+    closedir(dir);
+    return ok;
+}
+
+/**
+ * List refs under a prefix by reading loose refs and packed-refs
+ * directly, like "for-each-ref <prefix>" without the spawn
+ *
+ * @param prefix Ref prefix ending in '/', e.g. "refs/remotes/origin/"
+ * @param refs Output: array sorted by name (must be freed)
+ * @param count Output: number of refs
+ * @return gm_error_t Error code
+ */
+gm_error_t read_refs(const char *prefix, ref_entry_t **refs, int *count) {
+    if (prefix == NULL || strncmp(prefix, "refs/", 5) != 0 || refs == NULL || count == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *refs = NULL;
+    *count = 0;
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    char common_dir[MAX_PATH_LEN];
+    get_common_dir(git_dir, common_dir, sizeof(common_dir));
+
+    int capacity = 0;
+    char dir_name[MAX_PATH_LEN];
+    snprintf(dir_name, sizeof(dir_name), "%s", prefix);
+    size_t dir_len = strlen(dir_name);
+    if (dir_len > 0 && dir_name[dir_len - 1] == '/') {
+        dir_name[dir_len - 1] = '\0';
+    }
+
+    if (!read_loose_refs(common_dir, dir_name, refs, count, &capacity)) {
+        free(*refs);
+        *refs = NULL;
+        *count = 0;
+        return GM_ERR_MEMORY_ALLOC;
+    }
+    int loose_count = *count;
+    qsort(*refs, (size_t)loose_count, sizeof(ref_entry_t), compare_ref_entries);
+
+    char path[MAX_PATH_LEN + 16];
+    snprintf(path, sizeof(path), "%s/packed-refs", common_dir);
+    FILE *fp = fopen(path, "r");
+    if (fp != NULL) {
+        size_t prefix_len = strlen(prefix);
+        char line[MAX_PATH_LEN];
+        while (fgets(line, sizeof(line), fp) != NULL) {
+            if (line[0] == '#' || line[0] == '^') continue;
+
+            char *space = strchr(line, ' ');
+            if (space == NULL) continue;
+            *space = '\0';
+            char *name = space + 1;
+            name[strcspn(name, "\r\n")] = '\0';
+            if (strncmp(name, prefix, prefix_len) != 0) continue;
+
+            /* Loose refs take precedence over packed ones */
+            ref_entry_t key;
+            snprintf(key.name, sizeof(key.name), "%s", name);
+            if (bsearch(&key, *refs, (size_t)loose_count, sizeof(ref_entry_t),
+                        compare_ref_entries) != NULL) {
+                continue;
+            }
+
+            if (!append_ref_entry(refs, count, &capacity, name, line)) {
+                fclose(fp);
+                free(*refs);
+                *refs = NULL;
+                *count = 0;
+                return GM_ERR_MEMORY_ALLOC;
+            }
+        }
+        fclose(fp);
+    }
+
+    qsort(*refs, (size_t)*count, sizeof(ref_entry_t), compare_ref_entries);
+    return GM_SUCCESS;
+}
+
+/**
+ * Find the newest reflog entry of a ref whose message starts with a
+ * prefix, by reading the reflog file directly
+ *
+ * @param ref Full ref name, e.g. "refs/remotes/origin/main"
+ * @param message_prefix Message prefix, e.g. "update by push"
+ * @param when Output: entry time, or 0 if no entry matches
+ * @return gm_error_t Error code
+ */
+gm_error_t read_reflog_time(const char *ref, const char *message_prefix, time_t *when) {
+    if (ref == NULL || message_prefix == NULL || when == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *when = 0;
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    char common_dir[MAX_PATH_LEN];
+    get_common_dir(git_dir, common_dir, sizeof(common_dir));
+
+    char path[2 * MAX_PATH_LEN];
+    bool per_worktree = (strncmp(ref, "refs/", 5) != 0);
+    snprintf(path, sizeof(path), "%s/logs/%s", per_worktree ? git_dir : common_dir, ref);
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return (errno == ENOENT) ? GM_SUCCESS : GM_ERR_IO_ERROR;
+    }
+
+    /* "<old> <new> <name> <<email>> <time> <tz>\t<message>"; newest last */
+    size_t prefix_len = strlen(message_prefix);
+    char *line = NULL;
+    size_t cap = 0;
+    while (getline(&line, &cap, fp) != -1) {
+        char *tab = strchr(line, '\t');
+        if (tab == NULL || strncmp(tab + 1, message_prefix, prefix_len) != 0) {
+            continue;
+        }
+
+        *tab = '\0';
+        char *tz = strrchr(line, ' ');
+        if (tz == NULL) continue;
+        *tz = '\0';
+        char *stamp = strrchr(line, ' ');
+        if (stamp == NULL) continue;
+
+        *when = (time_t)strtoll(stamp + 1, NULL, 10);
+    }
+
+    free(line);
+    fclose(fp);
+    return GM_SUCCESS;
+}
+
+/* A mapped version-2 pack index */
+typedef struct {
+    unsigned char *data;
+    size_t size;
+    uint32_t object_count;
+} pack_index_t;
+
+static uint32_t read_be32(const unsigned char *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+/**
+ * Map every pack index under an object directory
+ */
+static int map_pack_indexes(const char *objects_dir, pack_index_t **indexes, int count) {
+    char pack_dir[MAX_PATH_LEN + 8];
+    if (snprintf(pack_dir, sizeof(pack_dir), "%s/pack", objects_dir) >= (int)sizeof(pack_dir)) {
+        return count;
+    }
+
+    DIR *dir = opendir(pack_dir);
+    if (dir == NULL) {
+        return count;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t name_len = strlen(entry->d_name);
+        if (name_len < 5 || strcmp(entry->d_name + name_len - 4, ".idx") != 0) {
+            continue;
+        }
+
+        char path[2 * MAX_PATH_LEN];
+        snprintf(path, sizeof(path), "%s/%s", pack_dir, entry->d_name);
+
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) continue;
+
+        struct stat st;
+        void *data = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= 8 + 256 * 4) {
+            data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (data == MAP_FAILED) continue;
+
+        /* Only version 2 indexes ("\377tOc", 2) are understood */
+        unsigned char *bytes = (unsigned char*)data;
+        if (memcmp(bytes, "\377tOc", 4) != 0 || read_be32(bytes + 4) != 2) {
+            munmap(data, (size_t)st.st_size);
+            continue;
+        }
+
+        pack_index_t *grown = (pack_index_t*)safe_realloc(*indexes,
+                                                          (size_t)(count + 1) * sizeof(pack_index_t));
+        if (grown == NULL) {
+            munmap(data, (size_t)st.st_size);
+            break;
+        }
+        *indexes = grown;
+        grown[count].data = bytes;
+        grown[count].size = (size_t)st.st_size;
+        grown[count].object_count = read_be32(bytes + 8 + 255 * 4);
+        count++;
+    }
+
+    closedir(dir);
+    return count;
+}
+
+/**
+ * Binary-search one pack index for a raw object ID
+ */
+static bool pack_index_contains(const pack_index_t *index, const unsigned char *oid,
+                                size_t hash_len) {
+    const unsigned char *fanout = index->data + 8;
+    const unsigned char *names = fanout + 256 * 4;
+
+    if (names + (size_t)index->object_count * hash_len > index->data + index->size) {
+        return false;
+    }
+
+    uint32_t lo = (oid[0] == 0) ? 0 : read_be32(fanout + (oid[0] - 1) * 4);
+    uint32_t hi = read_be32(fanout + oid[0] * 4);
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        int cmp = memcmp(names + (size_t)mid * hash_len, oid, hash_len);
+        if (cmp == 0) return true;
+        if (cmp < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    return false;
+}
+
+static bool hex_to_raw_oid(const char *hex, unsigned char *raw, size_t *hash_len) {
+    size_t len = strlen(hex);
+    if (len != 40 && len != 64) {
+        return false;
+    }
+
+    for (size_t i = 0; i < len / 2; i++) {
+        int hi = isxdigit((unsigned char)hex[2 * i]) ? hex[2 * i] : -1;
+        int lo = isxdigit((unsigned char)hex[2 * i + 1]) ? hex[2 * i + 1] : -1;
+        if (hi < 0 || lo < 0) return false;
+        hi = isdigit(hi) ? hi - '0' : tolower(hi) - 'a' + 10;
+        lo = isdigit(lo) ? lo - '0' : tolower(lo) - 'a' + 10;
+        raw[i] = (unsigned char)((hi << 4) | lo);
+    }
+    *hash_len = len / 2;
+    return true;
+}
+
+/**
+ * Narrow a list of object IDs down to those missing from the local
+ * object store, without spawning git
+ *
+ * Checks loose objects and version-2 pack indexes in the repository's
+ * object directory and its alternates. Lookups never trigger a lazy
+ * fetch, unlike "git cat-file -e" in a partial clone.
+ *
+ * @param oids Hex object IDs; the missing ones are moved to the front
+ * @param count Number of object IDs
+ * @param missing Output: number of missing object IDs
+ * @return gm_error_t Error code
+ */
+gm_error_t find_missing_objects(char (*oids)[MAX_OID_LEN], int count, int *missing) {
+    if ((oids == NULL && count > 0) || missing == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    *missing = 0;
+    if (count == 0) {
+        return GM_SUCCESS;
+    }
+
+    char git_dir[MAX_PATH_LEN];
+    gm_error_t err = find_git_dir(git_dir, sizeof(git_dir));
+    if (err != GM_SUCCESS) {
+        return err;
+    }
+
+    /* The object directory, then any alternates it lists */
+    char object_dirs[MAX_ALTERNATES + 1][MAX_PATH_LEN];
+    int dir_count = 0;
+
+    const char *env = getenv("GIT_OBJECT_DIRECTORY");
+    if (env != NULL && strlen(env) > 0) {
+        snprintf(object_dirs[0], MAX_PATH_LEN, "%s", env);
+    } else {
+        char common_dir[MAX_PATH_LEN];
+        get_common_dir(git_dir, common_dir, sizeof(common_dir));
+        if (snprintf(object_dirs[0], MAX_PATH_LEN, "%s/objects", common_dir) >= MAX_PATH_LEN) {
+            return GM_ERR_IO_ERROR;
+        }
+    }
+    dir_count = 1;
+
+    char base[MAX_PATH_LEN];
+    char alternates[MAX_PATH_LEN + 32];
+    memcpy(base, object_dirs[0], sizeof(base));
+    snprintf(alternates, sizeof(alternates), "%s/info/alternates", base);
+    FILE *fp = fopen(alternates, "r");
+    if (fp != NULL) {
+        char line[MAX_PATH_LEN];
+        while (dir_count <= MAX_ALTERNATES && fgets(line, sizeof(line), fp) != NULL) {
+            line[strcspn(line, "\r\n")] = '\0';
+            if (line[0] == '\0' || line[0] == '#') continue;
+            int n = (line[0] == '/')
+                ? snprintf(object_dirs[dir_count], MAX_PATH_LEN, "%s", line)
+                : snprintf(object_dirs[dir_count], MAX_PATH_LEN, "%s/%s", base, line);
+            if (n < MAX_PATH_LEN) dir_count++;
+        }
+        fclose(fp);
+    }
+
+    pack_index_t *indexes = NULL;
+    int index_count = 0;
+    for (int d = 0; d < dir_count; d++) {
+        index_count = map_pack_indexes(object_dirs[d], &indexes, index_count);
+    }
+
+    for (int i = 0; i < count; i++) {
+        unsigned char raw[32];
+        size_t hash_len = 0;
+        bool present = false;
+
+        if (!hex_to_raw_oid(oids[i], raw, &hash_len)) {
+            continue;
+        }
+
+        for (int d = 0; d < dir_count && !present; d++) {
+            char loose[MAX_PATH_LEN + MAX_OID_LEN + 4];
+            struct stat st;
+            if (snprintf(loose, sizeof(loose), "%s/%.2s/%s", object_dirs[d], oids[i],
+                         oids[i] + 2) < (int)sizeof(loose)) {
+                present = (stat(loose, &st) == 0);
+            }
+        }
+
+        for (int p = 0; p < index_count && !present; p++) {
+            present = pack_index_contains(&indexes[p], raw, hash_len);
+        }
+
+        if (!present) {
+            if (*missing != i) {
+                char tmp[MAX_OID_LEN];
+                memcpy(tmp, oids[*missing], MAX_OID_LEN);
+                memcpy(oids[*missing], oids[i], MAX_OID_LEN);
+                memcpy(oids[i], tmp, MAX_OID_LEN);
+            }
+            (*missing)++;
+        }
+    }
+
+    for (int p = 0; p < index_count; p++) {
+        munmap(indexes[p].data, indexes[p].size);
+    }
+    free(indexes);
+
+    return GM_SUCCESS;
+}
+
 /* ============================================================================
  * Application State Functions
  * ============================================================================ */
@@ -0,0 +1,671 @@
+/**
+ * worktree.c - Warm Worktree Pool for Git Master
+ *
+ * Keeps checked-out `git worktree`s of frequently used branches so that
+ * switching to one of them is a directory change instead of a checkout.
+ * Pool membership is decided by checkout frequency (ties broken by the
+ * least recently used) and bounded by a count and a disk budget.
+ */
+
+#include "config.h"
+#include <ftw.h>
+
+/* ============================================================================
+ * Pool State
+ * ============================================================================ */
+
+#define POOL_DIR_NAME       "gm-worktrees"
+#define POOL_STATE_FILE     "pool.state"
+#define POOL_MAX_ENTRIES    256
+
+/* Usage record for one branch; pooled entries own a worktree */
+typedef struct {
+    char branch[MAX_BRANCH_NAME];
+    int checkouts;
+    long long last_used;
+    bool pooled;
+} pool_entry_t;
+
+typedef struct {
+    char pool_dir[MAX_PATH_LEN];
+    pool_entry_t entries[POOL_MAX_ENTRIES];
+    int count;
+} pool_state_t;
+
+/* A worktree reported by `git worktree list --porcelain` */
+typedef struct {
+    char path[MAX_PATH_LEN];
+    char branch[MAX_BRANCH_NAME];
+} worktree_entry_t;
+
+/**
+ * Build a "-C <repo>" prefix for git commands (empty for the current directory)
+ */
+static void repo_prefix(const char *repo_path, char *out, size_t max_len) {
+    if (repo_path != NULL && repo_path[0] != '\0') {
+        snprintf(out, max_len, "-C \"%s\" ", repo_path);
+    } else {
+        out[0] = '\0';
+    }
+}
+
+/**
+ * Create a directory and any missing parents, like `mkdir -p`
+ */
+static bool make_directories(const char *path) {
+    char partial[MAX_PATH_LEN];
+    if (snprintf(partial, sizeof(partial), "%s", path) >= (int)sizeof(partial)) {
+        return false;
+    }
+
+    for (char *p = partial + 1; *p != '\0'; p++) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(partial, 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        *p = '/';
+    }
+    return mkdir(partial, 0755) == 0 || errno == EEXIST;
+}
+
+/**
+ * Resolve the pool directory for a repository
+ */
+static gm_error_t resolve_pool_dir(const worktree_pool_settings_t *settings,
+                                   const char *repo_path, char *out, size_t max_len) {
+    char prefix[MAX_PATH_LEN + 8];
+    char cmd[MAX_COMMAND_LEN];
+
+    repo_prefix(repo_path, prefix, sizeof(prefix));
+    snprintf(cmd, sizeof(cmd), "%srev-parse --path-format=absolute --git-common-dir", prefix);
+
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+    if (result->exit_code != 0) {
+        free_cmd_result(result);
+        return GM_ERR_NOT_GIT_REPO;
+    }
+
+    char *common_dir = trim_whitespace(result->output);
+    int written;
+
+    if (settings->directory[0] != '\0') {
+        /* Several repositories may share one configured root */
+        size_t len = strlen(common_dir);
+        if (len > 5 && strcmp(common_dir + len - 5, "/.git") == 0) {
+            common_dir[len - 5] = '\0';
+        }
+        const char *slash = strrchr(common_dir, '/');
+        const char *base = (slash != NULL) ? slash + 1 : common_dir;
+        written = snprintf(out, max_len, "%s/%s", settings->directory, base);
+    } else {
+        written = snprintf(out, max_len, "%s/%s", common_dir, POOL_DIR_NAME);
+    }
+
+    free_cmd_result(result);
+
+    /* Leave room for the worktree names built under it */
+    if (written < 0 || (size_t)written + MAX_BRANCH_NAME + 16 > max_len) {
+        PRINT_ERROR("Worktree pool directory path is too long");
+        return GM_ERR_INVALID_INPUT;
+    }
+    return GM_SUCCESS;
+}
+
+/**
+ * Load pool state from <pool_dir>/pool.state
+ *
+ * Format: one "<checkouts>\t<last_used>\t<pooled>\t<branch>" line per branch.
+ */
+static void load_pool_state(pool_state_t *state) {
+    char path[MAX_PATH_LEN + 32];
+    snprintf(path, sizeof(path), "%s/%s", state->pool_dir, POOL_STATE_FILE);
+
+    state->count = 0;
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+
+    char line[MAX_BRANCH_NAME + 64];
+    while (fgets(line, sizeof(line), fp) != NULL && state->count < POOL_MAX_ENTRIES) {
+        pool_entry_t *e = &state->entries[state->count];
+        int pooled = 0;
+        int consumed = 0;
+
+        if (sscanf(line, "%d\t%lld\t%d\t%n", &e->checkouts, &e->last_used,
+                   &pooled, &consumed) != 3 || consumed == 0) {
+            continue;
+        }
+
+        char *name = trim_whitespace(line + consumed);
+        if (name[0] == '\0') {
+            continue;
+        }
+
+        strncpy(e->branch, name, sizeof(e->branch) - 1);
+        e->branch[sizeof(e->branch) - 1] = '\0';
+        e->pooled = (pooled != 0);
+        state->count++;
+    }
+
+    fclose(fp);
+}
+
+/**
+ * Write pool state atomically (temp file + rename)
+ */
+static gm_error_t save_pool_state(const pool_state_t *state) {
+    char path[MAX_PATH_LEN + 32];
+    char tmp_path[MAX_PATH_LEN + 40];
+
+    snprintf(path, sizeof(path), "%s/%s", state->pool_dir, POOL_STATE_FILE);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        return GM_ERR_IO_ERROR;
+    }
+
+    for (int i = 0; i < state->count; i++) {
+        const pool_entry_t *e = &state->entries[i];
+        fprintf(fp, "%d\t%lld\t%d\t%s\n", e->checkouts, e->last_used,
+                e->pooled ? 1 : 0, e->branch);
+    }
+
+    if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return GM_ERR_IO_ERROR;
+    }
+
+    return GM_SUCCESS;
+}
+
+/**
+ * True if entry a should be evicted before entry b
+ */
+static bool pool_entry_colder(const pool_entry_t *a, const pool_entry_t *b) {
+    if (a->checkouts != b->checkouts) {
+        return a->checkouts < b->checkouts;
+    }
+    return a->last_used < b->last_used;
+}
+
+/**
+ * Find or add the usage record for a branch
+ */
+static pool_entry_t* pool_entry_for(pool_state_t *state, const char *branch) {
+    for (int i = 0; i < state->count; i++) {
+        if (strcmp(state->entries[i].branch, branch) == 0) {
+            return &state->entries[i];
+        }
+    }
+
+    if (state->count == POOL_MAX_ENTRIES) {
+        /* Forget the coldest unpooled record to make room */
+        int victim = -1;
+        for (int i = 0; i < state->count; i++) {
+            if (!state->entries[i].pooled &&
+                (victim < 0 || pool_entry_colder(&state->entries[i], &state->entries[victim]))) {
+                victim = i;
+            }
+        }
+        if (victim < 0) {
+            return NULL;
+        }
+        state->entries[victim] = state->entries[--state->count];
+    }
+
+    pool_entry_t *e = &state->entries[state->count++];
+    memset(e, 0, sizeof(*e));
+    strncpy(e->branch, branch, sizeof(e->branch) - 1);
+    return e;
+}
+
+/**
+ * Directory used for a branch inside the pool
+ *
+ * Slashes are flattened and a short hash keeps "a/b" and "a-b" apart.
+ *
+ * @return bool False if the path did not fit in out
+ */
+static bool pool_worktree_path(const pool_state_t *state, const char *branch,
+                               char *out, size_t max_len) {
+    char flat[MAX_BRANCH_NAME];
+    unsigned int hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; branch[i] != '\0' && i < sizeof(flat) - 1; i++) {
+        flat[i] = (branch[i] == '/') ? '-' : branch[i];
+        hash ^= (unsigned char)branch[i];
+        hash *= 16777619u;
+    }
+    flat[i] = '\0';
+
+    return snprintf(out, max_len, "%s/%s-%08x", state->pool_dir, flat, hash) < (int)max_len;
+}
+
+/* ============================================================================
+ * Worktree Queries
+ * ============================================================================ */
+
+/**
+ * List worktrees of a repository
+ *
+ * @return int Number of entries written to out, or -1 on failure
+ */
+static int list_worktrees(const char *repo_path, worktree_entry_t *out, int max_entries) {
+    char prefix[MAX_PATH_LEN + 8];
+    char cmd[MAX_COMMAND_LEN];
+
+    repo_prefix(repo_path, prefix, sizeof(prefix));
+    snprintf(cmd, sizeof(cmd), "%sworktree list --porcelain", prefix);
+
+    cmd_result_t *result = exec_git_command_input(cmd, NULL, 0);
+    if (result == NULL) {
+        return -1;
+    }
+    if (result->exit_code != 0) {
+        free_cmd_result(result);
+        return -1;
+    }
+
+    int count = -1;
+    char *line = result->output;
+
+    while (line != NULL && *line != '\0') {
+        char *eol = strchr(line, '\n');
+        if (eol != NULL) {
+            *eol = '\0';
+        }
+
+        if (strncmp(line, "worktree ", 9) == 0) {
+            if (count + 1 >= max_entries) {
+                break;
+            }
+            count++;
+            memset(&out[count], 0, sizeof(out[count]));
+            strncpy(out[count].path, line + 9, sizeof(out[count].path) - 1);
+        } else if (count >= 0 && strncmp(line, "branch refs/heads/", 18) == 0) {
+            strncpy(out[count].branch, line + 18, sizeof(out[count].branch) - 1);
+        }
+
+        line = (eol != NULL) ? eol + 1 : NULL;
+    }
+
+    free_cmd_result(result);
+    return count + 1;
+}
+
+/* Accumulator for nftw, which offers no user pointer */
+static unsigned long long g_du_bytes;
+
+static int du_visit(const char *path, const struct stat *st, int flag, struct FTW *ftw) {
+    (void)path;
+    (void)flag;
+    (void)ftw;
+    g_du_bytes += (unsigned long long)st->st_blocks * 512ULL;
+    return 0;
+}
+
+/**
+ * Disk usage of a directory tree in bytes
+ */
+static unsigned long long directory_usage(const char *path) {
+    g_du_bytes = 0;
+    nftw(path, du_visit, 32, FTW_PHYS);
+    return g_du_bytes;
+}
+
+/**
+ * Remove a pooled worktree, refusing if it has local changes
+ */
+static gm_error_t remove_pool_worktree(const char *repo_path, const char *path) {
+    char prefix[MAX_PATH_LEN + 8];
+    char cmd[MAX_COMMAND_LEN];
+
+    repo_prefix(repo_path, prefix, sizeof(prefix));
+    snprintf(cmd, sizeof(cmd), "%sworktree remove \"%s\"", prefix, path);
+
+    cmd_result_t *result = exec_git_command(cmd);
+    if (result == NULL) {
+        return GM_ERR_COMMAND_FAILED;
+    }
+
+    gm_error_t err = GM_SUCCESS;
+    if (result->exit_code != 0) {
+        PRINT_WARNING("Keeping pooled worktree %s: %s", path, trim_whitespace(result->error));
+        err = GM_ERR_UNCOMMITTED_CHANGES;
+    }
+
+    free_cmd_result(result);
+    return err;
+}
+
+/**
+ * Evict cold worktrees until the pool fits its size and disk budget
+ *
+ * @param keep Branch that must stay pooled (the one being switched to)
+ */
+static void evict_pool(const worktree_pool_settings_t *settings, const char *repo_path,
+                       pool_state_t *state, const char *keep) {
+    unsigned long long budget = (unsigned long long)settings->disk_budget_mb * 1024ULL * 1024ULL;
+    unsigned long long usage = 0;
+    int pooled = 0;
+
+    for (int i = 0; i < state->count; i++) {
+        if (state->entries[i].pooled) {
+            pooled++;
+        }
+    }
+
+    if (budget > 0) {
+        for (int i = 0; i < state->count; i++) {
+            if (state->entries[i].pooled) {
+                char path[MAX_PATH_LEN];
+                pool_worktree_path(state, state->entries[i].branch, path, sizeof(path));
+                usage += directory_usage(path);
+            }
+        }
+    }
+
+    /* Entries that refused removal are skipped rather than retried */
+    bool skipped[POOL_MAX_ENTRIES] = { false };
+
+    while (pooled > settings->size || (budget > 0 && usage > budget)) {
+        int victim = -1;
+
+        for (int i = 0; i < state->count; i++) {
+            pool_entry_t *e = &state->entries[i];
+            if (!e->pooled || skipped[i] || strcmp(e->branch, keep) == 0) {
+                continue;
+            }
+            if (victim < 0 || pool_entry_colder(e, &state->entries[victim])) {
+                victim = i;
+            }
+        }
+
+        if (victim < 0) {
+            break;
+        }
+
+        char path[MAX_PATH_LEN];
+        pool_worktree_path(state, state->entries[victim].branch, path, sizeof(path));
+        unsigned long long size = (budget > 0) ? directory_usage(path) : 0;
+
+        if (remove_pool_worktree(repo_path, path) == GM_SUCCESS) {
+            state->entries[victim].pooled = false;
+            pooled--;
+            usage = (usage > size) ? usage - size : 0;
+        } else {
+            skipped[victim] = true;
+        }
+    }
+}
+
+/* ============================================================================
+ * Public API
+ * ============================================================================ */
+
+/**
+ * Get a worktree with a branch checked out, creating one in the pool if needed
+ *
+ * If the branch is already checked out in any worktree (the main one,
+ * a pooled one or one the user made) that path is returned without
+ * touching any files. Otherwise a pooled worktree is added and cold
+ * entries are evicted to respect the configured size and disk budget.
+ *
+ * @param settings Pool settings from the configuration
+ * @param repo_path Repository to operate on (NULL for the current directory)
+ * @param branch_name Branch to switch to
+ * @param path_out Output: directory to change into
+ * @param max_len Size of path_out
+ * @return gm_error_t Error code
+ */
+gm_error_t worktree_pool_switch(const worktree_pool_settings_t *settings, const char *repo_path,
+                                const char *branch_name, char *path_out, size_t max_len) {
+    if (settings == NULL || branch_name == NULL || path_out == NULL ||
+        strlen(branch_name) == 0) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    pool_state_t *state = (pool_state_t*)safe_calloc(1, sizeof(pool_state_t));
+    if (state == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    gm_error_t err = resolve_pool_dir(settings, repo_path, state->pool_dir, sizeof(state->pool_dir));
+    if (err != GM_SUCCESS) {
+        free(state);
+        return err;
+    }
+
+    if (!make_directories(state->pool_dir)) {
+        PRINT_ERROR("Cannot create worktree pool directory: %s", state->pool_dir);
+        free(state);
+        return GM_ERR_IO_ERROR;
+    }
+
+    load_pool_state(state);
+
+    pool_entry_t *entry = pool_entry_for(state, branch_name);
+    if (entry != NULL) {
+        entry->checkouts++;
+        entry->last_used = (long long)time(NULL);
+    }
+
+    /* Already checked out somewhere? Then it's just a directory change */
+    worktree_entry_t *trees = (worktree_entry_t*)safe_calloc(POOL_MAX_ENTRIES,
+                                                             sizeof(worktree_entry_t));
+    if (trees == NULL) {
+        free(state);
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    int tree_count = list_worktrees(repo_path, trees, POOL_MAX_ENTRIES);
+    bool found = false;
+
+    for (int i = 0; i < tree_count; i++) {
+        if (strcmp(trees[i].branch, branch_name) == 0) {
+            snprintf(path_out, max_len, "%s", trees[i].path);
+            found = true;
+            break;
+        }
+    }
+
+    /* Reconcile pooled flags with what actually exists on disk */
+    for (int i = 0; i < state->count; i++) {
+        if (!state->entries[i].pooled) {
+            continue;
+        }
+        char path[MAX_PATH_LEN];
+        pool_worktree_path(state, state->entries[i].branch, path, sizeof(path));
+        bool present = false;
+        for (int j = 0; j < tree_count && !present; j++) {
+            present = (strcmp(trees[j].path, path) == 0);
+        }
+        state->entries[i].pooled = present;
+    }
+
+    free(trees);
+
+    if (!found) {
+        char path[MAX_PATH_LEN];
+        char prefix[MAX_PATH_LEN + 8];
+        char cmd[MAX_COMMAND_LEN];
+
+        if (!pool_worktree_path(state, branch_name, path, sizeof(path))) {
+            PRINT_ERROR("Worktree path for '%s' is too long", branch_name);
+            free(state);
+            return GM_ERR_INVALID_INPUT;
+        }
+        repo_prefix(repo_path, prefix, sizeof(prefix));
+        snprintf(cmd, sizeof(cmd), "%sworktree add --quiet \"%s\" \"%s\"", prefix, path, branch_name);
+
+        cmd_result_t *result = exec_git_command(cmd);
+        if (result == NULL) {
+            free(state);
+            return GM_ERR_COMMAND_FAILED;
+        }
+
+        if (result->exit_code != 0) {
+            if (strstr(result->error, "invalid reference") != NULL) {
+                PRINT_ERROR("Branch '%s' does not exist", branch_name);
+                err = GM_ERR_BRANCH_NOT_FOUND;
+            } else {
+                PRINT_ERROR("Failed to add worktree: %s", result->error);
+                err = GM_ERR_CHECKOUT_FAILED;
+            }
+            free_cmd_result(result);
+            save_pool_state(state);
+            free(state);
+            return err;
+        }
+
+        free_cmd_result(result);
+
+        if (entry != NULL) {
+            entry->pooled = true;
+        }
+        snprintf(path_out, max_len, "%s", path);
+    }
+
+    evict_pool(settings, repo_path, state, branch_name);
+    save_pool_state(state);
+    free(state);
+
+    return GM_SUCCESS;
+}
+
+/**
+ * Fast-forward pooled worktrees whose upstream has moved
+ *
+ * Meant to run from the daemon after a fetch. Worktrees with local
+ * changes or diverged history are left alone.
+ *
+ * @param settings Pool settings from the configuration
+ * @param repo_path Repository to operate on (NULL for the current directory)
+ * @return gm_error_t Error code
+ */
+gm_error_t worktree_pool_refresh(const worktree_pool_settings_t *settings, const char *repo_path) {
+    if (settings == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    pool_state_t *state = (pool_state_t*)safe_calloc(1, sizeof(pool_state_t));
+    if (state == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    gm_error_t err = resolve_pool_dir(settings, repo_path, state->pool_dir, sizeof(state->pool_dir));
+    if (err != GM_SUCCESS) {
+        free(state);
+        return err;
+    }
+
+    load_pool_state(state);
+
+    for (int i = 0; i < state->count; i++) {
+        if (!state->entries[i].pooled) {
+            continue;
+        }
+
+        char path[MAX_PATH_LEN];
+        char cmd[MAX_COMMAND_LEN];
+        pool_worktree_path(state, state->entries[i].branch, path, sizeof(path));
+
+        /* Only clean worktrees that are strictly behind are touched */
+        snprintf(cmd, sizeof(cmd),
+                 "-C \"%s\" status --porcelain --untracked-files=no", path);
+        cmd_result_t *result = exec_git_command(cmd);
+        bool clean = (result != NULL && result->exit_code == 0 && result->output_len == 0);
+        if (result != NULL) free_cmd_result(result);
+        if (!clean) {
+            continue;
+        }
+
+        snprintf(cmd, sizeof(cmd),
+                 "-C \"%s\" rev-list --left-right --count HEAD...@{upstream}", path);
+        result = exec_git_command(cmd);
+        int ahead = 0, behind = 0;
+        bool ok = (result != NULL && result->exit_code == 0 &&
+                   sscanf(result->output, "%d\t%d", &ahead, &behind) == 2);
+        if (result != NULL) free_cmd_result(result);
+        if (!ok || ahead != 0 || behind == 0) {
+            continue;
+        }
+
+        snprintf(cmd, sizeof(cmd), "-C \"%s\" merge --ff-only --quiet @{upstream}", path);
+        result = exec_git_command(cmd);
+        if (result != NULL) {
+            if (result->exit_code != 0) {
+                err = GM_ERR_COMMAND_FAILED;
+            }
+            free_cmd_result(result);
+        }
+    }
+
+    free(state);
+    return err;
+}
+
+/**
+ * Print the pool contents, hottest first
+ *
+ * @param settings Pool settings from the configuration
+ * @param repo_path Repository to operate on (NULL for the current directory)
+ * @return gm_error_t Error code
+ */
+gm_error_t worktree_pool_show(const worktree_pool_settings_t *settings, const char *repo_path) {
+    if (settings == NULL) {
+        return GM_ERR_INVALID_INPUT;
+    }
+
+    pool_state_t *state = (pool_state_t*)safe_calloc(1, sizeof(pool_state_t));
+    if (state == NULL) {
+        return GM_ERR_MEMORY_ALLOC;
+    }
+
+    gm_error_t err = resolve_pool_dir(settings, repo_path, state->pool_dir, sizeof(state->pool_dir));
+    if (err != GM_SUCCESS) {
+        free(state);
+        return err;
+    }
+
+    load_pool_state(state);
+
+    printf("\n" COLOR_BOLD "Worktree pool (%d max, %d MB budget):" COLOR_RESET "\n",
+           settings->size, settings->disk_budget_mb);
+
+    int shown = 0;
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < state->count; i++) {
+            if (state->entries[i].pooled &&
+                (best < 0 || pool_entry_colder(&state->entries[best], &state->entries[i]))) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        char path[MAX_PATH_LEN];
+        pool_worktree_path(state, state->entries[best].branch, path, sizeof(path));
+        printf("  " COLOR_GREEN "%-30s" COLOR_RESET " %4d switches  %s\n",
+               state->entries[best].branch, state->entries[best].checkouts, path);
+        state->entries[best].pooled = false;
+        shown++;
+    }
+
+    if (shown == 0) {
+        printf("  (empty)\n");
+    }
+
+    free(state);
+    return GM_SUCCESS;
+}